@@ -0,0 +1,32 @@
+#version 450
+
+layout(binding = 0) uniform UniformBufferObject
+{
+    mat4 Model;
+    mat4 View;
+    mat4 Proj;
+    vec4 Position;
+} UBO;
+
+layout(push_constant) uniform PushConstant
+{
+    mat4 Model;
+    vec4 BoundsMin;
+    vec4 BoundsExtent;
+} PC;
+
+layout(location = 0) in vec4 Position;
+layout(location = 3) in vec2 UV;
+
+layout(location = 0) out vec3 FragColor;
+layout(location = 1) out vec2 FragTexCoord;
+
+invariant gl_Position;
+
+void main() {
+    vec3 LocalPosition = PC.BoundsMin.xyz + Position.xyz * PC.BoundsExtent.xyz;
+
+    gl_Position = UBO.Proj * UBO.View * PC.Model * vec4(LocalPosition, 1.0);
+    FragColor = vec3(1.0);
+    FragTexCoord = UV;
+}
\ No newline at end of file
@@ -21,6 +21,8 @@ layout(location = 3) in vec2 UV;
 layout(location = 0) out vec3 FragColor;
 layout(location = 1) out vec2 FragTexCoord;
 
+invariant gl_Position;
+
 void main() {
     gl_Position = UBO.Proj * UBO.View * PC.Model * vec4(Position, 1.0);
     FragColor = Color;
@@ -1,5 +1,8 @@
 C:/VulkanSDK/1.3.275.0/Bin/glslc.exe BaseShader.vert -o BaseVertexShader.spv
 C:/VulkanSDK/1.3.275.0/Bin/glslc.exe BaseShader.frag -o BaseFragmentShader.spv
+C:/VulkanSDK/1.3.275.0/Bin/glslc.exe BasePackedShader.vert -o BasePackedVertexShader.spv
+C:/VulkanSDK/1.3.275.0/Bin/glslc.exe DepthShader.vert -o DepthVertexShader.spv
+C:/VulkanSDK/1.3.275.0/Bin/glslc.exe DepthPackedShader.vert -o DepthPackedVertexShader.spv
 C:/VulkanSDK/1.3.275.0/Bin/glslc.exe LightingShader.vert -o LightingVertexShader.spv
 C:/VulkanSDK/1.3.275.0/Bin/glslc.exe LightingShader.frag -o LightingFragmentShader.spv
 pause
\ No newline at end of file
@@ -0,0 +1,26 @@
+#version 450
+
+layout(binding = 0) uniform UniformBufferObject
+{
+    mat4 Model;
+    mat4 View;
+    mat4 Proj;
+    vec4 Position;
+} UBO;
+
+layout(push_constant) uniform PushConstant
+{
+    mat4 Model;
+    vec4 BoundsMin;
+    vec4 BoundsExtent;
+} PC;
+
+layout(location = 0) in vec4 Position;
+
+invariant gl_Position;
+
+void main() {
+    vec3 LocalPosition = PC.BoundsMin.xyz + Position.xyz * PC.BoundsExtent.xyz;
+
+    gl_Position = UBO.Proj * UBO.View * PC.Model * vec4(LocalPosition, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#version 450
+
+layout(binding = 0) uniform UniformBufferObject
+{
+    mat4 Model;
+    mat4 View;
+    mat4 Proj;
+    vec4 Position;
+} UBO;
+
+layout(push_constant) uniform PushConstant
+{
+    mat4 Model;
+} PC;
+
+layout(location = 0) in vec3 Position;
+
+invariant gl_Position;
+
+void main() {
+    gl_Position = UBO.Proj * UBO.View * PC.Model * vec4(Position, 1.0);
+}
\ No newline at end of file
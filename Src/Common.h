@@ -32,6 +32,8 @@
 #include <algorithm>
 #include <fstream>
 #include <chrono>
+#include <functional>
+#include <memory>
 
 enum class API { Vulkan, DirectX12, OpenGL, Undefined };
 
@@ -0,0 +1,984 @@
+#include "../../Src/Common.h"
+
+#include "Renderer.h"
+#include "Allocator.h"
+
+#include <mutex>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+VkDeviceSize Vulkan::Allocator::BlockSize = 256 * 1024 * 1024;
+VkDeviceSize Vulkan::Allocator::DedicatedImageSize = 16 * 1024 * 1024;
+double Vulkan::Allocator::BudgetLogInterval = 10.0;
+
+namespace
+{
+    /*
+        TLSF size classes: the first level is the power of two, the second splits it into 16 linear
+        steps. Everything below 256 bytes shares first level 0 in 16 byte steps.
+    */
+
+    const uint32_t SecondLevelLog2 = 4;
+    const uint32_t SecondLevelCount = 1 << SecondLevelLog2;
+    const uint32_t SmallSizeLog2 = 8;
+    const uint32_t FirstLevelCount = 48;
+    const uint32_t InvalidNode = UINT32_MAX;
+
+    struct Node
+    {
+        VkDeviceSize Offset = 0;
+        VkDeviceSize Size = 0;
+        uint32_t PreviousPhysical = InvalidNode;
+        uint32_t NextPhysical = InvalidNode;
+        uint32_t PreviousFree = InvalidNode;
+        uint32_t NextFree = InvalidNode;
+        bool Free = false;
+    };
+
+    struct Block
+    {
+        VkDeviceMemory Memory = VK_NULL_HANDLE;
+        VkDeviceSize Size = 0;
+        VkDeviceSize Used = 0;
+        uint32_t Allocations = 0;
+        char* Mapped = nullptr;
+
+        uint64_t FirstLevelMap = 0;
+        std::array<uint32_t, FirstLevelCount> SecondLevelMaps{};
+        std::vector<uint32_t> FreeHeads;
+
+        std::vector<Node> Nodes;
+        std::vector<uint32_t> SpareNodes;
+    };
+
+    /*
+        One pool per memory type and resource kind
+    */
+
+    struct Pool
+    {
+        std::vector<Block> Blocks;
+    };
+
+    std::mutex Mutex;
+    bool Initialized = false;
+
+    VkPhysicalDeviceMemoryProperties MemoryProperties{};
+    VkDeviceSize BufferImageGranularity = 1;
+    uint32_t MaxAllocationCount = 0;
+
+    std::vector<Pool> Pools;
+    std::vector<uint32_t> DedicatedCounts;
+    std::vector<VkDeviceSize> DedicatedBytes;
+    uint32_t DeviceMemoryCount = 0;
+
+    /*
+        Accounting, device memory held per heap and allocation bytes per category, both with peaks
+    */
+
+    std::vector<VkDeviceSize> HeapAllocated;
+    std::vector<VkDeviceSize> HeapPeak;
+    std::array<Vulkan::Allocator::CategoryStats, static_cast<size_t>(Vulkan::Allocator::Category::Count)> Categories{};
+
+    PFN_vkGetPhysicalDeviceMemoryProperties2KHR GetMemoryProperties2 = nullptr;
+
+    std::chrono::steady_clock::time_point LastBudgetCheck;
+    std::chrono::steady_clock::time_point LastBudgetLog;
+    std::vector<bool> OverBudget;
+
+    uint32_t LowestBit(uint64_t Value)
+    {
+#ifdef _MSC_VER
+        unsigned long Index;
+        _BitScanForward64(&Index, Value);
+        return static_cast<uint32_t>(Index);
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(Value));
+#endif
+    }
+
+    uint32_t HighestBit(uint64_t Value)
+    {
+#ifdef _MSC_VER
+        unsigned long Index;
+        _BitScanReverse64(&Index, Value);
+        return static_cast<uint32_t>(Index);
+#else
+        return 63 - static_cast<uint32_t>(__builtin_clzll(Value));
+#endif
+    }
+
+    VkDeviceSize AlignUp(VkDeviceSize Value, VkDeviceSize Alignment)
+    {
+        return (Value + Alignment - 1) / Alignment * Alignment;
+    }
+
+    void MapSize(VkDeviceSize Size, uint32_t& FirstLevel, uint32_t& SecondLevel)
+    {
+        if (Size < (VkDeviceSize(1) << SmallSizeLog2))
+        {
+            FirstLevel = 0;
+            SecondLevel = static_cast<uint32_t>(Size >> (SmallSizeLog2 - SecondLevelLog2));
+            return;
+        }
+
+        uint32_t Log2 = HighestBit(Size);
+
+        FirstLevel = Log2 - SmallSizeLog2 + 1;
+        SecondLevel = static_cast<uint32_t>(Size >> (Log2 - SecondLevelLog2)) ^ SecondLevelCount;
+    }
+
+    /*
+        Rounds up to the next class boundary, so every range in the class found fits the request
+    */
+
+    void MapSearchSize(VkDeviceSize Size, uint32_t& FirstLevel, uint32_t& SecondLevel)
+    {
+        if (Size < (VkDeviceSize(1) << SmallSizeLog2))
+        {
+            Size = AlignUp(Size, VkDeviceSize(1) << (SmallSizeLog2 - SecondLevelLog2));
+        }
+        else
+        {
+            Size += (VkDeviceSize(1) << (HighestBit(Size) - SecondLevelLog2)) - 1;
+        }
+
+        MapSize(Size, FirstLevel, SecondLevel);
+    }
+
+    uint32_t& FreeHead(Block& Owner, uint32_t FirstLevel, uint32_t SecondLevel)
+    {
+        return Owner.FreeHeads[FirstLevel * SecondLevelCount + SecondLevel];
+    }
+
+    uint32_t NewNode(Block& Owner)
+    {
+        if (!Owner.SpareNodes.empty())
+        {
+            uint32_t Index = Owner.SpareNodes.back();
+            Owner.SpareNodes.pop_back();
+
+            Owner.Nodes[Index] = Node{};
+            return Index;
+        }
+
+        Owner.Nodes.emplace_back();
+        return static_cast<uint32_t>(Owner.Nodes.size() - 1);
+    }
+
+    void InsertFree(Block& Owner, uint32_t Index)
+    {
+        uint32_t FirstLevel, SecondLevel;
+        MapSize(Owner.Nodes[Index].Size, FirstLevel, SecondLevel);
+
+        uint32_t& Head = FreeHead(Owner, FirstLevel, SecondLevel);
+
+        Owner.Nodes[Index].Free = true;
+        Owner.Nodes[Index].PreviousFree = InvalidNode;
+        Owner.Nodes[Index].NextFree = Head;
+
+        if (Head != InvalidNode)
+        {
+            Owner.Nodes[Head].PreviousFree = Index;
+        }
+
+        Head = Index;
+
+        Owner.FirstLevelMap |= uint64_t(1) << FirstLevel;
+        Owner.SecondLevelMaps[FirstLevel] |= 1u << SecondLevel;
+    }
+
+    void RemoveFree(Block& Owner, uint32_t Index)
+    {
+        Node& Target = Owner.Nodes[Index];
+
+        uint32_t FirstLevel, SecondLevel;
+        MapSize(Target.Size, FirstLevel, SecondLevel);
+
+        if (Target.PreviousFree != InvalidNode)
+        {
+            Owner.Nodes[Target.PreviousFree].NextFree = Target.NextFree;
+        }
+        else
+        {
+            FreeHead(Owner, FirstLevel, SecondLevel) = Target.NextFree;
+        }
+
+        if (Target.NextFree != InvalidNode)
+        {
+            Owner.Nodes[Target.NextFree].PreviousFree = Target.PreviousFree;
+        }
+
+        if (FreeHead(Owner, FirstLevel, SecondLevel) == InvalidNode)
+        {
+            Owner.SecondLevelMaps[FirstLevel] &= ~(1u << SecondLevel);
+
+            if (Owner.SecondLevelMaps[FirstLevel] == 0)
+            {
+                Owner.FirstLevelMap &= ~(uint64_t(1) << FirstLevel);
+            }
+        }
+
+        Target.Free = false;
+        Target.PreviousFree = InvalidNode;
+        Target.NextFree = InvalidNode;
+    }
+
+    uint32_t FindFree(Block& Owner, VkDeviceSize Size)
+    {
+        uint32_t FirstLevel, SecondLevel;
+        MapSearchSize(Size, FirstLevel, SecondLevel);
+
+        if (FirstLevel >= FirstLevelCount)
+        {
+            return InvalidNode;
+        }
+
+        uint32_t SecondLevelMap = Owner.SecondLevelMaps[FirstLevel] & (~0u << SecondLevel);
+
+        if (SecondLevelMap == 0)
+        {
+            uint64_t FirstLevelMap = FirstLevel + 1 < 64 ? Owner.FirstLevelMap & (~uint64_t(0) << (FirstLevel + 1)) : 0;
+
+            if (FirstLevelMap == 0)
+            {
+                return InvalidNode;
+            }
+
+            FirstLevel = LowestBit(FirstLevelMap);
+            SecondLevelMap = Owner.SecondLevelMaps[FirstLevel];
+        }
+
+        return FreeHead(Owner, FirstLevel, LowestBit(SecondLevelMap));
+    }
+
+    /*
+        Splits the tail of Index past Size off into a new free range
+    */
+
+    void SplitTail(Block& Owner, uint32_t Index, VkDeviceSize Size)
+    {
+        if (Owner.Nodes[Index].Size <= Size)
+        {
+            return;
+        }
+
+        uint32_t Tail = NewNode(Owner);
+
+        Node& Target = Owner.Nodes[Index];
+
+        Owner.Nodes[Tail].Offset = Target.Offset + Size;
+        Owner.Nodes[Tail].Size = Target.Size - Size;
+        Owner.Nodes[Tail].PreviousPhysical = Index;
+        Owner.Nodes[Tail].NextPhysical = Target.NextPhysical;
+
+        if (Target.NextPhysical != InvalidNode)
+        {
+            Owner.Nodes[Target.NextPhysical].PreviousPhysical = Tail;
+        }
+
+        Target.NextPhysical = Tail;
+        Target.Size = Size;
+
+        InsertFree(Owner, Tail);
+    }
+
+    bool TryAllocate(Block& Owner, VkDeviceSize Size, VkDeviceSize Alignment, uint32_t& Result)
+    {
+        uint32_t Index = FindFree(Owner, Size + Alignment - 1);
+
+        if (Index == InvalidNode)
+        {
+            return false;
+        }
+
+        RemoveFree(Owner, Index);
+
+        /*
+            Padding in front of the aligned start becomes a free range of its own
+        */
+
+        VkDeviceSize Padding = AlignUp(Owner.Nodes[Index].Offset, Alignment) - Owner.Nodes[Index].Offset;
+
+        if (Padding > 0)
+        {
+            uint32_t Aligned = Index;
+
+            SplitTail(Owner, Index, Padding);
+
+            Aligned = Owner.Nodes[Index].NextPhysical;
+            RemoveFree(Owner, Aligned);
+            InsertFree(Owner, Index);
+
+            Index = Aligned;
+        }
+
+        SplitTail(Owner, Index, Size);
+
+        Owner.Used += Size;
+        Owner.Allocations++;
+
+        Result = Index;
+        return true;
+    }
+
+    void FreeNode(Block& Owner, uint32_t Index)
+    {
+        Owner.Used -= Owner.Nodes[Index].Size;
+        Owner.Allocations--;
+
+        uint32_t Previous = Owner.Nodes[Index].PreviousPhysical;
+        uint32_t Next = Owner.Nodes[Index].NextPhysical;
+
+        if (Next != InvalidNode && Owner.Nodes[Next].Free)
+        {
+            RemoveFree(Owner, Next);
+
+            Owner.Nodes[Index].Size += Owner.Nodes[Next].Size;
+            Owner.Nodes[Index].NextPhysical = Owner.Nodes[Next].NextPhysical;
+
+            if (Owner.Nodes[Next].NextPhysical != InvalidNode)
+            {
+                Owner.Nodes[Owner.Nodes[Next].NextPhysical].PreviousPhysical = Index;
+            }
+
+            Owner.SpareNodes.push_back(Next);
+        }
+
+        if (Previous != InvalidNode && Owner.Nodes[Previous].Free)
+        {
+            RemoveFree(Owner, Previous);
+
+            Owner.Nodes[Previous].Size += Owner.Nodes[Index].Size;
+            Owner.Nodes[Previous].NextPhysical = Owner.Nodes[Index].NextPhysical;
+
+            if (Owner.Nodes[Index].NextPhysical != InvalidNode)
+            {
+                Owner.Nodes[Owner.Nodes[Index].NextPhysical].PreviousPhysical = Previous;
+            }
+
+            Owner.SpareNodes.push_back(Index);
+            Index = Previous;
+        }
+
+        InsertFree(Owner, Index);
+    }
+
+    bool IsHostVisible(uint32_t MemoryType)
+    {
+        return (MemoryProperties.memoryTypes[MemoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+    }
+
+    uint32_t GetHeap(uint32_t MemoryType)
+    {
+        return MemoryProperties.memoryTypes[MemoryType].heapIndex;
+    }
+
+    void Initialize()
+    {
+        if (Initialized)
+        {
+            return;
+        }
+
+        VkPhysicalDeviceProperties Properties;
+        vkGetPhysicalDeviceProperties(Vulkan::Renderer::PhysicalDevice, &Properties);
+        vkGetPhysicalDeviceMemoryProperties(Vulkan::Renderer::PhysicalDevice, &MemoryProperties);
+
+        BufferImageGranularity = std::max<VkDeviceSize>(Properties.limits.bufferImageGranularity, 1);
+        MaxAllocationCount = Properties.limits.maxMemoryAllocationCount;
+
+        Pools.assign(MemoryProperties.memoryTypeCount * static_cast<uint32_t>(Vulkan::Allocator::ResourceKind::Count), Pool{});
+        DedicatedCounts.assign(MemoryProperties.memoryHeapCount, 0);
+        DedicatedBytes.assign(MemoryProperties.memoryHeapCount, 0);
+        HeapAllocated.assign(MemoryProperties.memoryHeapCount, 0);
+        HeapPeak.assign(MemoryProperties.memoryHeapCount, 0);
+        OverBudget.assign(MemoryProperties.memoryHeapCount, false);
+
+        /*
+            Budget queries need VK_EXT_memory_budget on the device and memory properties 2, which is an
+            instance extension on a 1.0 instance
+        */
+
+        GetMemoryProperties2 = nullptr;
+
+        if (Vulkan::Renderer::MemoryBudgetSupported)
+        {
+            GetMemoryProperties2 = (PFN_vkGetPhysicalDeviceMemoryProperties2KHR)vkGetInstanceProcAddr(Vulkan::Renderer::Instance, "vkGetPhysicalDeviceMemoryProperties2KHR");
+        }
+
+        LastBudgetCheck = std::chrono::steady_clock::now();
+        LastBudgetLog = LastBudgetCheck;
+
+        Initialized = true;
+    }
+
+    uint32_t GetPoolIndex(uint32_t MemoryType, Vulkan::Allocator::ResourceKind Kind)
+    {
+        uint32_t KindIndex = BufferImageGranularity > 1 ? static_cast<uint32_t>(Kind) : 0;
+
+        return MemoryType * static_cast<uint32_t>(Vulkan::Allocator::ResourceKind::Count) + KindIndex;
+    }
+
+    /*
+        Block size for a heap, small heaps (integrated or BAR memory) get proportionally smaller blocks
+    */
+
+    VkDeviceSize GetPreferredBlockSize(uint32_t MemoryType)
+    {
+        VkDeviceSize HeapSize = MemoryProperties.memoryHeaps[GetHeap(MemoryType)].size;
+
+        if (HeapSize <= VkDeviceSize(1024) * 1024 * 1024)
+        {
+            return std::min(Vulkan::Allocator::BlockSize, AlignUp(HeapSize / 8, 32));
+        }
+
+        return Vulkan::Allocator::BlockSize;
+    }
+
+    bool AllocateDeviceMemory(uint32_t MemoryType, VkDeviceSize Size, VkDeviceMemory& Memory, char*& Mapped)
+    {
+        VkMemoryAllocateInfo AllocateInfo{};
+        AllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        AllocateInfo.allocationSize = Size;
+        AllocateInfo.memoryTypeIndex = MemoryType;
+
+        if (vkAllocateMemory(Vulkan::Renderer::Device, &AllocateInfo, nullptr, &Memory) != VK_SUCCESS)
+        {
+            return false;
+        }
+
+        Mapped = nullptr;
+
+        if (IsHostVisible(MemoryType))
+        {
+            void* Data = nullptr;
+            vkMapMemory(Vulkan::Renderer::Device, Memory, 0, VK_WHOLE_SIZE, 0, &Data);
+
+            Mapped = static_cast<char*>(Data);
+        }
+
+        DeviceMemoryCount++;
+
+        uint32_t Heap = GetHeap(MemoryType);
+
+        HeapAllocated[Heap] += Size;
+        HeapPeak[Heap] = std::max(HeapPeak[Heap], HeapAllocated[Heap]);
+
+        if (MaxAllocationCount > 0 && DeviceMemoryCount * 4 > MaxAllocationCount * 3)
+        {
+            std::cout << "VK > Warning, " << DeviceMemoryCount << " device memory allocations of " << MaxAllocationCount << " allowed" << std::endl;
+        }
+
+        return true;
+    }
+
+    void FreeDeviceMemory(uint32_t MemoryType, VkDeviceSize Size, VkDeviceMemory Memory, bool Mapped)
+    {
+        if (Mapped)
+        {
+            vkUnmapMemory(Vulkan::Renderer::Device, Memory);
+        }
+
+        vkFreeMemory(Vulkan::Renderer::Device, Memory, nullptr);
+
+        DeviceMemoryCount--;
+
+        HeapAllocated[GetHeap(MemoryType)] -= Size;
+    }
+
+    void Track(const Vulkan::Allocator::Allocation& Target)
+    {
+        auto& Stats = Categories[static_cast<size_t>(Target.Tag)];
+
+        Stats.Allocations++;
+        Stats.Bytes += Target.Size;
+        Stats.PeakBytes = std::max(Stats.PeakBytes, Stats.Bytes);
+    }
+
+    void Untrack(const Vulkan::Allocator::Allocation& Target)
+    {
+        auto& Stats = Categories[static_cast<size_t>(Target.Tag)];
+
+        Stats.Allocations--;
+        Stats.Bytes -= Target.Size;
+    }
+
+    bool CreateBlock(uint32_t MemoryType, VkDeviceSize Size, Block& Result)
+    {
+        if (!AllocateDeviceMemory(MemoryType, Size, Result.Memory, Result.Mapped))
+        {
+            return false;
+        }
+
+        Result.Size = Size;
+        Result.Used = 0;
+        Result.Allocations = 0;
+        Result.FirstLevelMap = 0;
+        Result.SecondLevelMaps.fill(0);
+        Result.FreeHeads.assign(FirstLevelCount * SecondLevelCount, InvalidNode);
+        Result.Nodes.clear();
+        Result.SpareNodes.clear();
+
+        uint32_t Whole = NewNode(Result);
+        Result.Nodes[Whole].Size = Size;
+
+        InsertFree(Result, Whole);
+
+        std::cout << "VK > New device memory block, type " << MemoryType << ", " << Size / (1024 * 1024) << " MB" << std::endl;
+
+        return true;
+    }
+
+    Vulkan::Allocator::Allocation AllocateDedicated(uint32_t MemoryType, VkDeviceSize Size, Vulkan::Allocator::Category Tag)
+    {
+        Vulkan::Allocator::Allocation Result;
+        char* Mapped = nullptr;
+
+        if (!AllocateDeviceMemory(MemoryType, Size, Result.Memory, Mapped))
+        {
+            throw std::runtime_error("VK > Failed to allocate dedicated device memory!");
+        }
+
+        Result.Size = Size;
+        Result.Mapped = Mapped;
+        Result.MemoryType = MemoryType;
+        Result.Tag = Tag;
+
+        DedicatedCounts[GetHeap(MemoryType)]++;
+        DedicatedBytes[GetHeap(MemoryType)] += Size;
+
+        Track(Result);
+
+        return Result;
+    }
+}
+
+Vulkan::Allocator::Allocation Vulkan::Allocator::Allocate(const VkMemoryRequirements& Requirements, VkMemoryPropertyFlags Properties, Vulkan::Allocator::ResourceKind Kind, Vulkan::Allocator::Category Tag, bool Dedicated)
+{
+    std::lock_guard<std::mutex> Lock(Mutex);
+
+    Initialize();
+
+    uint32_t MemoryType = Vulkan::Renderer::FindMemoryType(Requirements.memoryTypeBits, Properties);
+    VkDeviceSize PreferredBlockSize = GetPreferredBlockSize(MemoryType);
+
+    if (Dedicated || Requirements.size > PreferredBlockSize / 2)
+    {
+        return AllocateDedicated(MemoryType, Requirements.size, Tag);
+    }
+
+    uint32_t PoolIndex = GetPoolIndex(MemoryType, Kind);
+    Pool& Target = Pools[PoolIndex];
+
+    VkDeviceSize Alignment = std::max<VkDeviceSize>(Requirements.alignment, 1);
+
+    Vulkan::Allocator::Allocation Result;
+    Result.Size = Requirements.size;
+    Result.MemoryType = MemoryType;
+    Result.Tag = Tag;
+    Result.Pool = PoolIndex;
+
+    auto Finish = [&](uint32_t BlockIndex, uint32_t NodeIndex)
+    {
+        Block& Owner = Target.Blocks[BlockIndex];
+
+        Result.Memory = Owner.Memory;
+        Result.Offset = Owner.Nodes[NodeIndex].Offset;
+        Result.Mapped = Owner.Mapped != nullptr ? Owner.Mapped + Result.Offset : nullptr;
+        Result.Block = BlockIndex;
+        Result.Node = NodeIndex;
+
+        Track(Result);
+
+        return Result;
+    };
+
+    for (uint32_t i = 0; i < Target.Blocks.size(); i++)
+    {
+        uint32_t NodeIndex;
+
+        if (Target.Blocks[i].Memory != VK_NULL_HANDLE && TryAllocate(Target.Blocks[i], Requirements.size, Alignment, NodeIndex))
+        {
+            return Finish(i, NodeIndex);
+        }
+    }
+
+    /*
+        Nothing fits, reuse a released block slot or add a new one. If the heap can't take a full block
+        the request falls back to a dedicated allocation of its own size.
+    */
+
+    auto Empty = std::find_if(Target.Blocks.begin(), Target.Blocks.end(), [](const Block& Candidate) { return Candidate.Memory == VK_NULL_HANDLE; });
+
+    if (Empty == Target.Blocks.end())
+    {
+        Target.Blocks.emplace_back();
+        Empty = Target.Blocks.end() - 1;
+    }
+
+    if (!CreateBlock(MemoryType, PreferredBlockSize, *Empty))
+    {
+        return AllocateDedicated(MemoryType, Requirements.size, Tag);
+    }
+
+    uint32_t NodeIndex;
+    TryAllocate(*Empty, Requirements.size, Alignment, NodeIndex);
+
+    return Finish(static_cast<uint32_t>(Empty - Target.Blocks.begin()), NodeIndex);
+}
+
+void Vulkan::Allocator::Free(Vulkan::Allocator::Allocation& Target)
+{
+    if (Target.Memory == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> Lock(Mutex);
+
+    Untrack(Target);
+
+    if (Target.IsDedicated())
+    {
+        FreeDeviceMemory(Target.MemoryType, Target.Size, Target.Memory, Target.Mapped != nullptr);
+
+        DedicatedCounts[GetHeap(Target.MemoryType)]--;
+        DedicatedBytes[GetHeap(Target.MemoryType)] -= Target.Size;
+
+        Target = Vulkan::Allocator::Allocation{};
+        return;
+    }
+
+    Pool& Owner = Pools[Target.Pool];
+    Block& Parent = Owner.Blocks[Target.Block];
+
+    FreeNode(Parent, Target.Node);
+
+    /*
+        Blocks past the first are given back once empty
+    */
+
+    if (Parent.Allocations == 0 && Target.Block > 0)
+    {
+        FreeDeviceMemory(Target.MemoryType, Parent.Size, Parent.Memory, Parent.Mapped != nullptr);
+
+        Parent = Block{};
+    }
+
+    Target = Vulkan::Allocator::Allocation{};
+}
+
+void Vulkan::Allocator::CreateBuffer(const VkBufferCreateInfo& CreateInfo, VkMemoryPropertyFlags Properties, VkBuffer& Buffer, Vulkan::Allocator::Allocation& Memory, Vulkan::Allocator::Category Tag)
+{
+    if (vkCreateBuffer(Vulkan::Renderer::Device, &CreateInfo, nullptr, &Buffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("VK > Failed to create buffer!");
+    }
+
+    VkMemoryRequirements MemoryRequirements;
+    vkGetBufferMemoryRequirements(Vulkan::Renderer::Device, Buffer, &MemoryRequirements);
+
+    Memory = Vulkan::Allocator::Allocate(MemoryRequirements, Properties, Vulkan::Allocator::ResourceKind::Linear, Tag);
+
+    vkBindBufferMemory(Vulkan::Renderer::Device, Buffer, Memory.Memory, Memory.Offset);
+}
+
+void Vulkan::Allocator::DestroyBuffer(VkBuffer& Buffer, Vulkan::Allocator::Allocation& Memory)
+{
+    if (Buffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(Vulkan::Renderer::Device, Buffer, nullptr);
+        Buffer = VK_NULL_HANDLE;
+    }
+
+    Vulkan::Allocator::Free(Memory);
+}
+
+void Vulkan::Allocator::CreateImage(const VkImageCreateInfo& CreateInfo, VkMemoryPropertyFlags Properties, VkImage& Image, Vulkan::Allocator::Allocation& Memory, Vulkan::Allocator::Category Tag)
+{
+    if (vkCreateImage(Vulkan::Renderer::Device, &CreateInfo, nullptr, &Image) != VK_SUCCESS)
+    {
+        throw std::runtime_error("VK > Failed to create image!");
+    }
+
+    VkMemoryRequirements MemoryRequirements;
+    vkGetImageMemoryRequirements(Vulkan::Renderer::Device, Image, &MemoryRequirements);
+
+    /*
+        Attachments are recreated with the swap chain and large images would fragment the blocks
+    */
+
+    VkImageUsageFlags AttachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    bool Dedicated = (CreateInfo.usage & AttachmentUsage) != 0 || MemoryRequirements.size >= Vulkan::Allocator::DedicatedImageSize;
+
+    Vulkan::Allocator::ResourceKind Kind = CreateInfo.tiling == VK_IMAGE_TILING_OPTIMAL ? Vulkan::Allocator::ResourceKind::Optimal : Vulkan::Allocator::ResourceKind::Linear;
+
+    Memory = Vulkan::Allocator::Allocate(MemoryRequirements, Properties, Kind, Tag, Dedicated);
+
+    vkBindImageMemory(Vulkan::Renderer::Device, Image, Memory.Memory, Memory.Offset);
+}
+
+void Vulkan::Allocator::DestroyImage(VkImage& Image, Vulkan::Allocator::Allocation& Memory)
+{
+    if (Image != VK_NULL_HANDLE)
+    {
+        vkDestroyImage(Vulkan::Renderer::Device, Image, nullptr);
+        Image = VK_NULL_HANDLE;
+    }
+
+    Vulkan::Allocator::Free(Memory);
+}
+
+std::vector<Vulkan::Allocator::HeapStats> Vulkan::Allocator::GetHeapStats()
+{
+    std::lock_guard<std::mutex> Lock(Mutex);
+
+    std::vector<Vulkan::Allocator::HeapStats> Result(MemoryProperties.memoryHeapCount);
+
+    for (uint32_t Heap = 0; Heap < MemoryProperties.memoryHeapCount; Heap++)
+    {
+        Result[Heap].HeapSize = MemoryProperties.memoryHeaps[Heap].size;
+        Result[Heap].DedicatedAllocations = DedicatedCounts[Heap];
+        Result[Heap].DedicatedBytes = DedicatedBytes[Heap];
+    }
+
+    for (uint32_t PoolIndex = 0; PoolIndex < Pools.size(); PoolIndex++)
+    {
+        uint32_t MemoryType = PoolIndex / static_cast<uint32_t>(Vulkan::Allocator::ResourceKind::Count);
+        Vulkan::Allocator::HeapStats& Stats = Result[GetHeap(MemoryType)];
+
+        for (const auto& Entry : Pools[PoolIndex].Blocks)
+        {
+            if (Entry.Memory == VK_NULL_HANDLE)
+            {
+                continue;
+            }
+
+            Stats.Blocks++;
+            Stats.Allocations += Entry.Allocations;
+            Stats.BlockBytes += Entry.Size;
+            Stats.UsedBytes += Entry.Used;
+        }
+    }
+
+    return Result;
+}
+
+uint32_t Vulkan::Allocator::GetDeviceMemoryCount()
+{
+    std::lock_guard<std::mutex> Lock(Mutex);
+
+    return DeviceMemoryCount;
+}
+
+std::array<Vulkan::Allocator::CategoryStats, static_cast<size_t>(Vulkan::Allocator::Category::Count)> Vulkan::Allocator::GetCategoryStats()
+{
+    std::lock_guard<std::mutex> Lock(Mutex);
+
+    return Categories;
+}
+
+const char* Vulkan::Allocator::GetCategoryName(Vulkan::Allocator::Category Tag)
+{
+    switch (Tag)
+    {
+    case Vulkan::Allocator::Category::Geometry:
+        return "geometry";
+    case Vulkan::Allocator::Category::Textures:
+        return "textures";
+    case Vulkan::Allocator::Category::Uniforms:
+        return "uniforms";
+    case Vulkan::Allocator::Category::Depth:
+        return "depth";
+    case Vulkan::Allocator::Category::Staging:
+        return "staging";
+    default:
+        return "other";
+    }
+}
+
+std::vector<Vulkan::Allocator::HeapBudget> Vulkan::Allocator::GetBudgets()
+{
+    std::lock_guard<std::mutex> Lock(Mutex);
+
+    std::vector<Vulkan::Allocator::HeapBudget> Result(MemoryProperties.memoryHeapCount);
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT Budget{};
+    Budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    if (GetMemoryProperties2 != nullptr)
+    {
+        VkPhysicalDeviceMemoryProperties2 Properties{};
+        Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        Properties.pNext = &Budget;
+
+        GetMemoryProperties2(Vulkan::Renderer::PhysicalDevice, &Properties);
+    }
+
+    for (uint32_t Heap = 0; Heap < MemoryProperties.memoryHeapCount; Heap++)
+    {
+        Vulkan::Allocator::HeapBudget& Entry = Result[Heap];
+
+        Entry.HeapSize = MemoryProperties.memoryHeaps[Heap].size;
+        Entry.Allocated = HeapAllocated[Heap];
+        Entry.PeakAllocated = HeapPeak[Heap];
+
+        /*
+            Drivers may leave a heap at zero budget, the estimate is the better answer then
+        */
+
+        if (GetMemoryProperties2 != nullptr && Budget.heapBudget[Heap] > 0)
+        {
+            Entry.Usage = Budget.heapUsage[Heap];
+            Entry.Budget = Budget.heapBudget[Heap];
+            Entry.FromDriver = true;
+        }
+        else
+        {
+            Entry.Usage = Entry.Allocated;
+            Entry.Budget = Entry.HeapSize / 10 * 8;
+        }
+    }
+
+    return Result;
+}
+
+void Vulkan::Allocator::PrintBudget()
+{
+    if (!Initialized)
+    {
+        return;
+    }
+
+    std::vector<Vulkan::Allocator::HeapBudget> Budgets = Vulkan::Allocator::GetBudgets();
+
+    for (uint32_t Heap = 0; Heap < Budgets.size(); Heap++)
+    {
+        const Vulkan::Allocator::HeapBudget& Entry = Budgets[Heap];
+
+        if (Entry.PeakAllocated == 0)
+        {
+            continue;
+        }
+
+        bool DeviceLocal = (MemoryProperties.memoryHeaps[Heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+
+        std::cout << "VK > Heap " << Heap << (DeviceLocal ? " (device local): " : " (host): ")
+            << Entry.Usage / (1024 * 1024) << " / " << Entry.Budget / (1024 * 1024) << " MB " << (Entry.FromDriver ? "budget" : "estimated budget")
+            << ", allocator holds " << Entry.Allocated / (1024 * 1024) << " MB, peak " << Entry.PeakAllocated / (1024 * 1024) << " MB" << std::endl;
+    }
+
+    std::array<Vulkan::Allocator::CategoryStats, static_cast<size_t>(Vulkan::Allocator::Category::Count)> Stats = Vulkan::Allocator::GetCategoryStats();
+
+    std::cout << "VK > Memory by category:";
+
+    for (size_t i = 0; i < Stats.size(); i++)
+    {
+        if (Stats[i].PeakBytes == 0)
+        {
+            continue;
+        }
+
+        std::cout << " " << Vulkan::Allocator::GetCategoryName(static_cast<Vulkan::Allocator::Category>(i)) << " " << Stats[i].Bytes / 1024 << " KB"
+            << " (" << Stats[i].Allocations << ", peak " << Stats[i].PeakBytes / 1024 << " KB)";
+    }
+
+    std::cout << std::endl;
+}
+
+void Vulkan::Allocator::Update()
+{
+    if (!Initialized)
+    {
+        return;
+    }
+
+    auto Now = std::chrono::steady_clock::now();
+
+    /*
+        The budget query goes to the driver, once a second is plenty to catch a heap filling up
+    */
+
+    if (Now - LastBudgetCheck < std::chrono::seconds(1))
+    {
+        return;
+    }
+
+    LastBudgetCheck = Now;
+
+    std::vector<Vulkan::Allocator::HeapBudget> Budgets = Vulkan::Allocator::GetBudgets();
+
+    for (uint32_t Heap = 0; Heap < Budgets.size(); Heap++)
+    {
+        bool Over = Budgets[Heap].Budget > 0 && Budgets[Heap].Usage > Budgets[Heap].Budget / 10 * 9;
+
+        if (Over && !OverBudget[Heap])
+        {
+            std::cout << "VK > Warning, heap " << Heap << " at " << Budgets[Heap].Usage / (1024 * 1024) << " of " << Budgets[Heap].Budget / (1024 * 1024) << " MB budget" << std::endl;
+        }
+
+        OverBudget[Heap] = Over;
+    }
+
+    if (Vulkan::Allocator::BudgetLogInterval > 0.0 && std::chrono::duration<double>(Now - LastBudgetLog).count() >= Vulkan::Allocator::BudgetLogInterval)
+    {
+        LastBudgetLog = Now;
+
+        Vulkan::Allocator::PrintBudget();
+    }
+}
+
+void Vulkan::Allocator::PrintStats()
+{
+    std::vector<Vulkan::Allocator::HeapStats> Stats = Vulkan::Allocator::GetHeapStats();
+
+    for (uint32_t Heap = 0; Heap < Stats.size(); Heap++)
+    {
+        const Vulkan::Allocator::HeapStats& Entry = Stats[Heap];
+
+        if (Entry.Blocks == 0 && Entry.DedicatedAllocations == 0)
+        {
+            continue;
+        }
+
+        bool DeviceLocal = (MemoryProperties.memoryHeaps[Heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+
+        std::cout << "VK > Heap " << Heap << (DeviceLocal ? " (device local, " : " (host, ") << Entry.HeapSize / (1024 * 1024) << " MB): "
+            << Entry.Allocations << " allocations using " << Entry.UsedBytes / 1024 << " / " << Entry.BlockBytes / 1024 << " KB in " << Entry.Blocks << " blocks, "
+            << Entry.DedicatedAllocations << " dedicated (" << Entry.DedicatedBytes / 1024 << " KB)" << std::endl;
+    }
+
+    std::cout << "VK > " << Vulkan::Allocator::GetDeviceMemoryCount() << " device memory objects of " << MaxAllocationCount << " allowed" << std::endl;
+}
+
+void Vulkan::Allocator::Destroy()
+{
+    std::lock_guard<std::mutex> Lock(Mutex);
+
+    for (uint32_t PoolIndex = 0; PoolIndex < Pools.size(); PoolIndex++)
+    {
+        uint32_t MemoryType = PoolIndex / static_cast<uint32_t>(Vulkan::Allocator::ResourceKind::Count);
+
+        for (auto& Entry : Pools[PoolIndex].Blocks)
+        {
+            if (Entry.Memory == VK_NULL_HANDLE)
+            {
+                continue;
+            }
+
+            if (Entry.Allocations > 0)
+            {
+                std::cout << "VK > " << Entry.Allocations << " allocations still live in a device memory block at shutdown" << std::endl;
+            }
+
+            FreeDeviceMemory(MemoryType, Entry.Size, Entry.Memory, Entry.Mapped != nullptr);
+        }
+    }
+
+    Pools.clear();
+    Categories = {};
+    Initialized = false;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+namespace Vulkan
+{
+	/*
+		Device memory sub-allocator, so the number of live vkAllocateMemory objects stays in the tens
+		no matter how many buffers and images exist.
+
+		Memory is taken from the driver in large blocks per memory type and handed out with a
+		two-level segregated fit (TLSF) allocator: free ranges are bucketed by size class with a
+		bitmap per level, so finding a fit and merging a freed range with its neighbours are both
+		constant time. Host visible blocks are mapped once for their whole lifetime.
+
+		When bufferImageGranularity is larger than 1, buffers and optimally tiled images are kept in
+		separate blocks, so linear and non-linear resources never share a granularity page.
+	*/
+
+	namespace Allocator
+	{
+		enum class ResourceKind : uint32_t { Linear, Optimal, Count };
+
+		/*
+			What an allocation is used for, every allocation is accounted under exactly one
+		*/
+
+		enum class Category : uint32_t { Geometry, Textures, Uniforms, Depth, Staging, Other, Count };
+
+		struct Allocation
+		{
+			VkDeviceMemory Memory = VK_NULL_HANDLE;
+			VkDeviceSize Offset = 0;
+			VkDeviceSize Size = 0;
+
+			/*
+				Host visible allocations stay mapped, already offset to the start of this allocation
+			*/
+
+			void* Mapped = nullptr;
+
+			uint32_t MemoryType = 0;
+			Category Tag = Category::Other;
+			uint32_t Pool = UINT32_MAX;
+			uint32_t Block = UINT32_MAX;
+			uint32_t Node = UINT32_MAX;
+
+			bool IsDedicated() const
+			{
+				return Memory != VK_NULL_HANDLE && Block == UINT32_MAX;
+			}
+		};
+
+		/*
+			Preferred block size, heaps of 1 GB or less use an eighth of the heap instead. Requests
+			larger than half a block always get a dedicated allocation.
+		*/
+
+		extern VkDeviceSize BlockSize;
+
+		/*
+			Images at least this large get their own allocation, as do all attachments
+		*/
+
+		extern VkDeviceSize DedicatedImageSize;
+
+		/*
+			Seconds between budget log lines written by Update, 0 turns the periodic log off
+		*/
+
+		extern double BudgetLogInterval;
+
+		Allocation Allocate(const VkMemoryRequirements& Requirements, VkMemoryPropertyFlags Properties, ResourceKind Kind, Category Tag = Category::Other, bool Dedicated = false);
+		void Free(Allocation& Target);
+
+		/*
+			Create a resource, allocate and bind its memory in one go. Destroy releases both.
+		*/
+
+		void CreateBuffer(const VkBufferCreateInfo& CreateInfo, VkMemoryPropertyFlags Properties, VkBuffer& Buffer, Allocation& Memory, Category Tag = Category::Other);
+		void DestroyBuffer(VkBuffer& Buffer, Allocation& Memory);
+
+		void CreateImage(const VkImageCreateInfo& CreateInfo, VkMemoryPropertyFlags Properties, VkImage& Image, Allocation& Memory, Category Tag = Category::Other);
+		void DestroyImage(VkImage& Image, Allocation& Memory);
+
+		struct HeapStats
+		{
+			uint32_t Blocks = 0;
+			uint32_t Allocations = 0;
+			uint32_t DedicatedAllocations = 0;
+			VkDeviceSize BlockBytes = 0;
+			VkDeviceSize UsedBytes = 0;
+			VkDeviceSize DedicatedBytes = 0;
+			VkDeviceSize HeapSize = 0;
+		};
+
+		std::vector<HeapStats> GetHeapStats();
+
+		struct CategoryStats
+		{
+			uint32_t Allocations = 0;
+			VkDeviceSize Bytes = 0;
+			VkDeviceSize PeakBytes = 0;
+		};
+
+		std::array<CategoryStats, static_cast<size_t>(Category::Count)> GetCategoryStats();
+		const char* GetCategoryName(Category Tag);
+
+		/*
+			Per heap view for capacity planning. Allocated is the device memory this allocator holds, with
+			its peak since startup. Usage and Budget come from VK_EXT_memory_budget when the device has it
+			and cover the whole process. Without it Usage is Allocated and Budget is 80% of the heap.
+		*/
+
+		struct HeapBudget
+		{
+			VkDeviceSize HeapSize = 0;
+			VkDeviceSize Allocated = 0;
+			VkDeviceSize PeakAllocated = 0;
+			VkDeviceSize Usage = 0;
+			VkDeviceSize Budget = 0;
+			bool FromDriver = false;
+		};
+
+		std::vector<HeapBudget> GetBudgets();
+
+		/*
+			Live VkDeviceMemory objects, compared against maxMemoryAllocationCount
+		*/
+
+		uint32_t GetDeviceMemoryCount();
+
+		void PrintStats();
+		void PrintBudget();
+
+		/*
+			Called once per frame, writes the budget log every BudgetLogInterval seconds and warns as soon
+			as a heap goes over 90% of its budget
+		*/
+
+		void Update();
+		void Destroy();
+	}
+}
+
+#endif
@@ -0,0 +1,137 @@
+#include "../../Src/Common.h"
+
+#include "Renderer.h"
+#include "Deletion.h"
+
+#include <deque>
+
+namespace
+{
+    struct Entry
+    {
+        uint64_t Frame;
+        uint64_t Batch;
+        std::function<void()> Destroy;
+    };
+
+    std::deque<Entry> Pending;
+
+    /*
+        Frames are numbered from 1 in submission order, Slots holds the number last submitted with
+        each frame in flight slot
+    */
+
+    uint64_t SubmittedFrames = 0;
+    uint64_t CompletedFrames = 0;
+    std::vector<uint64_t> Slots;
+
+    void Collect()
+    {
+        /*
+            Tags never decrease, so the queue is in completion order
+        */
+
+        while (!Pending.empty() && Pending.front().Frame <= CompletedFrames && Vulkan::Staging::IsComplete(Pending.front().Batch))
+        {
+            std::function<void()> Destroy = std::move(Pending.front().Destroy);
+            Pending.pop_front();
+
+            Destroy();
+        }
+    }
+}
+
+void Vulkan::Deletion::Defer(std::function<void()> Destroy)
+{
+    Pending.push_back({ SubmittedFrames + 1, Vulkan::Staging::GetBatch(), std::move(Destroy) });
+}
+
+void Vulkan::Deletion::DestroyBuffer(VkBuffer& Buffer, Vulkan::Allocator::Allocation& Memory)
+{
+    VkBuffer Target = Buffer;
+    Vulkan::Allocator::Allocation TargetMemory = Memory;
+
+    Vulkan::Deletion::Defer([Target, TargetMemory]() mutable
+    {
+        Vulkan::Allocator::DestroyBuffer(Target, TargetMemory);
+    });
+
+    Buffer = VK_NULL_HANDLE;
+    Memory = Vulkan::Allocator::Allocation{};
+}
+
+void Vulkan::Deletion::DestroyImage(VkImage& Image, Vulkan::Allocator::Allocation& Memory)
+{
+    VkImage Target = Image;
+    Vulkan::Allocator::Allocation TargetMemory = Memory;
+
+    Vulkan::Deletion::Defer([Target, TargetMemory]() mutable
+    {
+        Vulkan::Allocator::DestroyImage(Target, TargetMemory);
+    });
+
+    Image = VK_NULL_HANDLE;
+    Memory = Vulkan::Allocator::Allocation{};
+}
+
+void Vulkan::Deletion::DestroyImageView(VkImageView& ImageView)
+{
+    VkImageView Target = ImageView;
+
+    Vulkan::Deletion::Defer([Target]()
+    {
+        vkDestroyImageView(Vulkan::Renderer::Device, Target, nullptr);
+    });
+
+    ImageView = VK_NULL_HANDLE;
+}
+
+void Vulkan::Deletion::DestroyPipeline(VkPipeline& Pipeline)
+{
+    VkPipeline Target = Pipeline;
+
+    Vulkan::Deletion::Defer([Target]()
+    {
+        vkDestroyPipeline(Vulkan::Renderer::Device, Target, nullptr);
+    });
+
+    Pipeline = VK_NULL_HANDLE;
+}
+
+void Vulkan::Deletion::FrameSubmitted(uint32_t Slot)
+{
+    if (Slot >= Slots.size())
+    {
+        Slots.resize(Slot + 1, 0);
+    }
+
+    Slots[Slot] = ++SubmittedFrames;
+}
+
+void Vulkan::Deletion::FrameComplete(uint32_t Slot)
+{
+    if (Slot < Slots.size())
+    {
+        CompletedFrames = std::max(CompletedFrames, Slots[Slot]);
+    }
+
+    Collect();
+}
+
+size_t Vulkan::Deletion::GetPendingCount()
+{
+    return Pending.size();
+}
+
+void Vulkan::Deletion::Flush()
+{
+    CompletedFrames = SubmittedFrames;
+
+    while (!Pending.empty())
+    {
+        std::function<void()> Destroy = std::move(Pending.front().Destroy);
+        Pending.pop_front();
+
+        Destroy();
+    }
+}
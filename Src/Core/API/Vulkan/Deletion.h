@@ -0,0 +1,52 @@
+#pragma once
+
+#ifndef DELETION_H
+#define DELETION_H
+
+namespace Vulkan
+{
+	/*
+		Deferred destruction, so resources can be released mid-session without vkDeviceWaitIdle.
+
+		Everything queued is tagged with the next frame to be submitted, the earliest frame that can no
+		longer be using it, and with the staging batch recording at the time, which may still copy into
+		it. Frames on the graphics queue complete in submission order, so once the fence of a frame has
+		been waited on every entry tagged with that frame or earlier is destroyed.
+	*/
+
+	namespace Deletion
+	{
+		/*
+			Run Destroy once nothing in flight can reference what it frees
+		*/
+
+		void Defer(std::function<void()> Destroy);
+
+		/*
+			Queue the resource and clear the caller's handles straight away
+		*/
+
+		void DestroyBuffer(VkBuffer& Buffer, Vulkan::Allocator::Allocation& Memory);
+		void DestroyImage(VkImage& Image, Vulkan::Allocator::Allocation& Memory);
+		void DestroyImageView(VkImageView& ImageView);
+		void DestroyPipeline(VkPipeline& Pipeline);
+
+		/*
+			FrameSubmitted right after a frame's vkQueueSubmit, FrameComplete once its InFlightFence
+			has been waited on, which also destroys whatever that frame was holding back
+		*/
+
+		void FrameSubmitted(uint32_t Slot);
+		void FrameComplete(uint32_t Slot);
+
+		size_t GetPendingCount();
+
+		/*
+			Destroy everything queued regardless of frames, only valid once the device is idle
+		*/
+
+		void Flush();
+	}
+}
+
+#endif
@@ -0,0 +1,329 @@
+#include "../../Src/Common.h"
+
+#include "Renderer.h"
+#include "GpuProfiler.h"
+
+bool Vulkan::GpuProfiler::Enabled = true;
+uint32_t Vulkan::GpuProfiler::HistorySize = 256;
+double Vulkan::GpuProfiler::LogInterval = 5.0;
+
+namespace
+{
+    /*
+        Section i writes queries 2i (begin) and 2i + 1 (end) of every pool
+    */
+
+    struct Section
+    {
+        std::string Name;
+        std::vector<double> History;
+        uint32_t Next = 0;
+        uint64_t Samples = 0;
+        double Last = 0.0;
+    };
+
+    std::vector<Section> Sections;
+
+    std::vector<VkQueryPool> Pools;
+
+    /*
+        Set when a command buffer writing the slot's pool was submitted, cleared once Collect has read it, so
+        a frame that was skipped before its submit is never read twice
+    */
+
+    std::vector<bool> PoolSubmitted;
+    VkQueryPool RecordingPool = VK_NULL_HANDLE;
+
+    bool Supported = false;
+    double TimestampPeriod = 0.0;
+    uint64_t TimestampMask = 0;
+
+    auto LastLog = std::chrono::high_resolution_clock::now();
+
+    const uint32_t QueryCount = Vulkan::GpuProfiler::MaxSections * 2;
+
+    void AddSample(Section& Target, double Milliseconds)
+    {
+        uint32_t Size = std::max<uint32_t>(Vulkan::GpuProfiler::HistorySize, 1);
+
+        if (Target.History.size() != Size)
+        {
+            Target.History.assign(Size, 0.0);
+            Target.Next = 0;
+            Target.Samples = 0;
+        }
+
+        Target.History[Target.Next] = Milliseconds;
+        Target.Next = (Target.Next + 1) % static_cast<uint32_t>(Target.History.size());
+        Target.Samples++;
+        Target.Last = Milliseconds;
+    }
+}
+
+void Vulkan::GpuProfiler::Create()
+{
+    VkPhysicalDeviceProperties Properties;
+    vkGetPhysicalDeviceProperties(Vulkan::Renderer::PhysicalDevice, &Properties);
+
+    uint32_t FamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(Vulkan::Renderer::PhysicalDevice, &FamilyCount, nullptr);
+
+    std::vector<VkQueueFamilyProperties> Families(FamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(Vulkan::Renderer::PhysicalDevice, &FamilyCount, Families.data());
+
+    uint32_t Graphics = Vulkan::Renderer::FindQueueFamilies(Vulkan::Renderer::PhysicalDevice).GraphicsFamily.value();
+    uint32_t ValidBits = Graphics < Families.size() ? Families[Graphics].timestampValidBits : 0;
+
+    Supported = ValidBits > 0 && Properties.limits.timestampPeriod > 0.0f;
+
+    if (!Supported)
+    {
+        std::cout << "VK > Graphics queue has no timestamps, GPU profiler disabled" << std::endl;
+        return;
+    }
+
+    TimestampPeriod = Properties.limits.timestampPeriod;
+    TimestampMask = ValidBits >= 64 ? UINT64_MAX : (uint64_t(1) << ValidBits) - 1;
+
+    VkQueryPoolCreateInfo CreateInfo{};
+    CreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    CreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    CreateInfo.queryCount = QueryCount;
+
+    Pools.resize(Vulkan::Renderer::MaxFramesInFlight);
+    PoolSubmitted.assign(Vulkan::Renderer::MaxFramesInFlight, false);
+
+    for (auto& Pool : Pools)
+    {
+        if (vkCreateQueryPool(Vulkan::Renderer::Device, &CreateInfo, nullptr, &Pool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("VK > Failed to create timestamp query pool!");
+        }
+    }
+
+    Sections.reserve(Vulkan::GpuProfiler::MaxSections);
+}
+
+void Vulkan::GpuProfiler::Destroy()
+{
+    for (auto Pool : Pools)
+    {
+        vkDestroyQueryPool(Vulkan::Renderer::Device, Pool, nullptr);
+    }
+
+    Pools.clear();
+    PoolSubmitted.clear();
+    RecordingPool = VK_NULL_HANDLE;
+}
+
+void Vulkan::GpuProfiler::Collect(uint32_t Frame)
+{
+    if (Frame >= Pools.size() || !PoolSubmitted[Frame])
+    {
+        return;
+    }
+
+    PoolSubmitted[Frame] = false;
+
+    if (Sections.empty())
+    {
+        return;
+    }
+
+    /*
+        The frame's fence has signalled, so this never waits. Sections its command buffer didn't
+        write report unavailable and are skipped.
+    */
+
+    uint32_t Count = static_cast<uint32_t>(Sections.size()) * 2;
+    std::vector<uint64_t> Results(Count * 2);
+
+    VkResult Result = vkGetQueryPoolResults(Vulkan::Renderer::Device, Pools[Frame], 0, Count, Results.size() * sizeof(uint64_t), Results.data(),
+        sizeof(uint64_t) * 2, VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+    if (Result != VK_SUCCESS && Result != VK_NOT_READY)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < Sections.size(); i++)
+    {
+        const uint64_t* Query = &Results[i * 4];
+
+        if (Query[1] == 0 || Query[3] == 0)
+        {
+            continue;
+        }
+
+        uint64_t Ticks = (Query[2] - Query[0]) & TimestampMask;
+
+        AddSample(Sections[i], Ticks * TimestampPeriod / 1000000.0);
+    }
+}
+
+void Vulkan::GpuProfiler::BeginFrame(VkCommandBuffer CommandBuffer, uint32_t Frame)
+{
+    if (!Vulkan::GpuProfiler::Enabled || !Supported || Frame >= Pools.size())
+    {
+        RecordingPool = VK_NULL_HANDLE;
+        return;
+    }
+
+    vkCmdResetQueryPool(CommandBuffer, Pools[Frame], 0, QueryCount);
+
+    RecordingPool = Pools[Frame];
+}
+
+void Vulkan::GpuProfiler::FrameSubmitted(uint32_t Frame)
+{
+    /*
+        Cached command buffers are thrown away when Enabled changes, so whatever was just submitted wrote
+        the pool exactly when profiling is on
+    */
+
+    if (Vulkan::GpuProfiler::Enabled && Supported && Frame < Pools.size())
+    {
+        PoolSubmitted[Frame] = true;
+    }
+}
+
+uint32_t Vulkan::GpuProfiler::GetSection(const char* Name)
+{
+    for (uint32_t i = 0; i < Sections.size(); i++)
+    {
+        if (Sections[i].Name == Name)
+        {
+            return i;
+        }
+    }
+
+    if (Sections.size() >= Vulkan::GpuProfiler::MaxSections)
+    {
+        return UINT32_MAX;
+    }
+
+    Sections.push_back({});
+    Sections.back().Name = Name;
+
+    return static_cast<uint32_t>(Sections.size() - 1);
+}
+
+void Vulkan::GpuProfiler::Begin(VkCommandBuffer CommandBuffer, uint32_t Section)
+{
+    if (RecordingPool == VK_NULL_HANDLE || Section >= Vulkan::GpuProfiler::MaxSections)
+    {
+        return;
+    }
+
+    vkCmdWriteTimestamp(CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, RecordingPool, Section * 2);
+}
+
+void Vulkan::GpuProfiler::End(VkCommandBuffer CommandBuffer, uint32_t Section)
+{
+    if (RecordingPool == VK_NULL_HANDLE || Section >= Vulkan::GpuProfiler::MaxSections)
+    {
+        return;
+    }
+
+    vkCmdWriteTimestamp(CommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, RecordingPool, Section * 2 + 1);
+}
+
+void Vulkan::GpuProfiler::Begin(VkCommandBuffer CommandBuffer, const char* Name)
+{
+    if (RecordingPool != VK_NULL_HANDLE)
+    {
+        Vulkan::GpuProfiler::Begin(CommandBuffer, Vulkan::GpuProfiler::GetSection(Name));
+    }
+}
+
+void Vulkan::GpuProfiler::End(VkCommandBuffer CommandBuffer, const char* Name)
+{
+    if (RecordingPool != VK_NULL_HANDLE)
+    {
+        Vulkan::GpuProfiler::End(CommandBuffer, Vulkan::GpuProfiler::GetSection(Name));
+    }
+}
+
+Vulkan::GpuProfiler::Scope::Scope(VkCommandBuffer CommandBuffer, const char* Name)
+    : CommandBuffer(CommandBuffer), Section(RecordingPool != VK_NULL_HANDLE ? Vulkan::GpuProfiler::GetSection(Name) : UINT32_MAX)
+{
+    Vulkan::GpuProfiler::Begin(CommandBuffer, Section);
+}
+
+Vulkan::GpuProfiler::Scope::~Scope()
+{
+    Vulkan::GpuProfiler::End(CommandBuffer, Section);
+}
+
+std::vector<Vulkan::GpuProfiler::SectionStats> Vulkan::GpuProfiler::GetStats()
+{
+    std::vector<Vulkan::GpuProfiler::SectionStats> Result;
+
+    for (const auto& Source : Sections)
+    {
+        if (Source.Samples == 0)
+        {
+            continue;
+        }
+
+        size_t Count = static_cast<size_t>(std::min<uint64_t>(Source.Samples, Source.History.size()));
+
+        std::vector<double> Sorted(Source.History.begin(), Source.History.begin() + Count);
+        std::sort(Sorted.begin(), Sorted.end());
+
+        auto Percentile = [&](double Fraction)
+        {
+            size_t Rank = static_cast<size_t>(std::ceil(Fraction * Count));
+
+            return Sorted[std::clamp<size_t>(Rank, 1, Count) - 1];
+        };
+
+        Vulkan::GpuProfiler::SectionStats Stats;
+        Stats.Name = Source.Name;
+        Stats.Samples = Count;
+        Stats.Last = Source.Last;
+
+        for (double Sample : Sorted)
+        {
+            Stats.Average += Sample;
+        }
+
+        Stats.Average /= Count;
+        Stats.P50 = Percentile(0.50);
+        Stats.P95 = Percentile(0.95);
+        Stats.P99 = Percentile(0.99);
+        Stats.Max = Sorted.back();
+
+        Result.push_back(Stats);
+    }
+
+    return Result;
+}
+
+void Vulkan::GpuProfiler::PrintStats()
+{
+    for (const auto& Stats : Vulkan::GpuProfiler::GetStats())
+    {
+        std::cout << "VK > GPU " << Stats.Name << ": " << Stats.Average << " ms average, p50 " << Stats.P50 << ", p95 " << Stats.P95 << ", p99 " << Stats.P99
+            << ", max " << Stats.Max << " over " << Stats.Samples << " frames" << std::endl;
+    }
+}
+
+void Vulkan::GpuProfiler::Update()
+{
+    if (Vulkan::GpuProfiler::LogInterval <= 0.0)
+    {
+        return;
+    }
+
+    auto Now = std::chrono::high_resolution_clock::now();
+
+    if (std::chrono::duration<double>(Now - LastLog).count() < Vulkan::GpuProfiler::LogInterval)
+    {
+        return;
+    }
+
+    LastLog = Now;
+
+    Vulkan::GpuProfiler::PrintStats();
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#ifndef GPUPROFILER_H
+#define GPUPROFILER_H
+
+namespace Vulkan
+{
+	/*
+		GPU timings from timestamp queries. Every named section owns a fixed pair of queries in a pool
+		per frame in flight, the pool is reset at the start of each frame's command buffer and read
+		back once that frame's fence has signalled, so nothing ever waits on the GPU. Sections that
+		weren't written in a frame simply come back unavailable, which keeps cached command buffers
+		valid whatever they contain.
+
+		A section can be written once per frame. Begin and End by id are safe from recording threads,
+		GetSection and the name overloads only from the render thread.
+	*/
+
+	namespace GpuProfiler
+	{
+		extern bool Enabled;
+
+		/*
+			Frames of history per section the averages and percentiles are taken over
+		*/
+
+		extern uint32_t HistorySize;
+
+		/*
+			Seconds between log lines written by Update, 0 turns the periodic log off
+		*/
+
+		extern double LogInterval;
+
+		static const uint32_t MaxSections = 32;
+
+		/*
+			Query pools are sized for Renderer::MaxFramesInFlight, recreate them when it changes
+		*/
+
+		void Create();
+		void Destroy();
+
+		/*
+			Reads the results of the frame that last used this slot, call right after its fence wait
+		*/
+
+		void Collect(uint32_t Frame);
+
+		/*
+			Resets the slot's queries, recorded outside any render pass before the first section
+		*/
+
+		void BeginFrame(VkCommandBuffer CommandBuffer, uint32_t Frame);
+
+		/*
+			Call after the frame's command buffer was submitted, Collect only reads slots marked here
+		*/
+
+		void FrameSubmitted(uint32_t Frame);
+
+		uint32_t GetSection(const char* Name);
+		void Begin(VkCommandBuffer CommandBuffer, uint32_t Section);
+		void End(VkCommandBuffer CommandBuffer, uint32_t Section);
+		void Begin(VkCommandBuffer CommandBuffer, const char* Name);
+		void End(VkCommandBuffer CommandBuffer, const char* Name);
+
+		class Scope
+		{
+		public:
+			Scope(VkCommandBuffer CommandBuffer, const char* Name);
+			~Scope();
+
+		private:
+			VkCommandBuffer CommandBuffer;
+			uint32_t Section;
+		};
+
+		/*
+			Times in milliseconds over the last HistorySize frames the section was written in
+		*/
+
+		struct SectionStats
+		{
+			std::string Name;
+			uint64_t Samples = 0;
+			double Last = 0.0;
+			double Average = 0.0;
+			double P50 = 0.0;
+			double P95 = 0.0;
+			double P99 = 0.0;
+			double Max = 0.0;
+		};
+
+		std::vector<SectionStats> GetStats();
+		void PrintStats();
+		void Update();
+	}
+}
+
+#endif
@@ -0,0 +1,393 @@
+#include "../../Src/Common.h"
+
+#include "Renderer.h"
+#include "Pacing.h"
+
+#include <thread>
+
+double Vulkan::Pacing::LowLatencyFrameTime = 0.0;
+double Vulkan::Pacing::PowerSaveFrameTime = 1000.0 / 30.0;
+double Vulkan::Pacing::LatencyLogInterval = 5.0;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    Vulkan::Pacing::Policy Current = Vulkan::Pacing::Policy::LowLatency;
+    Vulkan::Pacing::Policy Requested = Vulkan::Pacing::Policy::LowLatency;
+    bool Pending = false;
+
+    Clock::time_point NextFrame = Clock::now();
+
+    /*
+        Earliest input not yet picked up by a submitted frame, and per frame in flight slot the input
+        its frame carries
+    */
+
+    struct SlotInput
+    {
+        Clock::time_point Input;
+        bool HasInput = false;
+    };
+
+    Clock::time_point PendingInput;
+    bool HasPendingInput = false;
+    std::vector<SlotInput> Slots;
+
+    /*
+        Running totals of the current log window, Last is the window before it
+    */
+
+    struct Window
+    {
+        uint64_t Frames = 0;
+        uint64_t PresentSamples = 0;
+        uint64_t CompleteSamples = 0;
+        double FrameTime = 0.0;
+        double Present = 0.0;
+        double MaxPresent = 0.0;
+        double Complete = 0.0;
+        double MaxComplete = 0.0;
+    };
+
+    Window Totals;
+    Vulkan::Pacing::LatencyStats Last;
+    Clock::time_point LastPresent;
+    bool Presented = false;
+    Clock::time_point LastLog = Clock::now();
+
+    double Milliseconds(Clock::duration Duration)
+    {
+        return std::chrono::duration<double, std::milli>(Duration).count();
+    }
+
+    double GetFrameTime(Vulkan::Pacing::Policy Mode)
+    {
+        switch (Mode)
+        {
+        case Vulkan::Pacing::Policy::LowLatency:
+            return Vulkan::Pacing::LowLatencyFrameTime;
+        case Vulkan::Pacing::Policy::PowerSave:
+            return Vulkan::Pacing::PowerSaveFrameTime;
+        default:
+            return 0.0;
+        }
+    }
+
+    SlotInput& GetSlot(uint32_t Slot)
+    {
+        if (Slot >= Slots.size())
+        {
+            Slots.resize(Slot + 1);
+        }
+
+        return Slots[Slot];
+    }
+
+    Vulkan::Pacing::LatencyStats Summarize(const Window& Source)
+    {
+        Vulkan::Pacing::LatencyStats Stats;
+        Stats.Frames = Source.Frames;
+        Stats.Samples = Source.PresentSamples;
+        Stats.FrameTime = Source.Frames > 0 ? Source.FrameTime / Source.Frames : 0.0;
+        Stats.AveragePresent = Source.PresentSamples > 0 ? Source.Present / Source.PresentSamples : 0.0;
+        Stats.MaxPresent = Source.MaxPresent;
+        Stats.AverageComplete = Source.CompleteSamples > 0 ? Source.Complete / Source.CompleteSamples : 0.0;
+        Stats.MaxComplete = Source.MaxComplete;
+
+        return Stats;
+    }
+}
+
+void Vulkan::Pacing::SetPolicy(Vulkan::Pacing::Policy Mode)
+{
+    Requested = Mode;
+
+    /*
+        Before the device exists there is nothing to recreate, Init sizes everything for the policy
+    */
+
+    if (Vulkan::Renderer::Device == VK_NULL_HANDLE)
+    {
+        Current = Mode;
+        Pending = false;
+
+        return;
+    }
+
+    Pending = Requested != Current;
+}
+
+Vulkan::Pacing::Policy Vulkan::Pacing::GetPolicy()
+{
+    return Current;
+}
+
+bool Vulkan::Pacing::IsPolicyPending()
+{
+    return Pending;
+}
+
+void Vulkan::Pacing::ApplyPolicy()
+{
+    if (!Pending)
+    {
+        return;
+    }
+
+    vkDeviceWaitIdle(Vulkan::Renderer::Device);
+
+    Current = Requested;
+    Pending = false;
+
+    uint32_t FramesInFlight = Vulkan::Pacing::GetFramesInFlight();
+
+    if (FramesInFlight != Vulkan::Renderer::MaxFramesInFlight)
+    {
+        Vulkan::Renderer::RecreateFrameResources(FramesInFlight);
+    }
+
+    Vulkan::Renderer::RecreateSwapChain();
+
+    Slots.clear();
+    HasPendingInput = false;
+    Presented = false;
+    NextFrame = Clock::now();
+
+    std::cout << "VK > Frame pacing set to " << Vulkan::Pacing::GetPolicyName(Current) << ", " << FramesInFlight << " frames in flight, "
+        << Vulkan::Renderer::SwapChainImages.size() << " swap chain images" << std::endl;
+}
+
+const char* Vulkan::Pacing::GetPolicyName(Vulkan::Pacing::Policy Mode)
+{
+    switch (Mode)
+    {
+    case Vulkan::Pacing::Policy::LowLatency:
+        return "low latency";
+    case Vulkan::Pacing::Policy::Throughput:
+        return "throughput";
+    case Vulkan::Pacing::Policy::PowerSave:
+        return "power save";
+    default:
+        return "unknown";
+    }
+}
+
+uint32_t Vulkan::Pacing::GetFramesInFlight()
+{
+    switch (Current)
+    {
+    case Vulkan::Pacing::Policy::LowLatency:
+        return 1;
+    case Vulkan::Pacing::Policy::Throughput:
+        return 3;
+    default:
+        return 2;
+    }
+}
+
+VkPresentModeKHR Vulkan::Pacing::ChoosePresentMode(const std::vector<VkPresentModeKHR>& AvailablePresentModes)
+{
+    auto Available = [&](VkPresentModeKHR Mode)
+    {
+        return std::find(AvailablePresentModes.begin(), AvailablePresentModes.end(), Mode) != AvailablePresentModes.end();
+    };
+
+    if (Current == Vulkan::Pacing::Policy::LowLatency)
+    {
+        if (Available(VK_PRESENT_MODE_MAILBOX_KHR))
+        {
+            return VK_PRESENT_MODE_MAILBOX_KHR;
+        }
+
+        if (Available(VK_PRESENT_MODE_IMMEDIATE_KHR))
+        {
+            return VK_PRESENT_MODE_IMMEDIATE_KHR;
+        }
+    }
+
+    /*
+        FIFO is the only mode every device supports
+    */
+
+    return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+uint32_t Vulkan::Pacing::ChooseImageCount(const VkSurfaceCapabilitiesKHR& Capabilities, VkPresentModeKHR PresentMode)
+{
+    /*
+        One image per frame in flight plus the one being scanned out, mailbox needs a spare on top
+        to have something to replace
+    */
+
+    uint32_t ImageCount = std::max(Capabilities.minImageCount, Vulkan::Pacing::GetFramesInFlight() + 1);
+
+    if (PresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
+    {
+        ImageCount = std::max(ImageCount, 3u);
+    }
+
+    if (Capabilities.maxImageCount > 0 && ImageCount > Capabilities.maxImageCount)
+    {
+        ImageCount = Capabilities.maxImageCount;
+    }
+
+    return ImageCount;
+}
+
+void Vulkan::Pacing::Limit()
+{
+    double FrameTime = GetFrameTime(Current);
+
+    if (FrameTime <= 0.0)
+    {
+        NextFrame = Clock::now();
+
+        return;
+    }
+
+    /*
+        Sleep most of the way and yield the rest, sleep alone overshoots by up to a scheduler tick
+    */
+
+    auto Now = Clock::now();
+
+    if (Now < NextFrame)
+    {
+        auto Coarse = NextFrame - std::chrono::milliseconds(1);
+
+        if (Now < Coarse)
+        {
+            std::this_thread::sleep_until(Coarse);
+        }
+
+        while (Clock::now() < NextFrame)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    /*
+        A late frame restarts the schedule instead of rushing the next ones to catch up
+    */
+
+    auto Interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(FrameTime));
+
+    NextFrame = std::max(NextFrame + Interval, Clock::now());
+}
+
+void Vulkan::Pacing::InputReceived(uint32_t EventTimestamp)
+{
+    /*
+        SDL timestamps are milliseconds on its own clock, so only the age of the event is carried over
+    */
+
+    uint32_t Age = SDL_GetTicks() - EventTimestamp;
+
+    if (Age > 1000)
+    {
+        Age = 0;
+    }
+
+    Clock::time_point Input = Clock::now() - std::chrono::milliseconds(Age);
+
+    if (!HasPendingInput || Input < PendingInput)
+    {
+        PendingInput = Input;
+        HasPendingInput = true;
+    }
+}
+
+void Vulkan::Pacing::FrameSubmitted(uint32_t Slot)
+{
+    SlotInput& Target = GetSlot(Slot);
+
+    Target.Input = PendingInput;
+    Target.HasInput = HasPendingInput;
+
+    HasPendingInput = false;
+}
+
+void Vulkan::Pacing::FramePresented(uint32_t Slot)
+{
+    auto Now = Clock::now();
+
+    if (Presented)
+    {
+        Totals.Frames++;
+        Totals.FrameTime += Milliseconds(Now - LastPresent);
+    }
+
+    LastPresent = Now;
+    Presented = true;
+
+    SlotInput& Target = GetSlot(Slot);
+
+    if (Target.HasInput)
+    {
+        double Latency = Milliseconds(Now - Target.Input);
+
+        Totals.PresentSamples++;
+        Totals.Present += Latency;
+        Totals.MaxPresent = std::max(Totals.MaxPresent, Latency);
+    }
+}
+
+void Vulkan::Pacing::FrameComplete(uint32_t Slot)
+{
+    SlotInput& Target = GetSlot(Slot);
+
+    if (!Target.HasInput)
+    {
+        return;
+    }
+
+    double Latency = Milliseconds(Clock::now() - Target.Input);
+
+    Totals.CompleteSamples++;
+    Totals.Complete += Latency;
+    Totals.MaxComplete = std::max(Totals.MaxComplete, Latency);
+
+    Target.HasInput = false;
+}
+
+Vulkan::Pacing::LatencyStats Vulkan::Pacing::GetLatency()
+{
+    return Last;
+}
+
+void Vulkan::Pacing::PrintLatency()
+{
+    Vulkan::Pacing::LatencyStats Stats = Totals.Frames > 0 ? Summarize(Totals) : Last;
+
+    std::cout << "VK > Pacing " << Vulkan::Pacing::GetPolicyName(Current) << ": " << Stats.FrameTime << " ms per frame";
+
+    if (Stats.Samples > 0)
+    {
+        std::cout << ", input to present " << Stats.AveragePresent << " ms (max " << Stats.MaxPresent << "), input to GPU complete "
+            << Stats.AverageComplete << " ms (max " << Stats.MaxComplete << ") over " << Stats.Samples << " frames with input";
+    }
+
+    std::cout << std::endl;
+}
+
+void Vulkan::Pacing::Update()
+{
+    auto Now = Clock::now();
+
+    double Elapsed = std::chrono::duration<double>(Now - LastLog).count();
+
+    if (Elapsed < (Vulkan::Pacing::LatencyLogInterval > 0.0 ? Vulkan::Pacing::LatencyLogInterval : 1.0))
+    {
+        return;
+    }
+
+    if (Vulkan::Pacing::LatencyLogInterval > 0.0)
+    {
+        Vulkan::Pacing::PrintLatency();
+    }
+
+    Last = Summarize(Totals);
+    Totals = Window{};
+    LastLog = Now;
+}
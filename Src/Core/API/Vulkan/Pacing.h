@@ -0,0 +1,89 @@
+#pragma once
+
+#ifndef PACING_H
+#define PACING_H
+
+namespace Vulkan
+{
+	/*
+		Frame pacing policies, each a present mode, a number of frames in flight and an optional CPU
+		frame cap:
+
+		LowLatency: mailbox, else immediate, 1 frame in flight, capped to LowLatencyFrameTime if set
+		Throughput: FIFO, 3 frames in flight, uncapped
+		PowerSave: FIFO, 2 frames in flight, capped to PowerSaveFrameTime
+
+		Latency is measured from the SDL timestamp of the first input event a frame consumed to the
+		return of its vkQueuePresentKHR, and to the point its fence was seen signalled.
+	*/
+
+	namespace Pacing
+	{
+		enum class Policy : uint32_t { LowLatency, Throughput, PowerSave };
+
+		/*
+			Target frame time in milliseconds for the capped policies, 0 turns the low latency cap off
+		*/
+
+		extern double LowLatencyFrameTime;
+		extern double PowerSaveFrameTime;
+
+		/*
+			Seconds between latency log lines written by Update, 0 turns the periodic log off
+		*/
+
+		extern double LatencyLogInterval;
+
+		/*
+			Takes effect at the start of the next frame, which recreates the swap chain and, when the
+			number of frames in flight changes, every per frame resource
+		*/
+
+		void SetPolicy(Policy Mode);
+		Policy GetPolicy();
+		bool IsPolicyPending();
+		void ApplyPolicy();
+		const char* GetPolicyName(Policy Mode);
+
+		uint32_t GetFramesInFlight();
+		VkPresentModeKHR ChoosePresentMode(const std::vector<VkPresentModeKHR>& AvailablePresentModes);
+		uint32_t ChooseImageCount(const VkSurfaceCapabilitiesKHR& Capabilities, VkPresentModeKHR PresentMode);
+
+		/*
+			CPU frame cap, sleeps until the current policy's frame time has passed since the last call
+		*/
+
+		void Limit();
+
+		/*
+			Latency tracking. InputReceived takes the SDL timestamp of the event, the rest the frame in
+			flight slot of the frame they are about.
+		*/
+
+		void InputReceived(uint32_t EventTimestamp);
+		void FrameSubmitted(uint32_t Slot);
+		void FramePresented(uint32_t Slot);
+		void FrameComplete(uint32_t Slot);
+
+		/*
+			Over the last log window, times in milliseconds
+		*/
+
+		struct LatencyStats
+		{
+			uint64_t Frames = 0;
+			uint64_t Samples = 0;
+			double FrameTime = 0.0;
+			double AveragePresent = 0.0;
+			double MaxPresent = 0.0;
+			double AverageComplete = 0.0;
+			double MaxComplete = 0.0;
+		};
+
+		LatencyStats GetLatency();
+		void PrintLatency();
+		void Update();
+	}
+}
+
+#endif
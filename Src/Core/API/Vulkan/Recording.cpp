@@ -0,0 +1,340 @@
+#include "../../Src/Common.h"
+
+#include "Renderer.h"
+#include "Recording.h"
+
+#include "../../Profiler.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+bool Vulkan::Recording::Enabled = true;
+uint32_t Vulkan::Recording::MinItemsPerThread = 256;
+
+namespace
+{
+    /*
+        Per recording thread, one pool per frame in flight and the secondaries handed out of it this frame
+    */
+
+    struct ThreadState
+    {
+        std::vector<VkCommandPool> Pools;
+        std::vector<std::vector<VkCommandBuffer>> Buffers;
+        std::vector<uint32_t> Used;
+    };
+
+    std::vector<ThreadState> Threads;
+    std::vector<std::thread> Workers;
+    uint32_t Frame = 0;
+
+    std::mutex Mutex;
+    std::condition_variable WorkAvailable;
+    std::condition_variable WorkDone;
+    uint64_t Generation = 0;
+    uint32_t Remaining = 0;
+    bool Stopping = false;
+
+    /*
+        The job in progress, written by the render thread before Generation moves on
+    */
+
+    const VkCommandBufferInheritanceInfo* JobInheritance = nullptr;
+    const Vulkan::Recording::RecordFunction* JobCallback = nullptr;
+    uint32_t JobItems = 0;
+    uint32_t JobChunks = 0;
+    std::vector<VkCommandBuffer> JobResult;
+    std::exception_ptr JobError;
+
+    VkCommandBuffer NextCommandBuffer(uint32_t Thread)
+    {
+        ThreadState& Owner = Threads[Thread];
+        std::vector<VkCommandBuffer>& Buffers = Owner.Buffers[Frame];
+
+        if (Owner.Used[Frame] == Buffers.size())
+        {
+            VkCommandBufferAllocateInfo AllocateInfo{};
+            AllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            AllocateInfo.commandPool = Owner.Pools[Frame];
+            AllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            AllocateInfo.commandBufferCount = 1;
+
+            VkCommandBuffer CommandBuffer;
+
+            if (vkAllocateCommandBuffers(Vulkan::Renderer::Device, &AllocateInfo, &CommandBuffer) != VK_SUCCESS)
+            {
+                throw std::runtime_error("VK > Failed to allocate secondary command buffer!");
+            }
+
+            Buffers.push_back(CommandBuffer);
+        }
+
+        return Buffers[Owner.Used[Frame]++];
+    }
+
+    void RecordChunk(uint32_t Chunk)
+    {
+        PROFILE_ZONE("Recording::RecordChunk");
+
+        uint32_t Begin = static_cast<uint32_t>(uint64_t(JobItems) * Chunk / JobChunks);
+        uint32_t End = static_cast<uint32_t>(uint64_t(JobItems) * (Chunk + 1) / JobChunks);
+
+        VkCommandBuffer CommandBuffer = NextCommandBuffer(Chunk);
+
+        VkCommandBufferBeginInfo BeginInfo{};
+        BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        BeginInfo.pInheritanceInfo = JobInheritance;
+
+        if (vkBeginCommandBuffer(CommandBuffer, &BeginInfo) != VK_SUCCESS)
+        {
+            throw std::runtime_error("VK > Failed to begin recording secondary command buffer!");
+        }
+
+        (*JobCallback)(CommandBuffer, Chunk, Begin, End);
+
+        if (vkEndCommandBuffer(CommandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("VK > Failed to record secondary command buffer!");
+        }
+
+        JobResult[Chunk] = CommandBuffer;
+    }
+
+    /*
+        Started at the Generation current when Start ran, Generation keeps counting across Stop and Start
+        so a new worker must not take the last job of the previous set for a new one
+    */
+
+    void WorkerMain(uint32_t Thread, uint64_t Seen)
+    {
+        PROFILE_THREAD("Recording " + std::to_string(Thread));
+
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> Lock(Mutex);
+                WorkAvailable.wait(Lock, [&] { return Stopping || Generation != Seen; });
+
+                if (Stopping)
+                {
+                    return;
+                }
+
+                Seen = Generation;
+
+                if (Thread >= JobChunks)
+                {
+                    continue;
+                }
+            }
+
+            try
+            {
+                RecordChunk(Thread);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> Lock(Mutex);
+
+                if (!JobError)
+                {
+                    JobError = std::current_exception();
+                }
+            }
+
+            std::lock_guard<std::mutex> Lock(Mutex);
+
+            if (--Remaining == 0)
+            {
+                WorkDone.notify_one();
+            }
+        }
+    }
+}
+
+void Vulkan::Recording::Start(unsigned int ThreadCount)
+{
+    if (!Threads.empty())
+    {
+        return;
+    }
+
+    if (ThreadCount == 0)
+    {
+        ThreadCount = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+    }
+
+    Vulkan::Renderer::QueueFamilyIndices Indices = Vulkan::Renderer::FindQueueFamilies(Vulkan::Renderer::PhysicalDevice);
+
+    VkCommandPoolCreateInfo PoolInfo{};
+    PoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    PoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    PoolInfo.queueFamilyIndex = Indices.GraphicsFamily.value();
+
+    Threads.resize(ThreadCount);
+
+    for (auto& Thread : Threads)
+    {
+        Thread.Pools.resize(Vulkan::Renderer::MaxFramesInFlight);
+        Thread.Buffers.resize(Vulkan::Renderer::MaxFramesInFlight);
+        Thread.Used.assign(Vulkan::Renderer::MaxFramesInFlight, 0);
+
+        for (auto& Pool : Thread.Pools)
+        {
+            if (vkCreateCommandPool(Vulkan::Renderer::Device, &PoolInfo, nullptr, &Pool) != VK_SUCCESS)
+            {
+                throw std::runtime_error("VK > Failed to create recording command pool!");
+            }
+        }
+    }
+
+    uint64_t StartGeneration = 0;
+
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+
+        Stopping = false;
+        StartGeneration = Generation;
+    }
+
+    for (uint32_t i = 1; i < ThreadCount; i++)
+    {
+        Workers.emplace_back(WorkerMain, i, StartGeneration);
+    }
+
+    std::cout << "VK > Recording secondary command buffers on " << ThreadCount << " threads" << std::endl;
+}
+
+void Vulkan::Recording::Stop()
+{
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Stopping = true;
+    }
+
+    WorkAvailable.notify_all();
+
+    for (auto& Worker : Workers)
+    {
+        Worker.join();
+    }
+
+    Workers.clear();
+
+    /*
+        Destroying a pool frees its command buffers, the device has to be idle
+    */
+
+    for (auto& Thread : Threads)
+    {
+        for (auto Pool : Thread.Pools)
+        {
+            vkDestroyCommandPool(Vulkan::Renderer::Device, Pool, nullptr);
+        }
+    }
+
+    Threads.clear();
+}
+
+uint32_t Vulkan::Recording::GetThreadCount()
+{
+    return static_cast<uint32_t>(Threads.size());
+}
+
+uint32_t Vulkan::Recording::GetChunkCount(uint32_t ItemCount)
+{
+    uint32_t Chunks = ItemCount / std::max<uint32_t>(Vulkan::Recording::MinItemsPerThread, 1);
+
+    return std::clamp<uint32_t>(Chunks, 1, std::max<uint32_t>(static_cast<uint32_t>(Threads.size()), 1));
+}
+
+bool Vulkan::Recording::ShouldRecord(uint32_t ItemCount)
+{
+    return Vulkan::Recording::Enabled && !Threads.empty() && ItemCount >= 2 * Vulkan::Recording::MinItemsPerThread;
+}
+
+void Vulkan::Recording::BeginFrame(uint32_t FrameIndex)
+{
+    Frame = FrameIndex;
+
+    for (auto& Thread : Threads)
+    {
+        vkResetCommandPool(Vulkan::Renderer::Device, Thread.Pools[Frame], 0);
+
+        Thread.Used[Frame] = 0;
+    }
+}
+
+std::vector<VkCommandBuffer> Vulkan::Recording::Record(const VkCommandBufferInheritanceInfo& Inheritance, uint32_t ItemCount, const Vulkan::Recording::RecordFunction& Callback)
+{
+    if (Threads.empty())
+    {
+        throw std::runtime_error("VK > Recording threads were not started!");
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+
+        JobInheritance = &Inheritance;
+        JobCallback = &Callback;
+        JobItems = ItemCount;
+        JobChunks = Vulkan::Recording::GetChunkCount(ItemCount);
+        JobResult.assign(JobChunks, VK_NULL_HANDLE);
+        JobError = nullptr;
+
+        Remaining = JobChunks - 1;
+        Generation++;
+    }
+
+    WorkAvailable.notify_all();
+
+    /*
+        The render thread takes the first chunk instead of waiting idle
+    */
+
+    try
+    {
+        RecordChunk(0);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+
+        if (!JobError)
+        {
+            JobError = std::current_exception();
+        }
+    }
+
+    std::vector<VkCommandBuffer> Result;
+    std::exception_ptr Error;
+
+    {
+        std::unique_lock<std::mutex> Lock(Mutex);
+        WorkDone.wait(Lock, [] { return Remaining == 0; });
+
+        /*
+            Inheritance and Callback belong to the caller and are gone once this returns
+        */
+
+        Result = std::move(JobResult);
+        Error = JobError;
+
+        JobInheritance = nullptr;
+        JobCallback = nullptr;
+        JobItems = 0;
+        JobChunks = 0;
+        JobResult.clear();
+        JobError = nullptr;
+    }
+
+    if (Error)
+    {
+        std::rethrow_exception(Error);
+    }
+
+    return Result;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#ifndef RECORDING_H
+#define RECORDING_H
+
+namespace Vulkan
+{
+	/*
+		Parallel recording into secondary command buffers. Work is split into contiguous chunks, one
+		per recording thread, and every chunk goes into its own secondary that continues the current
+		render pass. Executed in chunk order the secondaries draw exactly what one inline recording
+		would have.
+
+		Each thread owns one command pool per frame in flight, so recording never takes a lock. The
+		pools of a frame are reset together in BeginFrame, once that frame's fence has signalled.
+	*/
+
+	namespace Recording
+	{
+		/*
+			Record through secondaries at all, and the smallest number of items worth a chunk of its
+			own. Fewer items than two chunks' worth are recorded inline.
+		*/
+
+		extern bool Enabled;
+		extern uint32_t MinItemsPerThread;
+
+		/*
+			ThreadCount recording threads including the render thread, which records the first chunk.
+			0 picks one per hardware thread up to 8.
+		*/
+
+		void Start(unsigned int ThreadCount = 0);
+		void Stop();
+
+		uint32_t GetThreadCount();
+		bool ShouldRecord(uint32_t ItemCount);
+
+		/*
+			Number of chunks, and so secondaries, Record splits ItemCount items into
+		*/
+
+		uint32_t GetChunkCount(uint32_t ItemCount);
+
+		void BeginFrame(uint32_t Frame);
+
+		/*
+			Calls Callback for every chunk of [0, ItemCount) on its thread, with a begun secondary that
+			inherits Inheritance. Returns once all are ended, in chunk order, ready for vkCmdExecuteCommands.
+		*/
+
+		using RecordFunction = std::function<void(VkCommandBuffer CommandBuffer, uint32_t Chunk, uint32_t Begin, uint32_t End)>;
+
+		std::vector<VkCommandBuffer> Record(const VkCommandBufferInheritanceInfo& Inheritance, uint32_t ItemCount, const RecordFunction& Callback);
+	}
+}
+
+#endif
@@ -9,6 +9,13 @@
 #include "../../Camera.h"
 #include "../../Model.h"
 #include "../../GameObject.h"
+#include "../../ModelRegistry.h"
+#include "../../GeometryPool.h"
+#include "../../Material.h"
+#include "../../Streaming.h"
+#include "../../Profiler.h"
+
+#include <filesystem>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
@@ -23,12 +30,17 @@ VkDevice Vulkan::Renderer::Device;
 
 VkQueue Vulkan::Renderer::GraphicsQueue;
 VkQueue Vulkan::Renderer::PresentQueue;
+VkQueue Vulkan::Renderer::TransferQueue;
+
+bool Vulkan::Renderer::MemoryBudgetSupported = false;
 
 VkDescriptorSetLayout Vulkan::Renderer::DescriptorSetLayout;
 VkPipelineLayout Vulkan::Renderer::PipelineLayout;
 VkPipeline Vulkan::Renderer::GraphicsPipeline;
 VkPipeline Vulkan::Renderer::WireframePipeline;
 
+Vulkan::Renderer::PipelineList Vulkan::Renderer::Pipelines;
+
 std::vector<VkShaderModule> Vulkan::Renderer::ShaderModules;
 
 VkSwapchainKHR Vulkan::Renderer::SwapChain;
@@ -56,30 +68,142 @@ VkDebugUtilsMessengerEXT Vulkan::Renderer::DebugMessenger;
 //VkDeviceMemory Vulkan::Renderer::IndexBufferMemory;
 
 std::vector<VkBuffer> Vulkan::Renderer::UniformBuffers;
-std::vector<VkDeviceMemory> Vulkan::Renderer::UniformBuffersMemory;
+std::vector<Vulkan::Allocator::Allocation> Vulkan::Renderer::UniformBuffersMemory;
 std::vector<void*> Vulkan::Renderer::UniformBuffersMapped;
 
 VkDescriptorPool Vulkan::Renderer::DescriptorPool;
 std::vector<VkDescriptorSet> Vulkan::Renderer::DescriptorSets;
 
 VkImage Vulkan::Renderer::TextureImage;
-VkDeviceMemory Vulkan::Renderer::TextureImageMemory;
+Vulkan::Allocator::Allocation Vulkan::Renderer::TextureImageMemory;
 VkImageView Vulkan::Renderer::TextureImageView;
 VkSampler Vulkan::Renderer::TextureSampler;
 
 VkImage Vulkan::Renderer::DepthImage;
-VkDeviceMemory Vulkan::Renderer::DepthImageMemory;
+Vulkan::Allocator::Allocation Vulkan::Renderer::DepthImageMemory;
 VkImageView Vulkan::Renderer::DepthImageView;
 
 //std::vector<Vulkan::Renderer::Vertex> Vulkan::Renderer::Vertices;
 //std::vector<uint32_t> Vulkan::Renderer::Indices;
 
 bool Vulkan::Renderer::FramebufferResized = false;
+bool Vulkan::Renderer::DepthPrepass = false;
+bool Vulkan::Renderer::CacheCommandBuffers = false;
 
+uint32_t Vulkan::Renderer::MaxFramesInFlight = 2;
 uint32_t Vulkan::Renderer::CurrentFrame = 0;
 
+namespace
+{
+    /*
+        Cached recordings, slot ImageIndex * MaxFramesInFlight + CurrentFrame, each tagged with the
+        scene version it was recorded at. A slot is only ever submitted with its frame's fence, so it
+        is idle again once DrawFrame has waited on that fence.
+    */
+
+    std::vector<VkCommandBuffer> CachedCommandBuffers;
+    std::vector<uint64_t> CachedVersions;
+    uint64_t SceneVersion = 1;
+
+    glm::mat4 CachedViewProjection{ 0.0f };
+    bool CachedDepthPrepass = false;
+    bool CachedProfiling = false;
+
+    uint64_t FramesRecorded = 0;
+    uint64_t FramesReused = 0;
+
+    void FreeCachedCommandBuffers()
+    {
+        if (!CachedCommandBuffers.empty())
+        {
+            vkFreeCommandBuffers(Vulkan::Renderer::Device, Vulkan::Renderer::CommandPool, static_cast<uint32_t>(CachedCommandBuffers.size()), CachedCommandBuffers.data());
+        }
+
+        CachedCommandBuffers.clear();
+        CachedVersions.clear();
+    }
+
+    VkCommandBuffer GetCachedCommandBuffer(uint32_t ImageIndex)
+    {
+        size_t SlotCount = Vulkan::Renderer::SwapChainImages.size() * Vulkan::Renderer::MaxFramesInFlight;
+
+        if (CachedCommandBuffers.size() != SlotCount)
+        {
+            FreeCachedCommandBuffers();
+
+            CachedCommandBuffers.resize(SlotCount);
+            CachedVersions.assign(SlotCount, 0);
+
+            VkCommandBufferAllocateInfo AllocateInfo{};
+            AllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            AllocateInfo.commandPool = Vulkan::Renderer::CommandPool;
+            AllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            AllocateInfo.commandBufferCount = static_cast<uint32_t>(SlotCount);
+
+            if (vkAllocateCommandBuffers(Vulkan::Renderer::Device, &AllocateInfo, CachedCommandBuffers.data()) != VK_SUCCESS)
+            {
+                throw std::runtime_error("VK > Failed to allocate cached command buffers!");
+            }
+        }
+
+        /*
+            The camera only reaches the recording through LOD selection, which is rechecked when the
+            view moved. Anything else it changes is in the uniform buffer.
+        */
+
+        float AspectRatio = Vulkan::Renderer::SwapChainExtent.width / (float)Vulkan::Renderer::SwapChainExtent.height;
+        glm::mat4 ViewProjection = Engine::Camera::GetProjectionMatrix(AspectRatio) * Engine::Camera::GetViewMatrix();
+
+        if (ViewProjection != CachedViewProjection)
+        {
+            CachedViewProjection = ViewProjection;
+
+            if (Engine::GameObject::UpdateLods())
+            {
+                Vulkan::Renderer::InvalidateCommandBuffers();
+            }
+        }
+
+        if (Vulkan::Renderer::DepthPrepass != CachedDepthPrepass || Vulkan::GpuProfiler::Enabled != CachedProfiling)
+        {
+            CachedDepthPrepass = Vulkan::Renderer::DepthPrepass;
+            CachedProfiling = Vulkan::GpuProfiler::Enabled;
+
+            Vulkan::Renderer::InvalidateCommandBuffers();
+        }
+
+        uint32_t Slot = ImageIndex * Vulkan::Renderer::MaxFramesInFlight + Vulkan::Renderer::CurrentFrame;
+        VkCommandBuffer CommandBuffer = CachedCommandBuffers[Slot];
+
+        if (CachedVersions[Slot] == SceneVersion)
+        {
+            FramesReused++;
+
+            return CommandBuffer;
+        }
+
+        vkResetCommandBuffer(CommandBuffer, 0);
+
+        Vulkan::Renderer::RecordCommandBuffer(CommandBuffer, ImageIndex, true);
+
+        CachedVersions[Slot] = SceneVersion;
+        FramesRecorded++;
+
+        return CommandBuffer;
+    }
+}
+
+void Vulkan::Renderer::InvalidateCommandBuffers()
+{
+    SceneVersion++;
+}
+
 void Vulkan::Renderer::Init()
 {
+    PROFILE_ZONE("Renderer::Init");
+
+    Vulkan::Renderer::MaxFramesInFlight = Vulkan::Pacing::GetFramesInFlight();
+
     Vulkan::Renderer::CreateInstance();
     Vulkan::Renderer::InitDebugMessenger();
     Vulkan::Renderer::CreateSurface();
@@ -96,19 +220,20 @@ void Vulkan::Renderer::Init()
     Vulkan::Renderer::CreateTextureImage();
     Vulkan::Renderer::CreateTextureImageView();
     Vulkan::Renderer::CreateTextureSampler();
-    Engine::GameObject::CreateGameObjects();
     Vulkan::Renderer::CreateUniformBuffers();
     Vulkan::Renderer::CreateDescriptorPool();
     Vulkan::Renderer::CreateDescriptorSets();
+    Engine::Materials::CreateDescriptorSets();
     Vulkan::Renderer::CreateCommandBuffers();
     Vulkan::Renderer::CreateSyncObjects();
+    Vulkan::GpuProfiler::Create();
+    Vulkan::Recording::Start();
 }
 
 void Vulkan::Renderer::CleanUpSwapChain()
 {
     vkDestroyImageView(Vulkan::Renderer::Device, Vulkan::Renderer::DepthImageView, nullptr);
-    vkDestroyImage(Vulkan::Renderer::Device, Vulkan::Renderer::DepthImage, nullptr);
-    vkFreeMemory(Vulkan::Renderer::Device, Vulkan::Renderer::DepthImageMemory, nullptr);
+    Vulkan::Allocator::DestroyImage(Vulkan::Renderer::DepthImage, Vulkan::Renderer::DepthImageMemory);
 
     for (auto Framebuffer : Vulkan::Renderer::SwapChainFramebuffers)
     {
@@ -125,13 +250,26 @@ void Vulkan::Renderer::CleanUpSwapChain()
 
 void Vulkan::Renderer::CleanUp()
 {
+    vkDeviceWaitIdle(Vulkan::Renderer::Device);
+
+    Engine::Streaming::Stop();
+    Vulkan::Recording::Stop();
+
+    Vulkan::Pacing::PrintLatency();
+    Vulkan::GpuProfiler::PrintStats();
+    Vulkan::GpuProfiler::Destroy();
+
+    std::cout << "VK > " << FramesRecorded + FramesReused << " frames, " << FramesRecorded << " recorded, " << FramesReused << " submitted from the command buffer cache" << std::endl;
+
+    Vulkan::Allocator::PrintBudget();
+    Vulkan::Staging::Destroy();
+
     Vulkan::Renderer::CleanUpSwapChain();
 
     vkDestroySampler(Vulkan::Renderer::Device, Vulkan::Renderer::TextureSampler, nullptr);
     vkDestroyImageView(Vulkan::Renderer::Device, Vulkan::Renderer::TextureImageView, nullptr);
 
-    vkDestroyImage(Vulkan::Renderer::Device, Vulkan::Renderer::TextureImage, nullptr);
-    vkFreeMemory(Vulkan::Renderer::Device, Vulkan::Renderer::TextureImageMemory, nullptr);
+    Vulkan::Allocator::DestroyImage(Vulkan::Renderer::TextureImage, Vulkan::Renderer::TextureImageMemory);
 
     //vkDestroyBuffer(Vulkan::Renderer::Device, Vulkan::Renderer::IndexBuffer, nullptr);
     //vkFreeMemory(Vulkan::Renderer::Device, Vulkan::Renderer::IndexBufferMemory, nullptr);
@@ -141,15 +279,29 @@ void Vulkan::Renderer::CleanUp()
 
     for (size_t i = 0; i < Vulkan::Renderer::MaxFramesInFlight; i++)
     {
-        vkDestroyBuffer(Vulkan::Renderer::Device, Vulkan::Renderer::UniformBuffers[i], nullptr);
-        vkFreeMemory(Vulkan::Renderer::Device, Vulkan::Renderer::UniformBuffersMemory[i], nullptr);
+        Vulkan::Allocator::DestroyBuffer(Vulkan::Renderer::UniformBuffers[i], Vulkan::Renderer::UniformBuffersMemory[i]);
     }
 
+    Engine::Models::Destroy();
+    Vulkan::Deletion::Flush();
+    Engine::GeometryPool::Destroy();
+    Engine::Materials::Destroy();
+
+    Vulkan::Staging::PrintStats();
+    Vulkan::Allocator::PrintStats();
+    Vulkan::Allocator::Destroy();
+
     vkDestroyDescriptorPool(Vulkan::Renderer::Device, Vulkan::Renderer::DescriptorPool, nullptr);
     vkDestroyDescriptorSetLayout(Vulkan::Renderer::Device, Vulkan::Renderer::DescriptorSetLayout, nullptr);
 
     vkDestroyPipeline(Vulkan::Renderer::Device, Vulkan::Renderer::GraphicsPipeline, nullptr);
 
+    vkDestroyPipeline(Vulkan::Renderer::Device, Vulkan::Renderer::Pipelines.Normal, nullptr);
+    vkDestroyPipeline(Vulkan::Renderer::Device, Vulkan::Renderer::Pipelines.WireFrame, nullptr);
+    vkDestroyPipeline(Vulkan::Renderer::Device, Vulkan::Renderer::Pipelines.Packed, nullptr);
+    vkDestroyPipeline(Vulkan::Renderer::Device, Vulkan::Renderer::Pipelines.DepthOnly, nullptr);
+    vkDestroyPipeline(Vulkan::Renderer::Device, Vulkan::Renderer::Pipelines.DepthOnlyPacked, nullptr);
+
     vkDestroyPipelineLayout(Vulkan::Renderer::Device, Vulkan::Renderer::PipelineLayout, nullptr);
 
     vkDestroyRenderPass(Vulkan::Renderer::Device, Vulkan::Renderer::RenderPass, nullptr);
@@ -242,13 +394,11 @@ void Vulkan::Renderer::CreateInstance()
         CreateInfo.pNext = nullptr;
     }
 
-    VkResult result = vkCreateInstance(&CreateInfo, nullptr, &Vulkan::Renderer::Instance);
-
     if (vkCreateInstance(&CreateInfo, nullptr, &Vulkan::Renderer::Instance) != VK_SUCCESS)
     {
         throw std::runtime_error("VK > Failed to create instance!");
     }
-    else if (vkCreateInstance(&CreateInfo, nullptr, &Vulkan::Renderer::Instance) == VK_SUCCESS)
+    else
     {
         std::cout << "VK > Successfully created instance! \n";
     }
@@ -369,6 +519,44 @@ bool Vulkan::Renderer::CheckDeviceExtensionSupport(VkPhysicalDevice Device)
     return RequiredExtensions.empty();
 }
 
+bool Vulkan::Renderer::CheckDeviceExtensionSupport(VkPhysicalDevice Device, const char* Name)
+{
+    uint32_t ExtensionCount;
+    vkEnumerateDeviceExtensionProperties(Device, nullptr, &ExtensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> AvailableExtensions(ExtensionCount);
+    vkEnumerateDeviceExtensionProperties(Device, nullptr, &ExtensionCount, AvailableExtensions.data());
+
+    for (const auto& Extension : AvailableExtensions)
+    {
+        if (strcmp(Extension.extensionName, Name) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool Vulkan::Renderer::CheckInstanceExtensionSupport(const char* Name)
+{
+    uint32_t ExtensionCount;
+    vkEnumerateInstanceExtensionProperties(nullptr, &ExtensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> AvailableExtensions(ExtensionCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &ExtensionCount, AvailableExtensions.data());
+
+    for (const auto& Extension : AvailableExtensions)
+    {
+        if (strcmp(Extension.extensionName, Name) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void Vulkan::Renderer::CreateLogicalDevice()
 {
     QueueFamilyIndices Indices = FindQueueFamilies(Vulkan::Renderer::PhysicalDevice);
@@ -376,6 +564,11 @@ void Vulkan::Renderer::CreateLogicalDevice()
     std::vector<VkDeviceQueueCreateInfo> QueueCreateInfos;
     std::set<uint32_t> UniqueQueueFamilies = { Indices.GraphicsFamily.value(), Indices.PresentFamily.value() };
 
+    if (Indices.TransferFamily.has_value())
+    {
+        UniqueQueueFamilies.insert(Indices.TransferFamily.value());
+    }
+
     float QueuePriority = 1.0f;
 
     for (uint32_t QueueFamily : UniqueQueueFamilies)
@@ -401,8 +594,22 @@ void Vulkan::Renderer::CreateLogicalDevice()
 
     CreateInfo.pEnabledFeatures = &DeviceFeatures;
 
-    CreateInfo.enabledExtensionCount = static_cast<uint32_t>(Vulkan::Renderer::DeviceExtensions.size());
-    CreateInfo.ppEnabledExtensionNames = Vulkan::Renderer::DeviceExtensions.data();
+    /*
+        Memory budget reporting is optional, it needs the extension on the device and properties 2 on the instance
+    */
+
+    std::vector<const char*> Extensions = Vulkan::Renderer::DeviceExtensions;
+
+    Vulkan::Renderer::MemoryBudgetSupported = Vulkan::Renderer::CheckDeviceExtensionSupport(Vulkan::Renderer::PhysicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)
+        && Vulkan::Renderer::CheckInstanceExtensionSupport(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+
+    if (Vulkan::Renderer::MemoryBudgetSupported)
+    {
+        Extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
+    CreateInfo.enabledExtensionCount = static_cast<uint32_t>(Extensions.size());
+    CreateInfo.ppEnabledExtensionNames = Extensions.data();
 
     if (Vulkan::Renderer::EnableValidationLayers)
     {
@@ -418,13 +625,28 @@ void Vulkan::Renderer::CreateLogicalDevice()
     {
         throw std::runtime_error("VK > Failed to create logical device!");
     }
-    else if (vkCreateDevice(Vulkan::Renderer::PhysicalDevice, &CreateInfo, nullptr, &Vulkan::Renderer::Device) == VK_SUCCESS)
+    else
     {
         std::cout << "VK > Successfully created logical device! \n";
     }
 
+    std::cout << "VK > Memory budget " << (Vulkan::Renderer::MemoryBudgetSupported ? "reported by VK_EXT_memory_budget" : "estimated, VK_EXT_memory_budget not available") << std::endl;
+
     vkGetDeviceQueue(Vulkan::Renderer::Device, Indices.GraphicsFamily.value(), 0, &GraphicsQueue);
     vkGetDeviceQueue(Vulkan::Renderer::Device, Indices.PresentFamily.value(), 0, &PresentQueue);
+
+    if (Indices.TransferFamily.has_value())
+    {
+        vkGetDeviceQueue(Vulkan::Renderer::Device, Indices.TransferFamily.value(), 0, &TransferQueue);
+
+        std::cout << "VK > Using dedicated transfer queue family " << Indices.TransferFamily.value() << std::endl;
+    }
+    else
+    {
+        TransferQueue = GraphicsQueue;
+
+        std::cout << "VK > No dedicated transfer queue family, uploads share the graphics queue" << std::endl;
+    }
 }
 
 bool Vulkan::Renderer::CheckValidationLayerSupport()
@@ -476,6 +698,15 @@ std::vector<const char*> Vulkan::Renderer::GetRequiredExtensions()
         SLD2Extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
     }
 
+    /*
+        Needed for memory budget queries on a 1.0 instance, optional
+    */
+
+    if (Vulkan::Renderer::CheckInstanceExtensionSupport(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME))
+    {
+        SLD2Extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+    }
+
     return SLD2Extensions;
 }
 
@@ -514,6 +745,25 @@ Vulkan::Renderer::QueueFamilyIndices Vulkan::Renderer::FindQueueFamilies(VkPhysi
         i++;
     }
 
+    /*
+        Prefer a transfer only family (the copy engine) over one that also does compute
+    */
+
+    for (uint32_t Family = 0; Family < QueueFamilyCount; Family++)
+    {
+        VkQueueFlags Flags = QueueFamilies[Family].queueFlags;
+
+        if (!(Flags & VK_QUEUE_TRANSFER_BIT) || (Flags & VK_QUEUE_GRAPHICS_BIT) || QueueFamilies[Family].queueCount == 0)
+        {
+            continue;
+        }
+
+        if (!Indices.TransferFamily.has_value() || !(Flags & VK_QUEUE_COMPUTE_BIT))
+        {
+            Indices.TransferFamily = Family;
+        }
+    }
+
     return Indices;
 }
 
@@ -525,12 +775,7 @@ void Vulkan::Renderer::CreateSwapChain()
     VkPresentModeKHR PresentMode = ChooseSwapPresentMode(SwapChainSupport.PresentModes);
     VkExtent2D Extent = ChooseSwapExtent(SwapChainSupport.Capabilities);
 
-    uint32_t ImageCount = SwapChainSupport.Capabilities.minImageCount + 1;
-
-    if (SwapChainSupport.Capabilities.maxImageCount > 0 && ImageCount >> SwapChainSupport.Capabilities.maxImageCount)
-    {
-        ImageCount = SwapChainSupport.Capabilities.maxImageCount;
-    }
+    uint32_t ImageCount = Vulkan::Pacing::ChooseImageCount(SwapChainSupport.Capabilities, PresentMode);
 
     VkSwapchainCreateInfoKHR CreateInfo{};
     CreateInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
@@ -624,15 +869,7 @@ VkSurfaceFormatKHR Vulkan::Renderer::ChooseSwapSurfaceFormat(const std::vector<V
 
 VkPresentModeKHR Vulkan::Renderer::ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& AvailablePresentModes)
 {
-    for (const auto& AvailablePresentMode : AvailablePresentModes)
-    {
-        if (AvailablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR)
-        {
-            return AvailablePresentMode;
-        }
-    }
-
-    return VK_PRESENT_MODE_FIFO_KHR;
+    return Vulkan::Pacing::ChoosePresentMode(AvailablePresentModes);
 }
 
 VkExtent2D Vulkan::Renderer::ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& Capabilities)
@@ -661,8 +898,22 @@ VkExtent2D Vulkan::Renderer::ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& Ca
 
 void Vulkan::Renderer::RecreateSwapChain()
 {
+    /*
+        The open staging batch may still hold the layout transition of the depth image destroyed below,
+        it has to run before that. Waiting for the batch also covers a recreate before any frame submits.
+    */
+
+    Vulkan::Staging::Wait(Vulkan::Staging::GetBatch());
+
     vkDeviceWaitIdle(Vulkan::Renderer::Device);
 
+    /*
+        Cached recordings reference the old framebuffers and the image count may change
+    */
+
+    FreeCachedCommandBuffers();
+    Vulkan::Renderer::InvalidateCommandBuffers();
+
     Vulkan::Renderer::CleanUpSwapChain();
 
     Vulkan::Renderer::CreateSwapChain();
@@ -671,6 +922,61 @@ void Vulkan::Renderer::RecreateSwapChain()
     Vulkan::Renderer::CreateFramebuffers();
 }
 
+void Vulkan::Renderer::RecreateFrameResources(uint32_t FramesInFlight)
+{
+    vkDeviceWaitIdle(Vulkan::Renderer::Device);
+
+    /*
+        Everything submitted has finished, the deletion queue sees that before the slots are renumbered
+    */
+
+    for (uint32_t i = 0; i < Vulkan::Renderer::MaxFramesInFlight; i++)
+    {
+        Vulkan::Deletion::FrameComplete(i);
+    }
+
+    uint32_t RecordingThreads = Vulkan::Recording::GetThreadCount();
+
+    Vulkan::Recording::Stop();
+    Vulkan::GpuProfiler::Destroy();
+
+    for (size_t i = 0; i < Vulkan::Renderer::MaxFramesInFlight; i++)
+    {
+        vkDestroySemaphore(Vulkan::Renderer::Device, Vulkan::Renderer::RenderFinishedSemaphores[i], nullptr);
+        vkDestroySemaphore(Vulkan::Renderer::Device, Vulkan::Renderer::ImageAvailableSemaphores[i], nullptr);
+        vkDestroyFence(Vulkan::Renderer::Device, Vulkan::Renderer::InFlightFences[i], nullptr);
+
+        Vulkan::Allocator::DestroyBuffer(Vulkan::Renderer::UniformBuffers[i], Vulkan::Renderer::UniformBuffersMemory[i]);
+    }
+
+    vkFreeCommandBuffers(Vulkan::Renderer::Device, Vulkan::Renderer::CommandPool, static_cast<uint32_t>(Vulkan::Renderer::CommandBuffers.size()), Vulkan::Renderer::CommandBuffers.data());
+
+    /*
+        Destroying the pools frees the global and material descriptor sets
+    */
+
+    vkDestroyDescriptorPool(Vulkan::Renderer::Device, Vulkan::Renderer::DescriptorPool, nullptr);
+    Engine::Materials::DestroyDescriptorSets();
+
+    Vulkan::Renderer::MaxFramesInFlight = FramesInFlight;
+    Vulkan::Renderer::CurrentFrame = 0;
+
+    Vulkan::Renderer::CreateUniformBuffers();
+    Vulkan::Renderer::CreateDescriptorPool();
+    Vulkan::Renderer::CreateDescriptorSets();
+    Engine::Materials::CreateDescriptorSets();
+    Vulkan::Renderer::CreateCommandBuffers();
+    Vulkan::Renderer::CreateSyncObjects();
+    Vulkan::GpuProfiler::Create();
+
+    if (RecordingThreads > 0)
+    {
+        Vulkan::Recording::Start(RecordingThreads);
+    }
+
+    Vulkan::Renderer::InvalidateCommandBuffers();
+}
+
 void Vulkan::Renderer::CreateImageViews()
 {
     Vulkan::Renderer::SwapChainImageViews.resize(Vulkan::Renderer::SwapChainImages.size());
@@ -782,13 +1088,13 @@ void Vulkan::Renderer::CreatePipelines()
     VkPipelineVertexInputStateCreateInfo VertexInputInfo{};
     VertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
-    auto BindingDescription = Vulkan::Renderer::Vertex::GetBindingDescription();
+    auto BindingDescriptions = Vulkan::Renderer::Vertex::GetBindingDescriptions();
     auto AttributeDescriptions = Vulkan::Renderer::Vertex::GetAttributeDescriptions();
 
-    VertexInputInfo.vertexBindingDescriptionCount = 1;
+    VertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(BindingDescriptions.size());
     VertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(AttributeDescriptions.size());
 
-    VertexInputInfo.pVertexBindingDescriptions = &BindingDescription;
+    VertexInputInfo.pVertexBindingDescriptions = BindingDescriptions.data();
     VertexInputInfo.pVertexAttributeDescriptions = AttributeDescriptions.data();
 
     VkPipelineInputAssemblyStateCreateInfo InputAssembly{};
@@ -843,7 +1149,7 @@ void Vulkan::Renderer::CreatePipelines()
     DepthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
     DepthStencil.depthTestEnable = VK_TRUE;
     DepthStencil.depthWriteEnable = VK_TRUE;
-    DepthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+    DepthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL; // passes fragments the depth prepass already wrote
     DepthStencil.depthBoundsTestEnable = VK_FALSE;
     DepthStencil.minDepthBounds = 0.0f;
     DepthStencil.maxDepthBounds = 1.0f;
@@ -874,7 +1180,7 @@ void Vulkan::Renderer::CreatePipelines()
 
     VkPushConstantRange PushConstantRange;
     PushConstantRange.offset = 0;
-    PushConstantRange.size = sizeof(glm::mat4);
+    PushConstantRange.size = sizeof(glm::mat4) + sizeof(Vulkan::Renderer::PackedPushConstant);
     PushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
     
     VkPipelineLayoutCreateInfo PipelineLayoutInfo{};
@@ -888,7 +1194,7 @@ void Vulkan::Renderer::CreatePipelines()
     {
         throw std::runtime_error("VK > Failed to create pipeline layout!");
     }
-    else if (vkCreatePipelineLayout(Vulkan::Renderer::Device, &PipelineLayoutInfo, nullptr, &Vulkan::Renderer::PipelineLayout) == VK_SUCCESS)
+    else
     {
         std::cout << "VK > Successfully created pipeline layout! \n";
     }
@@ -945,10 +1251,102 @@ void Vulkan::Renderer::CreatePipelines()
         std::cout << "VK > Successfully created wireframe pipeline! \n";
     }
 
+    /*
+        Packed vertex shader stages + pipeline, only when the shader has been compiled
+    */
+
+    if (std::filesystem::exists("Shaders/BasePackedVertexShader.spv"))
+    {
+        auto PackedBindingDescriptions = Vulkan::Renderer::PackedVertex::GetBindingDescriptions();
+        auto PackedAttributeDescriptions = Vulkan::Renderer::PackedVertex::GetAttributeDescriptions();
+
+        VertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(PackedBindingDescriptions.size());
+        VertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(PackedAttributeDescriptions.size());
+        VertexInputInfo.pVertexBindingDescriptions = PackedBindingDescriptions.data();
+        VertexInputInfo.pVertexAttributeDescriptions = PackedAttributeDescriptions.data();
+
+        ShaderStages[0] = Vulkan::Renderer::LoadShader("Shaders/BasePackedVertexShader.spv", VK_SHADER_STAGE_VERTEX_BIT);
+        ShaderStages[1] = Vulkan::Renderer::LoadShader("Shaders/BaseFragmentShader.spv", VK_SHADER_STAGE_FRAGMENT_BIT);
+
+        if (vkCreateGraphicsPipelines(Vulkan::Renderer::Device, VK_NULL_HANDLE, 1, &PipelineInfo, nullptr, &Vulkan::Renderer::Pipelines.Packed) != VK_SUCCESS)
+        {
+            throw std::runtime_error("VK > Failed to create packed pipeline!");
+        }
+        else
+        {
+            std::cout << "VK > Successfully created packed pipeline! \n";
+        }
+    }
+    else
+    {
+        std::cout << "VK > Packed vertex shader not compiled, models will use the full vertex format \n";
+    }
+
+    /*
+        Depth only pipelines, vertex stage alone with only the position stream bound and color writes
+        masked off. The main pass tests LESS_OR_EQUAL against the depth they lay down, so each depth
+        shader computes gl_Position with the same expression as its main pass shader and every vertex
+        shader declares it invariant, the two have to come out bit identical.
+    */
+
+    PipelineInfo.stageCount = 1;
+    ColorBlendAttachment.colorWriteMask = 0;
+
+    if (std::filesystem::exists("Shaders/DepthVertexShader.spv"))
+    {
+        auto DepthBindingDescriptions = Vulkan::Renderer::Vertex::GetBindingDescriptions(true);
+        auto DepthAttributeDescriptions = Vulkan::Renderer::Vertex::GetAttributeDescriptions(true);
+
+        VertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(DepthBindingDescriptions.size());
+        VertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(DepthAttributeDescriptions.size());
+        VertexInputInfo.pVertexBindingDescriptions = DepthBindingDescriptions.data();
+        VertexInputInfo.pVertexAttributeDescriptions = DepthAttributeDescriptions.data();
+
+        ShaderStages[0] = Vulkan::Renderer::LoadShader("Shaders/DepthVertexShader.spv", VK_SHADER_STAGE_VERTEX_BIT);
+
+        if (vkCreateGraphicsPipelines(Vulkan::Renderer::Device, VK_NULL_HANDLE, 1, &PipelineInfo, nullptr, &Vulkan::Renderer::Pipelines.DepthOnly) != VK_SUCCESS)
+        {
+            throw std::runtime_error("VK > Failed to create depth only pipeline!");
+        }
+        else
+        {
+            std::cout << "VK > Successfully created depth only pipeline! \n";
+        }
+    }
+
+    if (Vulkan::Renderer::Pipelines.Packed != VK_NULL_HANDLE && std::filesystem::exists("Shaders/DepthPackedVertexShader.spv"))
+    {
+        auto DepthBindingDescriptions = Vulkan::Renderer::PackedVertex::GetBindingDescriptions(true);
+        auto DepthAttributeDescriptions = Vulkan::Renderer::PackedVertex::GetAttributeDescriptions(true);
+
+        VertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(DepthBindingDescriptions.size());
+        VertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(DepthAttributeDescriptions.size());
+        VertexInputInfo.pVertexBindingDescriptions = DepthBindingDescriptions.data();
+        VertexInputInfo.pVertexAttributeDescriptions = DepthAttributeDescriptions.data();
+
+        ShaderStages[0] = Vulkan::Renderer::LoadShader("Shaders/DepthPackedVertexShader.spv", VK_SHADER_STAGE_VERTEX_BIT);
+
+        if (vkCreateGraphicsPipelines(Vulkan::Renderer::Device, VK_NULL_HANDLE, 1, &PipelineInfo, nullptr, &Vulkan::Renderer::Pipelines.DepthOnlyPacked) != VK_SUCCESS)
+        {
+            throw std::runtime_error("VK > Failed to create packed depth only pipeline!");
+        }
+        else
+        {
+            std::cout << "VK > Successfully created packed depth only pipeline! \n";
+        }
+    }
+
+    if (Vulkan::Renderer::Pipelines.DepthOnly == VK_NULL_HANDLE)
+    {
+        std::cout << "VK > Depth vertex shader not compiled, depth prepass disabled \n";
+    }
+
     for (auto& ShaderModule : Vulkan::Renderer::ShaderModules)
     {
         vkDestroyShaderModule(Vulkan::Renderer::Device, ShaderModule, nullptr);
     }
+
+    Vulkan::Renderer::InvalidateCommandBuffers();
 }
 
 VkShaderModule Vulkan::Renderer::CreateShaderModule(const std::vector<char>& Code)
@@ -1066,12 +1464,58 @@ void Vulkan::Renderer::CreateSyncObjects()
     }
 }
 
+namespace
+{
+    bool FrameBegun = false;
+}
+
+void Vulkan::Renderer::BeginFrame()
+{
+    if (FrameBegun)
+    {
+        return;
+    }
+
+    PROFILE_ZONE("Renderer::BeginFrame");
+
+    Vulkan::Pacing::ApplyPolicy();
+
+    {
+        PROFILE_ZONE("Pacing::Limit");
+
+        Vulkan::Pacing::Limit();
+    }
+
+    {
+        PROFILE_ZONE("Wait for fence");
+
+        vkWaitForFences(Vulkan::Renderer::Device, 1, &Vulkan::Renderer::InFlightFences[Vulkan::Renderer::CurrentFrame], VK_TRUE, UINT64_MAX);
+    }
+
+    Vulkan::Pacing::FrameComplete(Vulkan::Renderer::CurrentFrame);
+    Vulkan::GpuProfiler::Collect(Vulkan::Renderer::CurrentFrame);
+    Vulkan::Deletion::FrameComplete(Vulkan::Renderer::CurrentFrame);
+    Vulkan::Recording::BeginFrame(Vulkan::Renderer::CurrentFrame);
+
+    FrameBegun = true;
+}
+
 void Vulkan::Renderer::DrawFrame()
 {
-    vkWaitForFences(Vulkan::Renderer::Device, 1, &Vulkan::Renderer::InFlightFences[Vulkan::Renderer::CurrentFrame], VK_TRUE, UINT64_MAX);
+    PROFILE_ZONE("Renderer::DrawFrame");
+
+    Vulkan::Renderer::BeginFrame();
+
+    FrameBegun = false;
 
     uint32_t ImageIndex;
-    VkResult Result = vkAcquireNextImageKHR(Vulkan::Renderer::Device, Vulkan::Renderer::SwapChain, UINT64_MAX, Vulkan::Renderer::ImageAvailableSemaphores[Vulkan::Renderer::CurrentFrame], VK_NULL_HANDLE, &ImageIndex);
+    VkResult Result;
+
+    {
+        PROFILE_ZONE("Acquire");
+
+        Result = vkAcquireNextImageKHR(Vulkan::Renderer::Device, Vulkan::Renderer::SwapChain, UINT64_MAX, Vulkan::Renderer::ImageAvailableSemaphores[Vulkan::Renderer::CurrentFrame], VK_NULL_HANDLE, &ImageIndex);
+    }
 
     if (Result == VK_ERROR_OUT_OF_DATE_KHR)
     {
@@ -1084,13 +1528,48 @@ void Vulkan::Renderer::DrawFrame()
         throw std::runtime_error("VK > Failed to acquire swap chain image!");
     }
 
-    Vulkan::Renderer::UpdateUniformBuffer(Vulkan::Renderer::CurrentFrame);
+    {
+        PROFILE_ZONE("UpdateUniformBuffer");
+
+        Vulkan::Renderer::UpdateUniformBuffer(Vulkan::Renderer::CurrentFrame);
+    }
+
+    {
+        PROFILE_ZONE("Uploads");
+
+        Engine::Streaming::Update();
+
+        /*
+            Everything uploaded since the last frame goes out in one submission ahead of the frame that uses it
+        */
+
+        Vulkan::Staging::Submit();
+    }
+
+    Vulkan::Allocator::Update();
+    Vulkan::Pacing::Update();
+    Vulkan::GpuProfiler::Update();
 
     vkResetFences(Vulkan::Renderer::Device, 1, &Vulkan::Renderer::InFlightFences[Vulkan::Renderer::CurrentFrame]);
 
-    vkResetCommandBuffer(Vulkan::Renderer::CommandBuffers[Vulkan::Renderer::CurrentFrame], 0);
+    VkCommandBuffer CommandBuffer = Vulkan::Renderer::CommandBuffers[Vulkan::Renderer::CurrentFrame];
+
+    {
+        PROFILE_ZONE("Record");
+
+        if (Vulkan::Renderer::CacheCommandBuffers)
+        {
+            CommandBuffer = GetCachedCommandBuffer(ImageIndex);
+        }
+        else
+        {
+            vkResetCommandBuffer(CommandBuffer, 0);
 
-    Vulkan::Renderer::RecordCommandBuffer(Vulkan::Renderer::CommandBuffers[Vulkan::Renderer::CurrentFrame], ImageIndex);
+            Vulkan::Renderer::RecordCommandBuffer(CommandBuffer, ImageIndex);
+
+            FramesRecorded++;
+        }
+    }
 
     VkSubmitInfo SubmitInfo{};
     SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -1102,17 +1581,25 @@ void Vulkan::Renderer::DrawFrame()
     SubmitInfo.pWaitSemaphores = waitSemaphores;
     SubmitInfo.pWaitDstStageMask = waitStages;
     SubmitInfo.commandBufferCount = 1;
-    SubmitInfo.pCommandBuffers = &Vulkan::Renderer::CommandBuffers[Vulkan::Renderer::CurrentFrame];
+    SubmitInfo.pCommandBuffers = &CommandBuffer;
 
     VkSemaphore SignalSemaphores[] = { Vulkan::Renderer::RenderFinishedSemaphores[Vulkan::Renderer::CurrentFrame] };
     SubmitInfo.signalSemaphoreCount = 1;
     SubmitInfo.pSignalSemaphores = SignalSemaphores;
 
-    if (vkQueueSubmit(Vulkan::Renderer::GraphicsQueue, 1, &SubmitInfo, Vulkan::Renderer::InFlightFences[Vulkan::Renderer::CurrentFrame]) != VK_SUCCESS)
     {
-        throw std::runtime_error("VK > Failed to submit the draw command buffer!");
+        PROFILE_ZONE("Submit");
+
+        if (vkQueueSubmit(Vulkan::Renderer::GraphicsQueue, 1, &SubmitInfo, Vulkan::Renderer::InFlightFences[Vulkan::Renderer::CurrentFrame]) != VK_SUCCESS)
+        {
+            throw std::runtime_error("VK > Failed to submit the draw command buffer!");
+        }
     }
 
+    Vulkan::Deletion::FrameSubmitted(Vulkan::Renderer::CurrentFrame);
+    Vulkan::Pacing::FrameSubmitted(Vulkan::Renderer::CurrentFrame);
+    Vulkan::GpuProfiler::FrameSubmitted(Vulkan::Renderer::CurrentFrame);
+
     VkPresentInfoKHR PresentInfo{};
     PresentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     PresentInfo.waitSemaphoreCount = 1;
@@ -1125,7 +1612,13 @@ void Vulkan::Renderer::DrawFrame()
     PresentInfo.pImageIndices = &ImageIndex;
     PresentInfo.pResults = nullptr;
 
-    Result = vkQueuePresentKHR(Vulkan::Renderer::PresentQueue, &PresentInfo);
+    {
+        PROFILE_ZONE("Present");
+
+        Result = vkQueuePresentKHR(Vulkan::Renderer::PresentQueue, &PresentInfo);
+    }
+
+    Vulkan::Pacing::FramePresented(Vulkan::Renderer::CurrentFrame);
 
     if (Result == VK_ERROR_OUT_OF_DATE_KHR || Result == VK_SUBOPTIMAL_KHR || Vulkan::Renderer::FramebufferResized)
     {
@@ -1162,7 +1655,7 @@ void Vulkan::Renderer::CreateCommandBuffers()
     }
 }
 
-void Vulkan::Renderer::RecordCommandBuffer(VkCommandBuffer CommandBuffer, uint32_t ImageIndex)
+void Vulkan::Renderer::RecordCommandBuffer(VkCommandBuffer CommandBuffer, uint32_t ImageIndex, bool Reusable)
 {
     VkCommandBufferBeginInfo BeginInfo{};
     BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -1174,6 +1667,8 @@ void Vulkan::Renderer::RecordCommandBuffer(VkCommandBuffer CommandBuffer, uint32
         throw std::runtime_error("VK > Failed to begin recording command buffer!");
     }
 
+    Vulkan::GpuProfiler::BeginFrame(CommandBuffer, Vulkan::Renderer::CurrentFrame);
+
     VkRenderPassBeginInfo RenderPassInfo{};
     RenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     RenderPassInfo.renderPass = Vulkan::Renderer::RenderPass;
@@ -1188,8 +1683,53 @@ void Vulkan::Renderer::RecordCommandBuffer(VkCommandBuffer CommandBuffer, uint32
     RenderPassInfo.clearValueCount = static_cast<uint32_t>(ClearValues.size());
     RenderPassInfo.pClearValues = ClearValues.data();
 
-    vkCmdBeginRenderPass(CommandBuffer, &RenderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    /*
+        Big draw lists are split across the recording threads into secondaries, the render pass then
+        holds nothing but vkCmdExecuteCommands. Reusable recordings stay inline, the secondaries are
+        one time submit and their pools are reset every frame.
+    */
+
+    Engine::GameObject::BuildDrawList();
+
+    Vulkan::GpuProfiler::Begin(CommandBuffer, "Render pass");
+
+    if (!Reusable && Vulkan::Recording::ShouldRecord(static_cast<uint32_t>(Engine::GameObject::DrawList.size())))
+    {
+        vkCmdBeginRenderPass(CommandBuffer, &RenderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+        VkCommandBufferInheritanceInfo Inheritance{};
+        Inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        Inheritance.renderPass = Vulkan::Renderer::RenderPass;
+        Inheritance.subpass = 0;
+        Inheritance.framebuffer = Vulkan::Renderer::SwapChainFramebuffers[ImageIndex];
+
+        Engine::GameObject::RenderGameObjectsParallel(CommandBuffer, Inheritance);
+    }
+    else
+    {
+        vkCmdBeginRenderPass(CommandBuffer, &RenderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+        Vulkan::Renderer::BindFrameState(CommandBuffer);
+
+        vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Vulkan::Renderer::Pipelines.Normal);
+
+        Engine::GameObject::RenderGameObjects(CommandBuffer, Reusable);
+    }
+
+    Engine::GameObject::ReportStats();
 
+    vkCmdEndRenderPass(CommandBuffer);
+
+    Vulkan::GpuProfiler::End(CommandBuffer, "Render pass");
+
+    if (vkEndCommandBuffer(CommandBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("VK > Failed to record command buffer!");
+    }
+}
+
+void Vulkan::Renderer::BindFrameState(VkCommandBuffer CommandBuffer)
+{
     vkCmdBindDescriptorSets(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Vulkan::Renderer::PipelineLayout, 0, 1, &Vulkan::Renderer::DescriptorSets[Vulkan::Renderer::CurrentFrame], 0, nullptr);
 
     VkViewport Viewport{};
@@ -1205,26 +1745,6 @@ void Vulkan::Renderer::RecordCommandBuffer(VkCommandBuffer CommandBuffer, uint32
     Scissor.offset = { 0, 0 };
     Scissor.extent = Vulkan::Renderer::SwapChainExtent;
     vkCmdSetScissor(CommandBuffer, 0, 1, &Scissor);
-
-    vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Vulkan::Renderer::Pipelines.Normal);
-
-    /*
-        Model magic
-    */
-
-    /*
-        This can probably be done better
-    */
-
-
-    Engine::GameObject::RenderGameObjects(CommandBuffer);
-
-    vkCmdEndRenderPass(CommandBuffer);
-
-    if (vkEndCommandBuffer(CommandBuffer) != VK_SUCCESS)
-    {
-        throw std::runtime_error("VK > Failed to record command buffer!");
-    }
 }
 
 void Vulkan::Renderer::CreateCommandPool()
@@ -1246,7 +1766,7 @@ void Vulkan::Renderer::CreateCommandPool()
     }
 }
 
-void Vulkan::Renderer::CreateImage(uint32_t Width, uint32_t Height, VkFormat Format, VkImageTiling Tiling, VkImageUsageFlags Usage, VkMemoryPropertyFlags Properties, VkImage& Image, VkDeviceMemory& ImageMemory)
+void Vulkan::Renderer::CreateImage(uint32_t Width, uint32_t Height, VkFormat Format, VkImageTiling Tiling, VkImageUsageFlags Usage, VkMemoryPropertyFlags Properties, VkImage& Image, Vulkan::Allocator::Allocation& ImageMemory, Vulkan::Allocator::Category Tag)
 {
     VkImageCreateInfo CreateInfo{};
     CreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -1264,39 +1784,11 @@ void Vulkan::Renderer::CreateImage(uint32_t Width, uint32_t Height, VkFormat For
     CreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
     CreateInfo.flags = 0;
 
-    if (vkCreateImage(Vulkan::Renderer::Device, &CreateInfo, nullptr, &Image) != VK_SUCCESS)
-    {
-        throw std::runtime_error("VK > Failed to create texture image!");
-    }
-    else if (vkCreateImage(Vulkan::Renderer::Device, &CreateInfo, nullptr, &Image) == VK_SUCCESS)
-    {
-        std::cout << "VK > Successfully created texture image!" << std::endl;
-    }
-
-    VkMemoryRequirements MemoryRequirements;
-    vkGetImageMemoryRequirements(Vulkan::Renderer::Device, Image, &MemoryRequirements);
-
-    VkMemoryAllocateInfo AllocateInfo{};
-    AllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    AllocateInfo.allocationSize = MemoryRequirements.size;
-    AllocateInfo.memoryTypeIndex = Vulkan::Renderer::FindMemoryType(MemoryRequirements.memoryTypeBits, Properties);
-
-    if (vkAllocateMemory(Vulkan::Renderer::Device, &AllocateInfo, nullptr, &ImageMemory) != VK_SUCCESS)
-    {
-        throw std::runtime_error("VK > Failed to allocate texture image memory!");
-    }
-    else
-    {
-        std::cout << "VK > Successfully allocated texture image memory!" << std::endl;
-    }
-
-    vkBindImageMemory(Vulkan::Renderer::Device, Image, ImageMemory, 0);
+    Vulkan::Allocator::CreateImage(CreateInfo, Properties, Image, ImageMemory, Tag);
 }
 
-void Vulkan::Renderer::TransitionImageLayout(VkImage Image, VkFormat Format, VkImageLayout OldLayout, VkImageLayout NewLayout)
+void Vulkan::Renderer::TransitionImageLayout(VkCommandBuffer CommandBuffer, VkImage Image, VkFormat Format, VkImageLayout OldLayout, VkImageLayout NewLayout)
 {
-    VkCommandBuffer CommandBuffer = Vulkan::Renderer::BeginSingleTimeCommands();
-
     VkImageMemoryBarrier Barrier{};
     Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
 
@@ -1361,8 +1853,6 @@ void Vulkan::Renderer::TransitionImageLayout(VkImage Image, VkFormat Format, VkI
     }
 
     vkCmdPipelineBarrier(CommandBuffer, SourceStage, DestinationStage, 0, 0, nullptr, 0, nullptr, 1, &Barrier);
-
-    Vulkan::Renderer::EndSingleTimeCommands(CommandBuffer);
 }
 
 VkFormat Vulkan::Renderer::FindSupportedFormats(const std::vector<VkFormat>& Candidates, VkImageTiling Tiling, VkFormatFeatureFlags Features)
@@ -1407,23 +1897,17 @@ void Vulkan::Renderer::CreateDepthResources()
 {
     VkFormat DepthFormat = Vulkan::Renderer::FindDepthFormat();
 
-    Vulkan::Renderer::CreateImage(Vulkan::Renderer::SwapChainExtent.width, Vulkan::Renderer::SwapChainExtent.height, DepthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, Vulkan::Renderer::DepthImage, Vulkan::Renderer::DepthImageMemory);
+    Vulkan::Renderer::CreateImage(Vulkan::Renderer::SwapChainExtent.width, Vulkan::Renderer::SwapChainExtent.height, DepthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, Vulkan::Renderer::DepthImage, Vulkan::Renderer::DepthImageMemory, Vulkan::Allocator::Category::Depth);
     Vulkan::Renderer::DepthImageView = Vulkan::Renderer::CreateImageView(Vulkan::Renderer::DepthImage, DepthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
 
-    Vulkan::Renderer::TransitionImageLayout(Vulkan::Renderer::DepthImage, DepthFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+    Vulkan::Renderer::TransitionImageLayout(Vulkan::Staging::GetGraphicsCommandBuffer(), Vulkan::Renderer::DepthImage, DepthFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
 
 
 }
 
 void Vulkan::Renderer::CreateTextureImage()
 {
-    int TextureWidth, TextureHeight, TextureChannels;
-
-    stbi_uc* Pixels = stbi_load(Engine::Model::TexturePath.c_str(), &TextureWidth, &TextureHeight, &TextureChannels, STBI_rgb_alpha);
-
-    VkDeviceSize ImageSize = TextureWidth * TextureHeight * 4;
-
-    if (!Pixels)
+    if (!Vulkan::Renderer::CreateTexture(Engine::Model::TexturePath, Vulkan::Renderer::TextureImage, Vulkan::Renderer::TextureImageMemory))
     {
         throw std::runtime_error("VK > Failed to load texture image!");
     }
@@ -1431,26 +1915,126 @@ void Vulkan::Renderer::CreateTextureImage()
     {
         std::cout << "VK > Successfully loaded texture image! \n";
     }
+}
+
+bool Vulkan::Renderer::CreateTexture(const std::string& FilePath, VkImage& Image, Vulkan::Allocator::Allocation& ImageMemory)
+{
+    std::vector<Vulkan::Renderer::TextureUpload> Uploads(1);
+    Uploads[0].FilePath = FilePath;
+
+    Vulkan::Renderer::CreateTextures(Uploads);
+
+    Image = Uploads[0].Image;
+    ImageMemory = Uploads[0].ImageMemory;
+
+    return Uploads[0].Loaded;
+}
+
+void Vulkan::Renderer::CreateTextures(std::vector<Vulkan::Renderer::TextureUpload>& Uploads)
+{
+    struct Pending
+    {
+        size_t Index;
+        Vulkan::Staging::Region Source;
+        uint32_t Width;
+        uint32_t Height;
+    };
+
+    std::vector<Pending> Group;
+    std::vector<VkImageMemoryBarrier> Barriers;
 
-    VkBuffer StagingBuffer;
-    VkDeviceMemory StagingBufferMemory;
-    Vulkan::Renderer::CreateBuffer(ImageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, StagingBuffer, StagingBufferMemory);
+    /*
+        Everything in Group has its pixels in the ring but no commands yet. It has to be recorded
+        before the ring is allowed to submit, otherwise the batch owning that space could retire and
+        hand it out again while the copies are still missing.
+    */
+
+    auto Record = [&]()
+    {
+        if (Group.empty())
+        {
+            return;
+        }
+
+        VkCommandBuffer CommandBuffer = Vulkan::Staging::GetCommandBuffer();
+
+        Barriers.clear();
+
+        for (const auto& Entry : Group)
+        {
+            VkImageMemoryBarrier Barrier{};
+            Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            Barrier.srcAccessMask = 0;
+            Barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            Barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            Barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            Barrier.image = Uploads[Entry.Index].Image;
+            Barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            Barrier.subresourceRange.baseMipLevel = 0;
+            Barrier.subresourceRange.levelCount = 1;
+            Barrier.subresourceRange.baseArrayLayer = 0;
+            Barrier.subresourceRange.layerCount = 1;
+
+            Barriers.push_back(Barrier);
+        }
+
+        vkCmdPipelineBarrier(CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(Barriers.size()), Barriers.data());
+
+        for (const auto& Entry : Group)
+        {
+            Vulkan::Renderer::CopyBufferToImage(CommandBuffer, Entry.Source.Buffer, Entry.Source.Offset, Uploads[Entry.Index].Image, Entry.Width, Entry.Height);
+
+            /*
+                The move to shader read happens in the batch's release barrier, which also hands the
+                image to the graphics queue
+            */
+
+            Vulkan::Staging::ReleaseImage(Uploads[Entry.Index].Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        }
+
+        Group.clear();
+    };
+
+    for (size_t i = 0; i < Uploads.size(); i++)
+    {
+        auto& Upload = Uploads[i];
+
+        int TextureWidth, TextureHeight, TextureChannels;
+
+        stbi_uc* Pixels = stbi_load(Upload.FilePath.c_str(), &TextureWidth, &TextureHeight, &TextureChannels, STBI_rgb_alpha);
+
+        if (!Pixels)
+        {
+            Upload.Loaded = false;
+
+            continue;
+        }
+
+        VkDeviceSize ImageSize = static_cast<VkDeviceSize>(TextureWidth) * TextureHeight * 4;
+
+        Vulkan::Staging::Region StagingRegion;
+
+        if (!Vulkan::Staging::TryAllocate(ImageSize, StagingRegion))
+        {
+            Record();
+
+            StagingRegion = Vulkan::Staging::Allocate(ImageSize);
+        }
 
-    void* Data;
-    vkMapMemory(Vulkan::Renderer::Device, StagingBufferMemory, 0, ImageSize, 0, &Data);
-    memcpy(Data, Pixels, static_cast<size_t>(ImageSize));
-    vkUnmapMemory(Vulkan::Renderer::Device, StagingBufferMemory);
+        memcpy(StagingRegion.Mapped, Pixels, static_cast<size_t>(ImageSize));
 
-    stbi_image_free(Pixels);
+        stbi_image_free(Pixels);
 
-    Vulkan::Renderer::CreateImage(TextureWidth, TextureHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, Vulkan::Renderer::TextureImage, Vulkan::Renderer::TextureImageMemory);
+        Vulkan::Renderer::CreateImage(TextureWidth, TextureHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, Upload.Image, Upload.ImageMemory, Vulkan::Allocator::Category::Textures);
 
-    Vulkan::Renderer::TransitionImageLayout(Vulkan::Renderer::TextureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    Vulkan::Renderer::CopyBufferToImage(StagingBuffer, Vulkan::Renderer::TextureImage, static_cast<uint32_t>(TextureWidth), static_cast<uint32_t>(TextureHeight));
-    Vulkan::Renderer::TransitionImageLayout(Vulkan::Renderer::TextureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        Upload.Loaded = true;
 
-    vkDestroyBuffer(Vulkan::Renderer::Device, StagingBuffer, nullptr);
-    vkFreeMemory(Vulkan::Renderer::Device, StagingBufferMemory, nullptr);
+        Group.push_back({ i, StagingRegion, static_cast<uint32_t>(TextureWidth), static_cast<uint32_t>(TextureHeight) });
+    }
+
+    Record();
 }
 
 void Vulkan::Renderer::CreateTextureSampler()
@@ -1529,9 +2113,9 @@ void Vulkan::Renderer::CreateUniformBuffers()
 
     for (size_t i = 0; i < Vulkan::Renderer::MaxFramesInFlight; i++)
     {
-        Vulkan::Renderer::CreateBuffer(BufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, Vulkan::Renderer::UniformBuffers[i], Vulkan::Renderer::UniformBuffersMemory[i]);
+        Vulkan::Renderer::CreateBuffer(BufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, Vulkan::Renderer::UniformBuffers[i], Vulkan::Renderer::UniformBuffersMemory[i], Vulkan::Allocator::Category::Uniforms);
 
-        vkMapMemory(Vulkan::Renderer::Device, Vulkan::Renderer::UniformBuffersMemory[i], 0, BufferSize, 0, &Vulkan::Renderer::UniformBuffersMapped[i]);
+        Vulkan::Renderer::UniformBuffersMapped[i] = Vulkan::Renderer::UniformBuffersMemory[i].Mapped;
     }
 }
 
@@ -1554,7 +2138,7 @@ void Vulkan::Renderer::CreateDescriptorPool()
     {
         throw std::runtime_error("VK > Failed to create descriptor pool!");
     }
-    else if (vkCreateDescriptorPool(Vulkan::Renderer::Device, &CreateInfo, nullptr, &Vulkan::Renderer::DescriptorPool) == VK_SUCCESS)
+    else
     {
         std::cout << "VK > Successfully created descriptor pool! \n";
     }
@@ -1629,13 +2213,12 @@ void Vulkan::Renderer::UpdateUniformBuffer(uint32_t CurrentImage)
     //UBO.Transform = glm::mat4(1.0f, 1.0f, 1.0f, 1.0f);
     //UBO.View = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     UBO.View = Engine::Camera::GetViewMatrix();
-    UBO.Proj = glm::perspective(glm::radians(45.0f), Vulkan::Renderer::SwapChainExtent.width / (float)Vulkan::Renderer::SwapChainExtent.height, 0.1f, 256.0f);
-    UBO.Proj[1][1] *= -1;
+    UBO.Proj = Engine::Camera::GetProjectionMatrix(Vulkan::Renderer::SwapChainExtent.width / (float)Vulkan::Renderer::SwapChainExtent.height);
 
     memcpy(Vulkan::Renderer::UniformBuffersMapped[CurrentImage], &UBO, sizeof(UBO));
 }
 
-void Vulkan::Renderer::CreateBuffer(VkDeviceSize Size, VkBufferUsageFlags Usage, VkMemoryPropertyFlags Properties, VkBuffer& Buffer, VkDeviceMemory& BufferMemory)
+void Vulkan::Renderer::CreateBuffer(VkDeviceSize Size, VkBufferUsageFlags Usage, VkMemoryPropertyFlags Properties, VkBuffer& Buffer, Vulkan::Allocator::Allocation& BufferMemory, Vulkan::Allocator::Category Tag)
 {
     VkBufferCreateInfo BufferInfo{};
     BufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -1643,33 +2226,7 @@ void Vulkan::Renderer::CreateBuffer(VkDeviceSize Size, VkBufferUsageFlags Usage,
     BufferInfo.usage = Usage;
     BufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-    if (vkCreateBuffer(Vulkan::Renderer::Device, &BufferInfo, nullptr, &Buffer) != VK_SUCCESS)
-    {
-        throw std::runtime_error("VK > Failed to create buffer!");
-    }
-    else if (vkCreateBuffer(Vulkan::Renderer::Device, &BufferInfo, nullptr, &Buffer) == VK_SUCCESS)
-    {
-        std::cout << "VK > Successfully created buffer! \n";
-    }
-
-    VkMemoryRequirements MemoryRequirements;
-    vkGetBufferMemoryRequirements(Vulkan::Renderer::Device, Buffer, &MemoryRequirements);
-
-    VkMemoryAllocateInfo AllocateInfo{};
-    AllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    AllocateInfo.allocationSize = MemoryRequirements.size;
-    AllocateInfo.memoryTypeIndex = Vulkan::Renderer::FindMemoryType(MemoryRequirements.memoryTypeBits, Properties);
-
-    if (vkAllocateMemory(Vulkan::Renderer::Device, &AllocateInfo, nullptr, &BufferMemory) != VK_SUCCESS)
-    {
-        throw std::runtime_error("VK > Failed to allocate buffer memory!");
-    }
-    else if (vkAllocateMemory(Vulkan::Renderer::Device, &AllocateInfo, nullptr, &BufferMemory) == VK_SUCCESS)
-    {
-        std::cout << "VK > Successfully allocated buffer memory! \n";
-    }
-
-    vkBindBufferMemory(Vulkan::Renderer::Device, Buffer, BufferMemory, 0);
+    Vulkan::Allocator::CreateBuffer(BufferInfo, Properties, Buffer, BufferMemory, Tag);
 }
 
 VkCommandBuffer Vulkan::Renderer::BeginSingleTimeCommands()
@@ -1721,12 +2278,10 @@ void Vulkan::Renderer::CopyBuffer(VkBuffer SrcBuffer, VkBuffer DstBuffer, VkDevi
     Vulkan::Renderer::EndSingleTimeCommands(CommandBuffer);
 }
 
-void Vulkan::Renderer::CopyBufferToImage(VkBuffer Buffer, VkImage Image, uint32_t Width, uint32_t Height)
+void Vulkan::Renderer::CopyBufferToImage(VkCommandBuffer CommandBuffer, VkBuffer Buffer, VkDeviceSize BufferOffset, VkImage Image, uint32_t Width, uint32_t Height)
 {
-    VkCommandBuffer CommandBuffer = Vulkan::Renderer::BeginSingleTimeCommands();
-
     VkBufferImageCopy Region{};
-    Region.bufferOffset = 0;
+    Region.bufferOffset = BufferOffset;
     Region.bufferRowLength = 0;
     Region.bufferImageHeight = 0;
 
@@ -1739,8 +2294,6 @@ void Vulkan::Renderer::CopyBufferToImage(VkBuffer Buffer, VkImage Image, uint32_
     Region.imageExtent = { Width, Height, 1 };
 
     vkCmdCopyBufferToImage(CommandBuffer, Buffer, Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Region);
-
-    Vulkan::Renderer::EndSingleTimeCommands(CommandBuffer);
 }
 
 uint32_t Vulkan::Renderer::FindMemoryType(uint32_t TypeFilter, VkMemoryPropertyFlags Properties)
@@ -1,5 +1,12 @@
 #pragma once
 
+#include "Allocator.h"
+#include "Staging.h"
+#include "Deletion.h"
+#include "Recording.h"
+#include "Pacing.h"
+#include "GpuProfiler.h"
+
 namespace Vulkan
 {
 	namespace Renderer
@@ -9,6 +16,12 @@ namespace Vulkan
 			std::optional<uint32_t> GraphicsFamily;
 			std::optional<uint32_t> PresentFamily;
 
+			/*
+				A family with transfer but no graphics support, usually the copy engine. Not required.
+			*/
+
+			std::optional<uint32_t> TransferFamily;
+
 			bool IsComplete()
 			{
 				return GraphicsFamily.has_value() && PresentFamily.has_value();
@@ -21,10 +34,24 @@ namespace Vulkan
 			std::vector<VkPresentModeKHR> PresentModes;
 		};
 
-		struct {
+		struct PipelineList {
 			VkPipeline Normal{ VK_NULL_HANDLE };
 			VkPipeline WireFrame{ VK_NULL_HANDLE };
-		} Pipelines;
+			VkPipeline Packed{ VK_NULL_HANDLE };
+
+			/*
+				Position stream only, no fragment stage, used by the depth prepass
+			*/
+
+			VkPipeline DepthOnly{ VK_NULL_HANDLE };
+			VkPipeline DepthOnlyPacked{ VK_NULL_HANDLE };
+		};
+
+		/*
+			On the GPU a vertex is split into two streams at Color: positions on binding 0 and the
+			remaining attributes on binding 1. Depth only pipelines bind just the first, fetching 12 of
+			the 44 bytes. The layout below stays the CPU and cache format, uploads deinterleave it.
+		*/
 
 		struct Vertex {
 			glm::vec3 Pos;
@@ -32,24 +59,36 @@ namespace Vulkan
 			glm::vec3 Normal;
 			glm::vec2 UV;
 
-			static VkVertexInputBindingDescription GetBindingDescription()
+			static const uint32_t AttributeOffset = sizeof(glm::vec3);
+
+			static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions(bool PositionOnly = false)
 			{
-				VkVertexInputBindingDescription BindingDescription{};
-				BindingDescription.binding = 0;
-				BindingDescription.stride = sizeof(Vertex);
-				BindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+				std::vector<VkVertexInputBindingDescription> BindingDescriptions{};
 
-				return BindingDescription;
+				BindingDescriptions.push_back({ 0, AttributeOffset, VK_VERTEX_INPUT_RATE_VERTEX });
+
+				if (!PositionOnly)
+				{
+					BindingDescriptions.push_back({ 1, sizeof(Vertex) - AttributeOffset, VK_VERTEX_INPUT_RATE_VERTEX });
+				}
+
+				return BindingDescriptions;
 			}
 
-			static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions()
+			static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions(bool PositionOnly = false)
 			{
 				std::vector<VkVertexInputAttributeDescription> AttributeDescriptions{};
 
 				AttributeDescriptions.push_back({ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, Pos) });
-				AttributeDescriptions.push_back({ 1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, Color) });
-				AttributeDescriptions.push_back({ 2, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, Normal) });
-				AttributeDescriptions.push_back({ 3, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, UV) });
+
+				if (PositionOnly)
+				{
+					return AttributeDescriptions;
+				}
+
+				AttributeDescriptions.push_back({ 1, 1, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, Color) - AttributeOffset });
+				AttributeDescriptions.push_back({ 2, 1, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, Normal) - AttributeOffset });
+				AttributeDescriptions.push_back({ 3, 1, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, UV) - AttributeOffset });
 
 				/*
 				AttributeDescriptions[0].binding = 0;
@@ -77,6 +116,65 @@ namespace Vulkan
 			}
 		};
 
+		/*
+			Compressed layout, 20 bytes instead of 44:
+			position as UNORM16 relative to the mesh bounds and an octahedral SNORM16 normal.
+			UVs stay float32, level geometry tiles them far past the range half floats hold exactly.
+			Color is dropped, the fragment shader never reads it. Decoded by BasePackedShader.vert.
+		*/
+
+		struct PackedVertex {
+			uint16_t Pos[4];
+			int16_t Normal[2];
+			glm::vec2 UV;
+
+			/*
+				Split like Vertex, the 8 byte position on binding 0 and normal and UV on binding 1. The
+				packed shader doesn't light anything yet, so only UV is bound as an attribute.
+			*/
+
+			static const uint32_t AttributeOffset = sizeof(uint16_t) * 4;
+
+			static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions(bool PositionOnly = false)
+			{
+				std::vector<VkVertexInputBindingDescription> BindingDescriptions{};
+
+				BindingDescriptions.push_back({ 0, AttributeOffset, VK_VERTEX_INPUT_RATE_VERTEX });
+
+				if (!PositionOnly)
+				{
+					BindingDescriptions.push_back({ 1, sizeof(PackedVertex) - AttributeOffset, VK_VERTEX_INPUT_RATE_VERTEX });
+				}
+
+				return BindingDescriptions;
+			}
+
+			static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions(bool PositionOnly = false)
+			{
+				std::vector<VkVertexInputAttributeDescription> AttributeDescriptions{};
+
+				AttributeDescriptions.push_back({ 0, 0, VK_FORMAT_R16G16B16A16_UNORM, offsetof(PackedVertex, Pos) });
+
+				if (PositionOnly)
+				{
+					return AttributeDescriptions;
+				}
+
+				AttributeDescriptions.push_back({ 3, 1, VK_FORMAT_R32G32_SFLOAT, offsetof(PackedVertex, UV) - AttributeOffset });
+
+				return AttributeDescriptions;
+			}
+		};
+
+		/*
+			Pushed after the object transform, lets the packed vertex shader rebuild positions
+		*/
+
+		struct PackedPushConstant {
+			glm::vec4 BoundsMin;
+			glm::vec4 BoundsExtent;
+		};
+
 		struct UniformBufferObject {
 			//alignas(16) glm::mat4 Model;
 			alignas(16) glm::mat4 Model;
@@ -86,6 +184,17 @@ namespace Vulkan
 			alignas(16) glm::mat4 Transform;
 		};
 
+		/*
+			One entry of a batched texture upload, Image and ImageMemory are only valid when Loaded
+		*/
+
+		struct TextureUpload {
+			std::string FilePath;
+			VkImage Image = VK_NULL_HANDLE;
+			Vulkan::Allocator::Allocation ImageMemory;
+			bool Loaded = false;
+		};
+
 		//extern std::vector<Vertex> Vertices;
 		//extern std::vector<uint32_t> Indices;
 
@@ -114,11 +223,25 @@ namespace Vulkan
 		extern VkQueue GraphicsQueue;
 		extern VkQueue PresentQueue;
 
+		/*
+			Dedicated transfer queue, the graphics queue when the device has no separate transfer family
+		*/
+
+		extern VkQueue TransferQueue;
+
+		/*
+			VK_EXT_memory_budget is enabled, the allocator reports the driver's budget instead of an estimate
+		*/
+
+		extern bool MemoryBudgetSupported;
+
 		extern VkDescriptorSetLayout DescriptorSetLayout;
 		extern VkPipelineLayout PipelineLayout;
 		extern VkPipeline GraphicsPipeline;
 		extern VkPipeline WireframePipeline;
 
+		extern PipelineList Pipelines;
+
 		extern std::vector<VkShaderModule> ShaderModules;
 
 		extern VkSwapchainKHR SwapChain;
@@ -146,24 +269,45 @@ namespace Vulkan
 		//extern VkDeviceMemory IndexBufferMemory;
 
 		extern std::vector<VkBuffer> UniformBuffers;
-		extern std::vector<VkDeviceMemory> UniformBuffersMemory;
+		extern std::vector<Vulkan::Allocator::Allocation> UniformBuffersMemory;
 		extern std::vector<void*> UniformBuffersMapped;
 
 		extern VkDescriptorPool DescriptorPool;
 		extern std::vector<VkDescriptorSet> DescriptorSets;
 
 		extern VkImage TextureImage;
-		extern VkDeviceMemory TextureImageMemory;
+		extern Vulkan::Allocator::Allocation TextureImageMemory;
 		extern VkImageView TextureImageView;
 		extern VkSampler TextureSampler;
 
 		extern VkImage DepthImage;
-		extern VkDeviceMemory DepthImageMemory;
+		extern Vulkan::Allocator::Allocation DepthImageMemory;
 		extern VkImageView DepthImageView;
 
 		extern bool FramebufferResized;
 
-		const uint32_t MaxFramesInFlight = 2;
+		/*
+			Lay down depth with the position-only pipelines before the main pass, so shaded fragments
+			are only run for visible surfaces. Ignored if the depth shaders aren't compiled.
+		*/
+
+		extern bool DepthPrepass;
+
+		/*
+			Keep one recorded command buffer per swapchain image and frame in flight and submit it again
+			while nothing it records has changed. Per frame data only reaches the GPU through the mapped
+			uniform buffers, so a clean frame costs a fence wait, a memcpy and a submit. Cached
+			recordings are made inline and without meshlet culling so they hold from any viewpoint,
+			camera movement only re-records when it changes an object's LOD.
+		*/
+
+		extern bool CacheCommandBuffers;
+
+		/*
+			Set by the frame pacing policy, every per frame resource is sized to it
+		*/
+
+		extern uint32_t MaxFramesInFlight;
 
 		extern uint32_t CurrentFrame;
 
@@ -177,6 +321,13 @@ namespace Vulkan
 		void CreateLogicalDevice();
 		void CreateSwapChain();
 		void RecreateSwapChain();
+
+		/*
+			Waits for the device, then rebuilds sync objects, command buffers, uniform buffers and every
+			descriptor set for a new number of frames in flight
+		*/
+
+		void RecreateFrameResources(uint32_t FramesInFlight);
 		void CleanUpSwapChain();
 		void CreateImageViews();
 		void CreateFramebuffers();
@@ -187,27 +338,60 @@ namespace Vulkan
 		void CreateRenderPass();
 		void CreateCommandBuffers();
 		void CreateCommandPool();
-		void RecordCommandBuffer(VkCommandBuffer CommandBuffer, uint32_t ImageIndex);
+		void RecordCommandBuffer(VkCommandBuffer CommandBuffer, uint32_t ImageIndex, bool Reusable = false);
+
+		/*
+			Marks every cached recording stale. Called for added, moved or unloaded objects, models
+			becoming resident, material and pipeline changes and swapchain recreation. Code writing to
+			GameObjects directly has to call it as well.
+		*/
+
+		void InvalidateCommandBuffers();
+
+		/*
+			Global descriptor set, viewport and scissor. Secondaries inherit none of it, so each one
+			recorded inside the render pass sets it again.
+		*/
+
+		void BindFrameState(VkCommandBuffer CommandBuffer);
 		void CreateSyncObjects();
+		/*
+			Applies a pending pacing policy, runs the frame cap and waits for the current frame's fence.
+			Called before input is read so the frame draws the freshest input, DrawFrame calls it itself
+			if it hasn't run yet.
+		*/
+
+		void BeginFrame();
 		void DrawFrame();
 		void PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& CreateInfo);
 		void DestroyDebugUtilsMessengerEXT(VkInstance Instance, VkDebugUtilsMessengerEXT DebugMessenger, const VkAllocationCallbacks* PAllocator);
 		void CreateTextureImage();
+		bool CreateTexture(const std::string& FilePath, VkImage& Image, Vulkan::Allocator::Allocation& ImageMemory);
+
+		/*
+			Records every texture into the current staging batch at once: one barrier moves all images to
+			transfer destination, then the copies follow, and the move to shader read is part of the batch's
+			release barrier. Nothing is submitted here, the batch goes out with the next Staging::Submit.
+		*/
+
+		void CreateTextures(std::vector<TextureUpload>& Uploads);
 		void CreateTextureImageView();
 		void CreateTextureSampler();
 		void CreateVertexBuffer();
 		void CreateIndexBuffer();
 		void CreateUniformBuffers();
 		void UpdateUniformBuffer(uint32_t CurrentImage);
-		void CreateBuffer(VkDeviceSize Size, VkBufferUsageFlags Usage, VkMemoryPropertyFlags Properties, VkBuffer& Buffer, VkDeviceMemory& BufferMemory);
+		void CreateBuffer(VkDeviceSize Size, VkBufferUsageFlags Usage, VkMemoryPropertyFlags Properties, VkBuffer& Buffer, Vulkan::Allocator::Allocation& BufferMemory, Vulkan::Allocator::Category Tag = Vulkan::Allocator::Category::Other);
 		void CopyBuffer(VkBuffer SrcBuffer, VkBuffer DstBuffer, VkDeviceSize Size);
-		void CopyBufferToImage(VkBuffer Buffer, VkImage Image, uint32_t Width, uint32_t Height);
+		void CopyBufferToImage(VkCommandBuffer CommandBuffer, VkBuffer Buffer, VkDeviceSize BufferOffset, VkImage Image, uint32_t Width, uint32_t Height);
 		void EndSingleTimeCommands(VkCommandBuffer CommandBuffer);
-		void TransitionImageLayout(VkImage Image, VkFormat Format, VkImageLayout OldLayout, VkImageLayout NewLayout);
+		void TransitionImageLayout(VkCommandBuffer CommandBuffer, VkImage Image, VkFormat Format, VkImageLayout OldLayout, VkImageLayout NewLayout);
 		void CreateDepthResources();
-		void CreateImage(uint32_t Width, uint32_t Height, VkFormat Format, VkImageTiling Tiling, VkImageUsageFlags Usage, VkMemoryPropertyFlags Properties, VkImage& Image, VkDeviceMemory& ImageMemory);
+		void CreateImage(uint32_t Width, uint32_t Height, VkFormat Format, VkImageTiling Tiling, VkImageUsageFlags Usage, VkMemoryPropertyFlags Properties, VkImage& Image, Vulkan::Allocator::Allocation& ImageMemory, Vulkan::Allocator::Category Tag = Vulkan::Allocator::Category::Other);
 
 		bool CheckDeviceExtensionSupport(VkPhysicalDevice Device);
+		bool CheckDeviceExtensionSupport(VkPhysicalDevice Device, const char* Name);
+		bool CheckInstanceExtensionSupport(const char* Name);
 		bool CheckValidationLayerSupport();
 		bool IsDeviceSuitable(VkPhysicalDevice Device);
 		bool HasStencilComponent(VkFormat Format);
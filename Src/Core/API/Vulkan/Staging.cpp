@@ -0,0 +1,620 @@
+#include "../../Src/Common.h"
+
+#include "Renderer.h"
+#include "Staging.h"
+
+#include <deque>
+
+VkDeviceSize Vulkan::Staging::RingSize = 64 * 1024 * 1024;
+bool Vulkan::Staging::UseTransferQueue = true;
+
+namespace
+{
+    /*
+        Command buffers and sync objects of one batch, recycled once it completes. Transfer and
+        Semaphore are only used with a dedicated transfer queue.
+    */
+
+    struct Frame
+    {
+        VkCommandBuffer Graphics = VK_NULL_HANDLE;
+        VkCommandBuffer Transfer = VK_NULL_HANDLE;
+        VkSemaphore Semaphore = VK_NULL_HANDLE;
+        VkFence Fence = VK_NULL_HANDLE;
+    };
+
+    struct Batch
+    {
+        uint64_t Id = 0;
+        Frame Objects;
+
+        /*
+            Ring position after the batch's last allocation, the tail moves here once it completes
+        */
+
+        uint64_t RingEnd = 0;
+
+        std::vector<std::pair<VkBuffer, Vulkan::Allocator::Allocation>> Oversize;
+    };
+
+    VkBuffer RingBuffer = VK_NULL_HANDLE;
+    Vulkan::Allocator::Allocation RingMemory;
+    VkDeviceSize RingCapacity = 0;
+
+    /*
+        Running byte counts, the live part of the ring is [Tail, Head) modulo RingCapacity
+    */
+
+    uint64_t Head = 0;
+    uint64_t Tail = 0;
+
+    Batch Active;
+    bool Open = false;
+    std::deque<Batch> InFlight;
+    std::vector<Frame> Spare;
+
+    /*
+        Ownership transfers of the recording batch, recorded as a single barrier on each side at Submit
+    */
+
+    std::vector<VkBufferMemoryBarrier> BufferReleases;
+    std::vector<VkImageMemoryBarrier> ImageReleases;
+
+    bool Initialized = false;
+    bool Dedicated = false;
+    uint32_t GraphicsFamily = 0;
+    uint32_t TransferFamily = 0;
+    VkCommandPool TransferCommandPool = VK_NULL_HANDLE;
+
+    uint64_t NextBatch = 1;
+    uint64_t Completed = 0;
+
+    Vulkan::Staging::Stats Totals;
+
+    void Initialize()
+    {
+        if (Initialized)
+        {
+            return;
+        }
+
+        Vulkan::Renderer::QueueFamilyIndices Indices = Vulkan::Renderer::FindQueueFamilies(Vulkan::Renderer::PhysicalDevice);
+
+        GraphicsFamily = Indices.GraphicsFamily.value();
+        Dedicated = Vulkan::Staging::UseTransferQueue && Indices.TransferFamily.has_value() && Vulkan::Renderer::TransferQueue != Vulkan::Renderer::GraphicsQueue;
+
+        if (Dedicated)
+        {
+            TransferFamily = Indices.TransferFamily.value();
+
+            VkCommandPoolCreateInfo PoolInfo{};
+            PoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            PoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+            PoolInfo.queueFamilyIndex = TransferFamily;
+
+            if (vkCreateCommandPool(Vulkan::Renderer::Device, &PoolInfo, nullptr, &TransferCommandPool) != VK_SUCCESS)
+            {
+                throw std::runtime_error("VK > Failed to create transfer command pool!");
+            }
+        }
+
+        Initialized = true;
+    }
+
+    void CreateRing()
+    {
+        if (RingBuffer != VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        RingCapacity = Vulkan::Staging::RingSize;
+
+        Vulkan::Renderer::CreateBuffer(RingCapacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, RingBuffer, RingMemory, Vulkan::Allocator::Category::Staging);
+
+        Head = 0;
+        Tail = 0;
+
+        std::cout << "VK > Created " << RingCapacity / (1024 * 1024) << " MB staging ring" << std::endl;
+    }
+
+    VkCommandBuffer AllocateCommandBuffer(VkCommandPool Pool)
+    {
+        VkCommandBufferAllocateInfo AllocateInfo{};
+        AllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        AllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        AllocateInfo.commandPool = Pool;
+        AllocateInfo.commandBufferCount = 1;
+
+        VkCommandBuffer CommandBuffer;
+
+        if (vkAllocateCommandBuffers(Vulkan::Renderer::Device, &AllocateInfo, &CommandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("VK > Failed to allocate staging command buffer!");
+        }
+
+        return CommandBuffer;
+    }
+
+    Frame CreateFrame()
+    {
+        Frame Result;
+        Result.Graphics = AllocateCommandBuffer(Vulkan::Renderer::CommandPool);
+
+        VkFenceCreateInfo FenceInfo{};
+        FenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        if (vkCreateFence(Vulkan::Renderer::Device, &FenceInfo, nullptr, &Result.Fence) != VK_SUCCESS)
+        {
+            throw std::runtime_error("VK > Failed to create staging fence!");
+        }
+
+        if (Dedicated)
+        {
+            Result.Transfer = AllocateCommandBuffer(TransferCommandPool);
+
+            VkSemaphoreCreateInfo SemaphoreInfo{};
+            SemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+            if (vkCreateSemaphore(Vulkan::Renderer::Device, &SemaphoreInfo, nullptr, &Result.Semaphore) != VK_SUCCESS)
+            {
+                throw std::runtime_error("VK > Failed to create staging semaphore!");
+            }
+        }
+
+        return Result;
+    }
+
+    void Begin()
+    {
+        if (Open)
+        {
+            return;
+        }
+
+        Initialize();
+
+        if (Spare.empty())
+        {
+            Spare.push_back(CreateFrame());
+        }
+
+        Active = Batch{};
+        Active.Id = NextBatch;
+        Active.Objects = Spare.back();
+
+        Spare.pop_back();
+
+        VkCommandBufferBeginInfo BeginInfo{};
+        BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        vkBeginCommandBuffer(Active.Objects.Graphics, &BeginInfo);
+
+        if (Dedicated)
+        {
+            vkBeginCommandBuffer(Active.Objects.Transfer, &BeginInfo);
+        }
+
+        Open = true;
+    }
+
+    void Finish(Batch& Finished)
+    {
+        Tail = Finished.RingEnd;
+        Completed = Finished.Id;
+
+        for (auto& Buffer : Finished.Oversize)
+        {
+            Vulkan::Allocator::DestroyBuffer(Buffer.first, Buffer.second);
+        }
+
+        vkResetFences(Vulkan::Renderer::Device, 1, &Finished.Objects.Fence);
+
+        Spare.push_back(Finished.Objects);
+    }
+
+    /*
+        Batches finish in submission order, stop at the first one still running
+    */
+
+    void Retire()
+    {
+        while (!InFlight.empty() && vkGetFenceStatus(Vulkan::Renderer::Device, InFlight.front().Objects.Fence) == VK_SUCCESS)
+        {
+            Finish(InFlight.front());
+            InFlight.pop_front();
+        }
+
+        if (InFlight.empty() && Head == Tail)
+        {
+            Head = 0;
+            Tail = 0;
+        }
+    }
+
+    void WaitOldest()
+    {
+        vkWaitForFences(Vulkan::Renderer::Device, 1, &InFlight.front().Objects.Fence, VK_TRUE, UINT64_MAX);
+
+        Finish(InFlight.front());
+        InFlight.pop_front();
+    }
+
+    /*
+        Place Size bytes in the ring without submitting or waiting, false when the ring is too full
+    */
+
+    bool Reserve(VkDeviceSize Size, VkDeviceSize Alignment, Vulkan::Staging::Region& Result)
+    {
+        Retire();
+
+        /*
+            An allocation never straddles the end of the ring, it skips to the start instead
+        */
+
+        VkDeviceSize Position = Head % RingCapacity;
+        VkDeviceSize Start = (Position + Alignment - 1) / Alignment * Alignment;
+
+        if (Start + Size > RingCapacity)
+        {
+            Start = 0;
+        }
+
+        uint64_t Skip = Start >= Position ? Start - Position : RingCapacity - Position;
+
+        if (Head + Skip + Size - Tail > RingCapacity)
+        {
+            return false;
+        }
+
+        Begin();
+
+        Head += Skip + Size;
+
+        Result.Buffer = RingBuffer;
+        Result.Offset = Start;
+        Result.Size = Size;
+        Result.Mapped = static_cast<char*>(RingMemory.Mapped) + Start;
+
+        return true;
+    }
+
+    void AllocateOversize(VkDeviceSize Size, Vulkan::Staging::Region& Result)
+    {
+        Begin();
+
+        Active.Oversize.emplace_back();
+
+        auto& Buffer = Active.Oversize.back();
+        Vulkan::Renderer::CreateBuffer(Size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, Buffer.first, Buffer.second, Vulkan::Allocator::Category::Staging);
+
+        Result.Buffer = Buffer.first;
+        Result.Offset = 0;
+        Result.Size = Size;
+        Result.Mapped = Buffer.second.Mapped;
+
+        Totals.OversizeUploads++;
+    }
+}
+
+Vulkan::Staging::Region Vulkan::Staging::Allocate(VkDeviceSize Size, VkDeviceSize Alignment)
+{
+    CreateRing();
+
+    Totals.Uploads++;
+    Totals.Bytes += Size;
+
+    Vulkan::Staging::Region Result;
+
+    if (Size > RingCapacity)
+    {
+        AllocateOversize(Size, Result);
+
+        return Result;
+    }
+
+    while (!Reserve(Size, Alignment, Result))
+    {
+        /*
+            Full, hand what has been recorded to the GPU and wait for the oldest batch to free its space
+        */
+
+        Vulkan::Staging::Submit();
+
+        Totals.Stalls++;
+
+        WaitOldest();
+    }
+
+    return Result;
+}
+
+bool Vulkan::Staging::TryAllocate(VkDeviceSize Size, Vulkan::Staging::Region& Result, VkDeviceSize Alignment)
+{
+    CreateRing();
+
+    if (Size > RingCapacity)
+    {
+        AllocateOversize(Size, Result);
+    }
+    else if (!Reserve(Size, Alignment, Result))
+    {
+        return false;
+    }
+
+    Totals.Uploads++;
+    Totals.Bytes += Size;
+
+    return true;
+}
+
+VkCommandBuffer Vulkan::Staging::GetCommandBuffer()
+{
+    Begin();
+
+    return Dedicated ? Active.Objects.Transfer : Active.Objects.Graphics;
+}
+
+VkCommandBuffer Vulkan::Staging::GetGraphicsCommandBuffer()
+{
+    Begin();
+
+    return Active.Objects.Graphics;
+}
+
+void Vulkan::Staging::ReleaseBuffer(VkBuffer Buffer, VkDeviceSize Offset, VkDeviceSize Size)
+{
+    Begin();
+
+    /*
+        On a shared queue the global barrier at Submit already covers buffers
+    */
+
+    if (!Dedicated)
+    {
+        return;
+    }
+
+    VkBufferMemoryBarrier Barrier{};
+    Barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    Barrier.srcQueueFamilyIndex = TransferFamily;
+    Barrier.dstQueueFamilyIndex = GraphicsFamily;
+    Barrier.buffer = Buffer;
+    Barrier.offset = Offset;
+    Barrier.size = Size;
+
+    BufferReleases.push_back(Barrier);
+}
+
+void Vulkan::Staging::ReleaseImage(VkImage Image, VkImageLayout OldLayout, VkImageLayout NewLayout)
+{
+    Begin();
+
+    VkImageMemoryBarrier Barrier{};
+    Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    Barrier.oldLayout = OldLayout;
+    Barrier.newLayout = NewLayout;
+    Barrier.srcQueueFamilyIndex = Dedicated ? TransferFamily : VK_QUEUE_FAMILY_IGNORED;
+    Barrier.dstQueueFamilyIndex = Dedicated ? GraphicsFamily : VK_QUEUE_FAMILY_IGNORED;
+    Barrier.image = Image;
+    Barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    Barrier.subresourceRange.baseMipLevel = 0;
+    Barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+    Barrier.subresourceRange.baseArrayLayer = 0;
+    Barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+    ImageReleases.push_back(Barrier);
+}
+
+bool Vulkan::Staging::HasTransferQueue()
+{
+    Initialize();
+
+    return Dedicated;
+}
+
+uint64_t Vulkan::Staging::GetBatch()
+{
+    return NextBatch;
+}
+
+bool Vulkan::Staging::IsComplete(uint64_t Batch)
+{
+    return Batch <= Completed || (Batch == NextBatch && !Open);
+}
+
+void Vulkan::Staging::Wait(uint64_t Batch)
+{
+    if (Batch == NextBatch && Open)
+    {
+        Vulkan::Staging::Submit();
+    }
+
+    while (!InFlight.empty() && InFlight.front().Id <= Batch)
+    {
+        WaitOldest();
+    }
+}
+
+void Vulkan::Staging::Submit()
+{
+    if (Open)
+    {
+        const VkPipelineStageFlags ReadStages = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        const VkAccessFlags ReadAccess = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+        if (Dedicated)
+        {
+            /*
+                Release on the transfer queue, the matching acquire on the graphics queue waits for the
+                semaphore the transfer submission signals
+            */
+
+            for (auto& Barrier : BufferReleases)
+            {
+                Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                Barrier.dstAccessMask = 0;
+            }
+
+            for (auto& Barrier : ImageReleases)
+            {
+                Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                Barrier.dstAccessMask = 0;
+            }
+
+            if (!BufferReleases.empty() || !ImageReleases.empty())
+            {
+                vkCmdPipelineBarrier(Active.Objects.Transfer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr,
+                    static_cast<uint32_t>(BufferReleases.size()), BufferReleases.data(), static_cast<uint32_t>(ImageReleases.size()), ImageReleases.data());
+            }
+
+            for (auto& Barrier : BufferReleases)
+            {
+                Barrier.srcAccessMask = 0;
+                Barrier.dstAccessMask = ReadAccess;
+            }
+
+            for (auto& Barrier : ImageReleases)
+            {
+                Barrier.srcAccessMask = 0;
+                Barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            }
+
+            if (!BufferReleases.empty() || !ImageReleases.empty())
+            {
+                vkCmdPipelineBarrier(Active.Objects.Graphics, VK_PIPELINE_STAGE_TRANSFER_BIT, ReadStages, 0, 0, nullptr,
+                    static_cast<uint32_t>(BufferReleases.size()), BufferReleases.data(), static_cast<uint32_t>(ImageReleases.size()), ImageReleases.data());
+            }
+
+            vkEndCommandBuffer(Active.Objects.Transfer);
+            vkEndCommandBuffer(Active.Objects.Graphics);
+
+            VkSubmitInfo TransferInfo{};
+            TransferInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            TransferInfo.commandBufferCount = 1;
+            TransferInfo.pCommandBuffers = &Active.Objects.Transfer;
+            TransferInfo.signalSemaphoreCount = 1;
+            TransferInfo.pSignalSemaphores = &Active.Objects.Semaphore;
+
+            if (vkQueueSubmit(Vulkan::Renderer::TransferQueue, 1, &TransferInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+            {
+                throw std::runtime_error("VK > Failed to submit staging batch to the transfer queue!");
+            }
+
+            VkPipelineStageFlags WaitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+            VkSubmitInfo AcquireInfo{};
+            AcquireInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            AcquireInfo.waitSemaphoreCount = 1;
+            AcquireInfo.pWaitSemaphores = &Active.Objects.Semaphore;
+            AcquireInfo.pWaitDstStageMask = &WaitStage;
+            AcquireInfo.commandBufferCount = 1;
+            AcquireInfo.pCommandBuffers = &Active.Objects.Graphics;
+
+            if (vkQueueSubmit(Vulkan::Renderer::GraphicsQueue, 1, &AcquireInfo, Active.Objects.Fence) != VK_SUCCESS)
+            {
+                throw std::runtime_error("VK > Failed to submit staging acquire!");
+            }
+        }
+        else
+        {
+            /*
+                Later submissions read the uploads as vertex, index or shader data
+            */
+
+            VkMemoryBarrier Barrier{};
+            Barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            Barrier.dstAccessMask = ReadAccess;
+
+            for (auto& ImageBarrier : ImageReleases)
+            {
+                ImageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                ImageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            }
+
+            vkCmdPipelineBarrier(Active.Objects.Graphics, VK_PIPELINE_STAGE_TRANSFER_BIT, ReadStages, 0, 1, &Barrier, 0, nullptr, static_cast<uint32_t>(ImageReleases.size()), ImageReleases.data());
+
+            vkEndCommandBuffer(Active.Objects.Graphics);
+
+            VkSubmitInfo SubmitInfo{};
+            SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            SubmitInfo.commandBufferCount = 1;
+            SubmitInfo.pCommandBuffers = &Active.Objects.Graphics;
+
+            if (vkQueueSubmit(Vulkan::Renderer::GraphicsQueue, 1, &SubmitInfo, Active.Objects.Fence) != VK_SUCCESS)
+            {
+                throw std::runtime_error("VK > Failed to submit staging batch!");
+            }
+        }
+
+        BufferReleases.clear();
+        ImageReleases.clear();
+
+        Active.RingEnd = Head;
+
+        InFlight.push_back(std::move(Active));
+        Active = Batch{};
+
+        Open = false;
+        NextBatch++;
+
+        Totals.Submits++;
+    }
+
+    Retire();
+}
+
+void Vulkan::Staging::Update()
+{
+    Retire();
+}
+
+Vulkan::Staging::Stats Vulkan::Staging::GetStats()
+{
+    return Totals;
+}
+
+void Vulkan::Staging::PrintStats()
+{
+    std::cout << "VK > Staging: " << Totals.Uploads << " uploads, " << Totals.Bytes / 1024 << " KB in " << Totals.Submits << " submits, "
+        << Totals.OversizeUploads << " oversize, " << Totals.Stalls << " waits on a full ring" << std::endl;
+}
+
+void Vulkan::Staging::Destroy()
+{
+    Vulkan::Staging::Submit();
+
+    while (!InFlight.empty())
+    {
+        WaitOldest();
+    }
+
+    for (const auto& Entry : Spare)
+    {
+        vkFreeCommandBuffers(Vulkan::Renderer::Device, Vulkan::Renderer::CommandPool, 1, &Entry.Graphics);
+        vkDestroyFence(Vulkan::Renderer::Device, Entry.Fence, nullptr);
+
+        if (Entry.Semaphore != VK_NULL_HANDLE)
+        {
+            vkDestroySemaphore(Vulkan::Renderer::Device, Entry.Semaphore, nullptr);
+        }
+    }
+
+    Spare.clear();
+
+    if (TransferCommandPool != VK_NULL_HANDLE)
+    {
+        vkDestroyCommandPool(Vulkan::Renderer::Device, TransferCommandPool, nullptr);
+        TransferCommandPool = VK_NULL_HANDLE;
+    }
+
+    Initialized = false;
+
+    Vulkan::Allocator::DestroyBuffer(RingBuffer, RingMemory);
+
+    RingCapacity = 0;
+    Head = 0;
+    Tail = 0;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#ifndef STAGING_H
+#define STAGING_H
+
+namespace Vulkan
+{
+	/*
+		Persistent host visible staging ring shared by every upload. Copies are recorded into one
+		batch command buffer, Submit sends the whole batch with a fence and ring space is reclaimed
+		once that fence has signalled, nothing ever waits on the queue going idle.
+
+		With a dedicated transfer queue family the copies run there, overlapping frames already in
+		flight. Every written range and image is released to the graphics family at the end of the
+		batch, and a small graphics command buffer acquires them behind a semaphore the transfer
+		submission signals. Without one the whole batch runs on the graphics queue. Either way batches
+		complete in submission order and anything drawn in a later frame sees the uploaded data.
+	*/
+
+	namespace Staging
+	{
+		/*
+			Space for one upload, Mapped points at Offset inside Buffer
+		*/
+
+		struct Region
+		{
+			VkBuffer Buffer = VK_NULL_HANDLE;
+			VkDeviceSize Offset = 0;
+			VkDeviceSize Size = 0;
+			void* Mapped = nullptr;
+		};
+
+		struct Stats
+		{
+			uint64_t Submits = 0;
+			uint64_t Uploads = 0;
+			uint64_t Bytes = 0;
+			uint64_t OversizeUploads = 0;
+			uint64_t Stalls = 0;
+		};
+
+		/*
+			Ring capacity, uploads larger than this get a temporary buffer that lives as long as the batch
+		*/
+
+		extern VkDeviceSize RingSize;
+
+		/*
+			Use the dedicated transfer queue when the device has one, read when the first batch starts
+		*/
+
+		extern bool UseTransferQueue;
+
+		/*
+			Reserve space in the current batch. When the ring is full the current batch is submitted and
+			the oldest one waited on, so fetch the command buffer only after allocating.
+		*/
+
+		Region Allocate(VkDeviceSize Size, VkDeviceSize Alignment = 16);
+
+		/*
+			Like Allocate but never submits, returns false instead when the ring has no room. Lets a caller
+			record the copies it has pending before the batch they belong to goes out.
+		*/
+
+		bool TryAllocate(VkDeviceSize Size, Region& Result, VkDeviceSize Alignment = 16);
+
+		/*
+			Copies and transfer stage work go into GetCommandBuffer, which may belong to the transfer queue.
+			Anything needing the graphics queue (attachment transitions) goes into GetGraphicsCommandBuffer.
+		*/
+
+		VkCommandBuffer GetCommandBuffer();
+		VkCommandBuffer GetGraphicsCommandBuffer();
+
+		/*
+			Hand a range or image written in this batch over to the graphics queue. Images move from
+			OldLayout to NewLayout as part of it, all of it is recorded as one barrier at Submit.
+		*/
+
+		void ReleaseBuffer(VkBuffer Buffer, VkDeviceSize Offset, VkDeviceSize Size);
+		void ReleaseImage(VkImage Image, VkImageLayout OldLayout, VkImageLayout NewLayout);
+
+		bool HasTransferQueue();
+
+		/*
+			Id of the batch currently recording, complete once IsComplete returns true for it
+		*/
+
+		uint64_t GetBatch();
+		bool IsComplete(uint64_t Batch);
+		void Wait(uint64_t Batch);
+
+		/*
+			Submit the recording batch if it holds anything, then retire finished batches. Never blocks.
+		*/
+
+		void Submit();
+		void Update();
+
+		Stats GetStats();
+		void PrintStats();
+		void Destroy();
+	}
+}
+
+#endif
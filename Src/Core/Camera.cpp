@@ -25,6 +25,14 @@ glm::mat4 Engine::Camera::GetViewMatrix()
 	return glm::lookAt(Engine::Camera::Camera.Eye, Engine::Camera::Camera.Eye + Engine::Camera::Camera.ViewDirection, Engine::Camera::Camera.UpVector);
 }
 
+glm::mat4 Engine::Camera::GetProjectionMatrix(float AspectRatio)
+{
+	glm::mat4 Projection = glm::perspective(glm::radians(Engine::Camera::FieldOfView), AspectRatio, Engine::Camera::NearPlane, Engine::Camera::FarPlane);
+	Projection[1][1] *= -1;
+
+	return Projection;
+}
+
 void Engine::Camera::MoveUp(float Speed)
 {
 	Engine::Camera::Camera.Eye.y += Speed;
@@ -15,10 +15,15 @@ namespace Engine
 
 		extern CameraStruct Camera;
 
+		const float FieldOfView = 45.0f;
+		const float NearPlane = 0.1f;
+		const float FarPlane = 256.0f;
+
 		extern glm::vec2 OldMousePosition;
 
 		void CreateCamera();
 		glm::mat4 GetViewMatrix();
+		glm::mat4 GetProjectionMatrix(float AspectRatio);
 
 		void MoveUp(float Speed);
 		void MoveDown(float Speed);
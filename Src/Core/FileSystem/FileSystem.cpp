@@ -5,6 +5,17 @@
 #include <filesystem>
 #include <regex>
 
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
 namespace fs = std::filesystem;
 
 std::vector<char> FileSystem::ReadFile(const std::string& FileName)
@@ -31,6 +42,120 @@ std::vector<char> FileSystem::ReadFile(const std::string& FileName)
     return Buffer;
 }
 
+FileSystem::MappedFile FileSystem::MapFile(const std::string& FileName)
+{
+    FileSystem::MappedFile File{};
+
+#ifdef _WIN32
+    HANDLE FileHandle = CreateFileA(FileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if (FileHandle == INVALID_HANDLE_VALUE)
+    {
+        return File;
+    }
+
+    LARGE_INTEGER FileSize;
+
+    if (!GetFileSizeEx(FileHandle, &FileSize) || FileSize.QuadPart == 0)
+    {
+        CloseHandle(FileHandle);
+        return File;
+    }
+
+    HANDLE MappingHandle = CreateFileMappingA(FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (MappingHandle == nullptr)
+    {
+        CloseHandle(FileHandle);
+        return File;
+    }
+
+    void* Data = MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+    if (Data == nullptr)
+    {
+        CloseHandle(MappingHandle);
+        CloseHandle(FileHandle);
+        return File;
+    }
+
+    File.Data = static_cast<const char*>(Data);
+    File.Size = static_cast<size_t>(FileSize.QuadPart);
+    File.FileHandle = FileHandle;
+    File.MappingHandle = MappingHandle;
+#else
+    int FileDescriptor = open(FileName.c_str(), O_RDONLY);
+
+    if (FileDescriptor < 0)
+    {
+        return File;
+    }
+
+    struct stat FileStat;
+
+    if (fstat(FileDescriptor, &FileStat) != 0 || FileStat.st_size == 0)
+    {
+        close(FileDescriptor);
+        return File;
+    }
+
+    void* Data = mmap(nullptr, static_cast<size_t>(FileStat.st_size), PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+
+    close(FileDescriptor);
+
+    if (Data == MAP_FAILED)
+    {
+        return File;
+    }
+
+    File.Data = static_cast<const char*>(Data);
+    File.Size = static_cast<size_t>(FileStat.st_size);
+#endif
+
+    return File;
+}
+
+void FileSystem::UnmapFile(FileSystem::MappedFile& File)
+{
+    if (!File.IsOpen())
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(File.Data);
+    CloseHandle(static_cast<HANDLE>(File.MappingHandle));
+    CloseHandle(static_cast<HANDLE>(File.FileHandle));
+#else
+    munmap(const_cast<char*>(File.Data), File.Size);
+#endif
+
+    File = FileSystem::MappedFile{};
+}
+
+bool FileSystem::GetFileStamp(const std::string& FileName, uint64_t& Size, int64_t& WriteTime)
+{
+    std::error_code Error;
+
+    Size = static_cast<uint64_t>(fs::file_size(FileName, Error));
+
+    if (Error)
+    {
+        return false;
+    }
+
+    auto LastWriteTime = fs::last_write_time(FileName, Error);
+
+    if (Error)
+    {
+        return false;
+    }
+
+    WriteTime = static_cast<int64_t>(LastWriteTime.time_since_epoch().count());
+
+    return true;
+}
+
 void FileSystem::LoadTextures()
 {
     int Count = 0;
@@ -7,8 +7,31 @@
 
 namespace FileSystem
 {
+	struct MappedFile
+	{
+		const char* Data = nullptr;
+		size_t Size = 0;
+
+		void* FileHandle = nullptr;
+		void* MappingHandle = nullptr;
+
+		bool IsOpen() const
+		{
+			return Data != nullptr;
+		}
+	};
+
 	std::vector<char> ReadFile(const std::string& FileName);
 
+	/*
+		Read-only memory mapping, returns an unopened MappedFile if the file is missing or empty
+	*/
+
+	MappedFile MapFile(const std::string& FileName);
+	void UnmapFile(MappedFile& File);
+
+	bool GetFileStamp(const std::string& FileName, uint64_t& Size, int64_t& WriteTime);
+
 	void LoadTextures();
 }
 
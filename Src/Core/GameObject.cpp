@@ -1,18 +1,50 @@
 #include "../Common.h"
 #include "./API/Vulkan/Renderer.h"
 #include "GameObject.h"
-#include "Model.h"
+#include "ModelRegistry.h"
+#include "Camera.h"
+#include "Material.h"
+#include "Streaming.h"
+
+#include <thread>
 
 std::vector<Engine::GameObject::Object> Engine::GameObject::GameObjects;
 
+float Engine::GameObject::LodPixelError = 1.0f;
+float Engine::GameObject::LodHysteresis = 0.25f;
+
+uint64_t Engine::GameObject::TrianglesSubmitted = 0;
+uint64_t Engine::GameObject::TrianglesFullDetail = 0;
+
+std::vector<Engine::GameObject::DrawItem> Engine::GameObject::DrawList;
+uint32_t Engine::GameObject::MaterialBinds = 0;
+uint32_t Engine::GameObject::BufferBinds = 0;
+
 Engine::GameObject::Object Engine::GameObject::CreateGameObject(std::string FilePath, glm::vec3 Position, glm::vec3 Scale)
 {
-	Engine::Model Model;
+	Engine::GameObject::Object GameObject{};
+	GameObject.Model = Engine::Models::Acquire(FilePath);
+	GameObject.ModelPath = FilePath;
+	GameObject.Position = Position;
+	GameObject.Scale = Scale;
+
+	glm::mat4 Transform;
+
+	Transform = glm::translate(glm::mat4(1.0f), GameObject.Position);
+	Transform = glm::scale(Transform, GameObject.Scale);
+	GameObject.Transform = Transform;
 
-	Model.Load(FilePath);
+	Engine::GameObject::GameObjects.push_back(GameObject);
+
+	Vulkan::Renderer::InvalidateCommandBuffers();
 
+	return GameObject;
+}
+
+uint32_t Engine::GameObject::CreateGameObjectAsync(std::string FilePath, glm::vec3 Position, glm::vec3 Scale)
+{
 	Engine::GameObject::Object GameObject{};
-	GameObject.Model = Model;
+	GameObject.Model = Engine::Models::Acquire(FilePath, true);
 	GameObject.ModelPath = FilePath;
 	GameObject.Position = Position;
 	GameObject.Scale = Scale;
@@ -25,7 +57,9 @@ Engine::GameObject::Object Engine::GameObject::CreateGameObject(std::string File
 
 	Engine::GameObject::GameObjects.push_back(GameObject);
 
-	return GameObject;
+	Vulkan::Renderer::InvalidateCommandBuffers();
+
+	return static_cast<uint32_t>(Engine::GameObject::GameObjects.size() - 1);
 }
 
 void Engine::GameObject::UpdateGameObjectPosition(Engine::GameObject::Object& GameObject, glm::vec3 Position)
@@ -44,6 +78,8 @@ void Engine::GameObject::UpdateGameObjectPosition(Engine::GameObject::Object& Ga
 			Engine::GameObject::GameObjects[i].Transform = GameObject.Transform;
 		}
 	}
+
+	Vulkan::Renderer::InvalidateCommandBuffers();
 }
 
 void Engine::GameObject::UpdateGameObjectRotation(Engine::GameObject::Object& GameObject, float Radians, glm::vec3 RotationDirection)
@@ -60,6 +96,8 @@ void Engine::GameObject::UpdateGameObjectRotation(Engine::GameObject::Object& Ga
 			Engine::GameObject::GameObjects[i].Transform = GameObject.Transform;
 		}
 	}
+
+	Vulkan::Renderer::InvalidateCommandBuffers();
 }
 
 void Engine::GameObject::UpdateGameObjectScale(Engine::GameObject::Object& GameObject, glm::vec3 Scale)
@@ -78,6 +116,8 @@ void Engine::GameObject::UpdateGameObjectScale(Engine::GameObject::Object& GameO
 			Engine::GameObject::GameObjects[i].Transform = GameObject.Transform;
 		}
 	}
+
+	Vulkan::Renderer::InvalidateCommandBuffers();
 }
 
 /*
@@ -101,23 +141,345 @@ void Engine::GameObject::UpdateGameObject(Engine::GameObject::Object& GameObject
 
 void Engine::GameObject::CreateGameObjects()
 {
-	Engine::GameObject GameObject;
-
-	GameObject.CreateGameObject("Assets/Models/280z.obj", glm::vec3(23.0f, -14.0f, 10.0f), glm::vec3(4.0f));
-	GameObject.CreateGameObject("Assets/Models/de_dust2.obj", glm::vec3(5.0f, 0.0f, 0.0f), glm::vec3(5.0f));
+	Engine::GameObject::CreateGameObjectAsync("Assets/Models/280z.obj", glm::vec3(23.0f, -14.0f, 10.0f), glm::vec3(4.0f));
+	Engine::GameObject::CreateGameObjectAsync("Assets/Models/de_dust2.obj", glm::vec3(5.0f, 0.0f, 0.0f), glm::vec3(5.0f));
 }
 
 void Engine::GameObject::RenderGameObject(Engine::GameObject::Object GameObject)
 {
 }
 
-void Engine::GameObject::RenderGameObjects(VkCommandBuffer CommandBuffer)
+uint32_t Engine::GameObject::SelectLod(const Engine::GameObject::Object& GameObject)
+{
+	const Engine::Model& Model = Engine::Models::Get(GameObject.Model);
+	const auto& Lods = Model.Lods;
+
+	if (Lods.size() <= 1)
+	{
+		return 0;
+	}
+
+	/*
+		Bounding sphere in world space
+	*/
+
+	glm::vec3 Center = glm::vec3(GameObject.Transform * glm::vec4((Model.BoundsMin + Model.BoundsMax) * 0.5f, 1.0f));
+
+	float Scale = std::max({ glm::length(glm::vec3(GameObject.Transform[0])), glm::length(glm::vec3(GameObject.Transform[1])), glm::length(glm::vec3(GameObject.Transform[2])) });
+	float Radius = glm::length(Model.BoundsMax - Model.BoundsMin) * 0.5f * Scale;
+	float Distance = glm::length(Center - Engine::Camera::Camera.Eye) - Radius;
+
+	if (Distance <= 0.0f)
+	{
+		return 0;
+	}
+
+	/*
+		Pixels per world unit at that distance
+	*/
+
+	float PixelScale = (Vulkan::Renderer::SwapChainExtent.height * 0.5f) / (Distance * std::tan(glm::radians(Engine::Camera::FieldOfView) * 0.5f));
+
+	auto ProjectedError = [&](uint32_t Level)
+	{
+		return Lods[Level].Error * Scale * PixelScale;
+	};
+
+	uint32_t Lod = std::min<uint32_t>(GameObject.Lod, static_cast<uint32_t>(Lods.size() - 1));
+
+	while (Lod > 0 && ProjectedError(Lod) > Engine::GameObject::LodPixelError * (1.0f + Engine::GameObject::LodHysteresis))
+	{
+		Lod--;
+	}
+
+	while (Lod + 1 < Lods.size() && ProjectedError(Lod + 1) <= Engine::GameObject::LodPixelError * (1.0f - Engine::GameObject::LodHysteresis))
+	{
+		Lod++;
+	}
+
+	return Lod;
+}
+
+namespace
+{
+	Engine::Meshlets::Frustum GetViewFrustum()
+	{
+		float AspectRatio = Vulkan::Renderer::SwapChainExtent.width / (float)Vulkan::Renderer::SwapChainExtent.height;
+
+		return Engine::Meshlets::ExtractFrustum(Engine::Camera::GetProjectionMatrix(AspectRatio) * Engine::Camera::GetViewMatrix(), Engine::Camera::Camera.Eye);
+	}
+
+	bool UseDepthPrepass()
+	{
+		return Vulkan::Renderer::DepthPrepass && Vulkan::Renderer::Pipelines.DepthOnly != VK_NULL_HANDLE;
+	}
+}
+
+bool Engine::GameObject::UpdateLods()
 {
+	bool Changed = false;
+
 	for (auto& GameObject : Engine::GameObject::GameObjects)
 	{
-		vkCmdPushConstants(CommandBuffer, Vulkan::Renderer::PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &GameObject.Transform);
+		if (GameObject.Model == Engine::Models::Invalid || !Engine::Models::Get(GameObject.Model).Resident)
+		{
+			continue;
+		}
+
+		uint32_t Lod = Engine::GameObject::SelectLod(GameObject);
+
+		if (Lod != GameObject.Lod)
+		{
+			GameObject.Lod = Lod;
+			Changed = true;
+		}
+	}
+
+	return Changed;
+}
+
+void Engine::GameObject::BuildDrawList()
+{
+	Engine::GameObject::TrianglesFullDetail = 0;
+
+	Engine::GameObject::DrawList.clear();
+
+	for (uint32_t i = 0; i < Engine::GameObject::GameObjects.size(); i++)
+	{
+		auto& GameObject = Engine::GameObject::GameObjects[i];
+
+		if (GameObject.Model == Engine::Models::Invalid || !Engine::Models::Get(GameObject.Model).Resident)
+		{
+			continue;
+		}
+
+		const Engine::Model& Model = Engine::Models::Get(GameObject.Model);
+
+		GameObject.Lod = Engine::GameObject::SelectLod(GameObject);
+
+		uint32_t SubmeshCount = Model.GetSubmeshCount();
+		uint32_t Lod = std::min<uint32_t>(GameObject.Lod, static_cast<uint32_t>(Model.Lods.size()) - 1);
+
+		for (uint32_t Part = 0; Part < SubmeshCount; Part++)
+		{
+			uint32_t Index = Lod * SubmeshCount + Part;
+
+			Engine::GameObject::DrawList.push_back({ Model.Materials[Model.Submeshes[Index].Material], GameObject.Model, i, Index });
+		}
+
+		if (!Model.Lods.empty())
+		{
+			Engine::GameObject::TrianglesFullDetail += Model.Lods[0].IndexCount / 3;
+		}
+	}
+
+	std::sort(Engine::GameObject::DrawList.begin(), Engine::GameObject::DrawList.end(), [](const DrawItem& A, const DrawItem& B)
+	{
+		if (A.Material != B.Material)
+		{
+			return A.Material < B.Material;
+		}
+
+		return A.Model != B.Model ? A.Model < B.Model : A.Object < B.Object;
+	});
+}
+
+void Engine::GameObject::RecordDraws(VkCommandBuffer CommandBuffer, uint32_t Begin, uint32_t End, bool DepthOnly, const Engine::Meshlets::Frustum* View, Engine::GameObject::RecordStats& Stats)
+{
+	/*
+		Material changes rebind the descriptor set, model changes push the model's constants (the
+		geometry pool buffers are only rebound if it lives in another block) and object changes only
+		push a new transform. Every range starts with nothing bound, so a range recorded into its own
+		secondary is self contained.
+	*/
+
+	uint32_t BoundMaterial = UINT32_MAX;
+	uint32_t BoundModel = UINT32_MAX;
+	uint32_t BoundObject = UINT32_MAX;
+
+	Engine::GeometryPool::BindState Bound;
+
+	for (uint32_t i = Begin; i < End; i++)
+	{
+		const auto& Item = Engine::GameObject::DrawList[i];
+		auto& GameObject = Engine::GameObject::GameObjects[Item.Object];
+		auto& Model = Engine::Models::Get(Item.Model);
+
+		if (DepthOnly)
+		{
+			/*
+				Packed models are left to the main pass when their depth pipeline is missing
+			*/
+
+			if (Model.Format == Engine::Model::VertexFormat::Packed && Vulkan::Renderer::Pipelines.DepthOnlyPacked == VK_NULL_HANDLE)
+			{
+				continue;
+			}
+		}
+		else if (Item.Material != BoundMaterial)
+		{
+			Engine::Materials::Bind(CommandBuffer, Item.Material);
+
+			BoundMaterial = Item.Material;
+			Stats.MaterialBinds++;
+		}
+
+		if (Item.Model != BoundModel)
+		{
+			Model.Bind(CommandBuffer, &Bound, DepthOnly);
+
+			BoundModel = Item.Model;
+		}
+
+		if (Item.Object != BoundObject)
+		{
+			vkCmdPushConstants(CommandBuffer, Vulkan::Renderer::PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &GameObject.Transform);
+
+			BoundObject = Item.Object;
+		}
+
+		uint32_t Triangles = Model.Draw(CommandBuffer, Model.Submeshes[Item.Submesh], View, GameObject.Transform);
+
+		if (!DepthOnly)
+		{
+			Stats.Triangles += Triangles;
+		}
+	}
+
+	if (!DepthOnly)
+	{
+		Stats.BufferBinds += Bound.BufferBinds;
+	}
+}
+
+void Engine::GameObject::RenderGameObjects(VkCommandBuffer CommandBuffer, bool ViewIndependent)
+{
+	Engine::Meshlets::Frustum Frustum = GetViewFrustum();
+	const Engine::Meshlets::Frustum* View = ViewIndependent ? nullptr : &Frustum;
+
+	uint32_t Count = static_cast<uint32_t>(Engine::GameObject::DrawList.size());
+
+	/*
+		Depth prepass with the position-only pipelines, so the main pass only shades the nearest
+		surface
+	*/
+
+	Engine::GameObject::RecordStats Stats;
+
+	if (UseDepthPrepass())
+	{
+		Vulkan::GpuProfiler::Scope Section(CommandBuffer, "Depth prepass");
+
+		Engine::GameObject::RecordDraws(CommandBuffer, 0, Count, true, View, Stats);
+	}
+
+	{
+		Vulkan::GpuProfiler::Scope Section(CommandBuffer, "Main pass");
+
+		Engine::GameObject::RecordDraws(CommandBuffer, 0, Count, false, View, Stats);
+	}
+
+	Engine::GameObject::TrianglesSubmitted = Stats.Triangles;
+	Engine::GameObject::MaterialBinds = Stats.MaterialBinds;
+	Engine::GameObject::BufferBinds = Stats.BufferBinds;
+}
+
+void Engine::GameObject::RenderGameObjectsParallel(VkCommandBuffer CommandBuffer, const VkCommandBufferInheritanceInfo& Inheritance)
+{
+	Engine::Meshlets::Frustum Frustum = GetViewFrustum();
+
+	uint32_t Count = static_cast<uint32_t>(Engine::GameObject::DrawList.size());
+
+	/*
+		One stats slot per chunk so the threads never share a counter, summed once they have joined
+	*/
+
+	std::vector<Engine::GameObject::RecordStats> Stats(Vulkan::Recording::GetThreadCount());
+	std::vector<VkCommandBuffer> Secondaries;
+
+	/*
+		Timestamps can't go into the primary inside this render pass, a section begins in the pass's
+		first secondary and ends in its last. Ids are looked up here since the chunks run on other threads.
+	*/
+
+	uint32_t LastChunk = Vulkan::Recording::GetChunkCount(Count) - 1;
+
+	auto RecordPass = [&](bool DepthOnly)
+	{
+		uint32_t Section = Vulkan::GpuProfiler::GetSection(DepthOnly ? "Depth prepass" : "Main pass");
+
+		auto Buffers = Vulkan::Recording::Record(Inheritance, Count, [&](VkCommandBuffer Secondary, uint32_t Chunk, uint32_t Begin, uint32_t End)
+		{
+			if (Chunk == 0)
+			{
+				Vulkan::GpuProfiler::Begin(Secondary, Section);
+			}
+
+			Vulkan::Renderer::BindFrameState(Secondary);
+
+			Engine::GameObject::RecordDraws(Secondary, Begin, End, DepthOnly, &Frustum, Stats[Chunk]);
+
+			if (Chunk == LastChunk)
+			{
+				Vulkan::GpuProfiler::End(Secondary, Section);
+			}
+		});
+
+		Secondaries.insert(Secondaries.end(), Buffers.begin(), Buffers.end());
+	};
+
+	/*
+		Every depth chunk runs before the first main pass chunk, same as inline
+	*/
+
+	if (UseDepthPrepass())
+	{
+		RecordPass(true);
+	}
+
+	RecordPass(false);
+
+	vkCmdExecuteCommands(CommandBuffer, static_cast<uint32_t>(Secondaries.size()), Secondaries.data());
+
+	Engine::GameObject::TrianglesSubmitted = 0;
+	Engine::GameObject::MaterialBinds = 0;
+	Engine::GameObject::BufferBinds = 0;
+
+	for (const auto& Chunk : Stats)
+	{
+		Engine::GameObject::TrianglesSubmitted += Chunk.Triangles;
+		Engine::GameObject::MaterialBinds += Chunk.MaterialBinds;
+		Engine::GameObject::BufferBinds += Chunk.BufferBinds;
+	}
+}
+
+void Engine::GameObject::ReportStats()
+{
+	static auto LastReport = std::chrono::high_resolution_clock::now();
+	static uint64_t FramesSinceReport = 0;
+	static uint64_t SubmittedSinceReport = 0;
+	static uint64_t FullDetailSinceReport = 0;
+
+	/*
+		Average triangles per frame, reported once a second
+	*/
+
+	FramesSinceReport++;
+	SubmittedSinceReport += Engine::GameObject::TrianglesSubmitted;
+	FullDetailSinceReport += Engine::GameObject::TrianglesFullDetail;
+
+	auto Now = std::chrono::high_resolution_clock::now();
+
+	if (std::chrono::duration<float>(Now - LastReport).count() >= 1.0f)
+	{
+		std::cout << "LOD > Triangles per frame: " << SubmittedSinceReport / FramesSinceReport << " (" << FullDetailSinceReport / FramesSinceReport << " at full detail)" << std::endl;
+		std::cout << "MATERIAL > " << Engine::GameObject::DrawList.size() << " submesh draws, " << Engine::GameObject::MaterialBinds << " descriptor set binds, "
+			<< Engine::GameObject::BufferBinds << " geometry buffer binds per frame" << std::endl;
 
-		GameObject.Model.Render(CommandBuffer);
+		LastReport = Now;
+		FramesSinceReport = 0;
+		SubmittedSinceReport = 0;
+		FullDetailSinceReport = 0;
 	}
 }
 
@@ -3,7 +3,7 @@
 #ifndef GAMEOBJECT_H
 #define GAMEOBJECT_H
 
-#include "Model.h"
+#include "ModelRegistry.h"
 
 namespace Engine
 {
@@ -12,19 +12,60 @@ namespace Engine
 		public:
 			struct Object
 			{
-				Engine::Model Model;
+				/*
+					Index into Engine::Models, shared by every object using the same file
+				*/
+
+				uint32_t Model = Engine::Models::Invalid;
 				//glm::vec3 Model;
 				std::string ModelPath;
 				glm::vec3 Position;
 				glm::vec3 Rotation;
 				glm::vec3 Scale;
 				glm::mat4 Transform;
+				uint32_t Lod = 0;
 			};
 
 			static std::vector<Object> GameObjects;
 
+			/*
+				LOD selection, a level is used while its simplification error projects to at most
+				LodPixelError pixels. LodHysteresis widens the band around the current level so objects
+				near a threshold don't flicker between levels.
+			*/
+
+			static float LodPixelError;
+			static float LodHysteresis;
+
+			static uint64_t TrianglesSubmitted;
+			static uint64_t TrianglesFullDetail;
+
+			/*
+				One entry per visible submesh, sorted by material so each material's descriptor set is
+				bound once per frame, then by model so instances of one model share a buffer bind
+			*/
+
+			struct DrawItem
+			{
+				uint32_t Material;
+				uint32_t Model;
+				uint32_t Object;
+				uint32_t Submesh;
+			};
+
+			static std::vector<DrawItem> DrawList;
+			static uint32_t MaterialBinds;
+			static uint32_t BufferBinds;
+
 			Object CreateGameObject(std::string FilePath, glm::vec3 Position, glm::vec3 Scale);
 
+			/*
+				Adds the object straight away and streams its model in the background, it isn't drawn
+				until the model is resident. Returns the index into GameObjects.
+			*/
+
+			static uint32_t CreateGameObjectAsync(std::string FilePath, glm::vec3 Position, glm::vec3 Scale);
+
 			//static void SetGameObjectPosition(Object& GameObject, glm::vec3 Position);
 			//static void SetGameObjectRotation(Object& GameObject, float Radians, glm::vec3 RotationDirection);
 			//static void SetGameObjectScale(Object& GameObject, glm::vec3 Scale);
@@ -35,10 +76,42 @@ namespace Engine
 
 			static void CreateGameObjects();
 			static void RenderGameObject(Object GameObject);
-			static void RenderGameObjects(VkCommandBuffer CommandBuffer);
+			static uint32_t SelectLod(const Object& GameObject);
+
+			/*
+				LOD selection for every resident object, then the sort, once per frame before recording
+			*/
+
+			static void BuildDrawList();
+
+			/*
+				Reselects every object's LOD without recording, true if any changed
+			*/
+
+			static bool UpdateLods();
+
+			/*
+				Record DrawList inside the render pass, either inline or split across the recording
+				threads into secondaries that CommandBuffer executes. Both draw the same thing.
+				ViewIndependent skips meshlet culling, so the recording is valid from any viewpoint.
+			*/
+
+			static void RenderGameObjects(VkCommandBuffer CommandBuffer, bool ViewIndependent = false);
+			static void RenderGameObjectsParallel(VkCommandBuffer CommandBuffer, const VkCommandBufferInheritanceInfo& Inheritance);
+			static void ReportStats();
 
 			static Engine::GameObject::Object GetGameObject();
 
+		private:
+			struct RecordStats
+			{
+				uint64_t Triangles = 0;
+				uint32_t MaterialBinds = 0;
+				uint32_t BufferBinds = 0;
+			};
+
+			static void RecordDraws(VkCommandBuffer CommandBuffer, uint32_t Begin, uint32_t End, bool DepthOnly, const Engine::Meshlets::Frustum* View, RecordStats& Stats);
+
 	};
 }
 
@@ -0,0 +1,312 @@
+#include "../Common.h"
+#include "./API/Vulkan/Renderer.h"
+#include "GeometryPool.h"
+
+VkDeviceSize Engine::GeometryPool::BlockSize = 64 * 1024 * 1024;
+
+namespace
+{
+    struct FreeRange
+    {
+        uint32_t Offset;
+        uint32_t Count;
+    };
+
+    struct Block
+    {
+        std::array<VkBuffer, Engine::GeometryPool::MaxParts> Buffers{};
+        std::array<Vulkan::Allocator::Allocation, Engine::GeometryPool::MaxParts> Memory{};
+        uint32_t Capacity = 0;
+        uint32_t Used = 0;
+        std::vector<FreeRange> FreeList;
+    };
+
+    struct Pool
+    {
+        std::vector<Block> Blocks;
+    };
+
+    std::array<Pool, static_cast<size_t>(Engine::GeometryPool::Stream::Count)> Pools;
+
+    const char* StreamNames[] = { "vertices", "packed vertices", "indices" };
+
+    uint32_t GetStride(Engine::GeometryPool::Stream Type)
+    {
+        switch (Type)
+        {
+        case Engine::GeometryPool::Stream::Vertices:
+            return sizeof(Vulkan::Renderer::Vertex);
+        case Engine::GeometryPool::Stream::PackedVertices:
+            return sizeof(Vulkan::Renderer::PackedVertex);
+        default:
+            return sizeof(uint32_t);
+        }
+    }
+
+    bool IsLive(const Block& Candidate)
+    {
+        return Candidate.Buffers[0] != VK_NULL_HANDLE;
+    }
+
+    void DestroyBlock(Block& Target)
+    {
+        for (uint32_t Part = 0; Part < Engine::GeometryPool::MaxParts; Part++)
+        {
+            Vulkan::Allocator::DestroyBuffer(Target.Buffers[Part], Target.Memory[Part]);
+        }
+
+        Target = Block{};
+    }
+
+    void CreateBlock(Engine::GeometryPool::Stream Type, uint32_t Capacity, Block& Result)
+    {
+        VkBufferUsageFlags Usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        Usage |= Type == Engine::GeometryPool::Stream::Indices ? VK_BUFFER_USAGE_INDEX_BUFFER_BIT : VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+
+        for (uint32_t Part = 0; Part < Engine::GeometryPool::GetPartCount(Type); Part++)
+        {
+            Vulkan::Renderer::CreateBuffer(VkDeviceSize(Capacity) * Engine::GeometryPool::GetPartSize(Type, Part), Usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, Result.Buffers[Part], Result.Memory[Part], Vulkan::Allocator::Category::Geometry);
+        }
+
+        Result.Capacity = Capacity;
+        Result.Used = 0;
+        Result.FreeList.assign(1, { 0, Capacity });
+
+        std::cout << "GEOMETRY > New " << StreamNames[static_cast<size_t>(Type)] << " block, " << VkDeviceSize(Capacity) * GetStride(Type) / 1024 << " KB" << std::endl;
+    }
+
+    bool TryAllocate(Block& Target, uint32_t Count, uint32_t& Offset)
+    {
+        for (size_t i = 0; i < Target.FreeList.size(); i++)
+        {
+            FreeRange& Candidate = Target.FreeList[i];
+
+            if (Candidate.Count < Count)
+            {
+                continue;
+            }
+
+            Offset = Candidate.Offset;
+
+            Candidate.Offset += Count;
+            Candidate.Count -= Count;
+
+            if (Candidate.Count == 0)
+            {
+                Target.FreeList.erase(Target.FreeList.begin() + i);
+            }
+
+            Target.Used += Count;
+            return true;
+        }
+
+        return false;
+    }
+}
+
+uint32_t Engine::GeometryPool::GetPartCount(Engine::GeometryPool::Stream Type)
+{
+    return Type == Engine::GeometryPool::Stream::Indices ? 1 : 2;
+}
+
+uint32_t Engine::GeometryPool::GetPartOffset(Engine::GeometryPool::Stream Type, uint32_t Part)
+{
+    if (Part == 0)
+    {
+        return 0;
+    }
+
+    return Type == Engine::GeometryPool::Stream::PackedVertices ? Vulkan::Renderer::PackedVertex::AttributeOffset : Vulkan::Renderer::Vertex::AttributeOffset;
+}
+
+uint32_t Engine::GeometryPool::GetPartSize(Engine::GeometryPool::Stream Type, uint32_t Part)
+{
+    uint32_t End = Part + 1 < Engine::GeometryPool::GetPartCount(Type) ? Engine::GeometryPool::GetPartOffset(Type, Part + 1) : GetStride(Type);
+
+    return End - Engine::GeometryPool::GetPartOffset(Type, Part);
+}
+
+Engine::GeometryPool::Range Engine::GeometryPool::Allocate(Engine::GeometryPool::Stream Type, uint32_t Count)
+{
+    Engine::GeometryPool::Range Result;
+    Result.Type = Type;
+    Result.Count = Count;
+
+    if (Count == 0)
+    {
+        return Result;
+    }
+
+    Pool& Target = Pools[static_cast<size_t>(Type)];
+
+    for (uint32_t i = 0; i < Target.Blocks.size(); i++)
+    {
+        if (IsLive(Target.Blocks[i]) && TryAllocate(Target.Blocks[i], Count, Result.Offset))
+        {
+            Result.Block = i;
+            return Result;
+        }
+    }
+
+    /*
+        Nothing fits, reuse a released block slot or add a new one
+    */
+
+    uint32_t Capacity = std::max(Count, static_cast<uint32_t>(Engine::GeometryPool::BlockSize / GetStride(Type)));
+
+    auto Empty = std::find_if(Target.Blocks.begin(), Target.Blocks.end(), [](const Block& Candidate) { return !IsLive(Candidate); });
+
+    if (Empty == Target.Blocks.end())
+    {
+        Target.Blocks.emplace_back();
+        Empty = Target.Blocks.end() - 1;
+    }
+
+    CreateBlock(Type, Capacity, *Empty);
+
+    Result.Block = static_cast<uint32_t>(Empty - Target.Blocks.begin());
+    TryAllocate(*Empty, Count, Result.Offset);
+
+    return Result;
+}
+
+void Engine::GeometryPool::Free(Engine::GeometryPool::Range& Allocation)
+{
+    if (Allocation.Count == 0 || Allocation.Type == Engine::GeometryPool::Stream::Count)
+    {
+        return;
+    }
+
+    Pool& Target = Pools[static_cast<size_t>(Allocation.Type)];
+    Block& Owner = Target.Blocks[Allocation.Block];
+
+    /*
+        Insert sorted by offset and merge with the neighbours on either side
+    */
+
+    auto Next = std::lower_bound(Owner.FreeList.begin(), Owner.FreeList.end(), Allocation.Offset, [](const FreeRange& Range, uint32_t Offset) { return Range.Offset < Offset; });
+    auto Inserted = Owner.FreeList.insert(Next, { Allocation.Offset, Allocation.Count });
+
+    if (Inserted + 1 != Owner.FreeList.end() && Inserted->Offset + Inserted->Count == (Inserted + 1)->Offset)
+    {
+        Inserted->Count += (Inserted + 1)->Count;
+        Owner.FreeList.erase(Inserted + 1);
+    }
+
+    if (Inserted != Owner.FreeList.begin() && (Inserted - 1)->Offset + (Inserted - 1)->Count == Inserted->Offset)
+    {
+        (Inserted - 1)->Count += Inserted->Count;
+        Owner.FreeList.erase(Inserted);
+    }
+
+    Owner.Used -= Allocation.Count;
+
+    /*
+        Blocks past the first are given back once empty
+    */
+
+    if (Owner.Used == 0 && Allocation.Block > 0)
+    {
+        DestroyBlock(Owner);
+    }
+
+    Allocation = Engine::GeometryPool::Range{};
+}
+
+VkBuffer Engine::GeometryPool::GetBuffer(const Engine::GeometryPool::Range& Allocation, uint32_t Part)
+{
+    if (Allocation.Count == 0 || Allocation.Type == Engine::GeometryPool::Stream::Count)
+    {
+        return VK_NULL_HANDLE;
+    }
+
+    return Pools[static_cast<size_t>(Allocation.Type)].Blocks[Allocation.Block].Buffers[Part];
+}
+
+VkDeviceSize Engine::GeometryPool::GetByteOffset(const Engine::GeometryPool::Range& Allocation, uint32_t Part)
+{
+    return VkDeviceSize(Allocation.Offset) * Engine::GeometryPool::GetPartSize(Allocation.Type, Part);
+}
+
+VkDeviceSize Engine::GeometryPool::GetByteSize(const Engine::GeometryPool::Range& Allocation)
+{
+    return VkDeviceSize(Allocation.Count) * GetStride(Allocation.Type);
+}
+
+void Engine::GeometryPool::Bind(VkCommandBuffer CommandBuffer, const Engine::GeometryPool::Range& Vertices, const Engine::GeometryPool::Range& Indices, Engine::GeometryPool::BindState* State, bool PositionOnly)
+{
+    VkBuffer VertexBuffer = Engine::GeometryPool::GetBuffer(Vertices, 0);
+    VkBuffer AttributeBuffer = PositionOnly ? VK_NULL_HANDLE : Engine::GeometryPool::GetBuffer(Vertices, 1);
+    VkBuffer IndexBuffer = Engine::GeometryPool::GetBuffer(Indices);
+
+    /*
+        Both parts live in the same block, so they only ever change together
+    */
+
+    if (State == nullptr || State->VertexBuffer != VertexBuffer || State->AttributeBuffer != AttributeBuffer)
+    {
+        VkBuffer Buffers[] = { VertexBuffer, AttributeBuffer };
+        VkDeviceSize Offsets[] = { 0, 0 };
+
+        vkCmdBindVertexBuffers(CommandBuffer, 0, PositionOnly ? 1 : 2, Buffers, Offsets);
+    }
+
+    if (State == nullptr || State->IndexBuffer != IndexBuffer)
+    {
+        vkCmdBindIndexBuffer(CommandBuffer, IndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+    }
+
+    if (State != nullptr)
+    {
+        State->BufferBinds += (State->VertexBuffer != VertexBuffer || State->AttributeBuffer != AttributeBuffer) + (State->IndexBuffer != IndexBuffer);
+        State->VertexBuffer = VertexBuffer;
+        State->AttributeBuffer = AttributeBuffer;
+        State->IndexBuffer = IndexBuffer;
+    }
+}
+
+void Engine::GeometryPool::PrintStats()
+{
+    for (size_t i = 0; i < Pools.size(); i++)
+    {
+        uint32_t Blocks = 0;
+        uint64_t Capacity = 0;
+        uint64_t Used = 0;
+        size_t FreeRanges = 0;
+
+        for (const auto& Entry : Pools[i].Blocks)
+        {
+            if (!IsLive(Entry))
+            {
+                continue;
+            }
+
+            Blocks++;
+            Capacity += Entry.Capacity;
+            Used += Entry.Used;
+            FreeRanges += Entry.FreeList.size();
+        }
+
+        if (Blocks == 0)
+        {
+            continue;
+        }
+
+        uint32_t Stride = GetStride(static_cast<Engine::GeometryPool::Stream>(i));
+
+        std::cout << "GEOMETRY > " << StreamNames[i] << ": " << Blocks << " blocks, " << Used * Stride / 1024 << " / " << Capacity * Stride / 1024 << " KB used, " << FreeRanges << " free ranges" << std::endl;
+    }
+}
+
+void Engine::GeometryPool::Destroy()
+{
+    for (auto& Target : Pools)
+    {
+        for (auto& Entry : Target.Blocks)
+        {
+            DestroyBlock(Entry);
+        }
+
+        Target.Blocks.clear();
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#ifndef GEOMETRYPOOL_H
+#define GEOMETRYPOOL_H
+
+namespace Engine
+{
+	/*
+		Shared device local vertex and index buffers. Models get a range of elements out of a large
+		block instead of their own VkBuffer pair, so every model in a block is drawn with the same
+		bound buffers through vertexOffset and firstIndex. Each block keeps a free list sorted by
+		offset, freed ranges are merged with their neighbours and reused first fit.
+	*/
+
+	namespace GeometryPool
+	{
+		/*
+			One pool per element layout, the stride of a pool's buffers is fixed
+		*/
+
+		enum class Stream : uint32_t { Vertices, PackedVertices, Indices, Count };
+
+		struct Range
+		{
+			Stream Type = Stream::Count;
+			uint32_t Block = 0;
+			uint32_t Offset = 0;
+			uint32_t Count = 0;
+		};
+
+		/*
+			Tracks what a command buffer has bound so far, reset it at the start of each recording
+		*/
+
+		struct BindState
+		{
+			VkPipeline Pipeline = VK_NULL_HANDLE;
+			VkBuffer VertexBuffer = VK_NULL_HANDLE;
+			VkBuffer AttributeBuffer = VK_NULL_HANDLE;
+			VkBuffer IndexBuffer = VK_NULL_HANDLE;
+			uint32_t BufferBinds = 0;
+		};
+
+		/*
+			Vertex streams are stored deinterleaved, every block has one buffer per part (positions,
+			then the remaining attributes) and the parts share element offsets, so a single vertexOffset
+			addresses all bindings. A part is a byte range of the interleaved element, uploads split
+			elements along these ranges. Index streams have a single part.
+		*/
+
+		const uint32_t MaxParts = 2;
+
+		uint32_t GetPartCount(Stream Type);
+		uint32_t GetPartOffset(Stream Type, uint32_t Part);
+		uint32_t GetPartSize(Stream Type, uint32_t Part);
+
+		/*
+			Size of a newly created block, a single larger allocation gets a block of its own size
+		*/
+
+		extern VkDeviceSize BlockSize;
+
+		Range Allocate(Stream Type, uint32_t Count);
+		void Free(Range& Allocation);
+
+		VkBuffer GetBuffer(const Range& Allocation, uint32_t Part = 0);
+		VkDeviceSize GetByteOffset(const Range& Allocation, uint32_t Part = 0);
+
+		/*
+			Total over all parts
+		*/
+
+		VkDeviceSize GetByteSize(const Range& Allocation);
+
+		/*
+			PositionOnly binds just the first part, for pipelines that read nothing but positions
+		*/
+
+		void Bind(VkCommandBuffer CommandBuffer, const Range& Vertices, const Range& Indices, BindState* State = nullptr, bool PositionOnly = false);
+
+		void PrintStats();
+		void Destroy();
+	}
+}
+
+#endif
@@ -0,0 +1,1347 @@
+#include "../Common.h"
+#include "./API/Vulkan/Renderer.h"
+#include "GltfParser.h"
+#include "FileSystem/FileSystem.h"
+
+#include <filesystem>
+#include <sstream>
+#include <iomanip>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    const uint32_t GlbMagic = 0x46546C67; // "glTF"
+    const uint32_t GlbChunkJson = 0x4E4F534A; // "JSON"
+    const uint32_t GlbChunkBin = 0x004E4942; // "BIN\0"
+
+    const uint32_t ComponentByte = 5120;
+    const uint32_t ComponentUnsignedByte = 5121;
+    const uint32_t ComponentShort = 5122;
+    const uint32_t ComponentUnsignedShort = 5123;
+    const uint32_t ComponentUnsignedInt = 5125;
+    const uint32_t ComponentFloat = 5126;
+
+    const int MaxDepth = 64;
+
+    /*
+        Just enough JSON for glTF documents
+    */
+
+    struct JsonValue
+    {
+        enum class Type { Null, Boolean, Number, String, Array, Object };
+
+        Type Kind = Type::Null;
+        bool Boolean = false;
+        double Number = 0.0;
+        std::string String;
+        std::vector<JsonValue> Items;
+        std::vector<std::pair<std::string, JsonValue>> Members;
+
+        const JsonValue* Find(const char* Key) const
+        {
+            if (Kind != Type::Object)
+            {
+                return nullptr;
+            }
+
+            for (const auto& Member : Members)
+            {
+                if (Member.first == Key)
+                {
+                    return &Member.second;
+                }
+            }
+
+            return nullptr;
+        }
+
+        const JsonValue* At(size_t Index) const
+        {
+            return Kind == Type::Array && Index < Items.size() ? &Items[Index] : nullptr;
+        }
+
+        size_t Size() const
+        {
+            return Kind == Type::Array ? Items.size() : 0;
+        }
+
+        double GetNumber(const char* Key, double Default) const
+        {
+            const JsonValue* Value = Find(Key);
+
+            return Value != nullptr && Value->Kind == Type::Number ? Value->Number : Default;
+        }
+
+        int GetInt(const char* Key, int Default) const
+        {
+            return static_cast<int>(GetNumber(Key, Default));
+        }
+
+        std::string GetString(const char* Key) const
+        {
+            const JsonValue* Value = Find(Key);
+
+            return Value != nullptr && Value->Kind == Type::String ? Value->String : "";
+        }
+    };
+
+    class JsonReader
+    {
+    public:
+        JsonReader(const char* Begin, const char* End) : Position(Begin), End(End) {}
+
+        bool Parse(JsonValue& Result, std::string& Error)
+        {
+            if (!ParseValue(Result, 0))
+            {
+                Error = "GLTF > Invalid JSON: " + Problem;
+                return false;
+            }
+
+            return true;
+        }
+
+    private:
+        const char* Position;
+        const char* End;
+        std::string Problem;
+
+        void SkipWhitespace()
+        {
+            while (Position < End && (*Position == ' ' || *Position == '\t' || *Position == '\n' || *Position == '\r'))
+            {
+                Position++;
+            }
+        }
+
+        bool Fail(const char* Message)
+        {
+            if (Problem.empty())
+            {
+                Problem = Message;
+            }
+
+            return false;
+        }
+
+        bool Match(const char* Literal)
+        {
+            size_t Length = strlen(Literal);
+
+            if (static_cast<size_t>(End - Position) < Length || strncmp(Position, Literal, Length) != 0)
+            {
+                return false;
+            }
+
+            Position += Length;
+            return true;
+        }
+
+        bool ParseValue(JsonValue& Result, int Depth)
+        {
+            if (Depth > MaxDepth)
+            {
+                return Fail("nesting too deep");
+            }
+
+            SkipWhitespace();
+
+            if (Position >= End)
+            {
+                return Fail("unexpected end of input");
+            }
+
+            switch (*Position)
+            {
+            case '{':
+                return ParseObject(Result, Depth);
+            case '[':
+                return ParseArray(Result, Depth);
+            case '"':
+                Result.Kind = JsonValue::Type::String;
+                return ParseString(Result.String);
+            case 't':
+                Result.Kind = JsonValue::Type::Boolean;
+                Result.Boolean = true;
+                return Match("true") || Fail("bad literal");
+            case 'f':
+                Result.Kind = JsonValue::Type::Boolean;
+                Result.Boolean = false;
+                return Match("false") || Fail("bad literal");
+            case 'n':
+                Result.Kind = JsonValue::Type::Null;
+                return Match("null") || Fail("bad literal");
+            default:
+                return ParseNumber(Result);
+            }
+        }
+
+        bool ParseObject(JsonValue& Result, int Depth)
+        {
+            Result.Kind = JsonValue::Type::Object;
+            Position++;
+
+            SkipWhitespace();
+
+            if (Position < End && *Position == '}')
+            {
+                Position++;
+                return true;
+            }
+
+            for (;;)
+            {
+                SkipWhitespace();
+
+                std::string Key;
+
+                if (Position >= End || *Position != '"' || !ParseString(Key))
+                {
+                    return Fail("expected object key");
+                }
+
+                SkipWhitespace();
+
+                if (Position >= End || *Position != ':')
+                {
+                    return Fail("expected ':'");
+                }
+
+                Position++;
+
+                Result.Members.emplace_back(std::move(Key), JsonValue{});
+
+                if (!ParseValue(Result.Members.back().second, Depth + 1))
+                {
+                    return false;
+                }
+
+                SkipWhitespace();
+
+                if (Position < End && *Position == ',')
+                {
+                    Position++;
+                    continue;
+                }
+
+                if (Position < End && *Position == '}')
+                {
+                    Position++;
+                    return true;
+                }
+
+                return Fail("expected ',' or '}'");
+            }
+        }
+
+        bool ParseArray(JsonValue& Result, int Depth)
+        {
+            Result.Kind = JsonValue::Type::Array;
+            Position++;
+
+            SkipWhitespace();
+
+            if (Position < End && *Position == ']')
+            {
+                Position++;
+                return true;
+            }
+
+            for (;;)
+            {
+                Result.Items.emplace_back();
+
+                if (!ParseValue(Result.Items.back(), Depth + 1))
+                {
+                    return false;
+                }
+
+                SkipWhitespace();
+
+                if (Position < End && *Position == ',')
+                {
+                    Position++;
+                    continue;
+                }
+
+                if (Position < End && *Position == ']')
+                {
+                    Position++;
+                    return true;
+                }
+
+                return Fail("expected ',' or ']'");
+            }
+        }
+
+        static void AppendUtf8(std::string& Result, uint32_t CodePoint)
+        {
+            if (CodePoint < 0x80)
+            {
+                Result.push_back(static_cast<char>(CodePoint));
+            }
+            else if (CodePoint < 0x800)
+            {
+                Result.push_back(static_cast<char>(0xC0 | (CodePoint >> 6)));
+                Result.push_back(static_cast<char>(0x80 | (CodePoint & 0x3F)));
+            }
+            else if (CodePoint < 0x10000)
+            {
+                Result.push_back(static_cast<char>(0xE0 | (CodePoint >> 12)));
+                Result.push_back(static_cast<char>(0x80 | ((CodePoint >> 6) & 0x3F)));
+                Result.push_back(static_cast<char>(0x80 | (CodePoint & 0x3F)));
+            }
+            else
+            {
+                Result.push_back(static_cast<char>(0xF0 | (CodePoint >> 18)));
+                Result.push_back(static_cast<char>(0x80 | ((CodePoint >> 12) & 0x3F)));
+                Result.push_back(static_cast<char>(0x80 | ((CodePoint >> 6) & 0x3F)));
+                Result.push_back(static_cast<char>(0x80 | (CodePoint & 0x3F)));
+            }
+        }
+
+        bool ParseHex4(uint32_t& Result)
+        {
+            if (End - Position < 4)
+            {
+                return Fail("truncated escape");
+            }
+
+            Result = 0;
+
+            for (int i = 0; i < 4; i++)
+            {
+                char c = *Position++;
+                Result <<= 4;
+
+                if (c >= '0' && c <= '9') Result |= c - '0';
+                else if (c >= 'a' && c <= 'f') Result |= c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') Result |= c - 'A' + 10;
+                else return Fail("bad escape");
+            }
+
+            return true;
+        }
+
+        bool ParseString(std::string& Result)
+        {
+            Position++;
+
+            while (Position < End && *Position != '"')
+            {
+                if (*Position != '\\')
+                {
+                    Result.push_back(*Position++);
+                    continue;
+                }
+
+                if (++Position >= End)
+                {
+                    break;
+                }
+
+                char Escape = *Position++;
+
+                switch (Escape)
+                {
+                case '"': Result.push_back('"'); break;
+                case '\\': Result.push_back('\\'); break;
+                case '/': Result.push_back('/'); break;
+                case 'b': Result.push_back('\b'); break;
+                case 'f': Result.push_back('\f'); break;
+                case 'n': Result.push_back('\n'); break;
+                case 'r': Result.push_back('\r'); break;
+                case 't': Result.push_back('\t'); break;
+                case 'u':
+                {
+                    uint32_t CodePoint;
+
+                    if (!ParseHex4(CodePoint))
+                    {
+                        return false;
+                    }
+
+                    if (CodePoint >= 0xD800 && CodePoint < 0xDC00 && Match("\\u"))
+                    {
+                        uint32_t Low;
+
+                        if (!ParseHex4(Low))
+                        {
+                            return false;
+                        }
+
+                        CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + (Low - 0xDC00);
+                    }
+
+                    AppendUtf8(Result, CodePoint);
+                    break;
+                }
+                default:
+                    return Fail("bad escape");
+                }
+            }
+
+            if (Position >= End)
+            {
+                return Fail("unterminated string");
+            }
+
+            Position++;
+            return true;
+        }
+
+        bool ParseNumber(JsonValue& Result)
+        {
+            const char* Start = Position;
+
+            while (Position < End && (isdigit(static_cast<unsigned char>(*Position)) || *Position == '-' || *Position == '+' || *Position == '.' || *Position == 'e' || *Position == 'E'))
+            {
+                Position++;
+            }
+
+            if (Position == Start)
+            {
+                return Fail("unexpected character");
+            }
+
+            std::string Text(Start, Position);
+            char* Parsed = nullptr;
+
+            Result.Kind = JsonValue::Type::Number;
+            Result.Number = strtod(Text.c_str(), &Parsed);
+
+            return (Parsed == Text.c_str() + Text.size()) || Fail("bad number");
+        }
+    };
+
+    struct Buffer
+    {
+        const uint8_t* Data = nullptr;
+        size_t Size = 0;
+    };
+
+    struct Document
+    {
+        JsonValue Root;
+        std::vector<Buffer> Buffers;
+        std::vector<FileSystem::MappedFile> Files;
+        fs::path Directory;
+    };
+
+    struct Accessor
+    {
+        const uint8_t* Data = nullptr;
+        uint32_t Count = 0;
+        uint32_t Stride = 0;
+        uint32_t ComponentType = 0;
+        uint32_t Components = 0;
+        uint32_t ElementSize = 0;
+        bool Normalized = false;
+        int BufferView = -1;
+    };
+
+    uint32_t GetComponentSize(uint32_t ComponentType)
+    {
+        switch (ComponentType)
+        {
+        case ComponentByte:
+        case ComponentUnsignedByte:
+            return 1;
+        case ComponentShort:
+        case ComponentUnsignedShort:
+            return 2;
+        case ComponentUnsignedInt:
+        case ComponentFloat:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    uint32_t GetComponentCount(const std::string& Type)
+    {
+        if (Type == "SCALAR") return 1;
+        if (Type == "VEC2") return 2;
+        if (Type == "VEC3") return 3;
+        if (Type == "VEC4") return 4;
+        if (Type == "MAT2") return 4;
+        if (Type == "MAT3") return 9;
+        if (Type == "MAT4") return 16;
+
+        return 0;
+    }
+
+    bool ReadAccessor(const Document& Doc, int Index, Accessor& Result, std::string& Error)
+    {
+        const JsonValue* Accessors = Doc.Root.Find("accessors");
+        const JsonValue* Info = Accessors != nullptr ? Accessors->At(Index) : nullptr;
+
+        if (Info == nullptr)
+        {
+            Error = "GLTF > Accessor " + std::to_string(Index) + " does not exist";
+            return false;
+        }
+
+        if (Info->Find("sparse") != nullptr)
+        {
+            Error = "GLTF > Sparse accessors are not supported";
+            return false;
+        }
+
+        Result.Count = static_cast<uint32_t>(Info->GetNumber("count", 0));
+        Result.ComponentType = static_cast<uint32_t>(Info->GetInt("componentType", 0));
+        Result.Components = GetComponentCount(Info->GetString("type"));
+        Result.ElementSize = GetComponentSize(Result.ComponentType) * Result.Components;
+        Result.Normalized = Info->Find("normalized") != nullptr && Info->Find("normalized")->Boolean;
+        Result.BufferView = Info->GetInt("bufferView", -1);
+
+        if (Result.ElementSize == 0)
+        {
+            Error = "GLTF > Accessor " + std::to_string(Index) + " has an unknown type";
+            return false;
+        }
+
+        const JsonValue* Views = Doc.Root.Find("bufferViews");
+        const JsonValue* View = Views != nullptr ? Views->At(Result.BufferView) : nullptr;
+
+        if (View == nullptr)
+        {
+            Error = "GLTF > Accessors without a buffer view are not supported";
+            return false;
+        }
+
+        int BufferIndex = View->GetInt("buffer", -1);
+
+        if (BufferIndex < 0 || BufferIndex >= static_cast<int>(Doc.Buffers.size()) || Doc.Buffers[BufferIndex].Data == nullptr)
+        {
+            Error = "GLTF > Buffer view references a missing buffer";
+            return false;
+        }
+
+        const Buffer& Source = Doc.Buffers[BufferIndex];
+
+        uint64_t ViewOffset = static_cast<uint64_t>(View->GetNumber("byteOffset", 0));
+        uint64_t ViewLength = static_cast<uint64_t>(View->GetNumber("byteLength", 0));
+        uint64_t Offset = static_cast<uint64_t>(Info->GetNumber("byteOffset", 0));
+
+        Result.Stride = static_cast<uint32_t>(View->GetInt("byteStride", 0));
+
+        if (Result.Stride == 0)
+        {
+            Result.Stride = Result.ElementSize;
+        }
+
+        uint64_t Required = Result.Count == 0 ? 0 : Offset + uint64_t(Result.Stride) * (Result.Count - 1) + Result.ElementSize;
+
+        if (ViewOffset + ViewLength > Source.Size || Required > ViewLength)
+        {
+            Error = "GLTF > Accessor " + std::to_string(Index) + " reads past the end of its buffer";
+            return false;
+        }
+
+        Result.Data = Source.Data + ViewOffset + Offset;
+
+        return true;
+    }
+
+    float ReadComponent(const Accessor& Source, uint32_t Element, uint32_t Component)
+    {
+        const uint8_t* Data = Source.Data + size_t(Source.Stride) * Element;
+
+        switch (Source.ComponentType)
+        {
+        case ComponentFloat:
+        {
+            float Value;
+            memcpy(&Value, Data + Component * 4, 4);
+            return Value;
+        }
+        case ComponentUnsignedByte:
+        {
+            uint8_t Value = Data[Component];
+            return Source.Normalized ? Value / 255.0f : Value;
+        }
+        case ComponentByte:
+        {
+            int8_t Value = static_cast<int8_t>(Data[Component]);
+            return Source.Normalized ? std::max(Value / 127.0f, -1.0f) : Value;
+        }
+        case ComponentUnsignedShort:
+        {
+            uint16_t Value;
+            memcpy(&Value, Data + Component * 2, 2);
+            return Source.Normalized ? Value / 65535.0f : Value;
+        }
+        case ComponentShort:
+        {
+            int16_t Value;
+            memcpy(&Value, Data + Component * 2, 2);
+            return Source.Normalized ? std::max(Value / 32767.0f, -1.0f) : Value;
+        }
+        case ComponentUnsignedInt:
+        {
+            uint32_t Value;
+            memcpy(&Value, Data + Component * 4, 4);
+            return static_cast<float>(Value);
+        }
+        default:
+            return 0.0f;
+        }
+    }
+
+    uint32_t ReadIndex(const Accessor& Source, uint32_t Element)
+    {
+        const uint8_t* Data = Source.Data + size_t(Source.Stride) * Element;
+
+        switch (Source.ComponentType)
+        {
+        case ComponentUnsignedByte:
+            return Data[0];
+        case ComponentUnsignedShort:
+        {
+            uint16_t Value;
+            memcpy(&Value, Data, 2);
+            return Value;
+        }
+        default:
+        {
+            uint32_t Value;
+            memcpy(&Value, Data, 4);
+            return Value;
+        }
+        }
+    }
+
+    bool IsIdentity(const glm::mat4& Matrix)
+    {
+        for (int Column = 0; Column < 4; Column++)
+        {
+            for (int Row = 0; Row < 4; Row++)
+            {
+                if (Matrix[Column][Row] != (Column == Row ? 1.0f : 0.0f))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    glm::mat4 GetNodeTransform(const JsonValue& Node)
+    {
+        glm::mat4 Result(1.0f);
+
+        const JsonValue* Matrix = Node.Find("matrix");
+
+        if (Matrix != nullptr && Matrix->Size() == 16)
+        {
+            for (int i = 0; i < 16; i++)
+            {
+                Result[i / 4][i % 4] = static_cast<float>(Matrix->Items[i].Number);
+            }
+
+            return Result;
+        }
+
+        /*
+            T * R * S, rotation is a unit quaternion stored x, y, z, w
+        */
+
+        float T[3] = { 0.0f, 0.0f, 0.0f };
+        float R[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        float S[3] = { 1.0f, 1.0f, 1.0f };
+
+        auto ReadArray = [&](const char* Key, float* Values, size_t Count)
+        {
+            const JsonValue* Array = Node.Find(Key);
+
+            if (Array != nullptr && Array->Size() == Count)
+            {
+                for (size_t i = 0; i < Count; i++)
+                {
+                    Values[i] = static_cast<float>(Array->Items[i].Number);
+                }
+            }
+        };
+
+        ReadArray("translation", T, 3);
+        ReadArray("rotation", R, 4);
+        ReadArray("scale", S, 3);
+
+        float X = R[0], Y = R[1], Z = R[2], W = R[3];
+
+        Result[0][0] = (1.0f - 2.0f * (Y * Y + Z * Z)) * S[0];
+        Result[0][1] = (2.0f * (X * Y + W * Z)) * S[0];
+        Result[0][2] = (2.0f * (X * Z - W * Y)) * S[0];
+
+        Result[1][0] = (2.0f * (X * Y - W * Z)) * S[1];
+        Result[1][1] = (1.0f - 2.0f * (X * X + Z * Z)) * S[1];
+        Result[1][2] = (2.0f * (Y * Z + W * X)) * S[1];
+
+        Result[2][0] = (2.0f * (X * Z + W * Y)) * S[2];
+        Result[2][1] = (2.0f * (Y * Z - W * X)) * S[2];
+        Result[2][2] = (1.0f - 2.0f * (X * X + Y * Y)) * S[2];
+
+        Result[3][0] = T[0];
+        Result[3][1] = T[1];
+        Result[3][2] = T[2];
+
+        return Result;
+    }
+
+    bool LoadPrimitive(const Document& Doc, const JsonValue& Primitive, const glm::mat4& Transform, Engine::GltfParser::Mesh& Result, std::string& Error)
+    {
+        if (Primitive.GetInt("mode", 4) != 4)
+        {
+            std::cout << "GLTF > Skipping non triangle list primitive" << std::endl;
+            return true;
+        }
+
+        const JsonValue* Attributes = Primitive.Find("attributes");
+
+        if (Attributes == nullptr || Attributes->Find("POSITION") == nullptr)
+        {
+            std::cout << "GLTF > Skipping primitive without positions" << std::endl;
+            return true;
+        }
+
+        Accessor Position;
+        Accessor Normal;
+        Accessor Color;
+        Accessor Texcoord;
+
+        if (!ReadAccessor(Doc, Attributes->GetInt("POSITION", -1), Position, Error))
+        {
+            return false;
+        }
+
+        auto ReadOptional = [&](const char* Name, Accessor& Target)
+        {
+            if (Attributes->Find(Name) == nullptr)
+            {
+                return true;
+            }
+
+            if (!ReadAccessor(Doc, Attributes->GetInt(Name, -1), Target, Error))
+            {
+                return false;
+            }
+
+            if (Target.Count != Position.Count)
+            {
+                Error = std::string("GLTF > ") + Name + " count doesn't match POSITION";
+                return false;
+            }
+
+            return true;
+        };
+
+        if (!ReadOptional("NORMAL", Normal) || !ReadOptional("COLOR_0", Color) || !ReadOptional("TEXCOORD_0", Texcoord))
+        {
+            return false;
+        }
+
+        if (Position.ComponentType != ComponentFloat || Position.Components != 3)
+        {
+            Error = "GLTF > POSITION must be float VEC3";
+            return false;
+        }
+
+        bool Identity = IsIdentity(Transform);
+
+        size_t Base = Result.Vertices.size();
+        Result.Vertices.resize(Base + Position.Count);
+
+        Vulkan::Renderer::Vertex* Vertices = Result.Vertices.data() + Base;
+
+        /*
+            An interleaved view already in the Vertex layout is copied as one block
+        */
+
+        bool MatchesLayout = Identity &&
+            Position.Stride == sizeof(Vulkan::Renderer::Vertex) &&
+            Color.Data == Position.Data + offsetof(Vulkan::Renderer::Vertex, Color) && Color.ComponentType == ComponentFloat && Color.Components == 3 &&
+            Normal.Data == Position.Data + offsetof(Vulkan::Renderer::Vertex, Normal) && Normal.ComponentType == ComponentFloat && Normal.Components == 3 &&
+            Texcoord.Data == Position.Data + offsetof(Vulkan::Renderer::Vertex, UV) && Texcoord.ComponentType == ComponentFloat && Texcoord.Components == 2 &&
+            Color.Stride == Position.Stride && Normal.Stride == Position.Stride && Texcoord.Stride == Position.Stride;
+
+        if (MatchesLayout)
+        {
+            memcpy(Vertices, Position.Data, size_t(Position.Count) * sizeof(Vulkan::Renderer::Vertex));
+            Result.BlockCopies++;
+        }
+        else
+        {
+            for (uint32_t i = 0; i < Position.Count; i++)
+            {
+                memcpy(&Vertices[i].Pos, Position.Data + size_t(Position.Stride) * i, sizeof(glm::vec3));
+                Vertices[i].Color = glm::vec3(1.0f);
+                Vertices[i].Normal = glm::vec3(0.0f);
+                Vertices[i].UV = glm::vec2(0.0f);
+            }
+
+            if (Color.Data != nullptr)
+            {
+                for (uint32_t i = 0; i < Color.Count; i++)
+                {
+                    Vertices[i].Color = glm::vec3(ReadComponent(Color, i, 0), ReadComponent(Color, i, 1), ReadComponent(Color, i, 2));
+                }
+            }
+
+            if (Normal.Data != nullptr)
+            {
+                for (uint32_t i = 0; i < Normal.Count; i++)
+                {
+                    Vertices[i].Normal = glm::vec3(ReadComponent(Normal, i, 0), ReadComponent(Normal, i, 1), ReadComponent(Normal, i, 2));
+                }
+            }
+
+            if (Texcoord.Data != nullptr)
+            {
+                for (uint32_t i = 0; i < Texcoord.Count; i++)
+                {
+                    Vertices[i].UV = glm::vec2(ReadComponent(Texcoord, i, 0), ReadComponent(Texcoord, i, 1));
+                }
+            }
+
+            Result.ElementCopies++;
+        }
+
+        /*
+            Normals go through the cofactor matrix, which is the inverse transpose scaled by the determinant
+        */
+
+        float Determinant = 1.0f;
+
+        if (!Identity)
+        {
+            glm::vec3 A = glm::vec3(Transform[0]);
+            glm::vec3 B = glm::vec3(Transform[1]);
+            glm::vec3 C = glm::vec3(Transform[2]);
+
+            glm::vec3 CofactorX = glm::cross(B, C);
+            glm::vec3 CofactorY = glm::cross(C, A);
+            glm::vec3 CofactorZ = glm::cross(A, B);
+
+            Determinant = glm::dot(A, CofactorX);
+
+            float Sign = Determinant < 0.0f ? -1.0f : 1.0f;
+
+            for (uint32_t i = 0; i < Position.Count; i++)
+            {
+                Vertices[i].Pos = glm::vec3(Transform * glm::vec4(Vertices[i].Pos, 1.0f));
+
+                glm::vec3 N = Vertices[i].Normal;
+                glm::vec3 Transformed = (CofactorX * N.x + CofactorY * N.y + CofactorZ * N.z) * Sign;
+                float Length = glm::length(Transformed);
+
+                Vertices[i].Normal = Length > 0.0f ? Transformed / Length : Transformed;
+            }
+        }
+
+        /*
+            Indices, mirrored transforms flip the winding
+        */
+
+        size_t FirstIndex = Result.Indices.size();
+        uint32_t IndexCount = Position.Count;
+
+        if (Primitive.Find("indices") != nullptr)
+        {
+            Accessor Indices;
+
+            if (!ReadAccessor(Doc, Primitive.GetInt("indices", -1), Indices, Error))
+            {
+                return false;
+            }
+
+            if (Indices.Components != 1 || (Indices.ComponentType != ComponentUnsignedByte && Indices.ComponentType != ComponentUnsignedShort && Indices.ComponentType != ComponentUnsignedInt))
+            {
+                Error = "GLTF > Indices must be unsigned scalars";
+                return false;
+            }
+
+            IndexCount = Indices.Count / 3 * 3;
+            Result.Indices.resize(FirstIndex + IndexCount);
+
+            uint32_t* Target = Result.Indices.data() + FirstIndex;
+
+            if (Indices.ComponentType == ComponentUnsignedInt && Indices.Stride == 4)
+            {
+                memcpy(Target, Indices.Data, size_t(IndexCount) * 4);
+                Result.BlockCopies++;
+            }
+            else
+            {
+                for (uint32_t i = 0; i < IndexCount; i++)
+                {
+                    Target[i] = ReadIndex(Indices, i);
+                }
+
+                Result.ElementCopies++;
+            }
+
+            for (uint32_t i = 0; i < IndexCount; i++)
+            {
+                if (Target[i] >= Position.Count)
+                {
+                    Error = "GLTF > Index out of range";
+                    return false;
+                }
+
+                Target[i] += static_cast<uint32_t>(Base);
+            }
+        }
+        else
+        {
+            IndexCount = Position.Count / 3 * 3;
+            Result.Indices.resize(FirstIndex + IndexCount);
+
+            for (uint32_t i = 0; i < IndexCount; i++)
+            {
+                Result.Indices[FirstIndex + i] = static_cast<uint32_t>(Base) + i;
+            }
+        }
+
+        if (Determinant < 0.0f)
+        {
+            for (size_t i = FirstIndex; i < Result.Indices.size(); i += 3)
+            {
+                std::swap(Result.Indices[i + 1], Result.Indices[i + 2]);
+            }
+        }
+
+        Result.MaterialIds.insert(Result.MaterialIds.end(), IndexCount / 3, Primitive.GetInt("material", -1));
+
+        return true;
+    }
+
+    bool LoadMesh(const Document& Doc, int MeshIndex, const glm::mat4& Transform, Engine::GltfParser::Mesh& Result, std::string& Error)
+    {
+        const JsonValue* Meshes = Doc.Root.Find("meshes");
+        const JsonValue* Mesh = Meshes != nullptr ? Meshes->At(MeshIndex) : nullptr;
+        const JsonValue* Primitives = Mesh != nullptr ? Mesh->Find("primitives") : nullptr;
+
+        if (Primitives == nullptr)
+        {
+            Error = "GLTF > Mesh " + std::to_string(MeshIndex) + " does not exist";
+            return false;
+        }
+
+        for (const auto& Primitive : Primitives->Items)
+        {
+            if (!LoadPrimitive(Doc, Primitive, Transform, Result, Error))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool LoadNode(const Document& Doc, int NodeIndex, const glm::mat4& Parent, int Depth, Engine::GltfParser::Mesh& Result, std::string& Error)
+    {
+        const JsonValue* Nodes = Doc.Root.Find("nodes");
+        const JsonValue* Node = Nodes != nullptr ? Nodes->At(NodeIndex) : nullptr;
+
+        if (Node == nullptr || Depth > MaxDepth)
+        {
+            Error = "GLTF > Invalid node hierarchy";
+            return false;
+        }
+
+        glm::mat4 Transform = Parent * GetNodeTransform(*Node);
+
+        if (Node->Find("mesh") != nullptr && !LoadMesh(Doc, Node->GetInt("mesh", -1), Transform, Result, Error))
+        {
+            return false;
+        }
+
+        const JsonValue* Children = Node->Find("children");
+
+        for (size_t i = 0; Children != nullptr && i < Children->Size(); i++)
+        {
+            if (!LoadNode(Doc, static_cast<int>(Children->Items[i].Number), Transform, Depth + 1, Result, Error))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void LoadMaterials(const Document& Doc, Engine::GltfParser::Mesh& Result)
+    {
+        const JsonValue* Materials = Doc.Root.Find("materials");
+        const JsonValue* Textures = Doc.Root.Find("textures");
+        const JsonValue* Images = Doc.Root.Find("images");
+
+        for (size_t i = 0; Materials != nullptr && i < Materials->Size(); i++)
+        {
+            const JsonValue& Info = Materials->Items[i];
+
+            Engine::GltfParser::Material Material;
+            Material.Name = Info.GetString("name");
+
+            const JsonValue* Pbr = Info.Find("pbrMetallicRoughness");
+            const JsonValue* BaseColor = Pbr != nullptr ? Pbr->Find("baseColorTexture") : nullptr;
+            const JsonValue* Texture = (BaseColor != nullptr && Textures != nullptr) ? Textures->At(BaseColor->GetInt("index", -1)) : nullptr;
+            const JsonValue* Image = (Texture != nullptr && Images != nullptr) ? Images->At(Texture->GetInt("source", -1)) : nullptr;
+
+            if (Image != nullptr)
+            {
+                std::string Uri = Image->GetString("uri");
+
+                if (!Uri.empty() && Uri.compare(0, 5, "data:") != 0)
+                {
+                    Material.BaseColorTexture = (Doc.Directory / Uri).generic_string();
+                }
+                else
+                {
+                    std::cout << "GLTF > Embedded images are not supported, material " << Material.Name << " uses the default texture" << std::endl;
+                }
+            }
+
+            Result.Materials.push_back(Material);
+        }
+    }
+
+    void CloseDocument(Document& Doc)
+    {
+        for (auto& File : Doc.Files)
+        {
+            FileSystem::UnmapFile(File);
+        }
+
+        Doc.Files.clear();
+        Doc.Buffers.clear();
+    }
+
+    template <typename T>
+    void AppendBytes(std::string& Target, const T* Data, size_t Count)
+    {
+        Target.append(reinterpret_cast<const char*>(Data), sizeof(T) * Count);
+    }
+}
+
+bool Engine::GltfParser::Load(const std::string& FilePath, Engine::GltfParser::Mesh& Result, std::string& Error)
+{
+    Result = Engine::GltfParser::Mesh{};
+
+    Document Doc;
+    Doc.Directory = fs::path(FilePath).parent_path();
+
+    Doc.Files.push_back(FileSystem::MapFile(FilePath));
+
+    const FileSystem::MappedFile& File = Doc.Files.back();
+
+    if (!File.IsOpen())
+    {
+        Error = "GLTF > Failed to open file: " + FilePath;
+        CloseDocument(Doc);
+        return false;
+    }
+
+    const char* JsonBegin = File.Data;
+    const char* JsonEnd = File.Data + File.Size;
+
+    Buffer BinaryChunk;
+
+    uint32_t Magic = 0;
+
+    if (File.Size >= 4)
+    {
+        memcpy(&Magic, File.Data, 4);
+    }
+
+    if (Magic == GlbMagic)
+    {
+        /*
+            12 byte header, then length/type prefixed chunks, JSON first and an optional BIN second
+        */
+
+        uint32_t Header[3];
+
+        if (File.Size < 20)
+        {
+            Error = "GLTF > Truncated GLB header in " + FilePath;
+            CloseDocument(Doc);
+            return false;
+        }
+
+        memcpy(Header, File.Data, sizeof(Header));
+
+        if (Header[1] != 2 || Header[2] > File.Size)
+        {
+            Error = "GLTF > Unsupported GLB version or bad length in " + FilePath;
+            CloseDocument(Doc);
+            return false;
+        }
+
+        size_t Offset = 12;
+        bool HaveJson = false;
+
+        while (Offset + 8 <= Header[2])
+        {
+            uint32_t Chunk[2];
+            memcpy(Chunk, File.Data + Offset, sizeof(Chunk));
+
+            if (Offset + 8 + uint64_t(Chunk[0]) > Header[2])
+            {
+                break;
+            }
+
+            const char* Data = File.Data + Offset + 8;
+
+            if (Chunk[1] == GlbChunkJson && !HaveJson)
+            {
+                JsonBegin = Data;
+                JsonEnd = Data + Chunk[0];
+                HaveJson = true;
+            }
+            else if (Chunk[1] == GlbChunkBin && BinaryChunk.Data == nullptr)
+            {
+                BinaryChunk.Data = reinterpret_cast<const uint8_t*>(Data);
+                BinaryChunk.Size = Chunk[0];
+            }
+
+            Offset += 8 + ((uint64_t(Chunk[0]) + 3) & ~uint64_t(3));
+        }
+
+        if (!HaveJson)
+        {
+            Error = "GLTF > GLB has no JSON chunk: " + FilePath;
+            CloseDocument(Doc);
+            return false;
+        }
+    }
+
+    JsonReader Reader(JsonBegin, JsonEnd);
+
+    if (!Reader.Parse(Doc.Root, Error))
+    {
+        CloseDocument(Doc);
+        return false;
+    }
+
+    /*
+        Buffer 0 of a GLB without a uri is the BIN chunk, anything else is an external file
+    */
+
+    const JsonValue* Buffers = Doc.Root.Find("buffers");
+
+    for (size_t i = 0; Buffers != nullptr && i < Buffers->Size(); i++)
+    {
+        std::string Uri = Buffers->Items[i].GetString("uri");
+        Buffer Entry;
+
+        if (Uri.empty())
+        {
+            Entry = (i == 0) ? BinaryChunk : Buffer{};
+        }
+        else if (Uri.compare(0, 5, "data:") == 0)
+        {
+            std::cout << "GLTF > Embedded data URIs are not supported" << std::endl;
+        }
+        else
+        {
+            Doc.Files.push_back(FileSystem::MapFile((Doc.Directory / Uri).string()));
+
+            if (Doc.Files.back().IsOpen())
+            {
+                Entry.Data = reinterpret_cast<const uint8_t*>(Doc.Files.back().Data);
+                Entry.Size = Doc.Files.back().Size;
+            }
+            else
+            {
+                std::cout << "GLTF > Buffer not found: " << Uri << std::endl;
+            }
+        }
+
+        Doc.Buffers.push_back(Entry);
+    }
+
+    bool Success = true;
+
+    const JsonValue* Scenes = Doc.Root.Find("scenes");
+    const JsonValue* Scene = Scenes != nullptr ? Scenes->At(Doc.Root.GetInt("scene", 0)) : nullptr;
+    const JsonValue* SceneNodes = Scene != nullptr ? Scene->Find("nodes") : nullptr;
+
+    if (SceneNodes != nullptr)
+    {
+        for (size_t i = 0; Success && i < SceneNodes->Size(); i++)
+        {
+            Success = LoadNode(Doc, static_cast<int>(SceneNodes->Items[i].Number), glm::mat4(1.0f), 0, Result, Error);
+        }
+    }
+    else
+    {
+        /*
+            No scene, take every mesh untransformed
+        */
+
+        const JsonValue* Meshes = Doc.Root.Find("meshes");
+
+        for (size_t i = 0; Success && Meshes != nullptr && i < Meshes->Size(); i++)
+        {
+            Success = LoadMesh(Doc, static_cast<int>(i), glm::mat4(1.0f), Result, Error);
+        }
+    }
+
+    if (Success)
+    {
+        LoadMaterials(Doc, Result);
+    }
+
+    CloseDocument(Doc);
+
+    return Success;
+}
+
+bool Engine::GltfParser::Write(const std::string& FilePath, const std::vector<Vulkan::Renderer::Vertex>& Vertices, const std::vector<uint32_t>& Indices, bool Interleaved, std::string& Error)
+{
+    size_t VertexCount = Vertices.size();
+    bool ShortIndices = !Interleaved && VertexCount <= 0xFFFF;
+
+    glm::vec3 Minimum(std::numeric_limits<float>::max());
+    glm::vec3 Maximum(std::numeric_limits<float>::lowest());
+
+    for (const auto& Vertex : Vertices)
+    {
+        Minimum = glm::min(Minimum, Vertex.Pos);
+        Maximum = glm::max(Maximum, Vertex.Pos);
+    }
+
+    std::string Binary;
+    std::vector<size_t> ViewOffsets;
+
+    auto Align = [&]()
+    {
+        Binary.resize((Binary.size() + 3) & ~size_t(3), '\0');
+    };
+
+    if (Interleaved)
+    {
+        ViewOffsets.push_back(Binary.size());
+        AppendBytes(Binary, Vertices.data(), VertexCount);
+    }
+    else
+    {
+        std::vector<glm::vec3> Stream3(VertexCount);
+        std::vector<glm::vec2> Stream2(VertexCount);
+
+        for (size_t i = 0; i < VertexCount; i++) Stream3[i] = Vertices[i].Pos;
+        ViewOffsets.push_back(Binary.size());
+        AppendBytes(Binary, Stream3.data(), VertexCount);
+
+        for (size_t i = 0; i < VertexCount; i++) Stream3[i] = Vertices[i].Color;
+        ViewOffsets.push_back(Binary.size());
+        AppendBytes(Binary, Stream3.data(), VertexCount);
+
+        for (size_t i = 0; i < VertexCount; i++) Stream3[i] = Vertices[i].Normal;
+        ViewOffsets.push_back(Binary.size());
+        AppendBytes(Binary, Stream3.data(), VertexCount);
+
+        for (size_t i = 0; i < VertexCount; i++) Stream2[i] = Vertices[i].UV;
+        ViewOffsets.push_back(Binary.size());
+        AppendBytes(Binary, Stream2.data(), VertexCount);
+    }
+
+    ViewOffsets.push_back(Binary.size());
+
+    if (ShortIndices)
+    {
+        std::vector<uint16_t> Narrow(Indices.begin(), Indices.end());
+        AppendBytes(Binary, Narrow.data(), Narrow.size());
+    }
+    else
+    {
+        AppendBytes(Binary, Indices.data(), Indices.size());
+    }
+
+    size_t IndexBytes = Binary.size() - ViewOffsets.back();
+
+    Align();
+
+    /*
+        JSON document
+    */
+
+    std::ostringstream Json;
+    Json << std::setprecision(9);
+
+    Json << "{\"asset\":{\"version\":\"2.0\",\"generator\":\"Aqueduct\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],";
+    Json << "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"COLOR_0\":1,\"NORMAL\":2,\"TEXCOORD_0\":3},\"indices\":4,\"mode\":4}]}],";
+    Json << "\"buffers\":[{\"byteLength\":" << Binary.size() << "}],";
+
+    Json << "\"bufferViews\":[";
+
+    if (Interleaved)
+    {
+        Json << "{\"buffer\":0,\"byteOffset\":0,\"byteLength\":" << VertexCount * sizeof(Vulkan::Renderer::Vertex) << ",\"byteStride\":" << sizeof(Vulkan::Renderer::Vertex) << ",\"target\":34962},";
+    }
+    else
+    {
+        size_t Sizes[4] = { sizeof(glm::vec3), sizeof(glm::vec3), sizeof(glm::vec3), sizeof(glm::vec2) };
+
+        for (int i = 0; i < 4; i++)
+        {
+            Json << "{\"buffer\":0,\"byteOffset\":" << ViewOffsets[i] << ",\"byteLength\":" << VertexCount * Sizes[i] << ",\"target\":34962},";
+        }
+    }
+
+    Json << "{\"buffer\":0,\"byteOffset\":" << ViewOffsets.back() << ",\"byteLength\":" << IndexBytes << ",\"target\":34963}],";
+
+    const char* Types[4] = { "VEC3", "VEC3", "VEC3", "VEC2" };
+    size_t Offsets[4] = { offsetof(Vulkan::Renderer::Vertex, Pos), offsetof(Vulkan::Renderer::Vertex, Color), offsetof(Vulkan::Renderer::Vertex, Normal), offsetof(Vulkan::Renderer::Vertex, UV) };
+
+    Json << "\"accessors\":[";
+
+    for (int i = 0; i < 4; i++)
+    {
+        Json << "{\"bufferView\":" << (Interleaved ? 0 : i) << ",\"byteOffset\":" << (Interleaved ? Offsets[i] : 0)
+            << ",\"componentType\":" << ComponentFloat << ",\"count\":" << VertexCount << ",\"type\":\"" << Types[i] << "\"";
+
+        if (i == 0)
+        {
+            Json << ",\"min\":[" << Minimum.x << "," << Minimum.y << "," << Minimum.z << "],\"max\":[" << Maximum.x << "," << Maximum.y << "," << Maximum.z << "]";
+        }
+
+        Json << "},";
+    }
+
+    Json << "{\"bufferView\":" << (Interleaved ? 1 : 4) << ",\"componentType\":" << (ShortIndices ? ComponentUnsignedShort : ComponentUnsignedInt)
+        << ",\"count\":" << Indices.size() << ",\"type\":\"SCALAR\"}]}";
+
+    std::string JsonText = Json.str();
+    JsonText.resize((JsonText.size() + 3) & ~size_t(3), ' ');
+
+    uint32_t Header[3] = { GlbMagic, 2, static_cast<uint32_t>(12 + 8 + JsonText.size() + 8 + Binary.size()) };
+    uint32_t JsonChunk[2] = { static_cast<uint32_t>(JsonText.size()), GlbChunkJson };
+    uint32_t BinaryChunk[2] = { static_cast<uint32_t>(Binary.size()), GlbChunkBin };
+
+    std::ofstream Output(FilePath, std::ios::binary | std::ios::trunc);
+
+    if (!Output)
+    {
+        Error = "GLTF > Failed to create " + FilePath;
+        return false;
+    }
+
+    Output.write(reinterpret_cast<const char*>(Header), sizeof(Header));
+    Output.write(reinterpret_cast<const char*>(JsonChunk), sizeof(JsonChunk));
+    Output.write(JsonText.data(), JsonText.size());
+    Output.write(reinterpret_cast<const char*>(BinaryChunk), sizeof(BinaryChunk));
+    Output.write(Binary.data(), Binary.size());
+
+    if (!Output)
+    {
+        Error = "GLTF > Failed to write " + FilePath;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#ifndef GLTFPARSER_H
+#define GLTFPARSER_H
+
+namespace Engine
+{
+	/*
+		In-tree glTF 2.0 loader for .glb and .gltf files.
+
+		Buffers are memory mapped (the BIN chunk of a .glb, external .bin files of a .gltf) and accessor
+		data is read straight out of the mapping. glTF meshes are already indexed, so there's no vertex
+		dedup pass, and an interleaved buffer view that matches Vulkan::Renderer::Vertex is copied in
+		one block. Node transforms are applied, only triangle list primitives are loaded.
+	*/
+
+	namespace GltfParser
+	{
+		struct Material
+		{
+			std::string Name;
+			std::string BaseColorTexture;
+		};
+
+		struct Mesh
+		{
+			std::vector<Vulkan::Renderer::Vertex> Vertices;
+			std::vector<uint32_t> Indices;
+
+			/*
+				One entry per triangle, -1 for primitives without a material
+			*/
+
+			std::vector<int> MaterialIds;
+			std::vector<Material> Materials;
+
+			/*
+				Attribute and index streams that were copied as a block rather than element by element
+			*/
+
+			uint32_t BlockCopies = 0;
+			uint32_t ElementCopies = 0;
+		};
+
+		bool Load(const std::string& FilePath, Mesh& Result, std::string& Error);
+
+		/*
+			Writes a single mesh .glb, with either one interleaved buffer view in the Vertex layout or
+			one tightly packed view per attribute. Used to generate sample files for verification.
+		*/
+
+		bool Write(const std::string& FilePath, const std::vector<Vulkan::Renderer::Vertex>& Vertices, const std::vector<uint32_t>& Indices, bool Interleaved, std::string& Error);
+	}
+}
+
+#endif
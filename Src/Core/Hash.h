@@ -0,0 +1,136 @@
+#pragma once
+
+#ifndef HASH_H
+#define HASH_H
+
+namespace Engine
+{
+	namespace Hash
+	{
+		/*
+			MurmurHash64A, used for anything that needs a strong 64-bit
+			hash over raw bytes (file contents, vertices, paths)
+		*/
+
+		inline uint64_t Bytes(const void* Data, size_t Size, uint64_t Seed = 0)
+		{
+			const uint64_t M = 0xc6a4a7935bd1e995ULL;
+			const int R = 47;
+
+			uint64_t H = Seed ^ (Size * M);
+
+			const unsigned char* Bytes = static_cast<const unsigned char*>(Data);
+			const unsigned char* End = Bytes + (Size & ~size_t(7));
+
+			while (Bytes != End)
+			{
+				uint64_t K;
+				memcpy(&K, Bytes, sizeof(K));
+				Bytes += sizeof(K);
+
+				K *= M;
+				K ^= K >> R;
+				K *= M;
+
+				H ^= K;
+				H *= M;
+			}
+
+			switch (Size & 7)
+			{
+			case 7: H ^= uint64_t(Bytes[6]) << 48; [[fallthrough]];
+			case 6: H ^= uint64_t(Bytes[5]) << 40; [[fallthrough]];
+			case 5: H ^= uint64_t(Bytes[4]) << 32; [[fallthrough]];
+			case 4: H ^= uint64_t(Bytes[3]) << 24; [[fallthrough]];
+			case 3: H ^= uint64_t(Bytes[2]) << 16; [[fallthrough]];
+			case 2: H ^= uint64_t(Bytes[1]) << 8; [[fallthrough]];
+			case 1: H ^= uint64_t(Bytes[0]);
+				H *= M;
+			}
+
+			H ^= H >> R;
+			H *= M;
+			H ^= H >> R;
+
+			return H;
+		}
+
+		/*
+			Bytes over data that arrives in pieces (files read through a window), the total size has to
+			be known up front. Finish returns the same value Bytes would for the whole input.
+		*/
+
+		class Stream
+		{
+		public:
+			Stream(uint64_t TotalSize, uint64_t Seed = 0)
+				: H(Seed ^ (TotalSize * M))
+			{
+			}
+
+			void Update(const void* Data, size_t Size)
+			{
+				const unsigned char* Bytes = static_cast<const unsigned char*>(Data);
+
+				while (Size > 0)
+				{
+					size_t Take = std::min(Size, sizeof(Pending) - PendingSize);
+					memcpy(Pending + PendingSize, Bytes, Take);
+
+					PendingSize += Take;
+					Bytes += Take;
+					Size -= Take;
+
+					if (PendingSize == sizeof(Pending))
+					{
+						uint64_t K;
+						memcpy(&K, Pending, sizeof(K));
+
+						K *= M;
+						K ^= K >> R;
+						K *= M;
+
+						H ^= K;
+						H *= M;
+
+						PendingSize = 0;
+					}
+				}
+			}
+
+			uint64_t Finish()
+			{
+				for (size_t i = PendingSize; i-- > 0;)
+				{
+					H ^= uint64_t(Pending[i]) << (8 * i);
+				}
+
+				if (PendingSize > 0)
+				{
+					H *= M;
+				}
+
+				H ^= H >> R;
+				H *= M;
+				H ^= H >> R;
+
+				return H;
+			}
+
+		private:
+			static const uint64_t M = 0xc6a4a7935bd1e995ULL;
+			static const int R = 47;
+
+			uint64_t H;
+			unsigned char Pending[8] = {};
+			size_t PendingSize = 0;
+		};
+
+		inline uint64_t String(const std::string& Value, uint64_t Seed = 0)
+		{
+			return Engine::Hash::Bytes(Value.data(), Value.size(), Seed);
+		}
+	}
+}
+
+#endif
@@ -2,6 +2,7 @@
 #include "../Common.h"
 
 #include "Camera.h"
+#include "Profiler.h"
 
 #include "./API/Vulkan/Renderer.h"
 
@@ -11,8 +12,15 @@ SDL_Event Event;
 
 void Engine::Input::ParseEvent()
 {
+    PROFILE_ZONE("Input::ParseEvent");
+
     while (SDL_PollEvent(&Event))
    {
+        if (Event.type == SDL_KEYDOWN || Event.type == SDL_MOUSEMOTION)
+        {
+            Vulkan::Pacing::InputReceived(Event.common.timestamp);
+        }
+
         if (Event.type == SDL_KEYDOWN)
         {
             if (Event.key.keysym.sym == SDLK_SPACE)
@@ -50,6 +58,11 @@ void Engine::Input::ParseEvent()
                 Vulkan::Renderer::CleanUp();
             }
 
+            if (Event.key.keysym.sym == SDLK_F12)
+            {
+                PROFILE_WRITE("Profile.json");
+            }
+
             if (Event.key.keysym.sym == SDLK_h)
             {
                // std::cout << "PRESSING H" << std::endl;
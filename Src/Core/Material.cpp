@@ -0,0 +1,352 @@
+#include "../Common.h"
+#include "./API/Vulkan/Renderer.h"
+#include "Material.h"
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+std::vector<Engine::Materials::Material> Engine::Materials::Materials;
+VkDescriptorPool Engine::Materials::DescriptorPool = VK_NULL_HANDLE;
+
+namespace
+{
+    /*
+        Released slots whose texture has been destroyed, they keep their descriptor sets
+    */
+
+    std::vector<uint32_t> FreeSlots;
+
+    void EnsureDefault()
+    {
+        if (Engine::Materials::Materials.empty())
+        {
+            Engine::Materials::Materials.push_back({});
+        }
+    }
+
+    void WriteDescriptorSets(Engine::Materials::Material& Material)
+    {
+        if (Material.DescriptorSets.empty())
+        {
+            std::vector<VkDescriptorSetLayout> Layouts(Vulkan::Renderer::MaxFramesInFlight, Vulkan::Renderer::DescriptorSetLayout);
+
+            VkDescriptorSetAllocateInfo AllocateInfo{};
+            AllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            AllocateInfo.descriptorPool = Engine::Materials::DescriptorPool;
+            AllocateInfo.descriptorSetCount = static_cast<uint32_t>(Vulkan::Renderer::MaxFramesInFlight);
+            AllocateInfo.pSetLayouts = Layouts.data();
+
+            Material.DescriptorSets.resize(Vulkan::Renderer::MaxFramesInFlight);
+
+            if (vkAllocateDescriptorSets(Vulkan::Renderer::Device, &AllocateInfo, Material.DescriptorSets.data()) != VK_SUCCESS)
+            {
+                throw std::runtime_error("MATERIAL > Failed to allocate descriptor sets!");
+            }
+        }
+
+        for (size_t i = 0; i < Vulkan::Renderer::MaxFramesInFlight; i++)
+        {
+            VkDescriptorBufferInfo BufferInfo{};
+            BufferInfo.buffer = Vulkan::Renderer::UniformBuffers[i];
+            BufferInfo.offset = 0;
+            BufferInfo.range = sizeof(Vulkan::Renderer::UniformBufferObject);
+
+            VkDescriptorImageInfo ImageInfo{};
+            ImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            ImageInfo.imageView = Material.ImageView != VK_NULL_HANDLE ? Material.ImageView : Vulkan::Renderer::TextureImageView;
+            ImageInfo.sampler = Vulkan::Renderer::TextureSampler;
+
+            std::array<VkWriteDescriptorSet, 2> DescriptorWrites{};
+            DescriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            DescriptorWrites[0].dstSet = Material.DescriptorSets[i];
+            DescriptorWrites[0].dstBinding = 0;
+            DescriptorWrites[0].dstArrayElement = 0;
+            DescriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            DescriptorWrites[0].descriptorCount = 1;
+            DescriptorWrites[0].pBufferInfo = &BufferInfo;
+
+            DescriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            DescriptorWrites[1].dstSet = Material.DescriptorSets[i];
+            DescriptorWrites[1].dstBinding = 1;
+            DescriptorWrites[1].dstArrayElement = 0;
+            DescriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            DescriptorWrites[1].descriptorCount = 1;
+            DescriptorWrites[1].pImageInfo = &ImageInfo;
+
+            vkUpdateDescriptorSets(Vulkan::Renderer::Device, static_cast<uint32_t>(DescriptorWrites.size()), DescriptorWrites.data(), 0, nullptr);
+        }
+
+        /*
+            Updating a set invalidates every command buffer it is bound in
+        */
+
+        Vulkan::Renderer::InvalidateCommandBuffers();
+    }
+}
+
+uint32_t Engine::Materials::Acquire(const std::string& TexturePath)
+{
+    return Engine::Materials::Acquire(std::vector<std::string>{ TexturePath })[0];
+}
+
+std::vector<uint32_t> Engine::Materials::Acquire(const std::vector<std::string>& TexturePaths)
+{
+    EnsureDefault();
+
+    std::vector<uint32_t> Result(TexturePaths.size(), Engine::Materials::Default);
+
+    /*
+        New textures are collected first so they are recorded into the staging batch together,
+        Owners maps each of them back to the slots in Result asking for it
+    */
+
+    std::vector<Vulkan::Renderer::TextureUpload> Uploads;
+    std::vector<std::vector<size_t>> Owners;
+
+    for (size_t i = 0; i < TexturePaths.size(); i++)
+    {
+        const std::string& TexturePath = TexturePaths[i];
+
+        if (TexturePath.empty())
+        {
+            continue;
+        }
+
+        bool Found = false;
+
+        for (uint32_t j = 1; j < Engine::Materials::Materials.size() && !Found; j++)
+        {
+            if (Engine::Materials::Materials[j].TexturePath == TexturePath)
+            {
+                Result[i] = j;
+                Found = true;
+            }
+        }
+
+        for (size_t j = 0; j < Uploads.size() && !Found; j++)
+        {
+            if (Uploads[j].FilePath == TexturePath)
+            {
+                Owners[j].push_back(i);
+                Found = true;
+            }
+        }
+
+        if (Found)
+        {
+            continue;
+        }
+
+        if (Engine::Materials::Materials.size() - FreeSlots.size() + Uploads.size() >= Engine::Materials::MaxMaterials)
+        {
+            std::cout << "MATERIAL > Material limit reached, using the default texture for " << TexturePath << std::endl;
+            continue;
+        }
+
+        Uploads.push_back({});
+        Uploads.back().FilePath = TexturePath;
+        Owners.push_back({ i });
+    }
+
+    if (Uploads.empty())
+    {
+        return Result;
+    }
+
+    Vulkan::Renderer::CreateTextures(Uploads);
+
+    for (size_t i = 0; i < Uploads.size(); i++)
+    {
+        if (!Uploads[i].Loaded)
+        {
+            std::cout << "MATERIAL > Failed to load " << Uploads[i].FilePath << ", using the default texture" << std::endl;
+            continue;
+        }
+
+        uint32_t Index;
+
+        if (!FreeSlots.empty())
+        {
+            Index = FreeSlots.back();
+            FreeSlots.pop_back();
+        }
+        else
+        {
+            Index = static_cast<uint32_t>(Engine::Materials::Materials.size());
+            Engine::Materials::Materials.push_back({});
+        }
+
+        Engine::Materials::Material& Material = Engine::Materials::Materials[Index];
+        Material.TexturePath = Uploads[i].FilePath;
+        Material.Image = Uploads[i].Image;
+        Material.ImageMemory = Uploads[i].ImageMemory;
+        Material.ImageView = Vulkan::Renderer::CreateImageView(Material.Image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
+        Material.References = 0;
+
+        /*
+            Materials acquired after startup get their descriptor sets straight away, a reused slot
+            rewrites the sets it already has
+        */
+
+        if (Engine::Materials::DescriptorPool != VK_NULL_HANDLE)
+        {
+            WriteDescriptorSets(Material);
+        }
+
+        std::cout << "MATERIAL > Loaded " << Material.TexturePath << std::endl;
+
+        for (size_t Owner : Owners[i])
+        {
+            Result[Owner] = Index;
+        }
+    }
+
+    if (Uploads.size() > 1)
+    {
+        std::cout << "MATERIAL > Recorded " << Uploads.size() << " textures into one staging batch" << std::endl;
+    }
+
+    for (uint32_t Index : Result)
+    {
+        if (Index != Engine::Materials::Default)
+        {
+            Engine::Materials::Materials[Index].References++;
+        }
+    }
+
+    return Result;
+}
+
+void Engine::Materials::Release(uint32_t Material)
+{
+    if (Material == Engine::Materials::Default || Material >= Engine::Materials::Materials.size())
+    {
+        return;
+    }
+
+    Engine::Materials::Material& Target = Engine::Materials::Materials[Material];
+
+    if (Target.References == 0 || --Target.References > 0)
+    {
+        return;
+    }
+
+    std::cout << "MATERIAL > Released " << Target.TexturePath << std::endl;
+
+    /*
+        Cleared now so nothing acquires it again, the slot only becomes free once the frames that may
+        still sample it have finished
+    */
+
+    Target.TexturePath.clear();
+
+    Vulkan::Renderer::InvalidateCommandBuffers();
+
+    Vulkan::Deletion::DestroyImageView(Target.ImageView);
+    Vulkan::Deletion::DestroyImage(Target.Image, Target.ImageMemory);
+
+    Vulkan::Deletion::Defer([Material]()
+    {
+        FreeSlots.push_back(Material);
+    });
+}
+
+std::string Engine::Materials::ResolveTexturePath(const std::string& TexturePath, const std::string& ModelPath)
+{
+    if (TexturePath.empty())
+    {
+        return "";
+    }
+
+    std::error_code Error;
+
+    fs::path FileName = fs::path(TexturePath).filename();
+
+    std::vector<fs::path> Candidates = {
+        fs::path(TexturePath),
+        fs::path(ModelPath).parent_path() / TexturePath,
+        fs::path(ModelPath).parent_path() / FileName,
+        fs::path("Assets/Textures") / FileName
+    };
+
+    for (const auto& Candidate : Candidates)
+    {
+        if (fs::is_regular_file(Candidate, Error))
+        {
+            return Candidate.generic_string();
+        }
+    }
+
+    std::cout << "MATERIAL > Texture not found: " << TexturePath << std::endl;
+
+    return "";
+}
+
+void Engine::Materials::CreateDescriptorSets()
+{
+    EnsureDefault();
+
+    std::array<VkDescriptorPoolSize, 2> PoolSizes{};
+    PoolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    PoolSizes[0].descriptorCount = Engine::Materials::MaxMaterials * Vulkan::Renderer::MaxFramesInFlight;
+
+    PoolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    PoolSizes[1].descriptorCount = Engine::Materials::MaxMaterials * Vulkan::Renderer::MaxFramesInFlight;
+
+    VkDescriptorPoolCreateInfo CreateInfo{};
+    CreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    CreateInfo.poolSizeCount = static_cast<uint32_t>(PoolSizes.size());
+    CreateInfo.pPoolSizes = PoolSizes.data();
+    CreateInfo.maxSets = Engine::Materials::MaxMaterials * Vulkan::Renderer::MaxFramesInFlight;
+
+    if (vkCreateDescriptorPool(Vulkan::Renderer::Device, &CreateInfo, nullptr, &Engine::Materials::DescriptorPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("MATERIAL > Failed to create descriptor pool!");
+    }
+
+    for (auto& Material : Engine::Materials::Materials)
+    {
+        WriteDescriptorSets(Material);
+    }
+
+    std::cout << "MATERIAL > Created descriptor sets for " << Engine::Materials::Materials.size() << " materials" << std::endl;
+}
+
+void Engine::Materials::DestroyDescriptorSets()
+{
+    vkDestroyDescriptorPool(Vulkan::Renderer::Device, Engine::Materials::DescriptorPool, nullptr);
+
+    Engine::Materials::DescriptorPool = VK_NULL_HANDLE;
+
+    for (auto& Material : Engine::Materials::Materials)
+    {
+        Material.DescriptorSets.clear();
+    }
+}
+
+void Engine::Materials::Bind(VkCommandBuffer CommandBuffer, uint32_t Material)
+{
+    const auto& Sets = Engine::Materials::Materials[Material].DescriptorSets;
+
+    vkCmdBindDescriptorSets(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Vulkan::Renderer::PipelineLayout, 0, 1, &Sets[Vulkan::Renderer::CurrentFrame], 0, nullptr);
+}
+
+void Engine::Materials::Destroy()
+{
+    for (auto& Material : Engine::Materials::Materials)
+    {
+        if (Material.Image != VK_NULL_HANDLE)
+        {
+            vkDestroyImageView(Vulkan::Renderer::Device, Material.ImageView, nullptr);
+            Vulkan::Allocator::DestroyImage(Material.Image, Material.ImageMemory);
+        }
+    }
+
+    vkDestroyDescriptorPool(Vulkan::Renderer::Device, Engine::Materials::DescriptorPool, nullptr);
+
+    Engine::Materials::Materials.clear();
+    Engine::Materials::DescriptorPool = VK_NULL_HANDLE;
+
+    FreeSlots.clear();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#ifndef MATERIAL_H
+#define MATERIAL_H
+
+namespace Engine
+{
+	/*
+		Registry of every texture used by loaded models. Materials are shared between models by
+		texture path, each owns one descriptor set per frame in flight holding that frame's uniform
+		buffer and its texture, so drawing with a material is a single vkCmdBindDescriptorSets.
+	*/
+
+	namespace Materials
+	{
+		struct Material
+		{
+			std::string TexturePath;
+
+			VkImage Image = VK_NULL_HANDLE;
+			Vulkan::Allocator::Allocation ImageMemory;
+			VkImageView ImageView = VK_NULL_HANDLE;
+
+			std::vector<VkDescriptorSet> DescriptorSets;
+
+			uint32_t References = 0;
+		};
+
+		/*
+			Uses the global texture, anything without a loadable texture falls back to it
+		*/
+
+		const uint32_t Default = 0;
+		const uint32_t MaxMaterials = 256;
+
+		extern std::vector<Material> Materials;
+		extern VkDescriptorPool DescriptorPool;
+
+		uint32_t Acquire(const std::string& TexturePath);
+
+		/*
+			Acquire many at once, all new textures share one set of layout barriers in the staging batch
+			instead of one per texture. Returns one index per path.
+		*/
+
+		std::vector<uint32_t> Acquire(const std::vector<std::string>& TexturePaths);
+
+		/*
+			Drops one reference taken by Acquire. The last one queues the texture for deferred
+			destruction, its slot and descriptor sets are reused once no frame in flight can use them.
+		*/
+
+		void Release(uint32_t Material);
+
+		/*
+			Texture paths in .mtl files are often absolute paths from the exporting machine, look next to
+			the model and in Assets/Textures before giving up. Returns an empty string if nothing exists.
+		*/
+
+		std::string ResolveTexturePath(const std::string& TexturePath, const std::string& ModelPath);
+
+		void CreateDescriptorSets();
+
+		/*
+			Frees every material's descriptor sets with their pool, CreateDescriptorSets brings them back
+			sized for the current number of frames in flight
+		*/
+
+		void DestroyDescriptorSets();
+		void Bind(VkCommandBuffer CommandBuffer, uint32_t Material);
+		void Destroy();
+	}
+}
+
+#endif
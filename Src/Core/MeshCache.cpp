@@ -0,0 +1,554 @@
+#include "../Common.h"
+#include "./API/Vulkan/Renderer.h"
+#include "Model.h"
+#include "MeshCache.h"
+#include "Hash.h"
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+static_assert(sizeof(Vulkan::Renderer::Vertex) == 44, "MESHCACHE > Vertex layout changed, bump MeshCache::Version");
+static_assert(sizeof(Engine::Model::Submesh) == 20, "MESHCACHE > Submesh layout changed, bump MeshCache::Version");
+static_assert(sizeof(Engine::Meshlets::Meshlet) == 56, "MESHCACHE > Meshlet layout changed, bump MeshCache::Version");
+
+std::string Engine::MeshCache::CacheDirectory = "Cache/Meshes";
+
+static uint64_t AlignChunk(uint64_t Offset)
+{
+    return (Offset + 15) & ~uint64_t(15);
+}
+
+/*
+    Source size, timestamp and content hash, the hash is computed through a window so huge sources
+    never have to be mapped whole
+*/
+
+static bool StampSource(const std::string& SourcePath, Engine::MeshCache::Header& Info)
+{
+    if (!FileSystem::GetFileStamp(SourcePath, Info.SourceSize, Info.SourceTime))
+    {
+        return false;
+    }
+
+    std::ifstream Source(SourcePath, std::ios::binary);
+
+    if (!Source.is_open())
+    {
+        return false;
+    }
+
+    Engine::Hash::Stream Hash(Info.SourceSize);
+    std::vector<char> Window(4 * 1024 * 1024);
+
+    while (Source.read(Window.data(), static_cast<std::streamsize>(Window.size())) || Source.gcount() > 0)
+    {
+        Hash.Update(Window.data(), static_cast<size_t>(Source.gcount()));
+    }
+
+    Info.SourceHash = Hash.Finish();
+
+    return true;
+}
+
+/*
+    Moves a finished temporary file over the cache, replacing any previous version
+*/
+
+static void ReplaceCache(const std::string& TempPath, const std::string& CachePath)
+{
+    std::error_code Error;
+    fs::rename(TempPath, CachePath, Error);
+
+    if (Error)
+    {
+        fs::remove(CachePath, Error);
+        fs::rename(TempPath, CachePath, Error);
+    }
+}
+
+std::string Engine::MeshCache::GetCachePath(const std::string& SourcePath)
+{
+    char PathHash[17];
+    snprintf(PathHash, sizeof(PathHash), "%016llx", static_cast<unsigned long long>(Engine::Hash::String(fs::path(SourcePath).generic_string())));
+
+    return Engine::MeshCache::CacheDirectory + "/" + fs::path(SourcePath).stem().string() + "_" + PathHash + ".mesh";
+}
+
+const void* Engine::MeshCache::FindChunk(const Engine::MeshCache::CachedMesh& Mesh, Engine::MeshCache::ChunkType Type, uint64_t& Size)
+{
+    const Engine::MeshCache::Chunk* Chunks = reinterpret_cast<const Engine::MeshCache::Chunk*>(Mesh.File.Data + sizeof(Engine::MeshCache::Header));
+
+    for (uint32_t i = 0; i < Mesh.Info->ChunkCount; i++)
+    {
+        if (Chunks[i].Type == static_cast<uint32_t>(Type))
+        {
+            Size = Chunks[i].Size;
+            return Mesh.File.Data + Chunks[i].Offset;
+        }
+    }
+
+    Size = 0;
+    return nullptr;
+}
+
+bool Engine::MeshCache::Open(const std::string& SourcePath, Engine::MeshCache::CachedMesh& Mesh)
+{
+    uint64_t SourceSize;
+    int64_t SourceTime;
+
+    if (!FileSystem::GetFileStamp(SourcePath, SourceSize, SourceTime))
+    {
+        return false;
+    }
+
+    std::string CachePath = Engine::MeshCache::GetCachePath(SourcePath);
+
+    Mesh.File = FileSystem::MapFile(CachePath);
+
+    if (!Mesh.File.IsOpen())
+    {
+        std::cout << "MESHCACHE > No cache for " << SourcePath << std::endl;
+        return false;
+    }
+
+    Mesh.Info = reinterpret_cast<const Engine::MeshCache::Header*>(Mesh.File.Data);
+
+    if (Mesh.File.Size < sizeof(Engine::MeshCache::Header) ||
+        Mesh.Info->Magic != Engine::MeshCache::Magic ||
+        Mesh.Info->Version != Engine::MeshCache::Version ||
+        Mesh.Info->VertexStride != sizeof(Vulkan::Renderer::Vertex) ||
+        Mesh.File.Size < sizeof(Engine::MeshCache::Header) + Mesh.Info->ChunkCount * sizeof(Engine::MeshCache::Chunk))
+    {
+        std::cout << "MESHCACHE > Discarding outdated cache " << CachePath << std::endl;
+        Engine::MeshCache::Close(Mesh);
+        return false;
+    }
+
+    const Engine::MeshCache::Chunk* Chunks = reinterpret_cast<const Engine::MeshCache::Chunk*>(Mesh.File.Data + sizeof(Engine::MeshCache::Header));
+
+    for (uint32_t i = 0; i < Mesh.Info->ChunkCount; i++)
+    {
+        if (Chunks[i].Offset > Mesh.File.Size || Chunks[i].Size > Mesh.File.Size - Chunks[i].Offset)
+        {
+            std::cout << "MESHCACHE > Discarding truncated cache " << CachePath << std::endl;
+            Engine::MeshCache::Close(Mesh);
+            return false;
+        }
+    }
+
+    /*
+        Path hashes can collide, so the source path is stored and compared as well
+    */
+
+    uint64_t PathSize, VertexSize, IndexSize;
+    const char* StoredPath = static_cast<const char*>(Engine::MeshCache::FindChunk(Mesh, Engine::MeshCache::ChunkType::SourcePath, PathSize));
+
+    Mesh.Vertices = static_cast<const Vulkan::Renderer::Vertex*>(Engine::MeshCache::FindChunk(Mesh, Engine::MeshCache::ChunkType::Vertices, VertexSize));
+    Mesh.Indices = static_cast<const uint32_t*>(Engine::MeshCache::FindChunk(Mesh, Engine::MeshCache::ChunkType::Indices, IndexSize));
+
+    uint64_t ReportSize;
+    Mesh.Optimization = static_cast<const Engine::MeshOptimizer::Report*>(Engine::MeshCache::FindChunk(Mesh, Engine::MeshCache::ChunkType::OptimizationReport, ReportSize));
+
+    if (Mesh.Optimization != nullptr && ReportSize != sizeof(Engine::MeshOptimizer::Report))
+    {
+        Mesh.Optimization = nullptr;
+    }
+
+    uint64_t LodSize;
+    Mesh.Lods = static_cast<const Engine::MeshSimplifier::Lod*>(Engine::MeshCache::FindChunk(Mesh, Engine::MeshCache::ChunkType::Lods, LodSize));
+    Mesh.LodCount = Mesh.Lods != nullptr ? static_cast<uint32_t>(LodSize / sizeof(Engine::MeshSimplifier::Lod)) : 0;
+
+    for (uint32_t i = 0; i < Mesh.LodCount; i++)
+    {
+        if (uint64_t(Mesh.Lods[i].FirstIndex) + Mesh.Lods[i].IndexCount > Mesh.Info->IndexCount)
+        {
+            Mesh.Lods = nullptr;
+            Mesh.LodCount = 0;
+            break;
+        }
+    }
+
+    /*
+        Submeshes and meshlets are only usable alongside the LOD table they were built for
+    */
+
+    uint64_t MeshletSize;
+    uint64_t SubmeshSize;
+    uint64_t MaterialSize;
+    Mesh.Meshlets = static_cast<const Engine::Meshlets::Meshlet*>(Engine::MeshCache::FindChunk(Mesh, Engine::MeshCache::ChunkType::Meshlets, MeshletSize));
+    Mesh.Submeshes = static_cast<const Engine::Model::Submesh*>(Engine::MeshCache::FindChunk(Mesh, Engine::MeshCache::ChunkType::Submeshes, SubmeshSize));
+    Mesh.MeshletCount = Mesh.Meshlets != nullptr ? static_cast<uint32_t>(MeshletSize / sizeof(Engine::Meshlets::Meshlet)) : 0;
+    Mesh.SubmeshCount = Mesh.Submeshes != nullptr ? static_cast<uint32_t>(SubmeshSize / sizeof(Engine::Model::Submesh)) : 0;
+
+    const char* Textures = static_cast<const char*>(Engine::MeshCache::FindChunk(Mesh, Engine::MeshCache::ChunkType::MaterialTextures, MaterialSize));
+
+    Mesh.MaterialTextures.clear();
+
+    for (uint64_t Start = 0, i = 0; Textures != nullptr && i < MaterialSize; i++)
+    {
+        if (Textures[i] == '\0')
+        {
+            Mesh.MaterialTextures.emplace_back(Textures + Start, Textures + i);
+            Start = i + 1;
+        }
+    }
+
+    bool SubmeshesValid = Mesh.LodCount > 0 && Mesh.SubmeshCount > 0 && Mesh.SubmeshCount % Mesh.LodCount == 0 && !Mesh.MaterialTextures.empty();
+
+    for (uint32_t i = 0; SubmeshesValid && i < Mesh.SubmeshCount; i++)
+    {
+        const Engine::Model::Submesh& Part = Mesh.Submeshes[i];
+
+        SubmeshesValid = uint64_t(Part.FirstIndex) + Part.IndexCount <= Mesh.Info->IndexCount &&
+            uint64_t(Part.FirstMeshlet) + Part.MeshletCount <= Mesh.MeshletCount &&
+            Part.Material < Mesh.MaterialTextures.size();
+    }
+
+    for (uint32_t i = 0; SubmeshesValid && i < Mesh.MeshletCount; i++)
+    {
+        SubmeshesValid = uint64_t(Mesh.Meshlets[i].FirstIndex) + uint64_t(Mesh.Meshlets[i].TriangleCount) * 3 <= Mesh.Info->IndexCount;
+    }
+
+    if (!SubmeshesValid)
+    {
+        Mesh.Meshlets = nullptr;
+        Mesh.MeshletCount = 0;
+        Mesh.Submeshes = nullptr;
+        Mesh.SubmeshCount = 0;
+        Mesh.MaterialTextures.clear();
+    }
+
+    std::string GenericPath = fs::path(SourcePath).generic_string();
+
+    if (StoredPath == nullptr || std::string(StoredPath, PathSize) != GenericPath ||
+        Mesh.Vertices == nullptr || VertexSize != uint64_t(Mesh.Info->VertexCount) * sizeof(Vulkan::Renderer::Vertex) ||
+        Mesh.Indices == nullptr || IndexSize != uint64_t(Mesh.Info->IndexCount) * sizeof(uint32_t))
+    {
+        std::cout << "MESHCACHE > Discarding mismatched cache " << CachePath << std::endl;
+        Engine::MeshCache::Close(Mesh);
+        return false;
+    }
+
+    if (Mesh.Info->SourceSize == SourceSize && Mesh.Info->SourceTime == SourceTime)
+    {
+        return true;
+    }
+
+    /*
+        Timestamp changed (checkout, copy, touch), only rebuild if the contents actually differ
+    */
+
+    if (Mesh.Info->SourceSize == SourceSize)
+    {
+        Engine::MeshCache::Header Current{};
+
+        bool Unchanged = StampSource(SourcePath, Current) && Current.SourceHash == Mesh.Info->SourceHash;
+
+        if (Unchanged)
+        {
+            std::cout << "MESHCACHE > Source timestamp changed but contents match, using cache for " << SourcePath << std::endl;
+            return true;
+        }
+    }
+
+    std::cout << "MESHCACHE > Cache is stale for " << SourcePath << std::endl;
+    Engine::MeshCache::Close(Mesh);
+
+    return false;
+}
+
+void Engine::MeshCache::Close(Engine::MeshCache::CachedMesh& Mesh)
+{
+    FileSystem::UnmapFile(Mesh.File);
+
+    Mesh.Info = nullptr;
+    Mesh.Vertices = nullptr;
+    Mesh.Indices = nullptr;
+    Mesh.Optimization = nullptr;
+    Mesh.Lods = nullptr;
+    Mesh.LodCount = 0;
+    Mesh.Meshlets = nullptr;
+    Mesh.MeshletCount = 0;
+    Mesh.Submeshes = nullptr;
+    Mesh.SubmeshCount = 0;
+    Mesh.MaterialTextures.clear();
+}
+
+void Engine::MeshCache::Write(const std::string& SourcePath, const Engine::Model& Model)
+{
+    Engine::MeshCache::Header Info{};
+    Info.Magic = Engine::MeshCache::Magic;
+    Info.Version = Engine::MeshCache::Version;
+    Info.VertexStride = sizeof(Vulkan::Renderer::Vertex);
+    Info.VertexCount = static_cast<uint32_t>(Model.Vertices.size());
+    Info.IndexCount = static_cast<uint32_t>(Model.Indices.size());
+
+    Info.BoundsMin[0] = Model.BoundsMin.x;
+    Info.BoundsMin[1] = Model.BoundsMin.y;
+    Info.BoundsMin[2] = Model.BoundsMin.z;
+    Info.BoundsMax[0] = Model.BoundsMax.x;
+    Info.BoundsMax[1] = Model.BoundsMax.y;
+    Info.BoundsMax[2] = Model.BoundsMax.z;
+
+    if (!StampSource(SourcePath, Info))
+    {
+        return;
+    }
+
+    std::string GenericPath = fs::path(SourcePath).generic_string();
+
+    std::string MaterialTextures;
+
+    for (const auto& Texture : Model.MaterialTextures)
+    {
+        MaterialTextures.append(Texture);
+        MaterialTextures.push_back('\0');
+    }
+
+    struct Payload
+    {
+        Engine::MeshCache::ChunkType Type;
+        const void* Data;
+        uint64_t Size;
+    };
+
+    std::vector<Payload> Payloads = {
+        { Engine::MeshCache::ChunkType::SourcePath, GenericPath.data(), GenericPath.size() },
+        { Engine::MeshCache::ChunkType::Vertices, Model.Vertices.data(), Model.Vertices.size() * sizeof(Vulkan::Renderer::Vertex) },
+        { Engine::MeshCache::ChunkType::Indices, Model.Indices.data(), Model.Indices.size() * sizeof(uint32_t) },
+        { Engine::MeshCache::ChunkType::OptimizationReport, &Model.Optimization, sizeof(Model.Optimization) },
+        { Engine::MeshCache::ChunkType::Lods, Model.Lods.data(), Model.Lods.size() * sizeof(Engine::MeshSimplifier::Lod) },
+        { Engine::MeshCache::ChunkType::Meshlets, Model.Meshlets.data(), Model.Meshlets.size() * sizeof(Engine::Meshlets::Meshlet) },
+        { Engine::MeshCache::ChunkType::Submeshes, Model.Submeshes.data(), Model.Submeshes.size() * sizeof(Engine::Model::Submesh) },
+        { Engine::MeshCache::ChunkType::MaterialTextures, MaterialTextures.data(), MaterialTextures.size() }
+    };
+
+    Info.ChunkCount = static_cast<uint32_t>(Payloads.size());
+
+    std::vector<Engine::MeshCache::Chunk> Chunks(Payloads.size());
+    uint64_t Offset = AlignChunk(sizeof(Engine::MeshCache::Header) + Chunks.size() * sizeof(Engine::MeshCache::Chunk));
+
+    for (size_t i = 0; i < Payloads.size(); i++)
+    {
+        Chunks[i].Type = static_cast<uint32_t>(Payloads[i].Type);
+        Chunks[i].Reserved = 0;
+        Chunks[i].Offset = Offset;
+        Chunks[i].Size = Payloads[i].Size;
+
+        Offset = AlignChunk(Offset + Payloads[i].Size);
+    }
+
+    std::error_code Error;
+    fs::create_directories(Engine::MeshCache::CacheDirectory, Error);
+
+    /*
+        Written to a temporary file first so a crash mid-write never leaves a valid-looking cache behind
+    */
+
+    std::string CachePath = Engine::MeshCache::GetCachePath(SourcePath);
+    std::string TempPath = CachePath + ".tmp";
+
+    std::ofstream File(TempPath, std::ios::binary | std::ios::trunc);
+
+    if (!File.is_open())
+    {
+        std::cout << "MESHCACHE > Failed to write cache " << CachePath << std::endl;
+        return;
+    }
+
+    const char Padding[16] = {};
+
+    File.write(reinterpret_cast<const char*>(&Info), sizeof(Info));
+    File.write(reinterpret_cast<const char*>(Chunks.data()), Chunks.size() * sizeof(Engine::MeshCache::Chunk));
+
+    for (size_t i = 0; i < Payloads.size(); i++)
+    {
+        File.write(Padding, static_cast<std::streamsize>(Chunks[i].Offset - static_cast<uint64_t>(File.tellp())));
+        File.write(static_cast<const char*>(Payloads[i].Data), static_cast<std::streamsize>(Payloads[i].Size));
+    }
+
+    File.close();
+
+    if (!File)
+    {
+        fs::remove(TempPath, Error);
+        std::cout << "MESHCACHE > Failed to write cache " << CachePath << std::endl;
+        return;
+    }
+
+    ReplaceCache(TempPath, CachePath);
+
+    std::cout << "MESHCACHE > Wrote " << CachePath << " (" << Offset << " bytes)" << std::endl;
+}
+
+Engine::MeshCache::StreamWriter::~StreamWriter()
+{
+    if (File.is_open())
+    {
+        File.close();
+
+        std::error_code Error;
+        fs::remove(TempPath, Error);
+    }
+}
+
+bool Engine::MeshCache::StreamWriter::Open(const std::string& Path)
+{
+    SourcePath = Path;
+
+    Info = {};
+    Info.Magic = Engine::MeshCache::Magic;
+    Info.Version = Engine::MeshCache::Version;
+    Info.VertexStride = sizeof(Vulkan::Renderer::Vertex);
+
+    if (!StampSource(SourcePath, Info))
+    {
+        return false;
+    }
+
+    std::error_code Error;
+    fs::create_directories(Engine::MeshCache::CacheDirectory, Error);
+
+    TempPath = Engine::MeshCache::GetCachePath(SourcePath) + ".tmp";
+
+    File.open(TempPath, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+
+    if (!File.is_open())
+    {
+        std::cout << "MESHCACHE > Failed to write cache " << Engine::MeshCache::GetCachePath(SourcePath) << std::endl;
+        return false;
+    }
+
+    /*
+        Room for the header and a fixed size table, the payloads start right after
+    */
+
+    Chunks.clear();
+    End = AlignChunk(sizeof(Engine::MeshCache::Header) + Engine::MeshCache::StreamWriter::MaxChunks * sizeof(Engine::MeshCache::Chunk));
+
+    return true;
+}
+
+uint64_t Engine::MeshCache::StreamWriter::Reserve(Engine::MeshCache::ChunkType Type, uint64_t Size)
+{
+    if (Chunks.size() == Engine::MeshCache::StreamWriter::MaxChunks)
+    {
+        throw std::runtime_error("MESHCACHE > Too many chunks in streamed cache for " + SourcePath);
+    }
+
+    End = AlignChunk(End);
+
+    Chunks.push_back({ static_cast<uint32_t>(Type), 0, End, Size });
+    End += Size;
+
+    return Chunks.back().Offset;
+}
+
+void Engine::MeshCache::StreamWriter::WriteAt(uint64_t Offset, const void* Data, uint64_t Size)
+{
+    File.seekp(static_cast<std::streamoff>(Offset));
+    File.write(static_cast<const char*>(Data), static_cast<std::streamsize>(Size));
+}
+
+void Engine::MeshCache::StreamWriter::Move(uint64_t From, uint64_t To, uint64_t Size)
+{
+    /*
+        Front to back in fixed windows, with To below From nothing is overwritten before it was read
+    */
+
+    if (To > From)
+    {
+        throw std::runtime_error("MESHCACHE > Streamed cache data can only move towards the start of " + SourcePath);
+    }
+
+    std::vector<char> Window(static_cast<size_t>(std::min<uint64_t>(Size, 256 * 1024)));
+
+    for (uint64_t Done = 0; Done < Size;)
+    {
+        uint64_t Part = std::min<uint64_t>(Size - Done, Window.size());
+
+        File.seekg(static_cast<std::streamoff>(From + Done));
+        File.read(Window.data(), static_cast<std::streamsize>(Part));
+
+        Engine::MeshCache::StreamWriter::WriteAt(To + Done, Window.data(), Part);
+
+        Done += Part;
+    }
+}
+
+void Engine::MeshCache::StreamWriter::Shrink(uint64_t Offset, uint64_t Size)
+{
+    for (auto& Entry : Chunks)
+    {
+        if (Entry.Offset == Offset)
+        {
+            Entry.Size = std::min(Entry.Size, Size);
+            return;
+        }
+    }
+}
+
+void Engine::MeshCache::StreamWriter::Append(Engine::MeshCache::ChunkType Type, const void* Data, uint64_t Size)
+{
+    if (Chunks.empty() || Chunks.back().Type != static_cast<uint32_t>(Type) || Chunks.back().Offset + Chunks.back().Size != End)
+    {
+        Engine::MeshCache::StreamWriter::Reserve(Type, 0);
+    }
+
+    Engine::MeshCache::StreamWriter::WriteAt(End, Data, Size);
+
+    Chunks.back().Size += Size;
+    End += Size;
+}
+
+bool Engine::MeshCache::StreamWriter::Finish(uint32_t VertexCount, uint32_t IndexCount, const glm::vec3& BoundsMin, const glm::vec3& BoundsMax)
+{
+    Info.VertexCount = VertexCount;
+    Info.IndexCount = IndexCount;
+    Info.ChunkCount = static_cast<uint32_t>(Chunks.size());
+
+    Info.BoundsMin[0] = BoundsMin.x;
+    Info.BoundsMin[1] = BoundsMin.y;
+    Info.BoundsMin[2] = BoundsMin.z;
+    Info.BoundsMax[0] = BoundsMax.x;
+    Info.BoundsMax[1] = BoundsMax.y;
+    Info.BoundsMax[2] = BoundsMax.z;
+
+    /*
+        Reserved chunks that were never fully written must still read back as zeros, so the file is
+        extended to its full length before the table goes in
+    */
+
+    File.seekp(0, std::ios::end);
+
+    uint64_t Written = static_cast<uint64_t>(File.tellp());
+
+    if (Written < End)
+    {
+        const char Zero = 0;
+        Engine::MeshCache::StreamWriter::WriteAt(End - 1, &Zero, 1);
+    }
+
+    Engine::MeshCache::StreamWriter::WriteAt(0, &Info, sizeof(Info));
+    Engine::MeshCache::StreamWriter::WriteAt(sizeof(Info), Chunks.data(), Chunks.size() * sizeof(Engine::MeshCache::Chunk));
+
+    File.close();
+
+    std::string CachePath = Engine::MeshCache::GetCachePath(SourcePath);
+
+    if (!File)
+    {
+        std::error_code Error;
+        fs::remove(TempPath, Error);
+
+        std::cout << "MESHCACHE > Failed to write cache " << CachePath << std::endl;
+        return false;
+    }
+
+    ReplaceCache(TempPath, CachePath);
+
+    std::cout << "MESHCACHE > Streamed " << CachePath << " (" << End << " bytes)" << std::endl;
+
+    return true;
+}
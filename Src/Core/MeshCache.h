@@ -0,0 +1,124 @@
+#pragma once
+
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include "FileSystem/FileSystem.h"
+#include "Model.h"
+
+namespace Engine
+{
+	/*
+		Versioned binary cache of fully processed meshes, so warm starts skip OBJ parsing entirely.
+
+		Layout: Header, Chunk table, then the chunk payloads. Every payload is 16 byte aligned so
+		vertex and index data can be copied straight out of the mapped file.
+	*/
+
+	namespace MeshCache
+	{
+		const uint32_t Magic = 0x434D5141; // "AQMC"
+		const uint32_t Version = 5;
+
+		extern std::string CacheDirectory;
+
+		enum class ChunkType : uint32_t
+		{
+			SourcePath = 0,
+			Vertices = 1,
+			Indices = 2,
+			OptimizationReport = 3,
+			Lods = 4,
+			Meshlets = 5,
+			Submeshes = 6,
+			MaterialTextures = 7
+		};
+
+		struct Header
+		{
+			uint32_t Magic;
+			uint32_t Version;
+
+			uint64_t SourceSize;
+			int64_t SourceTime;
+			uint64_t SourceHash;
+
+			uint32_t VertexStride;
+			uint32_t VertexCount;
+			uint32_t IndexCount;
+			uint32_t ChunkCount;
+
+			float BoundsMin[3];
+			float BoundsMax[3];
+		};
+
+		struct Chunk
+		{
+			uint32_t Type;
+			uint32_t Reserved;
+			uint64_t Offset;
+			uint64_t Size;
+		};
+
+		struct CachedMesh
+		{
+			FileSystem::MappedFile File;
+
+			const Header* Info = nullptr;
+			const Vulkan::Renderer::Vertex* Vertices = nullptr;
+			const uint32_t* Indices = nullptr;
+			const Engine::MeshOptimizer::Report* Optimization = nullptr;
+			const Engine::MeshSimplifier::Lod* Lods = nullptr;
+			uint32_t LodCount = 0;
+			const Engine::Meshlets::Meshlet* Meshlets = nullptr;
+			uint32_t MeshletCount = 0;
+			const Engine::Model::Submesh* Submeshes = nullptr;
+			uint32_t SubmeshCount = 0;
+			std::vector<std::string> MaterialTextures;
+		};
+
+		std::string GetCachePath(const std::string& SourcePath);
+
+		bool Open(const std::string& SourcePath, CachedMesh& Mesh);
+		void Close(CachedMesh& Mesh);
+		void Write(const std::string& SourcePath, const Engine::Model& Model);
+
+		const void* FindChunk(const CachedMesh& Mesh, ChunkType Type, uint64_t& Size);
+
+		/*
+			Builds a cache file piece by piece for meshes too large to assemble in memory first.
+
+			Reserve places a chunk of known size and returns its file offset for WriteAt, Append grows
+			the last chunk (or starts one) so its size doesn't have to be known. Move copies data already
+			written to a lower offset and Shrink cuts a reserved chunk down to what was used. The header
+			and chunk table are only written by Finish, an abandoned writer never leaves a usable cache
+			behind.
+		*/
+
+		class StreamWriter
+		{
+		public:
+			static const uint32_t MaxChunks = 16;
+
+			~StreamWriter();
+
+			bool Open(const std::string& SourcePath);
+			uint64_t Reserve(ChunkType Type, uint64_t Size);
+			void WriteAt(uint64_t Offset, const void* Data, uint64_t Size);
+			void Move(uint64_t From, uint64_t To, uint64_t Size);
+			void Shrink(uint64_t Offset, uint64_t Size);
+			void Append(ChunkType Type, const void* Data, uint64_t Size);
+			bool Finish(uint32_t VertexCount, uint32_t IndexCount, const glm::vec3& BoundsMin, const glm::vec3& BoundsMax);
+
+		private:
+			std::fstream File;
+			std::string SourcePath;
+			std::string TempPath;
+			Header Info{};
+			std::vector<Chunk> Chunks;
+			uint64_t End = 0;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,448 @@
+#include "../Common.h"
+#include "./API/Vulkan/Renderer.h"
+#include "MeshOptimizer.h"
+
+namespace
+{
+    /*
+        Triangle lists per vertex, stored as offsets into one flat array
+    */
+
+    struct Adjacency
+    {
+        std::vector<uint32_t> Counts;
+        std::vector<uint32_t> Offsets;
+        std::vector<uint32_t> Triangles;
+    };
+
+    void BuildAdjacency(Adjacency& Result, const std::vector<uint32_t>& Indices, size_t VertexCount)
+    {
+        size_t TriangleCount = Indices.size() / 3;
+
+        Result.Counts.assign(VertexCount, 0);
+        Result.Offsets.assign(VertexCount, 0);
+        Result.Triangles.resize(TriangleCount * 3);
+
+        for (uint32_t Index : Indices)
+        {
+            Result.Counts[Index]++;
+        }
+
+        uint32_t Offset = 0;
+
+        for (size_t i = 0; i < VertexCount; i++)
+        {
+            Result.Offsets[i] = Offset;
+            Offset += Result.Counts[i];
+        }
+
+        std::vector<uint32_t> Cursor = Result.Offsets;
+
+        for (size_t i = 0; i < TriangleCount * 3; i++)
+        {
+            Result.Triangles[Cursor[Indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    /*
+        FIFO cache simulation, returns the number of misses for one triangle
+    */
+
+    struct CacheSimulator
+    {
+        std::vector<uint32_t> Timestamps;
+        uint32_t Time;
+        uint32_t Size;
+
+        CacheSimulator(size_t VertexCount, uint32_t CacheSize) : Timestamps(VertexCount, 0), Time(CacheSize + 1), Size(CacheSize) {}
+
+        void Reset()
+        {
+            Time += Size + 1;
+        }
+
+        uint32_t Process(const uint32_t* Triangle)
+        {
+            uint32_t Misses = 0;
+
+            for (int k = 0; k < 3; k++)
+            {
+                if (Time - Timestamps[Triangle[k]] > Size)
+                {
+                    Timestamps[Triangle[k]] = Time++;
+                    Misses++;
+                }
+            }
+
+            return Misses;
+        }
+    };
+}
+
+Engine::MeshOptimizer::Statistics Engine::MeshOptimizer::AnalyzeVertexCache(const uint32_t* Indices, size_t IndexCount, size_t VertexCount, uint32_t CacheSize)
+{
+    Engine::MeshOptimizer::Statistics Result{};
+
+    if (IndexCount < 3 || VertexCount == 0)
+    {
+        return Result;
+    }
+
+    CacheSimulator Cache(VertexCount, CacheSize);
+    std::vector<char> Referenced(VertexCount, 0);
+
+    size_t Misses = 0;
+    size_t UniqueVertices = 0;
+
+    for (size_t i = 0; i + 2 < IndexCount; i += 3)
+    {
+        Misses += Cache.Process(Indices + i);
+    }
+
+    for (size_t i = 0; i < IndexCount; i++)
+    {
+        if (!Referenced[Indices[i]])
+        {
+            Referenced[Indices[i]] = 1;
+            UniqueVertices++;
+        }
+    }
+
+    Result.ACMR = static_cast<float>(Misses) / static_cast<float>(IndexCount / 3);
+    Result.ATVR = static_cast<float>(Misses) / static_cast<float>(UniqueVertices);
+
+    return Result;
+}
+
+void Engine::MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& Indices, size_t VertexCount, std::vector<uint32_t>* Clusters)
+{
+    size_t TriangleCount = Indices.size() / 3;
+
+    if (TriangleCount == 0)
+    {
+        return;
+    }
+
+    Adjacency Adjacent;
+    BuildAdjacency(Adjacent, Indices, VertexCount);
+
+    std::vector<uint32_t> LiveTriangles = Adjacent.Counts;
+    std::vector<uint32_t> CacheTimestamps(VertexCount, 0);
+    std::vector<char> Emitted(TriangleCount, 0);
+
+    std::vector<uint32_t> DeadEnd;
+    DeadEnd.reserve(Indices.size());
+
+    std::vector<uint32_t> Candidates;
+    Candidates.reserve(64);
+
+    std::vector<uint32_t> Result;
+    Result.reserve(Indices.size());
+
+    if (Clusters != nullptr)
+    {
+        Clusters->clear();
+    }
+
+    uint32_t Time = Engine::MeshOptimizer::CacheSize + 1;
+    size_t Cursor = 0;
+
+    /*
+        Restarts after a dead end break cache locality, those are where overdraw clusters may split
+    */
+
+    auto SkipDeadEnd = [&]() -> int64_t
+    {
+        while (!DeadEnd.empty())
+        {
+            uint32_t Vertex = DeadEnd.back();
+            DeadEnd.pop_back();
+
+            if (LiveTriangles[Vertex] > 0)
+            {
+                return Vertex;
+            }
+        }
+
+        while (Cursor < VertexCount)
+        {
+            if (LiveTriangles[Cursor] > 0)
+            {
+                return static_cast<int64_t>(Cursor);
+            }
+
+            Cursor++;
+        }
+
+        return -1;
+    };
+
+    int64_t Fanning = SkipDeadEnd();
+
+    if (Clusters != nullptr)
+    {
+        Clusters->push_back(0);
+    }
+
+    while (Fanning >= 0)
+    {
+        Candidates.clear();
+
+        uint32_t Begin = Adjacent.Offsets[Fanning];
+        uint32_t End = Begin + Adjacent.Counts[Fanning];
+
+        for (uint32_t i = Begin; i < End; i++)
+        {
+            uint32_t Triangle = Adjacent.Triangles[i];
+
+            if (Emitted[Triangle])
+            {
+                continue;
+            }
+
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t Vertex = Indices[Triangle * 3 + k];
+
+                Result.push_back(Vertex);
+                DeadEnd.push_back(Vertex);
+                Candidates.push_back(Vertex);
+
+                LiveTriangles[Vertex]--;
+
+                if (Time - CacheTimestamps[Vertex] > Engine::MeshOptimizer::CacheSize)
+                {
+                    CacheTimestamps[Vertex] = Time++;
+                }
+            }
+
+            Emitted[Triangle] = 1;
+        }
+
+        int64_t Next = -1;
+        int64_t BestPriority = -1;
+
+        for (uint32_t Vertex : Candidates)
+        {
+            if (LiveTriangles[Vertex] == 0)
+            {
+                continue;
+            }
+
+            int64_t Priority = 0;
+
+            if (Time - CacheTimestamps[Vertex] + 2 * LiveTriangles[Vertex] <= Engine::MeshOptimizer::CacheSize)
+            {
+                Priority = Time - CacheTimestamps[Vertex];
+            }
+
+            if (Priority > BestPriority)
+            {
+                BestPriority = Priority;
+                Next = Vertex;
+            }
+        }
+
+        if (Next == -1)
+        {
+            Next = SkipDeadEnd();
+
+            if (Next >= 0 && Clusters != nullptr && Clusters->back() != Result.size() / 3)
+            {
+                Clusters->push_back(static_cast<uint32_t>(Result.size() / 3));
+            }
+        }
+
+        Fanning = Next;
+    }
+
+    Indices.swap(Result);
+}
+
+void Engine::MeshOptimizer::OptimizeOverdraw(std::vector<uint32_t>& Indices, const std::vector<Vulkan::Renderer::Vertex>& Vertices, const std::vector<uint32_t>& HardClusters, float Threshold)
+{
+    size_t TriangleCount = Indices.size() / 3;
+
+    if (TriangleCount == 0 || HardClusters.empty())
+    {
+        return;
+    }
+
+    /*
+        Split hard clusters further wherever the running ACMR drops back under the cluster's own ACMR,
+        that keeps most of the cache gains while giving the sort smaller pieces to work with
+    */
+
+    std::vector<uint32_t> Clusters;
+    CacheSimulator Cache(Vertices.size(), Engine::MeshOptimizer::CacheSize);
+
+    for (size_t c = 0; c < HardClusters.size(); c++)
+    {
+        uint32_t Begin = HardClusters[c];
+        uint32_t End = (c + 1 < HardClusters.size()) ? HardClusters[c + 1] : static_cast<uint32_t>(TriangleCount);
+
+        Cache.Reset();
+
+        uint32_t ClusterMisses = 0;
+
+        for (uint32_t t = Begin; t < End; t++)
+        {
+            ClusterMisses += Cache.Process(&Indices[t * 3]);
+        }
+
+        float ClusterACMR = static_cast<float>(ClusterMisses) / static_cast<float>(End - Begin);
+
+        Clusters.push_back(Begin);
+        Cache.Reset();
+
+        uint32_t SegmentStart = Begin;
+        uint32_t SegmentMisses = 0;
+
+        for (uint32_t t = Begin; t < End; t++)
+        {
+            SegmentMisses += Cache.Process(&Indices[t * 3]);
+
+            uint32_t SegmentTriangles = t + 1 - SegmentStart;
+
+            if (t + 1 < End && static_cast<float>(SegmentMisses) <= ClusterACMR * Threshold * static_cast<float>(SegmentTriangles) && SegmentTriangles >= 16)
+            {
+                Clusters.push_back(t + 1);
+
+                SegmentStart = t + 1;
+                SegmentMisses = 0;
+                Cache.Reset();
+            }
+        }
+    }
+
+    glm::vec3 MeshCentroid(0.0f);
+    float MeshArea = 0.0f;
+
+    std::vector<float> SortKeys(Clusters.size());
+
+    std::vector<glm::vec3> ClusterCentroids(Clusters.size(), glm::vec3(0.0f));
+    std::vector<glm::vec3> ClusterNormals(Clusters.size(), glm::vec3(0.0f));
+
+    for (size_t c = 0; c < Clusters.size(); c++)
+    {
+        uint32_t Begin = Clusters[c];
+        uint32_t End = (c + 1 < Clusters.size()) ? Clusters[c + 1] : static_cast<uint32_t>(TriangleCount);
+
+        float ClusterArea = 0.0f;
+
+        for (uint32_t t = Begin; t < End; t++)
+        {
+            const glm::vec3& A = Vertices[Indices[t * 3 + 0]].Pos;
+            const glm::vec3& B = Vertices[Indices[t * 3 + 1]].Pos;
+            const glm::vec3& C = Vertices[Indices[t * 3 + 2]].Pos;
+
+            glm::vec3 Normal = glm::cross(B - A, C - A);
+            float Area = glm::length(Normal);
+
+            ClusterCentroids[c] += (A + B + C) * (Area / 3.0f);
+            ClusterNormals[c] += Normal;
+            ClusterArea += Area;
+        }
+
+        MeshCentroid += ClusterCentroids[c];
+        MeshArea += ClusterArea;
+
+        ClusterCentroids[c] = ClusterArea > 0.0f ? ClusterCentroids[c] / ClusterArea : Vertices[Indices[Begin * 3]].Pos;
+    }
+
+    MeshCentroid = MeshArea > 0.0f ? MeshCentroid / MeshArea : glm::vec3(0.0f);
+
+    for (size_t c = 0; c < Clusters.size(); c++)
+    {
+        float Length = glm::length(ClusterNormals[c]);
+        glm::vec3 Normal = Length > 0.0f ? ClusterNormals[c] / Length : glm::vec3(0.0f);
+
+        SortKeys[c] = glm::dot(ClusterCentroids[c] - MeshCentroid, Normal);
+    }
+
+    /*
+        Clusters facing away from the centre are the most likely occluders, draw them first
+    */
+
+    std::vector<uint32_t> Order(Clusters.size());
+
+    for (size_t c = 0; c < Order.size(); c++)
+    {
+        Order[c] = static_cast<uint32_t>(c);
+    }
+
+    std::stable_sort(Order.begin(), Order.end(), [&](uint32_t A, uint32_t B) { return SortKeys[A] > SortKeys[B]; });
+
+    std::vector<uint32_t> Result;
+    Result.reserve(Indices.size());
+
+    for (uint32_t c : Order)
+    {
+        uint32_t Begin = Clusters[c];
+        uint32_t End = (c + 1 < Clusters.size()) ? Clusters[c + 1] : static_cast<uint32_t>(TriangleCount);
+
+        Result.insert(Result.end(), Indices.begin() + Begin * 3, Indices.begin() + End * 3);
+    }
+
+    Indices.swap(Result);
+}
+
+void Engine::MeshOptimizer::OptimizeVertexFetch(std::vector<uint32_t>& Indices, std::vector<Vulkan::Renderer::Vertex>& Vertices)
+{
+    const uint32_t Unused = 0xFFFFFFFF;
+
+    std::vector<uint32_t> Remap(Vertices.size(), Unused);
+    std::vector<Vulkan::Renderer::Vertex> Result;
+    Result.reserve(Vertices.size());
+
+    for (uint32_t& Index : Indices)
+    {
+        if (Remap[Index] == Unused)
+        {
+            Remap[Index] = static_cast<uint32_t>(Result.size());
+            Result.push_back(Vertices[Index]);
+        }
+
+        Index = Remap[Index];
+    }
+
+    Vertices.swap(Result);
+}
+
+Engine::MeshOptimizer::Report Engine::MeshOptimizer::Optimize(std::vector<uint32_t>& Indices, std::vector<Vulkan::Renderer::Vertex>& Vertices, const std::vector<uint32_t>& Boundaries)
+{
+    Engine::MeshOptimizer::Report Result{};
+    Result.Before = Engine::MeshOptimizer::AnalyzeVertexCache(Indices.data(), Indices.size(), Vertices.size());
+
+    std::vector<uint32_t> Clusters;
+
+    if (Boundaries.size() < 2)
+    {
+        Engine::MeshOptimizer::OptimizeVertexCache(Indices, Vertices.size(), &Clusters);
+        Engine::MeshOptimizer::OptimizeOverdraw(Indices, Vertices, Clusters);
+    }
+    else
+    {
+        std::vector<uint32_t> Range;
+
+        for (size_t i = 0; i + 1 < Boundaries.size(); i++)
+        {
+            Range.assign(Indices.begin() + Boundaries[i], Indices.begin() + Boundaries[i + 1]);
+
+            Engine::MeshOptimizer::OptimizeVertexCache(Range, Vertices.size(), &Clusters);
+            Engine::MeshOptimizer::OptimizeOverdraw(Range, Vertices, Clusters);
+
+            std::copy(Range.begin(), Range.end(), Indices.begin() + Boundaries[i]);
+        }
+    }
+
+    /*
+        Fetch order only renames vertices, triangle order is untouched
+    */
+
+    Engine::MeshOptimizer::OptimizeVertexFetch(Indices, Vertices);
+
+    Result.After = Engine::MeshOptimizer::AnalyzeVertexCache(Indices.data(), Indices.size(), Vertices.size());
+
+    return Result;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#ifndef MESHOPTIMIZER_H
+#define MESHOPTIMIZER_H
+
+namespace Engine
+{
+	/*
+		Post load index and vertex reordering.
+
+		Vertex cache order uses Tipsify (Sander, Nehab, Barczak 2007), overdraw order sorts the resulting
+		clusters front facing first by their distance from the mesh centroid, and vertex fetch order
+		remaps vertices to first use so the vertex buffer is read linearly.
+	*/
+
+	namespace MeshOptimizer
+	{
+		const uint32_t CacheSize = 16;
+		const float OverdrawThreshold = 1.05f;
+
+		struct Statistics
+		{
+			float ACMR = 0.0f; // post-transform cache misses per triangle
+			float ATVR = 0.0f; // post-transform cache misses per vertex
+		};
+
+		struct Report
+		{
+			Statistics Before;
+			Statistics After;
+		};
+
+		Statistics AnalyzeVertexCache(const uint32_t* Indices, size_t IndexCount, size_t VertexCount, uint32_t CacheSize = Engine::MeshOptimizer::CacheSize);
+
+		void OptimizeVertexCache(std::vector<uint32_t>& Indices, size_t VertexCount, std::vector<uint32_t>* Clusters = nullptr);
+		void OptimizeOverdraw(std::vector<uint32_t>& Indices, const std::vector<Vulkan::Renderer::Vertex>& Vertices, const std::vector<uint32_t>& HardClusters, float Threshold = Engine::MeshOptimizer::OverdrawThreshold);
+		void OptimizeVertexFetch(std::vector<uint32_t>& Indices, std::vector<Vulkan::Renderer::Vertex>& Vertices);
+
+		/*
+			All three passes in order, returns cache statistics for the original and optimized meshes.
+			Boundaries splits Indices into ranges (submeshes) that are reordered independently, triangles
+			never move between ranges.
+		*/
+
+		Report Optimize(std::vector<uint32_t>& Indices, std::vector<Vulkan::Renderer::Vertex>& Vertices, const std::vector<uint32_t>& Boundaries = {});
+	}
+}
+
+#endif
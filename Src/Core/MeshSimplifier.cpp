@@ -0,0 +1,580 @@
+#include "../Common.h"
+#include "./API/Vulkan/Renderer.h"
+#include "MeshSimplifier.h"
+#include "Hash.h"
+
+#include <unordered_map>
+
+namespace
+{
+    const uint32_t Invalid = 0xFFFFFFFF;
+
+    /*
+        Borders get an extra perpendicular plane so they resist moving inwards
+    */
+
+    const float BorderWeight = 10.0f;
+
+    enum class VertexKind : uint8_t { Manifold, Border, Seam, Locked };
+
+    struct Quadric
+    {
+        double A00 = 0, A11 = 0, A22 = 0, A01 = 0, A02 = 0, A12 = 0;
+        double B0 = 0, B1 = 0, B2 = 0;
+        double C = 0;
+        double Weight = 0;
+
+        void AddPlane(const glm::vec3& Normal, double Distance, double PlaneWeight)
+        {
+            A00 += PlaneWeight * Normal.x * Normal.x;
+            A11 += PlaneWeight * Normal.y * Normal.y;
+            A22 += PlaneWeight * Normal.z * Normal.z;
+            A01 += PlaneWeight * Normal.x * Normal.y;
+            A02 += PlaneWeight * Normal.x * Normal.z;
+            A12 += PlaneWeight * Normal.y * Normal.z;
+            B0 += PlaneWeight * Normal.x * Distance;
+            B1 += PlaneWeight * Normal.y * Distance;
+            B2 += PlaneWeight * Normal.z * Distance;
+            C += PlaneWeight * Distance * Distance;
+            Weight += PlaneWeight;
+        }
+
+        void Add(const Quadric& Other)
+        {
+            A00 += Other.A00; A11 += Other.A11; A22 += Other.A22;
+            A01 += Other.A01; A02 += Other.A02; A12 += Other.A12;
+            B0 += Other.B0; B1 += Other.B1; B2 += Other.B2;
+            C += Other.C;
+            Weight += Other.Weight;
+        }
+
+        /*
+            Weighted mean squared distance from the accumulated planes
+        */
+
+        double Evaluate(const glm::vec3& Point) const
+        {
+            double X = Point.x, Y = Point.y, Z = Point.z;
+
+            double Result = A00 * X * X + A11 * Y * Y + A22 * Z * Z
+                + 2.0 * (A01 * X * Y + A02 * X * Z + A12 * Y * Z)
+                + 2.0 * (B0 * X + B1 * Y + B2 * Z)
+                + C;
+
+            return Weight > 0.0 ? std::max(Result, 0.0) / Weight : 0.0;
+        }
+    };
+
+    struct PositionHash
+    {
+        size_t operator()(const glm::vec3& Position) const
+        {
+            return static_cast<size_t>(Engine::Hash::Bytes(&Position, sizeof(Position)));
+        }
+    };
+
+    struct PositionEqual
+    {
+        bool operator()(const glm::vec3& A, const glm::vec3& B) const
+        {
+            return memcmp(&A, &B, sizeof(glm::vec3)) == 0;
+        }
+    };
+
+    inline uint64_t EdgeKey(uint32_t A, uint32_t B)
+    {
+        return A < B ? (uint64_t(A) << 32) | B : (uint64_t(B) << 32) | A;
+    }
+
+    struct EdgeInfo
+    {
+        uint32_t Count = 0;
+        uint64_t Wedges = 0;
+        bool Seam = false;
+    };
+
+    struct Collapse
+    {
+        uint32_t From;
+        uint32_t To;
+        double Cost;
+    };
+
+    float AttributeDistance(const Vulkan::Renderer::Vertex& A, const Vulkan::Renderer::Vertex& B)
+    {
+        glm::vec2 UV = A.UV - B.UV;
+        glm::vec3 Normal = A.Normal - B.Normal;
+
+        return glm::dot(UV, UV) + glm::dot(Normal, Normal);
+    }
+}
+
+std::vector<uint32_t> Engine::MeshSimplifier::Simplify(const std::vector<uint32_t>& Indices, const std::vector<Vulkan::Renderer::Vertex>& Vertices, size_t TargetIndexCount, float TargetError, float& ResultError)
+{
+    ResultError = 0.0f;
+
+    std::vector<uint32_t> Result = Indices;
+
+    if (Indices.size() <= TargetIndexCount || Vertices.empty())
+    {
+        return Result;
+    }
+
+    size_t VertexCount = Vertices.size();
+
+    /*
+        Every vertex points at the first vertex with the same position, collapses work on those
+    */
+
+    std::vector<uint32_t> PositionOf(VertexCount);
+    std::vector<uint32_t> WedgeNext(VertexCount);
+
+    {
+        std::unordered_map<glm::vec3, uint32_t, PositionHash, PositionEqual> FirstVertex;
+        FirstVertex.reserve(VertexCount);
+
+        std::vector<uint32_t> LastWedge(VertexCount, Invalid);
+
+        for (uint32_t i = 0; i < VertexCount; i++)
+        {
+            auto Inserted = FirstVertex.emplace(Vertices[i].Pos, i);
+            uint32_t First = Inserted.first->second;
+
+            PositionOf[i] = First;
+            WedgeNext[i] = i;
+
+            if (First != i)
+            {
+                /*
+                    Circular list of all vertices sharing a position
+                */
+
+                uint32_t Last = LastWedge[First] == Invalid ? First : LastWedge[First];
+
+                WedgeNext[i] = WedgeNext[Last];
+                WedgeNext[Last] = i;
+                LastWedge[First] = i;
+            }
+        }
+    }
+
+    std::vector<Quadric> Quadrics(VertexCount);
+
+    for (size_t t = 0; t + 2 < Result.size(); t += 3)
+    {
+        const glm::vec3& P0 = Vertices[Result[t + 0]].Pos;
+        const glm::vec3& P1 = Vertices[Result[t + 1]].Pos;
+        const glm::vec3& P2 = Vertices[Result[t + 2]].Pos;
+
+        glm::vec3 Normal = glm::cross(P1 - P0, P2 - P0);
+        float Area = glm::length(Normal);
+
+        if (Area <= 0.0f)
+        {
+            continue;
+        }
+
+        Normal /= Area;
+        double Distance = -glm::dot(Normal, P0);
+
+        for (int k = 0; k < 3; k++)
+        {
+            Quadrics[PositionOf[Result[t + k]]].AddPlane(Normal, Distance, Area);
+        }
+    }
+
+    std::vector<VertexKind> Kinds(VertexCount);
+    std::vector<char> Locked(VertexCount);
+    std::vector<uint32_t> TriangleOffsets(VertexCount + 1);
+    std::vector<uint32_t> TriangleList;
+    std::vector<uint32_t> VertexRemap(VertexCount);
+    std::unordered_map<uint64_t, EdgeInfo> Edges;
+
+    bool FirstPass = true;
+    double ErrorLimit = double(TargetError) * double(TargetError);
+
+    while (Result.size() > TargetIndexCount)
+    {
+        /*
+            Classify position edges: borders are used once, seams are used twice with different vertex pairs,
+            anything used more than twice is non-manifold and locks its endpoints
+        */
+
+        Edges.clear();
+        Edges.reserve(Result.size());
+
+        for (size_t t = 0; t + 2 < Result.size(); t += 3)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t V0 = Result[t + k];
+                uint32_t V1 = Result[t + (k + 1) % 3];
+
+                EdgeInfo& Edge = Edges[EdgeKey(PositionOf[V0], PositionOf[V1])];
+                uint64_t Wedges = EdgeKey(V0, V1);
+
+                if (Edge.Count == 0)
+                {
+                    Edge.Wedges = Wedges;
+                }
+                else if (Edge.Wedges != Wedges)
+                {
+                    Edge.Seam = true;
+                }
+
+                Edge.Count++;
+            }
+        }
+
+        std::vector<uint8_t> BorderEdges(VertexCount, 0);
+        std::vector<uint8_t> SeamEdges(VertexCount, 0);
+
+        std::fill(Kinds.begin(), Kinds.end(), VertexKind::Manifold);
+
+        for (const auto& Entry : Edges)
+        {
+            uint32_t A = static_cast<uint32_t>(Entry.first >> 32);
+            uint32_t B = static_cast<uint32_t>(Entry.first & 0xFFFFFFFF);
+
+            if (Entry.second.Count > 2)
+            {
+                Kinds[A] = Kinds[B] = VertexKind::Locked;
+            }
+            else if (Entry.second.Count == 1)
+            {
+                BorderEdges[A] = static_cast<uint8_t>(std::min(BorderEdges[A] + 1, 255));
+                BorderEdges[B] = static_cast<uint8_t>(std::min(BorderEdges[B] + 1, 255));
+            }
+            else if (Entry.second.Seam)
+            {
+                SeamEdges[A] = static_cast<uint8_t>(std::min(SeamEdges[A] + 1, 255));
+                SeamEdges[B] = static_cast<uint8_t>(std::min(SeamEdges[B] + 1, 255));
+            }
+        }
+
+        if (FirstPass)
+        {
+            /*
+                Border planes, perpendicular to the face and through the open edge
+            */
+
+            for (size_t t = 0; t + 2 < Result.size(); t += 3)
+            {
+                const glm::vec3& Q0 = Vertices[Result[t + 0]].Pos;
+                const glm::vec3& Q1 = Vertices[Result[t + 1]].Pos;
+                const glm::vec3& Q2 = Vertices[Result[t + 2]].Pos;
+
+                glm::vec3 FaceNormal = glm::cross(Q1 - Q0, Q2 - Q0);
+
+                for (int k = 0; k < 3; k++)
+                {
+                    uint32_t A = PositionOf[Result[t + k]];
+                    uint32_t B = PositionOf[Result[t + (k + 1) % 3]];
+
+                    if (Edges[EdgeKey(A, B)].Count != 1)
+                    {
+                        continue;
+                    }
+
+                    glm::vec3 EdgeDirection = Vertices[B].Pos - Vertices[A].Pos;
+                    glm::vec3 PlaneNormal = glm::cross(EdgeDirection, FaceNormal);
+
+                    float Length = glm::length(EdgeDirection);
+                    float PlaneLength = glm::length(PlaneNormal);
+
+                    if (Length <= 0.0f || PlaneLength <= 0.0f)
+                    {
+                        continue;
+                    }
+
+                    PlaneNormal /= PlaneLength;
+                    double Distance = -glm::dot(PlaneNormal, Vertices[A].Pos);
+
+                    Quadrics[A].AddPlane(PlaneNormal, Distance, double(Length) * Length * BorderWeight);
+                    Quadrics[B].AddPlane(PlaneNormal, Distance, double(Length) * Length * BorderWeight);
+                }
+            }
+        }
+
+        for (uint32_t i = 0; i < VertexCount; i++)
+        {
+            if (PositionOf[i] != i || Kinds[i] == VertexKind::Locked)
+            {
+                continue;
+            }
+
+            /*
+                Only simple borders and seams (exactly two such edges) can slide, corners stay put
+            */
+
+            if (BorderEdges[i] > 0)
+            {
+                Kinds[i] = (BorderEdges[i] == 2 && SeamEdges[i] == 0) ? VertexKind::Border : VertexKind::Locked;
+            }
+            else if (SeamEdges[i] > 0)
+            {
+                Kinds[i] = SeamEdges[i] == 2 ? VertexKind::Seam : VertexKind::Locked;
+            }
+        }
+
+        FirstPass = false;
+
+        /*
+            Triangles around each position
+        */
+
+        std::fill(TriangleOffsets.begin(), TriangleOffsets.end(), 0);
+
+        for (uint32_t Index : Result)
+        {
+            TriangleOffsets[PositionOf[Index] + 1]++;
+        }
+
+        for (size_t i = 0; i < VertexCount; i++)
+        {
+            TriangleOffsets[i + 1] += TriangleOffsets[i];
+        }
+
+        TriangleList.resize(Result.size());
+
+        {
+            std::vector<uint32_t> Cursor(TriangleOffsets.begin(), TriangleOffsets.end() - 1);
+
+            for (size_t i = 0; i < Result.size(); i++)
+            {
+                TriangleList[Cursor[PositionOf[Result[i]]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        /*
+            Pick the cheaper legal direction for every edge
+        */
+
+        std::vector<Collapse> Candidates;
+        Candidates.reserve(Edges.size());
+
+        auto CanCollapse = [&](uint32_t From, uint32_t To, const EdgeInfo& Edge)
+        {
+            switch (Kinds[From])
+            {
+            case VertexKind::Manifold:
+                return true;
+            case VertexKind::Border:
+                return Edge.Count == 1;
+            case VertexKind::Seam:
+                return Edge.Count == 2 && Edge.Seam && Kinds[To] != VertexKind::Manifold;
+            default:
+                return false;
+            }
+        };
+
+        for (const auto& Entry : Edges)
+        {
+            uint32_t A = static_cast<uint32_t>(Entry.first >> 32);
+            uint32_t B = static_cast<uint32_t>(Entry.first & 0xFFFFFFFF);
+
+            Quadric Merged = Quadrics[A];
+            Merged.Add(Quadrics[B]);
+
+            Collapse Best{ Invalid, Invalid, std::numeric_limits<double>::max() };
+
+            if (CanCollapse(A, B, Entry.second))
+            {
+                Best = { A, B, Merged.Evaluate(Vertices[B].Pos) };
+            }
+
+            if (CanCollapse(B, A, Entry.second))
+            {
+                double Cost = Merged.Evaluate(Vertices[A].Pos);
+
+                if (Cost < Best.Cost)
+                {
+                    Best = { B, A, Cost };
+                }
+            }
+
+            if (Best.From != Invalid && Best.Cost <= ErrorLimit)
+            {
+                Candidates.push_back(Best);
+            }
+        }
+
+        if (Candidates.empty())
+        {
+            break;
+        }
+
+        std::sort(Candidates.begin(), Candidates.end(), [](const Collapse& A, const Collapse& B) { return A.Cost < B.Cost; });
+
+        /*
+            Apply as many independent collapses as possible, a collapse locks the whole one-ring of its source
+            so flip checks always see current positions
+        */
+
+        std::fill(Locked.begin(), Locked.end(), 0);
+
+        for (uint32_t i = 0; i < VertexCount; i++)
+        {
+            VertexRemap[i] = i;
+        }
+
+        size_t TriangleCount = Result.size() / 3;
+        size_t TargetTriangles = TargetIndexCount / 3;
+        size_t Collapsed = 0;
+
+        for (const Collapse& Candidate : Candidates)
+        {
+            if (TriangleCount <= TargetTriangles)
+            {
+                break;
+            }
+
+            if (Locked[Candidate.From] || Locked[Candidate.To])
+            {
+                continue;
+            }
+
+            const glm::vec3& Target = Vertices[Candidate.To].Pos;
+
+            bool Flips = false;
+            size_t Removed = 0;
+
+            for (uint32_t i = TriangleOffsets[Candidate.From]; i < TriangleOffsets[Candidate.From + 1] && !Flips; i++)
+            {
+                uint32_t Triangle = TriangleList[i];
+
+                uint32_t P[3] = { PositionOf[Result[Triangle * 3 + 0]], PositionOf[Result[Triangle * 3 + 1]], PositionOf[Result[Triangle * 3 + 2]] };
+
+                if (P[0] == Candidate.To || P[1] == Candidate.To || P[2] == Candidate.To)
+                {
+                    Removed++;
+                    continue;
+                }
+
+                glm::vec3 Old[3] = { Vertices[P[0]].Pos, Vertices[P[1]].Pos, Vertices[P[2]].Pos };
+                glm::vec3 New[3] = { Old[0], Old[1], Old[2] };
+
+                for (int k = 0; k < 3; k++)
+                {
+                    if (P[k] == Candidate.From)
+                    {
+                        New[k] = Target;
+                    }
+                }
+
+                glm::vec3 OldNormal = glm::cross(Old[1] - Old[0], Old[2] - Old[0]);
+                glm::vec3 NewNormal = glm::cross(New[1] - New[0], New[2] - New[0]);
+
+                if (glm::dot(OldNormal, NewNormal) <= 0.0f)
+                {
+                    Flips = true;
+                }
+            }
+
+            if (Flips)
+            {
+                continue;
+            }
+
+            /*
+                Move every vertex at the source position onto a vertex at the target position,
+                preferring one it already shares a triangle with so seams keep their attributes
+            */
+
+            uint32_t Wedge = Candidate.From;
+
+            do
+            {
+                uint32_t Replacement = Invalid;
+
+                for (uint32_t i = TriangleOffsets[Candidate.From]; i < TriangleOffsets[Candidate.From + 1] && Replacement == Invalid; i++)
+                {
+                    const uint32_t* Corners = &Result[TriangleList[i] * 3];
+
+                    if (Corners[0] != Wedge && Corners[1] != Wedge && Corners[2] != Wedge)
+                    {
+                        continue;
+                    }
+
+                    for (int k = 0; k < 3; k++)
+                    {
+                        if (PositionOf[Corners[k]] == Candidate.To)
+                        {
+                            Replacement = Corners[k];
+                            break;
+                        }
+                    }
+                }
+
+                if (Replacement == Invalid)
+                {
+                    float BestDistance = std::numeric_limits<float>::max();
+                    uint32_t Other = Candidate.To;
+
+                    do
+                    {
+                        float Distance = AttributeDistance(Vertices[Wedge], Vertices[Other]);
+
+                        if (Distance < BestDistance)
+                        {
+                            BestDistance = Distance;
+                            Replacement = Other;
+                        }
+
+                        Other = WedgeNext[Other];
+                    } while (Other != Candidate.To);
+                }
+
+                VertexRemap[Wedge] = Replacement;
+                Wedge = WedgeNext[Wedge];
+            } while (Wedge != Candidate.From);
+
+            for (uint32_t i = TriangleOffsets[Candidate.From]; i < TriangleOffsets[Candidate.From + 1]; i++)
+            {
+                uint32_t Triangle = TriangleList[i];
+
+                for (int k = 0; k < 3; k++)
+                {
+                    Locked[PositionOf[Result[Triangle * 3 + k]]] = 1;
+                }
+            }
+
+            Quadrics[Candidate.To].Add(Quadrics[Candidate.From]);
+
+            ResultError = std::max(ResultError, static_cast<float>(std::sqrt(Candidate.Cost)));
+            TriangleCount -= std::min(Removed, TriangleCount);
+            Collapsed++;
+        }
+
+        if (Collapsed == 0)
+        {
+            break;
+        }
+
+        /*
+            Rewrite the index list and drop triangles that collapsed to a line
+        */
+
+        size_t Write = 0;
+
+        for (size_t t = 0; t + 2 < Result.size(); t += 3)
+        {
+            uint32_t V0 = VertexRemap[Result[t + 0]];
+            uint32_t V1 = VertexRemap[Result[t + 1]];
+            uint32_t V2 = VertexRemap[Result[t + 2]];
+
+            if (PositionOf[V0] == PositionOf[V1] || PositionOf[V1] == PositionOf[V2] || PositionOf[V0] == PositionOf[V2])
+            {
+                continue;
+            }
+
+            Result[Write++] = V0;
+            Result[Write++] = V1;
+            Result[Write++] = V2;
+        }
+
+        Result.resize(Write);
+    }
+
+    return Result;
+}
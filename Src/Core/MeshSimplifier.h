@@ -0,0 +1,39 @@
+#pragma once
+
+#ifndef MESHSIMPLIFIER_H
+#define MESHSIMPLIFIER_H
+
+namespace Engine
+{
+	/*
+		Quadric error edge collapse (Garland & Heckbert) that only collapses onto existing vertices,
+		so every level of detail can index the same vertex buffer.
+
+		Collapses are tracked per position rather than per vertex, vertices that share a position but
+		differ in UV or normal (seams) move together and are only collapsed along the seam, open borders
+		only along the border, so simplification never opens cracks.
+	*/
+
+	namespace MeshSimplifier
+	{
+		/*
+			One level of detail, a range of the model's shared index buffer
+		*/
+
+		struct Lod
+		{
+			uint32_t FirstIndex;
+			uint32_t IndexCount;
+			float Error; // model space distance
+		};
+
+		/*
+			TargetError is an absolute distance in model space, ResultError receives the largest
+			deviation the simplified mesh was allowed to introduce
+		*/
+
+		std::vector<uint32_t> Simplify(const std::vector<uint32_t>& Indices, const std::vector<Vulkan::Renderer::Vertex>& Vertices, size_t TargetIndexCount, float TargetError, float& ResultError);
+	}
+}
+
+#endif
@@ -0,0 +1,237 @@
+#include "../Common.h"
+#include "./API/Vulkan/Renderer.h"
+#include "Meshlet.h"
+
+namespace
+{
+    void ComputeBounds(Engine::Meshlets::Meshlet& Cluster, const std::vector<uint32_t>& Indices, const std::vector<Vulkan::Renderer::Vertex>& Vertices)
+    {
+        uint32_t Begin = Cluster.FirstIndex;
+        uint32_t End = Cluster.FirstIndex + Cluster.TriangleCount * 3;
+
+        /*
+            Sphere around the AABB centre, good enough for culling and far cheaper than a minimal sphere
+        */
+
+        glm::vec3 Minimum(std::numeric_limits<float>::max());
+        glm::vec3 Maximum(std::numeric_limits<float>::lowest());
+
+        for (uint32_t i = Begin; i < End; i++)
+        {
+            Minimum = glm::min(Minimum, Vertices[Indices[i]].Pos);
+            Maximum = glm::max(Maximum, Vertices[Indices[i]].Pos);
+        }
+
+        Cluster.Center = (Minimum + Maximum) * 0.5f;
+        Cluster.Radius = 0.0f;
+
+        for (uint32_t i = Begin; i < End; i++)
+        {
+            Cluster.Radius = std::max(Cluster.Radius, glm::length(Vertices[Indices[i]].Pos - Cluster.Center));
+        }
+
+        /*
+            Normal cone from the face normals, triangles contribute equally regardless of area
+        */
+
+        std::vector<glm::vec3> Normals;
+        Normals.reserve(Cluster.TriangleCount);
+
+        glm::vec3 Axis(0.0f);
+
+        for (uint32_t i = Begin; i < End; i += 3)
+        {
+            const glm::vec3& P0 = Vertices[Indices[i + 0]].Pos;
+            const glm::vec3& P1 = Vertices[Indices[i + 1]].Pos;
+            const glm::vec3& P2 = Vertices[Indices[i + 2]].Pos;
+
+            glm::vec3 Normal = glm::cross(P1 - P0, P2 - P0);
+            float Length = glm::length(Normal);
+
+            Normal = Length > 0.0f ? Normal / Length : glm::vec3(0.0f);
+
+            Normals.push_back(Normal);
+            Axis += Normal;
+        }
+
+        float AxisLength = glm::length(Axis);
+
+        Cluster.ConeAxis = AxisLength > 0.0f ? Axis / AxisLength : glm::vec3(0.0f, 0.0f, 1.0f);
+        Cluster.ConeApex = Cluster.Center;
+        Cluster.ConeCutoff = 1.0f;
+
+        if (AxisLength <= 0.0f)
+        {
+            return;
+        }
+
+        float MinimumDot = 1.0f;
+
+        for (const glm::vec3& Normal : Normals)
+        {
+            MinimumDot = std::min(MinimumDot, glm::dot(Normal, Cluster.ConeAxis));
+        }
+
+        /*
+            Normals spread over more than a hemisphere, the cluster is never entirely back facing
+        */
+
+        if (MinimumDot <= 0.1f)
+        {
+            return;
+        }
+
+        /*
+            Move the apex back along the axis until every triangle plane is in front of it
+        */
+
+        float MaximumT = 0.0f;
+
+        for (uint32_t i = Begin, Triangle = 0; i < End; i += 3, Triangle++)
+        {
+            const glm::vec3& Normal = Normals[Triangle];
+            float Denominator = glm::dot(Cluster.ConeAxis, Normal);
+
+            if (Denominator <= 0.0f)
+            {
+                continue;
+            }
+
+            for (int k = 0; k < 3; k++)
+            {
+                float T = glm::dot(Cluster.Center - Vertices[Indices[i + k]].Pos, Normal) / Denominator;
+                MaximumT = std::max(MaximumT, T);
+            }
+        }
+
+        Cluster.ConeApex = Cluster.Center - Cluster.ConeAxis * MaximumT;
+        Cluster.ConeCutoff = std::sqrt(1.0f - MinimumDot * MinimumDot);
+    }
+}
+
+void Engine::Meshlets::Build(const std::vector<uint32_t>& Indices, uint32_t FirstIndex, uint32_t IndexCount, const std::vector<Vulkan::Renderer::Vertex>& Vertices, std::vector<Engine::Meshlets::Meshlet>& Result)
+{
+    /*
+        Triangles are already in vertex cache order, so consecutive runs are spatially coherent and the
+        index buffer can be split without rewriting it
+    */
+
+    std::vector<uint32_t> Stamp(Vertices.size(), 0xFFFFFFFF);
+
+    Engine::Meshlets::Meshlet Current{};
+    Current.FirstIndex = FirstIndex;
+
+    uint32_t MeshletId = 0;
+
+    auto Finish = [&]()
+    {
+        if (Current.TriangleCount > 0)
+        {
+            ComputeBounds(Current, Indices, Vertices);
+            Result.push_back(Current);
+        }
+
+        MeshletId++;
+
+        Current = Engine::Meshlets::Meshlet{};
+    };
+
+    for (uint32_t i = FirstIndex; i + 2 < FirstIndex + IndexCount; i += 3)
+    {
+        uint32_t NewVertices = 0;
+
+        for (int k = 0; k < 3; k++)
+        {
+            if (Stamp[Indices[i + k]] != MeshletId)
+            {
+                NewVertices++;
+            }
+        }
+
+        if (Current.VertexCount + NewVertices > Engine::Meshlets::MaxVertices || Current.TriangleCount + 1 > Engine::Meshlets::MaxTriangles)
+        {
+            Finish();
+            Current.FirstIndex = i;
+        }
+
+        for (int k = 0; k < 3; k++)
+        {
+            if (Stamp[Indices[i + k]] != MeshletId)
+            {
+                Stamp[Indices[i + k]] = MeshletId;
+                Current.VertexCount++;
+            }
+        }
+
+        Current.TriangleCount++;
+    }
+
+    Finish();
+}
+
+Engine::Meshlets::Frustum Engine::Meshlets::ExtractFrustum(const glm::mat4& ViewProjection, const glm::vec3& Eye)
+{
+    /*
+        Gribb/Hartmann, rows of the column major matrix, depth is zero to one
+    */
+
+    auto Row = [&](int i)
+    {
+        return glm::vec4(ViewProjection[0][i], ViewProjection[1][i], ViewProjection[2][i], ViewProjection[3][i]);
+    };
+
+    Engine::Meshlets::Frustum Result{};
+    Result.Eye = Eye;
+
+    Result.Planes[0] = Row(3) + Row(0);
+    Result.Planes[1] = Row(3) - Row(0);
+    Result.Planes[2] = Row(3) + Row(1);
+    Result.Planes[3] = Row(3) - Row(1);
+    Result.Planes[4] = Row(2);
+    Result.Planes[5] = Row(3) - Row(2);
+
+    for (auto& Plane : Result.Planes)
+    {
+        float Length = glm::length(glm::vec3(Plane));
+
+        if (Length > 0.0f)
+        {
+            Plane = Plane / Length;
+        }
+    }
+
+    return Result;
+}
+
+bool Engine::Meshlets::IsVisible(const Engine::Meshlets::Meshlet& Cluster, const glm::mat4& Transform, float Scale, const Engine::Meshlets::Frustum& View)
+{
+    glm::vec3 Center = glm::vec3(Transform * glm::vec4(Cluster.Center, 1.0f));
+    float Radius = Cluster.Radius * Scale;
+
+    for (const auto& Plane : View.Planes)
+    {
+        if (glm::dot(glm::vec3(Plane), Center) + Plane.w < -Radius)
+        {
+            return false;
+        }
+    }
+
+    if (Cluster.ConeCutoff >= 1.0f)
+    {
+        return true;
+    }
+
+    glm::vec3 Apex = glm::vec3(Transform * glm::vec4(Cluster.ConeApex, 1.0f));
+    glm::vec3 Axis = glm::vec3(Transform * glm::vec4(Cluster.ConeAxis, 0.0f));
+
+    float AxisLength = glm::length(Axis);
+    glm::vec3 ToApex = Apex - View.Eye;
+    float Distance = glm::length(ToApex);
+
+    if (AxisLength <= 0.0f || Distance <= 0.0f)
+    {
+        return true;
+    }
+
+    return glm::dot(ToApex / Distance, Axis / AxisLength) < Cluster.ConeCutoff;
+}
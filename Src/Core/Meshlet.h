@@ -0,0 +1,58 @@
+#pragma once
+
+#ifndef MESHLET_H
+#define MESHLET_H
+
+namespace Engine
+{
+	/*
+		Small clusters of consecutive triangles in a model's index buffer, each with a bounding sphere
+		and a normal cone so whole clusters can be rejected on the CPU before they're submitted.
+	*/
+
+	namespace Meshlets
+	{
+		const uint32_t MaxVertices = 64;
+		const uint32_t MaxTriangles = 124;
+
+		struct Meshlet
+		{
+			uint32_t FirstIndex;
+			uint32_t TriangleCount;
+
+			glm::vec3 Center;
+			float Radius;
+
+			/*
+				The cluster is back facing for any viewer where dot(normalize(ConeApex - Eye), ConeAxis) >= ConeCutoff
+			*/
+
+			glm::vec3 ConeApex;
+			float ConeCutoff;
+			glm::vec3 ConeAxis;
+			uint32_t VertexCount;
+		};
+
+		struct Frustum
+		{
+			glm::vec4 Planes[6];
+			glm::vec3 Eye;
+		};
+
+		/*
+			Splits [FirstIndex, FirstIndex + IndexCount) into meshlets, appending them to Result
+		*/
+
+		void Build(const std::vector<uint32_t>& Indices, uint32_t FirstIndex, uint32_t IndexCount, const std::vector<Vulkan::Renderer::Vertex>& Vertices, std::vector<Meshlet>& Result);
+
+		Frustum ExtractFrustum(const glm::mat4& ViewProjection, const glm::vec3& Eye);
+
+		/*
+			Transform is the object's model matrix, assumed to scale uniformly
+		*/
+
+		bool IsVisible(const Meshlet& Cluster, const glm::mat4& Transform, float Scale, const Frustum& View);
+	}
+}
+
+#endif
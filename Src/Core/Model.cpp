@@ -1,182 +1,1090 @@
-#include <unordered_map>
+#include <filesystem>
 
 #include "../Common.h"
 #include "./API/Vulkan/Renderer.h"
 #include "Model.h"
-
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tiny_obj_loader.h>
+#include "MeshCache.h"
+#include "ObjParser.h"
+#include "GltfParser.h"
+#include "VertexMap.h"
+#include "VertexPacking.h"
+#include "MeshSimplifier.h"
+#include "Material.h"
+#include "Profiler.h"
 
 std::string Engine::Model::TexturePath = "Assets/Textures/model.png";
 
-namespace std
+/*
+    OBJ files at least this large skip the in-memory parse on a cache miss and are imported through
+    fixed size windows straight into the mesh cache. The import refuses to start if it would need more
+    than the budget.
+*/
+
+size_t Engine::Model::StreamingImportThreshold = size_t(512) * 1024 * 1024;
+size_t Engine::Model::StreamingImportBudget = size_t(2048) * 1024 * 1024;
+size_t Engine::Model::StreamingImportWindow = size_t(16) * 1024 * 1024;
+
+/*
+    Upload copies into staging at most this much at a time, so a large mesh never needs one staging
+    region, or a packed copy, the size of the whole mesh
+*/
+
+size_t Engine::Model::UploadWindow = size_t(4) * 1024 * 1024;
+
+/*
+    Models fall back to the full format if the packed pipeline isn't available
+*/
+
+Engine::Model::VertexFormat Engine::Model::DefaultVertexFormat = Engine::Model::VertexFormat::Packed;
+bool Engine::Model::MeshletCulling = true;
+
+namespace
 {
-    template<> struct hash<Vulkan::Renderer::Vertex>
+    template<typename T>
+    size_t CapacityBytes(const std::vector<T>& Values)
     {
-        //size_t Vulkan::Renderer::Vertex.Operator()(Vulkan::Renderer::Vertex const& Vertex) const
-        size_t operator()(Vulkan::Renderer::Vertex const& Vertex) const
-        {
-            return ((hash<glm::vec3>()(Vertex.Pos) ^
-                (hash<glm::vec3>()(Vertex.Color) << 1)) >> 1) ^
-                (hash<glm::vec2>()(Vertex.UV) << 1);
-        }
-    };
+        return Values.capacity() * sizeof(T);
+    }
 }
 
 void Engine::Model::Load(std::string FilePath)
 {
+    PROFILE_ZONE("Model::Load");
+
     std::cout << "LOADING MODEL!" << std::endl;
 
-    Engine::Model::LoadModel(FilePath);
+    auto StartTime = std::chrono::high_resolution_clock::now();
+
+    Engine::Model::Prepare(FilePath);
+    Engine::Model::Upload();
+
+    /*
+        The staging batch is submitted ahead of the first frame that can draw it
+    */
+
+    Engine::Model::Resident = true;
 
-    Engine::Model::CreateVertexBuffer();
-    Engine::Model::CreateIndexBuffer();
+    Vulkan::Renderer::InvalidateCommandBuffers();
+
+    auto EndTime = std::chrono::high_resolution_clock::now();
+
+    std::cout << "MODEL > Loaded " << FilePath << " in " << std::chrono::duration<float, std::chrono::milliseconds::period>(EndTime - StartTime).count() << " ms" << std::endl;
 }
 
-void Engine::Model::Render(VkCommandBuffer CommandBuffer)
+void Engine::Model::Prepare(std::string FilePath)
 {
-    VkBuffer VertexBuffers[] = { Engine::Model::VertexBuffer };
-    VkDeviceSize Offsets[] = { 0 };
-    vkCmdBindVertexBuffers(CommandBuffer, 0, 1, VertexBuffers, Offsets);
-    vkCmdBindIndexBuffer(CommandBuffer, Engine::Model::IndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+    PROFILE_ZONE("Model::Prepare");
+
+    Engine::MeshCache::CachedMesh Cached;
+
+    bool CacheHit = Engine::MeshCache::Open(FilePath, Cached);
+
+    if (!CacheHit && Engine::Model::UsesStreamingImport(FilePath))
+    {
+        /*
+            Too large to parse in memory, the streamed import writes the cache itself and the model is
+            then loaded like any warm start
+        */
+
+        Engine::Model::ImportStreaming(FilePath);
+
+        CacheHit = Engine::MeshCache::Open(FilePath, Cached);
+
+        if (!CacheHit)
+        {
+            throw std::runtime_error("MODEL > Streamed import produced no usable cache for " + FilePath);
+        }
+    }
+
+    if (CacheHit)
+    {
+        /*
+            Warm start, vertex and index data stay in the mapped cache and Upload copies them from the
+            mapping into staging, only the small tables are copied out here
+        */
 
-    vkCmdDrawIndexed(CommandBuffer, static_cast<uint32_t>(Engine::Model::Indices.size()), 1, 0, 0, 0);
+        Engine::Model::VertexCount = Cached.Info->VertexCount;
+        Engine::Model::IndexCount = Cached.Info->IndexCount;
+        Engine::Model::BoundsMin = glm::vec3(Cached.Info->BoundsMin[0], Cached.Info->BoundsMin[1], Cached.Info->BoundsMin[2]);
+        Engine::Model::BoundsMax = glm::vec3(Cached.Info->BoundsMax[0], Cached.Info->BoundsMax[1], Cached.Info->BoundsMax[2]);
+
+        if (Cached.Optimization != nullptr)
+        {
+            Engine::Model::Optimization = *Cached.Optimization;
+        }
+
+        Engine::Model::Lods.assign(Cached.Lods, Cached.Lods + Cached.LodCount);
+
+        if (Engine::Model::Lods.empty())
+        {
+            Engine::Model::Lods.push_back({ 0, Engine::Model::IndexCount, 0.0f });
+        }
+
+        if (Cached.Submeshes != nullptr && Cached.LodCount == Engine::Model::Lods.size())
+        {
+            Engine::Model::Meshlets.assign(Cached.Meshlets, Cached.Meshlets + Cached.MeshletCount);
+            Engine::Model::Submeshes.assign(Cached.Submeshes, Cached.Submeshes + Cached.SubmeshCount);
+            Engine::Model::MaterialTextures = Cached.MaterialTextures;
+        }
+        else
+        {
+            /*
+                No usable submesh table, draw every level whole with the default material
+            */
+
+            Engine::Model::Meshlets.clear();
+            Engine::Model::Submeshes.clear();
+            Engine::Model::MaterialTextures.assign(1, "");
+
+            for (const auto& Level : Engine::Model::Lods)
+            {
+                Engine::Model::Submeshes.push_back({ 0, Level.FirstIndex, Level.IndexCount, 0, 0 });
+            }
+        }
+
+        Engine::Model::Vertices.clear();
+        Engine::Model::Indices.clear();
+
+        Engine::Model::MappedCache = std::shared_ptr<Engine::MeshCache::CachedMesh>(new Engine::MeshCache::CachedMesh(std::move(Cached)), [](Engine::MeshCache::CachedMesh* Mesh)
+        {
+            Engine::MeshCache::Close(*Mesh);
+            delete Mesh;
+        });
+    }
+    else
+    {
+        Engine::Model::LoadModel(FilePath);
+
+        Engine::MeshCache::Write(FilePath, *this);
+    }
+
+    Engine::Model::SelectVertexFormat();
 }
 
-void Engine::Model::Destroy()
+void Engine::Model::Upload()
 {
-    vkDestroyBuffer(Vulkan::Renderer::Device, VertexBuffer, nullptr);
-    vkFreeMemory(Vulkan::Renderer::Device, VertexBufferMemory, nullptr);
+    PROFILE_ZONE("Model::Upload");
+
+    Engine::Model::UploadVertices();
+
+    const uint32_t* IndexData = Engine::Model::GetIndexData();
 
-    vkDestroyBuffer(Vulkan::Renderer::Device, IndexBuffer, nullptr);
-    vkFreeMemory(Vulkan::Renderer::Device, IndexBufferMemory, nullptr);
+    Engine::Model::UploadRange(Engine::GeometryPool::Stream::Indices, Engine::Model::IndexCount, [IndexData](uint32_t First, uint32_t /*Count*/) -> const void*
+    {
+        return IndexData + First;
+    }, Engine::Model::IndexRange);
+
+    Engine::Model::AcquireMaterials();
+
+    /*
+        Everything lives in the staging ring now, drawing only needs the counts and tables
+    */
+
+    std::vector<Vulkan::Renderer::Vertex>().swap(Engine::Model::Vertices);
+    std::vector<uint32_t>().swap(Engine::Model::Indices);
+
+    Engine::Model::MappedCache.reset();
 }
 
-void Engine::Model::LoadModel(std::string ModelPath)
+uint32_t Engine::Model::Render(VkCommandBuffer CommandBuffer, uint32_t Lod, const Engine::Meshlets::Frustum* View, const glm::mat4& Transform)
 {
-    tinyobj::attrib_t Attrib;
-    std::vector<tinyobj::shape_t> Shapes;
-    std::vector<tinyobj::material_t> Materials;
-    std::string Warn, Error;
+    Engine::Model::Bind(CommandBuffer);
+
+    uint32_t SubmeshCount = Engine::Model::GetSubmeshCount();
 
-    if (!tinyobj::LoadObj(&Attrib, &Shapes, &Materials, &Warn, &Error, ModelPath.c_str()))
+    if (SubmeshCount == 0)
     {
-        throw std::runtime_error(Warn + Error);
+        vkCmdDrawIndexed(CommandBuffer, Engine::Model::IndexCount, 1, Engine::Model::IndexRange.Offset, static_cast<int32_t>(Engine::Model::VertexRange.Offset), 0);
+        return Engine::Model::IndexCount / 3;
     }
-    else
+
+    Lod = std::min<uint32_t>(Lod, static_cast<uint32_t>(Engine::Model::Lods.size()) - 1);
+
+    uint32_t TrianglesDrawn = 0;
+
+    for (uint32_t i = 0; i < SubmeshCount; i++)
     {
-        std::cout << "VK > Successfully loaded model!" << std::endl;
+        TrianglesDrawn += Engine::Model::Draw(CommandBuffer, Engine::Model::Submeshes[Lod * SubmeshCount + i], View, Transform);
     }
 
-    std::unordered_map<Vulkan::Renderer::Vertex, uint32_t> UniqueVertices{};
+    return TrianglesDrawn;
+}
+
+void Engine::Model::Bind(VkCommandBuffer CommandBuffer, Engine::GeometryPool::BindState* State, bool DepthOnly)
+{
+    bool Packed = Engine::Model::Format == Engine::Model::VertexFormat::Packed;
+    VkPipeline Pipeline = Packed ? Vulkan::Renderer::Pipelines.Packed : Vulkan::Renderer::Pipelines.Normal;
 
-    for (const auto& Material : Materials) {
-        std::cout << Material.diffuse_texname << std::endl;
+    if (DepthOnly)
+    {
+        Pipeline = Packed ? Vulkan::Renderer::Pipelines.DepthOnlyPacked : Vulkan::Renderer::Pipelines.DepthOnly;
     }
 
-    for (const auto& Shape : Shapes)
+    if (State == nullptr || State->Pipeline != Pipeline)
     {
-        for (const auto& Index : Shape.mesh.indices)
+        vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Pipeline);
+
+        if (State != nullptr)
         {
-            Vulkan::Renderer::Vertex Vertex{};
+            State->Pipeline = Pipeline;
+        }
+    }
 
-            if (Index.vertex_index >= 0)
-            {
-                Vertex.Pos = {
-                    Attrib.vertices[3 * Index.vertex_index + 0],
-                    Attrib.vertices[3 * Index.vertex_index + 1],
-                    Attrib.vertices[3 * Index.vertex_index + 2]
-                };
-            }
+    if (Packed)
+    {
+        Vulkan::Renderer::PackedPushConstant PushConstant{};
+        PushConstant.BoundsMin = glm::vec4(Engine::Model::BoundsMin, 0.0f);
+        PushConstant.BoundsExtent = glm::vec4(Engine::Model::BoundsMax - Engine::Model::BoundsMin, 0.0f);
+
+        vkCmdPushConstants(CommandBuffer, Vulkan::Renderer::PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, sizeof(glm::mat4), sizeof(PushConstant), &PushConstant);
+    }
+
+    Engine::GeometryPool::Bind(CommandBuffer, Engine::Model::VertexRange, Engine::Model::IndexRange, State, DepthOnly);
+}
+
+uint32_t Engine::Model::Draw(VkCommandBuffer CommandBuffer, const Engine::Model::Submesh& Part, const Engine::Meshlets::Frustum* View, const glm::mat4& Transform)
+{
+    if (Part.IndexCount == 0)
+    {
+        return 0;
+    }
+
+    int32_t VertexOffset = static_cast<int32_t>(Engine::Model::VertexRange.Offset);
+
+    if (View == nullptr || !Engine::Model::MeshletCulling || Part.MeshletCount == 0)
+    {
+        vkCmdDrawIndexed(CommandBuffer, Part.IndexCount, 1, Engine::Model::IndexRange.Offset + Part.FirstIndex, VertexOffset, 0);
+        return Part.IndexCount / 3;
+    }
+
+    /*
+        Meshlets of a submesh are contiguous in the index buffer, so neighbouring survivors are merged
+        into a single draw and a fully visible submesh still costs one vkCmdDrawIndexed
+    */
+
+    float Scale = std::max({ glm::length(glm::vec3(Transform[0])), glm::length(glm::vec3(Transform[1])), glm::length(glm::vec3(Transform[2])) });
+
+    uint32_t RangeStart = 0;
+    uint32_t RangeCount = 0;
+    uint32_t TrianglesDrawn = 0;
+
+    for (uint32_t i = Part.FirstMeshlet; i < Part.FirstMeshlet + Part.MeshletCount; i++)
+    {
+        const Engine::Meshlets::Meshlet& Cluster = Engine::Model::Meshlets[i];
+
+        if (!Engine::Meshlets::IsVisible(Cluster, Transform, Scale, *View))
+        {
+            continue;
+        }
 
-            auto ColorIndex = 3 * Index.vertex_index + 2;
-            if (ColorIndex < Attrib.colors.size())
+        if (RangeCount > 0 && RangeStart + RangeCount == Cluster.FirstIndex)
+        {
+            RangeCount += Cluster.TriangleCount * 3;
+        }
+        else
+        {
+            if (RangeCount > 0)
             {
-                Vertex.Color = {
-                    Attrib.colors[ColorIndex - 2],
-                    Attrib.colors[ColorIndex - 1],
-                    Attrib.colors[ColorIndex - 0]
-                };
+                vkCmdDrawIndexed(CommandBuffer, RangeCount, 1, Engine::Model::IndexRange.Offset + RangeStart, VertexOffset, 0);
             }
-            else
+
+            RangeStart = Cluster.FirstIndex;
+            RangeCount = Cluster.TriangleCount * 3;
+        }
+
+        TrianglesDrawn += Cluster.TriangleCount;
+    }
+
+    if (RangeCount > 0)
+    {
+        vkCmdDrawIndexed(CommandBuffer, RangeCount, 1, Engine::Model::IndexRange.Offset + RangeStart, VertexOffset, 0);
+    }
+
+    return TrianglesDrawn;
+}
+
+uint32_t Engine::Model::GetSubmeshCount() const
+{
+    if (Engine::Model::Lods.empty())
+    {
+        return 0;
+    }
+
+    return static_cast<uint32_t>(Engine::Model::Submeshes.size() / Engine::Model::Lods.size());
+}
+
+void Engine::Model::Destroy()
+{
+    for (uint32_t Material : Engine::Model::Materials)
+    {
+        Engine::Materials::Release(Material);
+    }
+
+    Engine::Model::Materials.clear();
+
+    /*
+        Frames in flight may still draw from these ranges, they go back to the pool once those are done
+    */
+
+    Engine::GeometryPool::Range Vertices = Engine::Model::VertexRange;
+    Engine::GeometryPool::Range Indices = Engine::Model::IndexRange;
+
+    Vulkan::Deletion::Defer([Vertices, Indices]() mutable
+    {
+        Engine::GeometryPool::Free(Vertices);
+        Engine::GeometryPool::Free(Indices);
+    });
+
+    Engine::Model::VertexRange = Engine::GeometryPool::Range{};
+    Engine::Model::IndexRange = Engine::GeometryPool::Range{};
+}
+
+bool Engine::Model::UsesStreamingImport(const std::string& FilePath)
+{
+    std::string Extension = std::filesystem::path(FilePath).extension().string();
+    std::transform(Extension.begin(), Extension.end(), Extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    std::error_code Error;
+    uintmax_t Size = std::filesystem::file_size(FilePath, Error);
+
+    return Extension == ".obj" && !Error && Size >= Engine::Model::StreamingImportThreshold;
+}
+
+size_t Engine::Model::ImportStreaming(const std::string& ModelPath)
+{
+    /*
+        Pass one keeps only the attribute streams, which faces index at random and so can't be windowed,
+        and counts triangles per material. Pass two triangulates window by window, welds corners by their
+        (position, texcoord, normal) index triple and writes vertices and per-material index ranges
+        straight into the cache file. Nothing proportional to the face count is held in memory.
+
+        The result is not run through the optimizer, LOD or meshlet builders, those need the whole mesh.
+    */
+
+    auto StartTime = std::chrono::high_resolution_clock::now();
+
+    const size_t IndexWindow = 64 * 1024;
+    const size_t VertexWindow = 16 * 1024;
+    const uint32_t Invalid = UINT32_MAX;
+
+    Engine::ObjParser::Mesh Attributes;
+    std::vector<uint64_t> TriangleBounds;
+    std::string Error;
+
+    if (!Engine::ObjParser::ScanAttributes(ModelPath, Engine::Model::StreamingImportWindow, Attributes, TriangleBounds, Error))
+    {
+        throw std::runtime_error(Error);
+    }
+
+    /*
+        Same slot grouping as LoadModel, materials that render identically share a submesh
+    */
+
+    std::vector<std::string> MaterialTextures;
+    std::vector<uint32_t> MaterialSlots(TriangleBounds.size(), Invalid);
+    std::vector<uint64_t> SlotBounds;
+
+    for (size_t Key = 0; Key < TriangleBounds.size(); Key++)
+    {
+        if (TriangleBounds[Key] == 0)
+        {
+            continue;
+        }
+
+        std::string Texture = Key > 0 ? Engine::Materials::ResolveTexturePath(Attributes.Materials[Key - 1].DiffuseTexture, ModelPath) : "";
+
+        auto Existing = std::find(MaterialTextures.begin(), MaterialTextures.end(), Texture);
+        MaterialSlots[Key] = static_cast<uint32_t>(Existing - MaterialTextures.begin());
+
+        if (Existing == MaterialTextures.end())
+        {
+            MaterialTextures.push_back(Texture);
+            SlotBounds.push_back(0);
+        }
+
+        SlotBounds[MaterialSlots[Key]] += TriangleBounds[Key] * 3;
+    }
+
+    if (MaterialTextures.empty())
+    {
+        MaterialTextures.push_back("");
+        SlotBounds.push_back(0);
+    }
+
+    std::vector<uint64_t> SlotStarts(SlotBounds.size() + 1, 0);
+
+    for (size_t Slot = 0; Slot < SlotBounds.size(); Slot++)
+    {
+        SlotStarts[Slot + 1] = SlotStarts[Slot] + SlotBounds[Slot];
+    }
+
+    uint64_t IndexBound = SlotStarts.back();
+    size_t PositionCount = Attributes.Positions.size() / 3;
+    size_t NormalCount = Attributes.Normals.size() / 3;
+    size_t TexcoordCount = Attributes.Texcoords.size() / 2;
+
+    if (IndexBound > UINT32_MAX || PositionCount >= UINT32_MAX)
+    {
+        throw std::runtime_error("MODEL > " + ModelPath + " has more indices or positions than 32-bit indexing allows");
+    }
+
+    /*
+        Check the budget before the expensive pass: attributes, one chain head per position, three words
+        per unique vertex (estimated like ObjParser::EstimateUniqueVertices), the read window with its parsed form
+        and the output windows
+    */
+
+    size_t EstimatedVertices = static_cast<size_t>(std::min<uint64_t>(IndexBound, std::max({ PositionCount, NormalCount, TexcoordCount })));
+
+    size_t AttributeBytes = CapacityBytes(Attributes.Positions) + CapacityBytes(Attributes.Normals) + CapacityBytes(Attributes.Texcoords) + CapacityBytes(Attributes.Colors);
+    size_t WeldBytes = PositionCount * sizeof(uint32_t) + EstimatedVertices * 3 * sizeof(uint32_t);
+    std::error_code SizeError;
+    size_t SourceBytes = static_cast<size_t>(std::filesystem::file_size(ModelPath, SizeError));
+    size_t ReadBytes = SizeError ? Engine::Model::StreamingImportWindow : std::min(SourceBytes, Engine::Model::StreamingImportWindow);
+
+    size_t WindowBytes = 4 * ReadBytes + SlotBounds.size() * IndexWindow * sizeof(uint32_t) + VertexWindow * sizeof(Vulkan::Renderer::Vertex);
+    size_t Required = AttributeBytes + WeldBytes + WindowBytes;
+
+    if (Required > Engine::Model::StreamingImportBudget)
+    {
+        throw std::runtime_error("MODEL > Streamed import of " + ModelPath + " needs about " + std::to_string(Required / (1024 * 1024)) +
+            " MB, over the " + std::to_string(Engine::Model::StreamingImportBudget / (1024 * 1024)) + " MB budget");
+    }
+
+    Engine::MeshCache::StreamWriter Writer;
+
+    if (!Writer.Open(ModelPath))
+    {
+        throw std::runtime_error("MODEL > Could not start streamed cache for " + ModelPath);
+    }
+
+    std::string GenericPath = std::filesystem::path(ModelPath).generic_string();
+    Writer.Append(Engine::MeshCache::ChunkType::SourcePath, GenericPath.data(), GenericPath.size());
+
+    uint64_t IndexOffset = Writer.Reserve(Engine::MeshCache::ChunkType::Indices, IndexBound * sizeof(uint32_t));
+
+    /*
+        Each slot owns a region of the index chunk sized by its bound, polygons that triangulate to fewer
+        triangles leave a gap at the end of the region which is closed up once every slot is written
+    */
+
+    std::vector<std::vector<uint32_t>> SlotWindows(SlotBounds.size());
+    std::vector<uint64_t> SlotWritten(SlotBounds.size(), 0);
+
+    auto FlushSlot = [&](size_t Slot)
+    {
+        std::vector<uint32_t>& Pending = SlotWindows[Slot];
+
+        Writer.WriteAt(IndexOffset + (SlotStarts[Slot] + SlotWritten[Slot]) * sizeof(uint32_t), Pending.data(), Pending.size() * sizeof(uint32_t));
+
+        SlotWritten[Slot] += Pending.size();
+        Pending.clear();
+    };
+
+    for (auto& Pending : SlotWindows)
+    {
+        Pending.reserve(IndexWindow);
+    }
+
+    std::vector<Vulkan::Renderer::Vertex> PendingVertices;
+    PendingVertices.reserve(VertexWindow);
+
+    std::vector<uint32_t> Heads(PositionCount, Invalid);
+    std::vector<uint32_t> Next, Texcoords, Normals;
+    Next.reserve(EstimatedVertices);
+    Texcoords.reserve(EstimatedVertices);
+    Normals.reserve(EstimatedVertices);
+
+    glm::vec3 BoundsMin(std::numeric_limits<float>::max());
+    glm::vec3 BoundsMax(std::numeric_limits<float>::lowest());
+
+    auto Weld = [&](const Engine::ObjParser::Index& Corner) -> uint32_t
+    {
+        if (Corner.VertexIndex >= static_cast<int>(PositionCount) || Corner.NormalIndex >= static_cast<int>(NormalCount) || Corner.TexcoordIndex >= static_cast<int>(TexcoordCount))
+        {
+            throw std::runtime_error("MODEL > Face index out of range in " + ModelPath);
+        }
+
+        uint32_t Texcoord = static_cast<uint32_t>(Corner.TexcoordIndex);
+        uint32_t Normal = static_cast<uint32_t>(Corner.NormalIndex);
+
+        for (uint32_t Vertex = Heads[Corner.VertexIndex]; Vertex != Invalid; Vertex = Next[Vertex])
+        {
+            if (Texcoords[Vertex] == Texcoord && Normals[Vertex] == Normal)
             {
-                Vertex.Color = { 1.0f, 1.0f, 1.0f };
+                return Vertex;
             }
+        }
+
+        uint32_t Vertex = static_cast<uint32_t>(Next.size());
+
+        Next.push_back(Heads[Corner.VertexIndex]);
+        Texcoords.push_back(Texcoord);
+        Normals.push_back(Normal);
+        Heads[Corner.VertexIndex] = Vertex;
+
+        PendingVertices.push_back(Engine::ObjParser::BuildVertex(Attributes, Corner));
+
+        BoundsMin = glm::min(BoundsMin, PendingVertices.back().Pos);
+        BoundsMax = glm::max(BoundsMax, PendingVertices.back().Pos);
+
+        if (PendingVertices.size() == VertexWindow)
+        {
+            Writer.Append(Engine::MeshCache::ChunkType::Vertices, PendingVertices.data(), PendingVertices.size() * sizeof(Vulkan::Renderer::Vertex));
+            PendingVertices.clear();
+        }
+
+        return Vertex;
+    };
+
+    auto Emit = [&](const Engine::ObjParser::Index* Triangle, int MaterialId)
+    {
+        uint32_t Key = (MaterialId >= 0 && MaterialId < static_cast<int>(Attributes.Materials.size())) ? MaterialId + 1 : 0;
+        uint32_t Slot = MaterialSlots[Key];
+
+        if (Slot == Invalid || SlotWritten[Slot] + SlotWindows[Slot].size() + 3 > SlotBounds[Slot])
+        {
+            throw std::runtime_error("MODEL > " + ModelPath + " changed during streamed import");
+        }
+
+        for (int Corner = 0; Corner < 3; Corner++)
+        {
+            SlotWindows[Slot].push_back(Weld(Triangle[Corner]));
+        }
+
+        if (SlotWindows[Slot].size() + 3 > IndexWindow)
+        {
+            FlushSlot(Slot);
+        }
+    };
+
+    if (!Engine::ObjParser::StreamTriangles(ModelPath, Engine::Model::StreamingImportWindow, Attributes, Emit, Error))
+    {
+        throw std::runtime_error(Error);
+    }
+
+    for (size_t Slot = 0; Slot < SlotWindows.size(); Slot++)
+    {
+        FlushSlot(Slot);
+    }
+
+    if (!PendingVertices.empty())
+    {
+        Writer.Append(Engine::MeshCache::ChunkType::Vertices, PendingVertices.data(), PendingVertices.size() * sizeof(Vulkan::Renderer::Vertex));
+    }
+    else if (Next.empty())
+    {
+        Writer.Reserve(Engine::MeshCache::ChunkType::Vertices, 0);
+    }
+
+    if (Next.empty())
+    {
+        BoundsMin = glm::vec3(0.0f);
+        BoundsMax = glm::vec3(0.0f);
+    }
+
+    size_t PeakBytes = AttributeBytes + CapacityBytes(Heads) + CapacityBytes(Next) + CapacityBytes(Texcoords) + CapacityBytes(Normals) + WindowBytes;
+
+    /*
+        Slide every slot down onto the end of the previous one, so the index chunk holds exactly the
+        indices written and a single level covers all of them
+    */
+
+    uint64_t IndexCount = 0;
 
-            if (Index.normal_index >= 0)
+    for (size_t Slot = 0; Slot < SlotBounds.size(); Slot++)
+    {
+        if (SlotStarts[Slot] != IndexCount)
+        {
+            Writer.Move(IndexOffset + SlotStarts[Slot] * sizeof(uint32_t), IndexOffset + IndexCount * sizeof(uint32_t), SlotWritten[Slot] * sizeof(uint32_t));
+        }
+
+        SlotStarts[Slot] = IndexCount;
+        IndexCount += SlotWritten[Slot];
+    }
+
+    Writer.Shrink(IndexOffset, IndexCount * sizeof(uint32_t));
+
+    std::vector<Engine::MeshSimplifier::Lod> Lods = { { 0, static_cast<uint32_t>(IndexCount), 0.0f } };
+    std::vector<Engine::Model::Submesh> Submeshes;
+    std::string TextureList;
+
+    for (uint32_t Slot = 0; Slot < MaterialTextures.size(); Slot++)
+    {
+        Submeshes.push_back({ Slot, static_cast<uint32_t>(SlotStarts[Slot]), static_cast<uint32_t>(SlotWritten[Slot]), 0, 0 });
+
+        TextureList.append(MaterialTextures[Slot]);
+        TextureList.push_back('\0');
+    }
+
+    Writer.Append(Engine::MeshCache::ChunkType::Lods, Lods.data(), Lods.size() * sizeof(Engine::MeshSimplifier::Lod));
+    Writer.Append(Engine::MeshCache::ChunkType::Submeshes, Submeshes.data(), Submeshes.size() * sizeof(Engine::Model::Submesh));
+    Writer.Append(Engine::MeshCache::ChunkType::MaterialTextures, TextureList.data(), TextureList.size());
+
+    if (!Writer.Finish(static_cast<uint32_t>(Next.size()), static_cast<uint32_t>(IndexCount), BoundsMin, BoundsMax))
+    {
+        throw std::runtime_error("MODEL > Failed to write streamed cache for " + ModelPath);
+    }
+
+    uint64_t Triangles = 0;
+
+    for (uint64_t Written : SlotWritten)
+    {
+        Triangles += Written / 3;
+    }
+
+    std::cout << "MODEL > Streamed import of " << ModelPath << ": " << Next.size() << " vertices, " << Triangles << " triangles, "
+        << MaterialTextures.size() << " submeshes in " << std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - StartTime).count() << " ms" << std::endl;
+    std::cout << "MODEL > Streamed import peak " << PeakBytes / (1024 * 1024) << " MB tracked (estimated " << Required / (1024 * 1024)
+        << " MB, budget " << Engine::Model::StreamingImportBudget / (1024 * 1024) << " MB)" << std::endl;
+
+    return PeakBytes;
+}
+
+void Engine::Model::LoadModel(std::string ModelPath)
+{
+    PROFILE_ZONE("Model::LoadModel");
+
+    /*
+        Per source triangle material id and per source material the texture as written in the file
+    */
+
+    std::vector<int> MaterialIds;
+    std::vector<std::string> Textures;
+
+    std::string Extension = std::filesystem::path(ModelPath).extension().string();
+    std::transform(Extension.begin(), Extension.end(), Extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (Extension == ".glb" || Extension == ".gltf")
+    {
+        Engine::Model::LoadGltf(ModelPath, MaterialIds, Textures);
+    }
+    else
+    {
+        Engine::Model::LoadObj(ModelPath, MaterialIds, Textures);
+    }
+
+    if (Engine::Model::Vertices.empty())
+    {
+        Engine::Model::BoundsMin = glm::vec3(0.0f);
+        Engine::Model::BoundsMax = glm::vec3(0.0f);
+    }
+
+    /*
+        Materials that would render identically (same texture, or none) share a slot, then triangles are
+        grouped by slot so each submesh is one contiguous index range
+    */
+
+    Engine::Model::MaterialTextures.clear();
+
+    std::vector<uint32_t> MaterialSlots(Textures.size() + 1, UINT32_MAX);
+    std::vector<uint32_t> TriangleSlots(Engine::Model::Indices.size() / 3);
+
+    for (size_t Triangle = 0; Triangle < TriangleSlots.size(); Triangle++)
+    {
+        int MaterialId = Triangle < MaterialIds.size() ? MaterialIds[Triangle] : -1;
+        uint32_t Key = (MaterialId >= 0 && MaterialId < static_cast<int>(Textures.size())) ? MaterialId + 1 : 0;
+
+        if (MaterialSlots[Key] == UINT32_MAX)
+        {
+            std::string Texture = Key > 0 ? Engine::Materials::ResolveTexturePath(Textures[Key - 1], ModelPath) : "";
+
+            auto Existing = std::find(Engine::Model::MaterialTextures.begin(), Engine::Model::MaterialTextures.end(), Texture);
+            MaterialSlots[Key] = static_cast<uint32_t>(Existing - Engine::Model::MaterialTextures.begin());
+
+            if (Existing == Engine::Model::MaterialTextures.end())
             {
-                Vertex.Normal = {
-                    Attrib.normals[3 * Index.normal_index + 0],
-                    Attrib.normals[3 * Index.normal_index + 1],
-                    Attrib.normals[3 * Index.normal_index + 2]
-                };
+                Engine::Model::MaterialTextures.push_back(Texture);
             }
+        }
+
+        TriangleSlots[Triangle] = MaterialSlots[Key];
+    }
+
+    if (Engine::Model::MaterialTextures.empty())
+    {
+        Engine::Model::MaterialTextures.push_back("");
+    }
+
+    std::vector<uint32_t> Boundaries(Engine::Model::MaterialTextures.size() + 1, 0);
+
+    for (uint32_t Slot : TriangleSlots)
+    {
+        Boundaries[Slot + 1] += 3;
+    }
+
+    for (size_t i = 1; i < Boundaries.size(); i++)
+    {
+        Boundaries[i] += Boundaries[i - 1];
+    }
+
+    if (Engine::Model::MaterialTextures.size() > 1)
+    {
+        std::vector<uint32_t> Sorted(Engine::Model::Indices.size());
+        std::vector<uint32_t> Cursor(Boundaries.begin(), Boundaries.end() - 1);
+
+        for (size_t Triangle = 0; Triangle < TriangleSlots.size(); Triangle++)
+        {
+            uint32_t& Offset = Cursor[TriangleSlots[Triangle]];
+
+            Sorted[Offset + 0] = Engine::Model::Indices[Triangle * 3 + 0];
+            Sorted[Offset + 1] = Engine::Model::Indices[Triangle * 3 + 1];
+            Sorted[Offset + 2] = Engine::Model::Indices[Triangle * 3 + 2];
+
+            Offset += 3;
+        }
+
+        Engine::Model::Indices.swap(Sorted);
+    }
+
+    Engine::Model::Submeshes.clear();
+
+    for (uint32_t Slot = 0; Slot < Engine::Model::MaterialTextures.size(); Slot++)
+    {
+        Engine::Model::Submeshes.push_back({ Slot, Boundaries[Slot], Boundaries[Slot + 1] - Boundaries[Slot], 0, 0 });
+    }
+
+    std::cout << "MODEL > " << Textures.size() << " materials in " << Engine::Model::MaterialTextures.size() << " submeshes" << std::endl;
+
+    /*
+        Reorder for the post-transform cache, overdraw and vertex fetch before anything is uploaded or cached
+    */
+
+    Engine::Model::Optimization = Engine::MeshOptimizer::Optimize(Engine::Model::Indices, Engine::Model::Vertices, Boundaries);
+
+    std::cout << "MODEL > ACMR " << Engine::Model::Optimization.Before.ACMR << " -> " << Engine::Model::Optimization.After.ACMR
+        << ", ATVR " << Engine::Model::Optimization.Before.ATVR << " -> " << Engine::Model::Optimization.After.ATVR << std::endl;
+
+    Engine::Model::GenerateLods();
+    Engine::Model::BuildMeshlets();
+
+    Engine::Model::VertexCount = static_cast<uint32_t>(Engine::Model::Vertices.size());
+    Engine::Model::IndexCount = static_cast<uint32_t>(Engine::Model::Indices.size());
+
+    std::cout << "VERTICES COUNT: " << Engine::Model::Vertices.size() << std::endl;
+    std::cout << "INDICES COUNT: " << Engine::Model::Indices.size() << std::endl;
+}
+
+void Engine::Model::LoadObj(const std::string& ModelPath, std::vector<int>& MaterialIds, std::vector<std::string>& Textures)
+{
+    Engine::ObjParser::Mesh Mesh;
+    std::string Error;
 
-            if (Index.texcoord_index >= 0)
+    if (!Engine::ObjParser::Load(ModelPath, Mesh, Error))
+    {
+        throw std::runtime_error(Error);
+    }
+    else
+    {
+        std::cout << "VK > Successfully loaded model!" << std::endl;
+    }
+
+    Engine::VertexMap UniqueVertices(Engine::ObjParser::EstimateUniqueVertices(Mesh));
+
+    Engine::Model::Vertices.clear();
+    Engine::Model::Indices.clear();
+    Engine::Model::Indices.reserve(Mesh.Indices.size());
+
+    Engine::Model::BoundsMin = glm::vec3(std::numeric_limits<float>::max());
+    Engine::Model::BoundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+
+    for (const auto& Index : Mesh.Indices)
+    {
+        Vulkan::Renderer::Vertex Vertex = Engine::ObjParser::BuildVertex(Mesh, Index);
+
+        size_t PreviousCount = Engine::Model::Vertices.size();
+        uint32_t VertexIndex = UniqueVertices.Insert(Vertex, Engine::Model::Vertices);
+
+        if (Engine::Model::Vertices.size() != PreviousCount)
+        {
+            Engine::Model::BoundsMin = glm::min(Engine::Model::BoundsMin, Vertex.Pos);
+            Engine::Model::BoundsMax = glm::max(Engine::Model::BoundsMax, Vertex.Pos);
+        }
+
+        Engine::Model::Indices.push_back(VertexIndex);
+    }
+
+    MaterialIds.swap(Mesh.MaterialIds);
+
+    for (const auto& Material : Mesh.Materials)
+    {
+        Textures.push_back(Material.DiffuseTexture);
+    }
+}
+
+void Engine::Model::LoadGltf(const std::string& ModelPath, std::vector<int>& MaterialIds, std::vector<std::string>& Textures)
+{
+    /*
+        glTF is already indexed, vertices and indices are taken as they are with no dedup pass
+    */
+
+    Engine::GltfParser::Mesh Mesh;
+    std::string Error;
+
+    if (!Engine::GltfParser::Load(ModelPath, Mesh, Error))
+    {
+        throw std::runtime_error(Error);
+    }
+
+    std::cout << "MODEL > glTF " << Mesh.BlockCopies << " block copies, " << Mesh.ElementCopies << " element copies" << std::endl;
+
+    Engine::Model::Vertices.swap(Mesh.Vertices);
+    Engine::Model::Indices.swap(Mesh.Indices);
+
+    Engine::Model::BoundsMin = glm::vec3(std::numeric_limits<float>::max());
+    Engine::Model::BoundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+
+    for (const auto& Vertex : Engine::Model::Vertices)
+    {
+        Engine::Model::BoundsMin = glm::min(Engine::Model::BoundsMin, Vertex.Pos);
+        Engine::Model::BoundsMax = glm::max(Engine::Model::BoundsMax, Vertex.Pos);
+    }
+
+    MaterialIds.swap(Mesh.MaterialIds);
+
+    for (const auto& Material : Mesh.Materials)
+    {
+        Textures.push_back(Material.BaseColorTexture);
+    }
+}
+
+void Engine::Model::GenerateLods()
+{
+    PROFILE_ZONE("Model::GenerateLods");
+
+    /*
+        Each level halves the previous one, all levels share the vertex buffer and are appended to the
+        index buffer. Submeshes are simplified separately so material boundaries stay intact, a level's
+        error is the worst of its submeshes. The chain stops once simplification can't make meaningful
+        progress.
+    */
+
+    const float ErrorLimit = 0.05f;
+    const float MinimumReduction = 0.9f;
+
+    uint32_t FullIndexCount = static_cast<uint32_t>(Engine::Model::Indices.size());
+    uint32_t SubmeshCount = static_cast<uint32_t>(Engine::Model::Submeshes.size());
+
+    Engine::Model::Lods.clear();
+    Engine::Model::Lods.push_back({ 0, FullIndexCount, 0.0f });
+
+    float Extent = glm::length(Engine::Model::BoundsMax - Engine::Model::BoundsMin);
+
+    std::vector<std::vector<uint32_t>> Previous(SubmeshCount);
+    std::vector<float> PreviousErrors(SubmeshCount, 0.0f);
+
+    for (uint32_t i = 0; i < SubmeshCount; i++)
+    {
+        const Engine::Model::Submesh& Part = Engine::Model::Submeshes[i];
+        Previous[i].assign(Engine::Model::Indices.begin() + Part.FirstIndex, Engine::Model::Indices.begin() + Part.FirstIndex + Part.IndexCount);
+    }
+
+    for (uint32_t Level = 1; Level < Engine::Model::MaxLods; Level++)
+    {
+        std::vector<std::vector<uint32_t>> Next(SubmeshCount);
+        std::vector<float> NextErrors = PreviousErrors;
+
+        size_t PreviousTotal = 0;
+        size_t NextTotal = 0;
+        float LevelError = 0.0f;
+
+        for (uint32_t i = 0; i < SubmeshCount; i++)
+        {
+            size_t Target = (Engine::Model::Submeshes[i].IndexCount >> Level) / 3 * 3;
+
+            float Error;
+            std::vector<uint32_t> Simplified = Engine::MeshSimplifier::Simplify(Previous[i], Engine::Model::Vertices, Target, Extent * ErrorLimit, Error);
+
+            if (Simplified.empty() || Simplified.size() >= Previous[i].size())
             {
-                Vertex.UV = {
-                    Attrib.texcoords[2 * Index.texcoord_index + 0],
-                    1.0f - Attrib.texcoords[2 * Index.texcoord_index + 1]
-                };
+                Next[i] = Previous[i];
             }
-
-            if (UniqueVertices.count(Vertex) == 0)
+            else
             {
-                UniqueVertices[Vertex] = static_cast<uint32_t>(Engine::Model::Vertices.size());
-                Engine::Model::Vertices.push_back(Vertex);
+                Engine::MeshOptimizer::OptimizeVertexCache(Simplified, Engine::Model::Vertices.size());
+
+                /*
+                    Errors of successive passes can stack, keep the bound conservative
+                */
 
+                NextErrors[i] += Error;
+                Next[i].swap(Simplified);
             }
-            Engine::Model::Indices.push_back(UniqueVertices[Vertex]);
+
+            PreviousTotal += Previous[i].size();
+            NextTotal += Next[i].size();
+            LevelError = std::max(LevelError, NextErrors[i]);
+        }
+
+        if (NextTotal == 0 || NextTotal > PreviousTotal * MinimumReduction)
+        {
+            break;
         }
+
+        Engine::Model::Lods.push_back({ static_cast<uint32_t>(Engine::Model::Indices.size()), static_cast<uint32_t>(NextTotal), LevelError });
+
+        for (uint32_t i = 0; i < SubmeshCount; i++)
+        {
+            uint32_t Material = Engine::Model::Submeshes[i].Material;
+
+            Engine::Model::Submeshes.push_back({ Material, static_cast<uint32_t>(Engine::Model::Indices.size()), static_cast<uint32_t>(Next[i].size()), 0, 0 });
+            Engine::Model::Indices.insert(Engine::Model::Indices.end(), Next[i].begin(), Next[i].end());
+        }
+
+        std::cout << "MODEL > LOD " << Level << ": " << NextTotal / 3 << " triangles, error " << LevelError << std::endl;
+
+        Previous.swap(Next);
+        PreviousErrors.swap(NextErrors);
     }
+}
 
-    std::cout << "VERTICES COUNT: " << Engine::Model::Vertices.size() << std::endl;
-    std::cout << "INDICES COUNT: " << Engine::Model::Indices.size() << std::endl;
+void Engine::Model::BuildMeshlets()
+{
+    PROFILE_ZONE("Model::BuildMeshlets");
+
+    Engine::Model::Meshlets.clear();
+
+    for (auto& Part : Engine::Model::Submeshes)
+    {
+        Part.FirstMeshlet = static_cast<uint32_t>(Engine::Model::Meshlets.size());
+        Engine::Meshlets::Build(Engine::Model::Indices, Part.FirstIndex, Part.IndexCount, Engine::Model::Vertices, Engine::Model::Meshlets);
+        Part.MeshletCount = static_cast<uint32_t>(Engine::Model::Meshlets.size()) - Part.FirstMeshlet;
+    }
+
+    size_t Cullable = std::count_if(Engine::Model::Meshlets.begin(), Engine::Model::Meshlets.end(), [](const Engine::Meshlets::Meshlet& Cluster) { return Cluster.ConeCutoff < 1.0f; });
+
+    std::cout << "MODEL > Built " << Engine::Model::Meshlets.size() << " meshlets, " << Cullable << " with a usable normal cone" << std::endl;
+}
+
+void Engine::Model::AcquireMaterials()
+{
+    Engine::Model::Materials = Engine::Materials::Acquire(Engine::Model::MaterialTextures);
 }
 
-void Engine::Model::CreateVertexBuffer()
+void Engine::Model::SelectVertexFormat()
 {
-    VkDeviceSize BufferSize = sizeof(Engine::Model::Vertices[0]) * Engine::Model::Vertices.size();
+    Engine::Model::Format = Engine::Model::DefaultVertexFormat;
 
-    std::cout << "VERTEX BUFFER SIZE: " << BufferSize << std::endl;
-    std::cout << "VERTICES SIZE 2: " << Engine::Model::Vertices.size() << std::endl;
+    if (Engine::Model::Format == Engine::Model::VertexFormat::Packed && Vulkan::Renderer::Pipelines.Packed == VK_NULL_HANDLE)
+    {
+        Engine::Model::Format = Engine::Model::VertexFormat::Full;
+    }
+
+    if (Engine::Model::Format == Engine::Model::VertexFormat::Full)
+    {
+        return;
+    }
+
+    std::cout << "MODEL > Packing " << Engine::Model::VertexCount << " vertices, " << sizeof(Vulkan::Renderer::Vertex) * Engine::Model::VertexCount / 1024 << " KB -> " << sizeof(Vulkan::Renderer::PackedVertex) * Engine::Model::VertexCount / 1024 << " KB" << std::endl;
+}
 
-    VkBuffer StagingBuffer;
-    VkDeviceMemory StagingBufferMemory;
+void Engine::Model::UploadVertices()
+{
+    const Vulkan::Renderer::Vertex* VertexData = Engine::Model::GetVertexData();
+
+    if (Engine::Model::Format == Engine::Model::VertexFormat::Packed)
+    {
+        /*
+            Packed one window at a time as it is staged, the buffer is reused across windows
+        */
 
-    Vulkan::Renderer::CreateBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, StagingBuffer, StagingBufferMemory);
+        std::vector<Vulkan::Renderer::PackedVertex> Packed;
 
-    void* Data;
-    vkMapMemory(Vulkan::Renderer::Device, StagingBufferMemory, 0, BufferSize, 0, &Data);
-    memcpy(Data, Engine::Model::Vertices.data(), (size_t)BufferSize);
-    vkUnmapMemory(Vulkan::Renderer::Device, StagingBufferMemory);
+        Engine::Model::UploadRange(Engine::GeometryPool::Stream::PackedVertices, Engine::Model::VertexCount, [this, VertexData, &Packed](uint32_t First, uint32_t Count) -> const void*
+        {
+            Engine::VertexPacking::Pack(VertexData + First, Count, Engine::Model::BoundsMin, Engine::Model::BoundsMax, Packed);
 
-    Vulkan::Renderer::CreateBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, Engine::Model::VertexBuffer, Engine::Model::VertexBufferMemory);
+            return Packed.data();
+        }, Engine::Model::VertexRange);
+    }
+    else
+    {
+        Engine::Model::UploadRange(Engine::GeometryPool::Stream::Vertices, Engine::Model::VertexCount, [VertexData](uint32_t First, uint32_t /*Count*/) -> const void*
+        {
+            return VertexData + First;
+        }, Engine::Model::VertexRange);
+    }
+}
 
-    Vulkan::Renderer::CopyBuffer(StagingBuffer, Engine::Model::VertexBuffer, BufferSize);
+const Vulkan::Renderer::Vertex* Engine::Model::GetVertexData() const
+{
+    return Engine::Model::MappedCache ? Engine::Model::MappedCache->Vertices : Engine::Model::Vertices.data();
+}
 
-    vkDestroyBuffer(Vulkan::Renderer::Device, StagingBuffer, nullptr);
-    vkFreeMemory(Vulkan::Renderer::Device, StagingBufferMemory, nullptr);
+const uint32_t* Engine::Model::GetIndexData() const
+{
+    return Engine::Model::MappedCache ? Engine::Model::MappedCache->Indices : Engine::Model::Indices.data();
 }
 
-void Engine::Model::CreateIndexBuffer()
+void Engine::Model::UploadRange(Engine::GeometryPool::Stream Type, uint32_t Count, const std::function<const void*(uint32_t First, uint32_t Count)>& Source, Engine::GeometryPool::Range& Target)
 {
-    VkDeviceSize BufferSize = sizeof(Engine::Model::Indices[0]) * Engine::Model::Indices.size();
+    Target = Engine::GeometryPool::Allocate(Type, Count);
+
+    VkDeviceSize BufferSize = Engine::GeometryPool::GetByteSize(Target);
+
+    if (BufferSize == 0)
+    {
+        return;
+    }
+
+    size_t Stride = static_cast<size_t>(BufferSize / Count);
+    uint32_t WindowCount = static_cast<uint32_t>(std::clamp<size_t>(Engine::Model::UploadWindow / Stride, 1, Count));
+    uint32_t PartCount = Engine::GeometryPool::GetPartCount(Type);
+
+    for (uint32_t First = 0; First < Count; First += WindowCount)
+    {
+        uint32_t Window = std::min(WindowCount, Count - First);
+        const char* Data = static_cast<const char*>(Source(First, Window));
+
+        Vulkan::Staging::Region Staging = Vulkan::Staging::Allocate(VkDeviceSize(Window) * Stride);
 
-    VkBuffer StagingBuffer;
-    VkDeviceMemory StagingBufferMemory;
+        /*
+            Vertices are deinterleaved into one run per stream part, back to back in the staging region
+        */
 
-    Vulkan::Renderer::CreateBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, StagingBuffer, StagingBufferMemory);
+        char* Destination = static_cast<char*>(Staging.Mapped);
 
-    void* Data;
-    vkMapMemory(Vulkan::Renderer::Device, StagingBufferMemory, 0, BufferSize, 0, &Data);
-    memcpy(Data, Engine::Model::Indices.data(), (size_t)BufferSize);
-    vkUnmapMemory(Vulkan::Renderer::Device, StagingBufferMemory);
+        if (PartCount == 1)
+        {
+            memcpy(Destination, Data, size_t(Window) * Stride);
+        }
+        else
+        {
+            for (uint32_t Part = 0; Part < PartCount; Part++)
+            {
+                const char* PartSource = Data + Engine::GeometryPool::GetPartOffset(Type, Part);
+                uint32_t PartSize = Engine::GeometryPool::GetPartSize(Type, Part);
+
+                for (uint32_t i = 0; i < Window; i++)
+                {
+                    memcpy(Destination, PartSource + i * Stride, PartSize);
+                    Destination += PartSize;
+                }
+            }
+        }
 
-    Vulkan::Renderer::CreateBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, Engine::Model::IndexBuffer, Engine::Model::IndexBufferMemory);
+        /*
+            One copy per stream part, each out of its run in the staging region to this window's place in
+            the part's own buffer. Allocate may have submitted the batch, so the command buffer is fetched
+            after it.
+        */
 
-    Vulkan::Renderer::CopyBuffer(StagingBuffer, Engine::Model::IndexBuffer, BufferSize);
+        VkCommandBuffer CommandBuffer = Vulkan::Staging::GetCommandBuffer();
+        VkDeviceSize SourceOffset = Staging.Offset;
 
-    vkDestroyBuffer(Vulkan::Renderer::Device, StagingBuffer, nullptr);
-    vkFreeMemory(Vulkan::Renderer::Device, StagingBufferMemory, nullptr);
-}
\ No newline at end of file
+        for (uint32_t Part = 0; Part < PartCount; Part++)
+        {
+            VkDeviceSize PartSize = Engine::GeometryPool::GetPartSize(Type, Part);
+
+            VkBufferCopy CopyRegion{};
+            CopyRegion.srcOffset = SourceOffset;
+            CopyRegion.dstOffset = Engine::GeometryPool::GetByteOffset(Target, Part) + VkDeviceSize(First) * PartSize;
+            CopyRegion.size = VkDeviceSize(Window) * PartSize;
+
+            vkCmdCopyBuffer(CommandBuffer, Staging.Buffer, Engine::GeometryPool::GetBuffer(Target, Part), 1, &CopyRegion);
+            Vulkan::Staging::ReleaseBuffer(Engine::GeometryPool::GetBuffer(Target, Part), CopyRegion.dstOffset, CopyRegion.size);
+
+            SourceOffset += CopyRegion.size;
+        }
+    }
+}
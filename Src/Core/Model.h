@@ -3,27 +3,141 @@
 #ifndef MODEL_H
 #define MODEL_H
 
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "Meshlet.h"
+#include "GeometryPool.h"
+
 namespace Engine
 {
+	namespace MeshCache
+	{
+		struct CachedMesh;
+	}
+
 	class Model
 	{
 	public:
+		enum class VertexFormat { Full, Packed };
+
+		/*
+			Triangles of one LOD sharing a material slot, contiguous in the index buffer
+		*/
+
+		struct Submesh
+		{
+			uint32_t Material;
+			uint32_t FirstIndex;
+			uint32_t IndexCount;
+			uint32_t FirstMeshlet;
+			uint32_t MeshletCount;
+		};
+
 		std::vector<Vulkan::Renderer::Vertex> Vertices;
 		std::vector<uint32_t> Indices;
-		VkBuffer VertexBuffer;
-		VkDeviceMemory VertexBufferMemory;
-		VkBuffer IndexBuffer;
-		VkDeviceMemory IndexBufferMemory;
+		uint32_t VertexCount = 0;
+		uint32_t IndexCount = 0;
+		glm::vec3 BoundsMin{ 0.0f };
+		glm::vec3 BoundsMax{ 0.0f };
+		Engine::MeshOptimizer::Report Optimization;
+		std::vector<Engine::MeshSimplifier::Lod> Lods;
+		std::vector<Engine::Meshlets::Meshlet> Meshlets;
+
+		/*
+			GetSubmeshCount() entries per LOD, grouped by LOD, every level has the same material slots
+		*/
+
+		std::vector<Submesh> Submeshes;
+
+		/*
+			Per material slot, the resolved texture path (empty for the default texture) and its
+			Engine::Materials registry index
+		*/
+
+		std::vector<std::string> MaterialTextures;
+		std::vector<uint32_t> Materials;
+		VertexFormat Format = VertexFormat::Full;
+
+		/*
+			Ranges in the shared geometry pool, indices are relative to the start of VertexRange
+		*/
+
+		Engine::GeometryPool::Range VertexRange;
+		Engine::GeometryPool::Range IndexRange;
+
+		/*
+			Set once the vertex and index buffers hold their data, streamed models aren't drawn before that
+		*/
+
+		bool Resident = false;
 
 		static std::string TexturePath;
+		static VertexFormat DefaultVertexFormat;
+		static bool MeshletCulling;
+
+		static size_t StreamingImportThreshold;
+		static size_t StreamingImportBudget;
+		static size_t StreamingImportWindow;
+		static size_t UploadWindow;
+
+		static const uint32_t MaxLods = 4;
 
 		void Load(std::string FilePath);
-		void Render(VkCommandBuffer CommandBuffer);
+
+		/*
+			Load split in two for streaming. Prepare is CPU only and safe on any thread, Upload must run on
+			the render thread. Upload writes into the staging ring and records its copies into the current
+			staging batch, which goes out with the next Vulkan::Staging::Submit.
+		*/
+
+		void Prepare(std::string FilePath);
+		void Upload();
+		uint32_t Render(VkCommandBuffer CommandBuffer, uint32_t Lod = 0, const Engine::Meshlets::Frustum* View = nullptr, const glm::mat4& Transform = glm::mat4(1.0f));
+
+		/*
+			Render split in two for batching, Bind sets pipeline and buffers, Draw issues one submesh.
+			With a State, only what differs from the previous Bind on that command buffer is rebound.
+			DepthOnly selects the depth only pipeline and binds just the position stream.
+		*/
+
+		void Bind(VkCommandBuffer CommandBuffer, Engine::GeometryPool::BindState* State = nullptr, bool DepthOnly = false);
+		uint32_t Draw(VkCommandBuffer CommandBuffer, const Submesh& Part, const Engine::Meshlets::Frustum* View = nullptr, const glm::mat4& Transform = glm::mat4(1.0f));
+		uint32_t GetSubmeshCount() const;
 		void Destroy();
+
+		/*
+			Bounded memory OBJ import, writes the mesh cache directly and returns the peak bytes it held.
+			Throws if the estimate exceeds StreamingImportBudget.
+		*/
+
+		static bool UsesStreamingImport(const std::string& FilePath);
+		static size_t ImportStreaming(const std::string& FilePath);
 	private:
 		void LoadModel(std::string FilePath);
-		void CreateVertexBuffer();
-		void CreateIndexBuffer();
+		void LoadObj(const std::string& ModelPath, std::vector<int>& MaterialIds, std::vector<std::string>& Textures);
+		void LoadGltf(const std::string& ModelPath, std::vector<int>& MaterialIds, std::vector<std::string>& Textures);
+		void GenerateLods();
+		void BuildMeshlets();
+		void AcquireMaterials();
+		void SelectVertexFormat();
+		void UploadVertices();
+
+		/*
+			Source returns Count elements of the stream's layout starting at First, the pointer only has
+			to stay valid until the next call
+		*/
+
+		void UploadRange(Engine::GeometryPool::Stream Type, uint32_t Count, const std::function<const void*(uint32_t First, uint32_t Count)>& Source, Engine::GeometryPool::Range& Target);
+
+		const Vulkan::Renderer::Vertex* GetVertexData() const;
+		const uint32_t* GetIndexData() const;
+
+		/*
+			Set by a warm Prepare, vertex and index data are read from the mapping until Upload is done
+			with them, Vertices and Indices stay empty
+		*/
+
+		std::shared_ptr<Engine::MeshCache::CachedMesh> MappedCache;
 	};
 }
 
@@ -0,0 +1,165 @@
+#include "../Common.h"
+#include "./API/Vulkan/Renderer.h"
+#include "ModelRegistry.h"
+#include "Streaming.h"
+
+#include <unordered_map>
+
+std::vector<Engine::Models::Entry> Engine::Models::Entries;
+
+namespace
+{
+    std::unordered_map<std::string, uint32_t> Lookup;
+    std::vector<uint32_t> FreeSlots;
+}
+
+uint32_t Engine::Models::Acquire(const std::string& FilePath, bool Async)
+{
+    auto Existing = Lookup.find(FilePath);
+
+    if (Existing != Lookup.end())
+    {
+        Engine::Models::Entry& Entry = Engine::Models::Entries[Existing->second];
+
+        Entry.References++;
+
+        if (Entry.Failed)
+        {
+            /*
+                Earlier streamed load failed and the entry is still referenced, try it again
+            */
+
+            Entry.Failed = false;
+            Entry.Model = Engine::Model{};
+
+            if (Async)
+            {
+                Engine::Streaming::Request(Existing->second, FilePath);
+            }
+            else
+            {
+                try
+                {
+                    Entry.Model.Load(FilePath);
+                }
+                catch (...)
+                {
+                    Entry.Failed = true;
+                    Entry.Model = Engine::Model{};
+                    Entry.References--;
+
+                    throw;
+                }
+            }
+        }
+
+        return Existing->second;
+    }
+
+    uint32_t Index;
+
+    if (!FreeSlots.empty())
+    {
+        Index = FreeSlots.back();
+        FreeSlots.pop_back();
+    }
+    else
+    {
+        Index = static_cast<uint32_t>(Engine::Models::Entries.size());
+        Engine::Models::Entries.emplace_back();
+    }
+
+    Engine::Models::Entry& Entry = Engine::Models::Entries[Index];
+    Entry.FilePath = FilePath;
+    Entry.Model = Engine::Model{};
+    Entry.References = 1;
+    Entry.Failed = false;
+
+    Lookup[FilePath] = Index;
+
+    if (Async)
+    {
+        Engine::Streaming::Request(Index, FilePath);
+    }
+    else
+    {
+        try
+        {
+            Entry.Model.Load(FilePath);
+        }
+        catch (...)
+        {
+            Lookup.erase(FilePath);
+            FreeSlots.push_back(Index);
+
+            Entry.FilePath.clear();
+            Entry.Model = Engine::Model{};
+            Entry.References = 0;
+
+            throw;
+        }
+    }
+
+    return Index;
+}
+
+void Engine::Models::Release(uint32_t Model)
+{
+    if (Model >= Engine::Models::Entries.size() || Engine::Models::Entries[Model].References == 0)
+    {
+        return;
+    }
+
+    Engine::Models::Entry& Entry = Engine::Models::Entries[Model];
+
+    if (--Entry.References == 0 && (Entry.Model.Resident || Entry.Failed))
+    {
+        Engine::Models::Unload(Model);
+    }
+}
+
+void Engine::Models::Unload(uint32_t Model)
+{
+    Engine::Models::Entry& Entry = Engine::Models::Entries[Model];
+
+    if (Entry.References > 0 || Entry.FilePath.empty())
+    {
+        return;
+    }
+
+    if (Entry.Model.Resident)
+    {
+        Entry.Model.Destroy();
+
+        Vulkan::Renderer::InvalidateCommandBuffers();
+    }
+
+    std::cout << "MODEL > Unloaded " << Entry.FilePath << std::endl;
+
+    Lookup.erase(Entry.FilePath);
+    FreeSlots.push_back(Model);
+
+    Entry.FilePath.clear();
+    Entry.Model = Engine::Model{};
+    Entry.Failed = false;
+}
+
+Engine::Model& Engine::Models::Get(uint32_t Model)
+{
+    return Engine::Models::Entries[Model].Model;
+}
+
+void Engine::Models::Destroy()
+{
+    for (auto& Entry : Engine::Models::Entries)
+    {
+        if (Entry.Model.Resident)
+        {
+            Entry.Model.Destroy();
+        }
+    }
+
+    Engine::Models::Entries.clear();
+    Lookup.clear();
+    FreeSlots.clear();
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#ifndef MODELREGISTRY_H
+#define MODELREGISTRY_H
+
+#include "Model.h"
+
+namespace Engine
+{
+	/*
+		Reference counted registry of loaded models keyed by file path. GameObjects hold an index into
+		it, so any number of objects using the same asset share one parse, one set of GPU buffers and
+		one set of material references.
+	*/
+
+	namespace Models
+	{
+		struct Entry
+		{
+			std::string FilePath;
+			Engine::Model Model;
+			uint32_t References = 0;
+
+			/*
+				Set when a streamed load threw, the next Acquire of the path loads it again
+			*/
+
+			bool Failed = false;
+		};
+
+		const uint32_t Invalid = UINT32_MAX;
+
+		extern std::vector<Entry> Entries;
+
+		/*
+			Returns the existing entry for FilePath or creates one. New entries are either loaded
+			straight away or handed to Engine::Streaming, in which case Model.Resident stays false
+			until the upload has finished. A synchronous load that throws leaves no entry behind.
+		*/
+
+		uint32_t Acquire(const std::string& FilePath, bool Async = false);
+		void Release(uint32_t Model);
+
+		/*
+			Frees the buffers of an entry nothing references anymore and makes its slot reusable.
+			Release does this for resident and failed models, streaming does it once a released model's upload
+			has finished.
+		*/
+
+		void Unload(uint32_t Model);
+
+		Engine::Model& Get(uint32_t Model);
+		void Destroy();
+	}
+}
+
+#endif
@@ -0,0 +1,1271 @@
+#include "../Common.h"
+#include "./API/Vulkan/Renderer.h"
+#include "ObjParser.h"
+#include "FileSystem/FileSystem.h"
+
+#include <filesystem>
+#include <thread>
+#include <cmath>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    /*
+        Chunks smaller than this aren't worth a thread
+    */
+
+    const size_t MinimumChunkSize = 256 * 1024;
+
+    struct Face
+    {
+        uint32_t First;
+        uint32_t Count;
+    };
+
+    struct MaterialChange
+    {
+        uint32_t Face;
+        std::string Name;
+    };
+
+    struct Chunk
+    {
+        const char* Begin;
+        const char* End;
+
+        std::vector<float> Positions;
+        std::vector<float> Colors;
+        std::vector<float> Normals;
+        std::vector<float> Texcoords;
+
+        std::vector<Engine::ObjParser::Index> FaceIndices;
+        std::vector<Face> Faces;
+
+        /*
+            Negative (relative) indices can point into earlier chunks, so they are stored relative to
+            this chunk's first element and offset once the chunk bases are known
+        */
+
+        std::vector<uint32_t> PositionFixups;
+        std::vector<uint32_t> NormalFixups;
+        std::vector<uint32_t> TexcoordFixups;
+
+        std::vector<MaterialChange> MaterialChanges;
+        std::vector<std::string> MaterialLibraries;
+
+        std::vector<Engine::ObjParser::Index> Triangles;
+        std::vector<int> TriangleMaterials;
+
+        size_t PositionBase = 0;
+        size_t NormalBase = 0;
+        size_t TexcoordBase = 0;
+        size_t TriangleBase = 0;
+
+        int InitialMaterial = -1;
+
+        std::string Error;
+    };
+
+    template<typename Function>
+    void ParallelFor(size_t Count, Function&& Work)
+    {
+        if (Count == 1)
+        {
+            Work(0);
+            return;
+        }
+
+        std::vector<std::thread> Workers;
+        Workers.reserve(Count);
+
+        for (size_t i = 0; i < Count; i++)
+        {
+            Workers.emplace_back([&Work, i]() { Work(i); });
+        }
+
+        for (auto& Worker : Workers)
+        {
+            Worker.join();
+        }
+    }
+
+    inline bool IsSpace(char Character)
+    {
+        return Character == ' ' || Character == '\t';
+    }
+
+    inline bool IsDigit(char Character)
+    {
+        return static_cast<unsigned>(Character - '0') < 10u;
+    }
+
+    inline bool IsTokenEnd(char Character)
+    {
+        return Character == ' ' || Character == '\t' || Character == '\r' || Character == '\n';
+    }
+
+    /*
+        Same algorithm as tinyobj's tryParseDouble, the result has to round identically
+        for the output to match
+    */
+
+    bool ParseDouble(const char* Cursor, const char* End, double& Result)
+    {
+        if (Cursor >= End)
+        {
+            return false;
+        }
+
+        double Mantissa = 0.0;
+        int Exponent = 0;
+
+        char Sign = '+';
+        char ExponentSign = '+';
+        bool LeadingDot = false;
+        int Read = 0;
+
+        if (*Cursor == '+' || *Cursor == '-')
+        {
+            Sign = *Cursor;
+            Cursor++;
+
+            if (Cursor != End && *Cursor == '.')
+            {
+                LeadingDot = true;
+            }
+        }
+        else if (*Cursor == '.')
+        {
+            LeadingDot = true;
+        }
+        else if (!IsDigit(*Cursor))
+        {
+            return false;
+        }
+
+        if (!LeadingDot)
+        {
+            while (Cursor != End && IsDigit(*Cursor))
+            {
+                Mantissa *= 10;
+                Mantissa += static_cast<int>(*Cursor - '0');
+                Cursor++;
+                Read++;
+            }
+
+            if (Read == 0)
+            {
+                return false;
+            }
+        }
+
+        if (Cursor != End && *Cursor == '.')
+        {
+            static const double PowLut[] = { 1.0, 0.1, 0.01, 0.001, 0.0001, 0.00001, 0.000001, 0.0000001 };
+            const int LutEntries = sizeof(PowLut) / sizeof(PowLut[0]);
+
+            Cursor++;
+            Read = 1;
+
+            while (Cursor != End && IsDigit(*Cursor))
+            {
+                Mantissa += static_cast<int>(*Cursor - '0') * (Read < LutEntries ? PowLut[Read] : std::pow(10.0, -Read));
+                Read++;
+                Cursor++;
+            }
+        }
+
+        if (Cursor != End && (*Cursor == 'e' || *Cursor == 'E'))
+        {
+            Cursor++;
+
+            if (Cursor != End && (*Cursor == '+' || *Cursor == '-'))
+            {
+                ExponentSign = *Cursor;
+                Cursor++;
+            }
+            else if (Cursor == End || !IsDigit(*Cursor))
+            {
+                return false;
+            }
+
+            Read = 0;
+
+            while (Cursor != End && IsDigit(*Cursor))
+            {
+                if (Exponent > 2147483647 / 10)
+                {
+                    return false;
+                }
+
+                Exponent *= 10;
+                Exponent += static_cast<int>(*Cursor - '0');
+                Cursor++;
+                Read++;
+            }
+
+            Exponent *= (ExponentSign == '+' ? 1 : -1);
+
+            if (Read == 0)
+            {
+                return false;
+            }
+        }
+
+        Result = (Sign == '+' ? 1 : -1) * (Exponent ? std::ldexp(Mantissa * std::pow(5.0, Exponent), Exponent) : Mantissa);
+
+        return true;
+    }
+
+    inline bool ParseFloat(const char*& Cursor, const char* LineEnd, float& Result)
+    {
+        while (Cursor < LineEnd && IsSpace(*Cursor))
+        {
+            Cursor++;
+        }
+
+        const char* TokenEnd = Cursor;
+
+        while (TokenEnd < LineEnd && !IsTokenEnd(*TokenEnd))
+        {
+            TokenEnd++;
+        }
+
+        double Value;
+        bool Parsed = ParseDouble(Cursor, TokenEnd, Value);
+
+        if (Parsed)
+        {
+            Result = static_cast<float>(Value);
+        }
+
+        Cursor = TokenEnd;
+
+        return Parsed;
+    }
+
+    inline float ParseFloat(const char*& Cursor, const char* LineEnd, double Default)
+    {
+        float Result = static_cast<float>(Default);
+        ParseFloat(Cursor, LineEnd, Result);
+
+        return Result;
+    }
+
+    inline int ParseInt(const char*& Cursor, const char* LineEnd)
+    {
+        int Sign = 1;
+        int Value = 0;
+
+        if (Cursor < LineEnd && (*Cursor == '-' || *Cursor == '+'))
+        {
+            Sign = (*Cursor == '-') ? -1 : 1;
+            Cursor++;
+        }
+
+        while (Cursor < LineEnd && IsDigit(*Cursor))
+        {
+            Value = Value * 10 + (*Cursor - '0');
+            Cursor++;
+        }
+
+        while (Cursor < LineEnd && *Cursor != '/' && !IsTokenEnd(*Cursor))
+        {
+            Cursor++;
+        }
+
+        return Sign * Value;
+    }
+
+    /*
+        Positive indices become absolute zero based indices, negative ones are resolved against the
+        chunk local count and flagged for fix-up
+    */
+
+    inline bool FixIndex(int Value, size_t LocalCount, std::vector<uint32_t>& Fixups, uint32_t Slot, int& Result)
+    {
+        if (Value > 0)
+        {
+            Result = Value - 1;
+            return true;
+        }
+
+        if (Value == 0)
+        {
+            return false;
+        }
+
+        Result = static_cast<int>(LocalCount) + Value;
+        Fixups.push_back(Slot);
+
+        return true;
+    }
+
+    std::string ReadName(const char* Cursor, const char* LineEnd)
+    {
+        while (Cursor < LineEnd && IsSpace(*Cursor))
+        {
+            Cursor++;
+        }
+
+        const char* NameEnd = LineEnd;
+
+        while (NameEnd > Cursor && (NameEnd[-1] == '\r' || IsSpace(NameEnd[-1])))
+        {
+            NameEnd--;
+        }
+
+        return std::string(Cursor, NameEnd);
+    }
+
+    void ParseChunk(Chunk& Work)
+    {
+        const char* Cursor = Work.Begin;
+
+        while (Cursor < Work.End)
+        {
+            const char* LineEnd = static_cast<const char*>(memchr(Cursor, '\n', Work.End - Cursor));
+
+            if (LineEnd == nullptr)
+            {
+                LineEnd = Work.End;
+            }
+
+            const char* Token = Cursor;
+            Cursor = LineEnd + 1;
+
+            while (Token < LineEnd && IsSpace(*Token))
+            {
+                Token++;
+            }
+
+            if (Token >= LineEnd || *Token == '#' || *Token == '\r')
+            {
+                continue;
+            }
+
+            size_t Remaining = LineEnd - Token;
+
+            if (Remaining > 1 && Token[0] == 'v' && IsSpace(Token[1]))
+            {
+                Token += 2;
+
+                float R, G, B;
+                Work.Positions.push_back(ParseFloat(Token, LineEnd, 0.0));
+                Work.Positions.push_back(ParseFloat(Token, LineEnd, 0.0));
+                Work.Positions.push_back(ParseFloat(Token, LineEnd, 0.0));
+
+                bool HasColor = ParseFloat(Token, LineEnd, R) && ParseFloat(Token, LineEnd, G) && ParseFloat(Token, LineEnd, B);
+
+                if (!HasColor)
+                {
+                    R = G = B = 1.0f;
+                }
+
+                Work.Colors.push_back(R);
+                Work.Colors.push_back(G);
+                Work.Colors.push_back(B);
+            }
+            else if (Remaining > 2 && Token[0] == 'v' && Token[1] == 'n' && IsSpace(Token[2]))
+            {
+                Token += 3;
+
+                Work.Normals.push_back(ParseFloat(Token, LineEnd, 0.0));
+                Work.Normals.push_back(ParseFloat(Token, LineEnd, 0.0));
+                Work.Normals.push_back(ParseFloat(Token, LineEnd, 0.0));
+            }
+            else if (Remaining > 2 && Token[0] == 'v' && Token[1] == 't' && IsSpace(Token[2]))
+            {
+                Token += 3;
+
+                Work.Texcoords.push_back(ParseFloat(Token, LineEnd, 0.0));
+                Work.Texcoords.push_back(ParseFloat(Token, LineEnd, 0.0));
+            }
+            else if (Remaining > 1 && Token[0] == 'f' && IsSpace(Token[1]))
+            {
+                Token += 2;
+
+                Face NewFace{ static_cast<uint32_t>(Work.FaceIndices.size()), 0 };
+
+                while (true)
+                {
+                    while (Token < LineEnd && (IsSpace(*Token) || *Token == '\r'))
+                    {
+                        Token++;
+                    }
+
+                    if (Token >= LineEnd)
+                    {
+                        break;
+                    }
+
+                    uint32_t Slot = static_cast<uint32_t>(Work.FaceIndices.size());
+                    Engine::ObjParser::Index Index{ -1, -1, -1 };
+
+                    bool Valid = FixIndex(ParseInt(Token, LineEnd), Work.Positions.size() / 3, Work.PositionFixups, Slot, Index.VertexIndex);
+
+                    if (Valid && Token < LineEnd && *Token == '/')
+                    {
+                        Token++;
+
+                        if (Token < LineEnd && *Token == '/')
+                        {
+                            Token++;
+                            Valid = FixIndex(ParseInt(Token, LineEnd), Work.Normals.size() / 3, Work.NormalFixups, Slot, Index.NormalIndex);
+                        }
+                        else
+                        {
+                            Valid = FixIndex(ParseInt(Token, LineEnd), Work.Texcoords.size() / 2, Work.TexcoordFixups, Slot, Index.TexcoordIndex);
+
+                            if (Valid && Token < LineEnd && *Token == '/')
+                            {
+                                Token++;
+                                Valid = FixIndex(ParseInt(Token, LineEnd), Work.Normals.size() / 3, Work.NormalFixups, Slot, Index.NormalIndex);
+                            }
+                        }
+                    }
+
+                    if (!Valid)
+                    {
+                        Work.Error = "OBJ > Invalid face index: " + ReadName(LineEnd - Remaining, LineEnd);
+                        return;
+                    }
+
+                    Work.FaceIndices.push_back(Index);
+                    NewFace.Count++;
+                }
+
+                Work.Faces.push_back(NewFace);
+            }
+            else if (Remaining > 6 && strncmp(Token, "usemtl", 6) == 0 && IsSpace(Token[6]))
+            {
+                Work.MaterialChanges.push_back({ static_cast<uint32_t>(Work.Faces.size()), ReadName(Token + 7, LineEnd) });
+            }
+            else if (Remaining > 6 && strncmp(Token, "mtllib", 6) == 0 && IsSpace(Token[6]))
+            {
+                Work.MaterialLibraries.push_back(ReadName(Token + 7, LineEnd));
+            }
+        }
+    }
+
+    /*
+        Point in triangle test used by tinyobj's ear clipping
+    */
+
+    bool PointInPolygon(int VertexCount, const float* VertexX, const float* VertexY, float TestX, float TestY)
+    {
+        bool Inside = false;
+
+        for (int i = 0, j = VertexCount - 1; i < VertexCount; j = i++)
+        {
+            if (((VertexY[i] > TestY) != (VertexY[j] > TestY)) &&
+                (TestX < (VertexX[j] - VertexX[i]) * (TestY - VertexY[i]) / (VertexY[j] - VertexY[i]) + VertexX[i]))
+            {
+                Inside = !Inside;
+            }
+        }
+
+        return Inside;
+    }
+
+    /*
+        Mirrors tinyobj: triangles pass through, quads split along the shorter diagonal,
+        larger polygons are ear clipped in the plane picked from the first non-degenerate corner
+    */
+
+    void Triangulate(const Engine::ObjParser::Index* Polygon, uint32_t Count, const std::vector<float>& Positions, int MaterialId, std::vector<Engine::ObjParser::Index>& Triangles, std::vector<int>& Materials)
+    {
+        auto Emit = [&](const Engine::ObjParser::Index& A, const Engine::ObjParser::Index& B, const Engine::ObjParser::Index& C)
+        {
+            Triangles.push_back(A);
+            Triangles.push_back(B);
+            Triangles.push_back(C);
+            Materials.push_back(MaterialId);
+        };
+
+        auto Position = [&](const Engine::ObjParser::Index& Index, size_t Axis)
+        {
+            return Positions[size_t(Index.VertexIndex) * 3 + Axis];
+        };
+
+        auto InRange = [&](const Engine::ObjParser::Index& Index)
+        {
+            return Index.VertexIndex >= 0 && size_t(Index.VertexIndex) * 3 + 2 < Positions.size();
+        };
+
+        if (Count < 3)
+        {
+            return;
+        }
+
+        if (Count == 3)
+        {
+            Emit(Polygon[0], Polygon[1], Polygon[2]);
+            return;
+        }
+
+        if (Count == 4)
+        {
+            if (!InRange(Polygon[0]) || !InRange(Polygon[1]) || !InRange(Polygon[2]) || !InRange(Polygon[3]))
+            {
+                return;
+            }
+
+            float E02X = Position(Polygon[2], 0) - Position(Polygon[0], 0);
+            float E02Y = Position(Polygon[2], 1) - Position(Polygon[0], 1);
+            float E02Z = Position(Polygon[2], 2) - Position(Polygon[0], 2);
+            float E13X = Position(Polygon[3], 0) - Position(Polygon[1], 0);
+            float E13Y = Position(Polygon[3], 1) - Position(Polygon[1], 1);
+            float E13Z = Position(Polygon[3], 2) - Position(Polygon[1], 2);
+
+            float Square02 = E02X * E02X + E02Y * E02Y + E02Z * E02Z;
+            float Square13 = E13X * E13X + E13Y * E13Y + E13Z * E13Z;
+
+            if (Square02 < Square13)
+            {
+                Emit(Polygon[0], Polygon[1], Polygon[2]);
+                Emit(Polygon[0], Polygon[2], Polygon[3]);
+            }
+            else
+            {
+                Emit(Polygon[0], Polygon[1], Polygon[3]);
+                Emit(Polygon[1], Polygon[2], Polygon[3]);
+            }
+
+            return;
+        }
+
+        size_t Axes[2] = { 1, 2 };
+
+        for (uint32_t k = 0; k < Count; k++)
+        {
+            const auto& I0 = Polygon[(k + 0) % Count];
+            const auto& I1 = Polygon[(k + 1) % Count];
+            const auto& I2 = Polygon[(k + 2) % Count];
+
+            if (!InRange(I0) || !InRange(I1) || !InRange(I2))
+            {
+                continue;
+            }
+
+            float E0X = Position(I1, 0) - Position(I0, 0);
+            float E0Y = Position(I1, 1) - Position(I0, 1);
+            float E0Z = Position(I1, 2) - Position(I0, 2);
+            float E1X = Position(I2, 0) - Position(I1, 0);
+            float E1Y = Position(I2, 1) - Position(I1, 1);
+            float E1Z = Position(I2, 2) - Position(I1, 2);
+
+            float CX = std::fabs(E0Y * E1Z - E0Z * E1Y);
+            float CY = std::fabs(E0Z * E1X - E0X * E1Z);
+            float CZ = std::fabs(E0X * E1Y - E0Y * E1X);
+
+            const float Epsilon = std::numeric_limits<float>::epsilon();
+
+            if (CX > Epsilon || CY > Epsilon || CZ > Epsilon)
+            {
+                if (!(CX > CY && CX > CZ))
+                {
+                    Axes[0] = 0;
+
+                    if (CZ > CX && CZ > CY)
+                    {
+                        Axes[1] = 1;
+                    }
+                }
+
+                break;
+            }
+        }
+
+        auto Projected = [&](const Engine::ObjParser::Index& Index, size_t Axis, float& Result)
+        {
+            size_t Offset = size_t(Index.VertexIndex) * 3 + Axes[Axis];
+
+            if (Index.VertexIndex < 0 || Offset >= Positions.size())
+            {
+                return false;
+            }
+
+            Result = Positions[Offset];
+            return true;
+        };
+
+        float Area = 0.0f;
+
+        for (uint32_t k = 0; k < Count; k++)
+        {
+            float V0X, V0Y, V1X, V1Y;
+
+            if (!Projected(Polygon[k], 0, V0X) || !Projected(Polygon[k], 1, V0Y) ||
+                !Projected(Polygon[(k + 1) % Count], 0, V1X) || !Projected(Polygon[(k + 1) % Count], 1, V1Y))
+            {
+                continue;
+            }
+
+            Area += (V0X * V1Y - V0Y * V1X) * 0.5f;
+        }
+
+        std::vector<Engine::ObjParser::Index> Remaining(Polygon, Polygon + Count);
+
+        size_t GuessVertex = 0;
+        size_t RemainingIterations = Remaining.size();
+        size_t PreviousRemaining = Remaining.size();
+
+        Engine::ObjParser::Index Ear[3];
+        float VX[3];
+        float VY[3];
+
+        while (Remaining.size() > 3 && RemainingIterations > 0)
+        {
+            size_t PolygonCount = Remaining.size();
+
+            if (GuessVertex >= PolygonCount)
+            {
+                GuessVertex -= PolygonCount;
+            }
+
+            if (PreviousRemaining != PolygonCount)
+            {
+                PreviousRemaining = PolygonCount;
+                RemainingIterations = PolygonCount;
+            }
+            else
+            {
+                RemainingIterations--;
+            }
+
+            for (size_t k = 0; k < 3; k++)
+            {
+                Ear[k] = Remaining[(GuessVertex + k) % PolygonCount];
+
+                if (!Projected(Ear[k], 0, VX[k]) || !Projected(Ear[k], 1, VY[k]))
+                {
+                    VX[k] = 0.0f;
+                    VY[k] = 0.0f;
+                }
+            }
+
+            float E0X = VX[1] - VX[0];
+            float E0Y = VY[1] - VY[0];
+            float E1X = VX[2] - VX[1];
+            float E1Y = VY[2] - VY[1];
+            float Cross = E0X * E1Y - E0Y * E1X;
+
+            if (Cross * Area < 0.0f)
+            {
+                GuessVertex += 1;
+                continue;
+            }
+
+            bool Overlap = false;
+
+            for (size_t Other = 3; Other < PolygonCount; Other++)
+            {
+                size_t OtherIndex = (GuessVertex + Other) % PolygonCount;
+
+                float TX, TY;
+
+                if (!Projected(Remaining[OtherIndex], 0, TX) || !Projected(Remaining[OtherIndex], 1, TY))
+                {
+                    continue;
+                }
+
+                if (PointInPolygon(3, VX, VY, TX, TY))
+                {
+                    Overlap = true;
+                    break;
+                }
+            }
+
+            if (Overlap)
+            {
+                GuessVertex += 1;
+                continue;
+            }
+
+            Emit(Ear[0], Ear[1], Ear[2]);
+
+            Remaining.erase(Remaining.begin() + (GuessVertex + 1) % PolygonCount);
+        }
+
+        if (Remaining.size() == 3)
+        {
+            Emit(Remaining[0], Remaining[1], Remaining[2]);
+        }
+    }
+
+    /*
+        Offsets the chunk's relative indices by the element counts of everything before it
+    */
+
+    bool FixRelativeIndices(Chunk& Work)
+    {
+        for (uint32_t Slot : Work.PositionFixups)
+        {
+            Work.FaceIndices[Slot].VertexIndex += static_cast<int>(Work.PositionBase / 3);
+        }
+
+        for (uint32_t Slot : Work.NormalFixups)
+        {
+            Work.FaceIndices[Slot].NormalIndex += static_cast<int>(Work.NormalBase / 3);
+        }
+
+        for (uint32_t Slot : Work.TexcoordFixups)
+        {
+            Work.FaceIndices[Slot].TexcoordIndex += static_cast<int>(Work.TexcoordBase / 2);
+        }
+
+        for (const auto& Index : Work.FaceIndices)
+        {
+            if (Index.VertexIndex < 0 || Index.NormalIndex < -1 || Index.TexcoordIndex < -1)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /*
+        Reads the file WindowBytes at a time and hands each window, cut after its last line break, to
+        Work. A line longer than the window grows the buffer instead of being split.
+    */
+
+    template<typename Function>
+    bool ForEachWindow(const std::string& FilePath, size_t WindowBytes, Function&& Work)
+    {
+        std::ifstream File(FilePath, std::ios::binary);
+
+        if (!File.is_open())
+        {
+            return false;
+        }
+
+        std::vector<char> Buffer(std::max<size_t>(WindowBytes, 4096));
+        size_t Carry = 0;
+
+        for (;;)
+        {
+            File.read(Buffer.data() + Carry, static_cast<std::streamsize>(Buffer.size() - Carry));
+
+            size_t Filled = Carry + static_cast<size_t>(File.gcount());
+            bool Last = Filled < Buffer.size();
+
+            if (Filled == 0)
+            {
+                break;
+            }
+
+            size_t Cut = Filled;
+
+            if (!Last)
+            {
+                size_t Newline = Filled;
+
+                while (Newline > 0 && Buffer[Newline - 1] != '\n')
+                {
+                    Newline--;
+                }
+
+                if (Newline == 0)
+                {
+                    Carry = Filled;
+                    Buffer.resize(Buffer.size() * 2);
+                    continue;
+                }
+
+                Cut = Newline;
+            }
+
+            if (!Work(Buffer.data(), Buffer.data() + Cut))
+            {
+                return false;
+            }
+
+            Carry = Filled - Cut;
+            memmove(Buffer.data(), Buffer.data() + Cut, Carry);
+
+            if (Last)
+            {
+                break;
+            }
+        }
+
+        return true;
+    }
+
+    void LoadMaterialLibrary(const std::string& FilePath, std::vector<Engine::ObjParser::Material>& Materials, std::map<std::string, int>& MaterialMap)
+    {
+        std::ifstream File(FilePath);
+
+        if (!File.is_open())
+        {
+            std::cout << "OBJ > Material library not found: " << FilePath << std::endl;
+            return;
+        }
+
+        std::string Line;
+        Engine::ObjParser::Material* Current = nullptr;
+
+        while (std::getline(File, Line))
+        {
+            const char* Token = Line.c_str();
+            const char* LineEnd = Token + Line.size();
+
+            while (Token < LineEnd && IsSpace(*Token))
+            {
+                Token++;
+            }
+
+            if (strncmp(Token, "newmtl", 6) == 0 && IsSpace(Token[6]))
+            {
+                std::string Name = ReadName(Token + 7, LineEnd);
+
+                if (MaterialMap.count(Name) == 0)
+                {
+                    MaterialMap[Name] = static_cast<int>(Materials.size());
+                    Materials.push_back({ Name, "", glm::vec3(1.0f) });
+                }
+
+                Current = &Materials[MaterialMap[Name]];
+            }
+            else if (Current != nullptr && strncmp(Token, "Kd", 2) == 0 && IsSpace(Token[2]))
+            {
+                Token += 3;
+
+                Current->Diffuse.x = ParseFloat(Token, LineEnd, 0.0);
+                Current->Diffuse.y = ParseFloat(Token, LineEnd, 0.0);
+                Current->Diffuse.z = ParseFloat(Token, LineEnd, 0.0);
+            }
+            else if (Current != nullptr && strncmp(Token, "map_Kd", 6) == 0 && IsSpace(Token[6]))
+            {
+                Current->DiffuseTexture = ReadName(Token + 7, LineEnd);
+            }
+        }
+    }
+}
+
+bool Engine::ObjParser::Load(const std::string& FilePath, Engine::ObjParser::Mesh& Result, std::string& Error, unsigned int ThreadCount)
+{
+    FileSystem::MappedFile File = FileSystem::MapFile(FilePath);
+
+    if (!File.IsOpen())
+    {
+        Error = "OBJ > Failed to open file: " + FilePath;
+        return false;
+    }
+
+    if (ThreadCount == 0)
+    {
+        ThreadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    size_t ChunkCount = std::max<size_t>(1, std::min<size_t>(ThreadCount, File.Size / MinimumChunkSize));
+
+    /*
+        Split at line boundaries
+    */
+
+    std::vector<Chunk> Chunks(ChunkCount);
+
+    const char* FileEnd = File.Data + File.Size;
+    const char* ChunkBegin = File.Data;
+
+    for (size_t i = 0; i < ChunkCount; i++)
+    {
+        const char* ChunkEnd = (i + 1 == ChunkCount) ? FileEnd : File.Data + (File.Size / ChunkCount) * (i + 1);
+
+        if (ChunkEnd < ChunkBegin)
+        {
+            ChunkEnd = ChunkBegin;
+        }
+
+        const char* LineEnd = static_cast<const char*>(memchr(ChunkEnd, '\n', FileEnd - ChunkEnd));
+        ChunkEnd = (i + 1 == ChunkCount || LineEnd == nullptr) ? FileEnd : LineEnd + 1;
+
+        Chunks[i].Begin = ChunkBegin;
+        Chunks[i].End = ChunkEnd;
+
+        ChunkBegin = ChunkEnd;
+    }
+
+    ParallelFor(ChunkCount, [&](size_t i) { ParseChunk(Chunks[i]); });
+
+    for (const auto& Work : Chunks)
+    {
+        if (!Work.Error.empty())
+        {
+            FileSystem::UnmapFile(File);
+
+            Error = Work.Error;
+            return false;
+        }
+    }
+
+    /*
+        Materials are tiny, resolve them serially
+    */
+
+    std::map<std::string, int> MaterialMap;
+    Result.Materials.clear();
+
+    std::string BaseDirectory = fs::path(FilePath).parent_path().string();
+
+    for (const auto& Work : Chunks)
+    {
+        for (const auto& Library : Work.MaterialLibraries)
+        {
+            LoadMaterialLibrary(BaseDirectory.empty() ? Library : BaseDirectory + "/" + Library, Result.Materials, MaterialMap);
+        }
+    }
+
+    int CurrentMaterial = -1;
+
+    for (auto& Work : Chunks)
+    {
+        Work.InitialMaterial = CurrentMaterial;
+
+        if (!Work.MaterialChanges.empty())
+        {
+            auto Found = MaterialMap.find(Work.MaterialChanges.back().Name);
+            CurrentMaterial = (Found != MaterialMap.end()) ? Found->second : -1;
+        }
+    }
+
+    /*
+        Chunk bases, then fix up relative indices
+    */
+
+    size_t PositionCount = 0, NormalCount = 0, TexcoordCount = 0;
+
+    for (auto& Work : Chunks)
+    {
+        Work.PositionBase = PositionCount;
+        Work.NormalBase = NormalCount;
+        Work.TexcoordBase = TexcoordCount;
+
+        PositionCount += Work.Positions.size();
+        NormalCount += Work.Normals.size();
+        TexcoordCount += Work.Texcoords.size();
+    }
+
+    for (auto& Work : Chunks)
+    {
+        if (!FixRelativeIndices(Work))
+        {
+            FileSystem::UnmapFile(File);
+
+            Error = "OBJ > Relative face index out of range in " + FilePath;
+            return false;
+        }
+    }
+
+    Result.Positions.resize(PositionCount);
+    Result.Colors.resize(PositionCount);
+    Result.Normals.resize(NormalCount);
+    Result.Texcoords.resize(TexcoordCount);
+
+    ParallelFor(ChunkCount, [&](size_t i)
+    {
+        Chunk& Work = Chunks[i];
+
+        std::copy(Work.Positions.begin(), Work.Positions.end(), Result.Positions.begin() + Work.PositionBase);
+        std::copy(Work.Colors.begin(), Work.Colors.end(), Result.Colors.begin() + Work.PositionBase);
+        std::copy(Work.Normals.begin(), Work.Normals.end(), Result.Normals.begin() + Work.NormalBase);
+        std::copy(Work.Texcoords.begin(), Work.Texcoords.end(), Result.Texcoords.begin() + Work.TexcoordBase);
+    });
+
+    /*
+        Triangulation needs the merged positions, but each chunk's faces are still independent
+    */
+
+    ParallelFor(ChunkCount, [&](size_t i)
+    {
+        Chunk& Work = Chunks[i];
+
+        int Material = Work.InitialMaterial;
+        size_t NextChange = 0;
+
+        Work.Triangles.reserve(Work.FaceIndices.size() * 2);
+
+        for (size_t FaceIndex = 0; FaceIndex < Work.Faces.size(); FaceIndex++)
+        {
+            while (NextChange < Work.MaterialChanges.size() && Work.MaterialChanges[NextChange].Face <= FaceIndex)
+            {
+                auto Found = MaterialMap.find(Work.MaterialChanges[NextChange].Name);
+                Material = (Found != MaterialMap.end()) ? Found->second : -1;
+                NextChange++;
+            }
+
+            const Face& Polygon = Work.Faces[FaceIndex];
+            Triangulate(Work.FaceIndices.data() + Polygon.First, Polygon.Count, Result.Positions, Material, Work.Triangles, Work.TriangleMaterials);
+        }
+    });
+
+    size_t TriangleCount = 0;
+
+    for (auto& Work : Chunks)
+    {
+        Work.TriangleBase = TriangleCount;
+        TriangleCount += Work.TriangleMaterials.size();
+    }
+
+    Result.Indices.resize(TriangleCount * 3);
+    Result.MaterialIds.resize(TriangleCount);
+
+    ParallelFor(ChunkCount, [&](size_t i)
+    {
+        Chunk& Work = Chunks[i];
+
+        std::copy(Work.Triangles.begin(), Work.Triangles.end(), Result.Indices.begin() + Work.TriangleBase * 3);
+        std::copy(Work.TriangleMaterials.begin(), Work.TriangleMaterials.end(), Result.MaterialIds.begin() + Work.TriangleBase);
+    });
+
+    FileSystem::UnmapFile(File);
+
+    return true;
+}
+
+bool Engine::ObjParser::ScanAttributes(const std::string& FilePath, size_t WindowBytes, Engine::ObjParser::Mesh& Attributes, std::vector<uint64_t>& TriangleBounds, std::string& Error)
+{
+    Attributes = Engine::ObjParser::Mesh{};
+
+    /*
+        Triangle counts are kept per usemtl name until the libraries are loaded, polygons count as
+        n - 2 triangles which ear clipping never exceeds
+    */
+
+    std::map<std::string, uint64_t> NamedBounds;
+    std::vector<std::string> Libraries;
+
+    uint64_t UnnamedBound = 0;
+    bool HasMaterial = false;
+    bool HasColors = false;
+    std::string CurrentName;
+
+    bool Success = ForEachWindow(FilePath, WindowBytes, [&](const char* Begin, const char* End)
+    {
+        Chunk Work{};
+        Work.Begin = Begin;
+        Work.End = End;
+
+        ParseChunk(Work);
+
+        if (!Work.Error.empty())
+        {
+            Error = Work.Error;
+            return false;
+        }
+
+        /*
+            Vertex colors are rare, only store them once the file turns out to have some
+        */
+
+        if (!HasColors && std::any_of(Work.Colors.begin(), Work.Colors.end(), [](float Value) { return Value != 1.0f; }))
+        {
+            HasColors = true;
+            Attributes.Colors.assign(Attributes.Positions.size(), 1.0f);
+        }
+
+        if (HasColors)
+        {
+            Attributes.Colors.insert(Attributes.Colors.end(), Work.Colors.begin(), Work.Colors.end());
+        }
+
+        Attributes.Positions.insert(Attributes.Positions.end(), Work.Positions.begin(), Work.Positions.end());
+        Attributes.Normals.insert(Attributes.Normals.end(), Work.Normals.begin(), Work.Normals.end());
+        Attributes.Texcoords.insert(Attributes.Texcoords.end(), Work.Texcoords.begin(), Work.Texcoords.end());
+
+        size_t NextChange = 0;
+
+        for (size_t FaceIndex = 0; FaceIndex < Work.Faces.size(); FaceIndex++)
+        {
+            while (NextChange < Work.MaterialChanges.size() && Work.MaterialChanges[NextChange].Face <= FaceIndex)
+            {
+                CurrentName = Work.MaterialChanges[NextChange].Name;
+                HasMaterial = true;
+                NextChange++;
+            }
+
+            uint64_t Bound = Work.Faces[FaceIndex].Count >= 3 ? Work.Faces[FaceIndex].Count - 2 : 0;
+
+            if (HasMaterial)
+            {
+                NamedBounds[CurrentName] += Bound;
+            }
+            else
+            {
+                UnnamedBound += Bound;
+            }
+        }
+
+        while (NextChange < Work.MaterialChanges.size())
+        {
+            CurrentName = Work.MaterialChanges[NextChange++].Name;
+            HasMaterial = true;
+        }
+
+        Libraries.insert(Libraries.end(), Work.MaterialLibraries.begin(), Work.MaterialLibraries.end());
+
+        return true;
+    });
+
+    if (!Success)
+    {
+        if (Error.empty())
+        {
+            Error = "OBJ > Failed to open file: " + FilePath;
+        }
+
+        return false;
+    }
+
+    std::map<std::string, int> MaterialMap;
+    std::string BaseDirectory = fs::path(FilePath).parent_path().string();
+
+    for (const auto& Library : Libraries)
+    {
+        LoadMaterialLibrary(BaseDirectory.empty() ? Library : BaseDirectory + "/" + Library, Attributes.Materials, MaterialMap);
+    }
+
+    TriangleBounds.assign(Attributes.Materials.size() + 1, 0);
+    TriangleBounds[0] = UnnamedBound;
+
+    for (const auto& Named : NamedBounds)
+    {
+        auto Found = MaterialMap.find(Named.first);
+        TriangleBounds[Found != MaterialMap.end() ? Found->second + 1 : 0] += Named.second;
+    }
+
+    return true;
+}
+
+bool Engine::ObjParser::StreamTriangles(const std::string& FilePath, size_t WindowBytes, const Engine::ObjParser::Mesh& Attributes, const std::function<void(const Engine::ObjParser::Index*, int)>& Emit, std::string& Error)
+{
+    std::map<std::string, int> MaterialMap;
+
+    for (size_t i = 0; i < Attributes.Materials.size(); i++)
+    {
+        MaterialMap.emplace(Attributes.Materials[i].Name, static_cast<int>(i));
+    }
+
+    size_t PositionCount = 0, NormalCount = 0, TexcoordCount = 0;
+    int Material = -1;
+
+    bool Success = ForEachWindow(FilePath, WindowBytes, [&](const char* Begin, const char* End)
+    {
+        Chunk Work{};
+        Work.Begin = Begin;
+        Work.End = End;
+
+        ParseChunk(Work);
+
+        Work.PositionBase = PositionCount;
+        Work.NormalBase = NormalCount;
+        Work.TexcoordBase = TexcoordCount;
+
+        PositionCount += Work.Positions.size();
+        NormalCount += Work.Normals.size();
+        TexcoordCount += Work.Texcoords.size();
+
+        if (!Work.Error.empty() || !FixRelativeIndices(Work))
+        {
+            Error = Work.Error.empty() ? "OBJ > Relative face index out of range in " + FilePath : Work.Error;
+            return false;
+        }
+
+        size_t NextChange = 0;
+
+        for (size_t FaceIndex = 0; FaceIndex < Work.Faces.size(); FaceIndex++)
+        {
+            while (NextChange < Work.MaterialChanges.size() && Work.MaterialChanges[NextChange].Face <= FaceIndex)
+            {
+                auto Found = MaterialMap.find(Work.MaterialChanges[NextChange].Name);
+                Material = (Found != MaterialMap.end()) ? Found->second : -1;
+                NextChange++;
+            }
+
+            const Face& Polygon = Work.Faces[FaceIndex];
+
+            Work.Triangles.clear();
+            Work.TriangleMaterials.clear();
+
+            Triangulate(Work.FaceIndices.data() + Polygon.First, Polygon.Count, Attributes.Positions, Material, Work.Triangles, Work.TriangleMaterials);
+
+            for (size_t Triangle = 0; Triangle < Work.TriangleMaterials.size(); Triangle++)
+            {
+                Emit(Work.Triangles.data() + Triangle * 3, Work.TriangleMaterials[Triangle]);
+            }
+        }
+
+        while (NextChange < Work.MaterialChanges.size())
+        {
+            auto Found = MaterialMap.find(Work.MaterialChanges[NextChange++].Name);
+            Material = (Found != MaterialMap.end()) ? Found->second : -1;
+        }
+
+        return true;
+    });
+
+    if (!Success && Error.empty())
+    {
+        Error = "OBJ > Failed to open file: " + FilePath;
+    }
+
+    return Success;
+}
+
+Vulkan::Renderer::Vertex Engine::ObjParser::BuildVertex(const Engine::ObjParser::Mesh& Mesh, const Engine::ObjParser::Index& Index)
+{
+    Vulkan::Renderer::Vertex Vertex{};
+
+    if (Index.VertexIndex >= 0)
+    {
+        Vertex.Pos = {
+            Mesh.Positions[3 * Index.VertexIndex + 0],
+            Mesh.Positions[3 * Index.VertexIndex + 1],
+            Mesh.Positions[3 * Index.VertexIndex + 2]
+        };
+    }
+
+    auto ColorIndex = 3 * Index.VertexIndex + 2;
+    if (ColorIndex < Mesh.Colors.size())
+    {
+        Vertex.Color = {
+            Mesh.Colors[ColorIndex - 2],
+            Mesh.Colors[ColorIndex - 1],
+            Mesh.Colors[ColorIndex - 0]
+        };
+    }
+    else
+    {
+        Vertex.Color = { 1.0f, 1.0f, 1.0f };
+    }
+
+    if (Index.NormalIndex >= 0)
+    {
+        Vertex.Normal = {
+            Mesh.Normals[3 * Index.NormalIndex + 0],
+            Mesh.Normals[3 * Index.NormalIndex + 1],
+            Mesh.Normals[3 * Index.NormalIndex + 2]
+        };
+    }
+
+    if (Index.TexcoordIndex >= 0)
+    {
+        Vertex.UV = {
+            Mesh.Texcoords[2 * Index.TexcoordIndex + 0],
+            1.0f - Mesh.Texcoords[2 * Index.TexcoordIndex + 1]
+        };
+    }
+
+    return Vertex;
+}
+
+size_t Engine::ObjParser::EstimateUniqueVertices(const Engine::ObjParser::Mesh& Mesh)
+{
+    size_t Largest = std::max({ Mesh.Positions.size() / 3, Mesh.Normals.size() / 3, Mesh.Texcoords.size() / 2 });
+
+    return std::min(Mesh.Indices.size(), Largest);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#ifndef OBJPARSER_H
+#define OBJPARSER_H
+
+namespace Engine
+{
+	/*
+		In-tree Wavefront OBJ parser used on the cold load path instead of tinyobj.
+
+		The file is memory mapped and split at line boundaries, each chunk is tokenized on its own
+		thread and the per-chunk results are merged in file order. Number parsing, face index
+		fix-up and polygon triangulation follow tinyobj so the output is identical to tinyobj::LoadObj.
+	*/
+
+	namespace ObjParser
+	{
+		struct Index
+		{
+			int VertexIndex;
+			int NormalIndex;
+			int TexcoordIndex;
+		};
+
+		struct Material
+		{
+			std::string Name;
+			std::string DiffuseTexture;
+			glm::vec3 Diffuse{ 1.0f };
+		};
+
+		struct Mesh
+		{
+			std::vector<float> Positions;
+			std::vector<float> Colors;
+			std::vector<float> Normals;
+			std::vector<float> Texcoords;
+
+			/*
+				Triangulated, three entries per triangle in file order
+			*/
+
+			std::vector<Index> Indices;
+			std::vector<int> MaterialIds;
+
+			std::vector<Material> Materials;
+		};
+
+		bool Load(const std::string& FilePath, Mesh& Result, std::string& Error, unsigned int ThreadCount = 0);
+
+		/*
+			Windowed alternative to Load for files too large to hold parsed in memory, the file is read
+			WindowBytes at a time in two passes.
+
+			ScanAttributes keeps only the attribute streams and materials (Indices and MaterialIds stay
+			empty, Colors is empty unless the file has vertex colors) plus, per material id + 1, an upper
+			bound on the triangles it will produce. StreamTriangles then hands every triangle to Emit in
+			file order, triangulated exactly like Load, nothing but the current window is held.
+		*/
+
+		bool ScanAttributes(const std::string& FilePath, size_t WindowBytes, Mesh& Attributes, std::vector<uint64_t>& TriangleBounds, std::string& Error);
+		bool StreamTriangles(const std::string& FilePath, size_t WindowBytes, const Mesh& Attributes, const std::function<void(const Index* Triangle, int MaterialId)>& Emit, std::string& Error);
+
+		/*
+			Vertex for one triangle corner, the texture V is flipped and corners without a color get white
+		*/
+
+		Vulkan::Renderer::Vertex BuildVertex(const Mesh& Mesh, const Index& Index);
+
+		/*
+			Unique vertices can't outnumber the triangle corners, and in practice rarely exceed the largest
+			attribute stream, so the dedup table is sized from whichever is smaller
+		*/
+
+		size_t EstimateUniqueVertices(const Mesh& Mesh);
+	}
+}
+
+#endif
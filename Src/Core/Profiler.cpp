@@ -0,0 +1,300 @@
+#include "../Common.h"
+#include "Profiler.h"
+
+#if ENGINE_PROFILE
+
+#include <atomic>
+#include <mutex>
+#include <memory>
+
+namespace
+{
+    struct Event
+    {
+        const char* Name;
+        uint64_t Begin;
+        uint64_t End;
+    };
+
+    /*
+        Ring slots are relaxed atomics so a reader copying a slot the owner is overwriting reads a mix of
+        old and new values rather than racing, Snapshot throws such slots away
+    */
+
+    struct Slot
+    {
+        std::atomic<const char*> Name{ nullptr };
+        std::atomic<uint64_t> Begin{ 0 };
+        std::atomic<uint64_t> End{ 0 };
+    };
+
+    /*
+        Written only by its owning thread. Head counts every event ever written, slot Head % EventsPerThread
+        is filled in first and Head published after it, so a reader that loads Head sees complete events
+        below it.
+    */
+
+    struct ThreadBuffer
+    {
+        uint32_t Id = 0;
+        std::string Name;
+        bool Retired = false;
+        std::atomic<uint64_t> Head{ 0 };
+        std::unique_ptr<Slot[]> Events;
+    };
+
+    const std::chrono::steady_clock::time_point Epoch = std::chrono::steady_clock::now();
+
+    struct ExitedThread
+    {
+        uint32_t Id;
+        std::string Name;
+        std::vector<Event> Events;
+    };
+
+    /*
+        Only taken when a thread records its first event, on exit and while writing the trace. The ring of
+        an exited thread is handed to the next new thread, so restarting a worker pool doesn't grow memory.
+        What it still held is copied to Exited first and written under the old thread's id.
+    */
+
+    std::mutex RegistryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> Buffers;
+    std::vector<ExitedThread> Exited;
+    uint32_t NextId = 1;
+
+    /*
+        Events kept across all exited threads, the oldest threads are dropped past it
+    */
+
+    const size_t MaxExitedEvents = 4 * Engine::Profiler::EventsPerThread;
+
+    /*
+        Copy out the events still in the ring. The owner keeps writing meanwhile, anything it may have
+        overwritten during the copy is dropped by checking Head again afterwards.
+    */
+
+    std::vector<Event> Snapshot(const ThreadBuffer& Buffer)
+    {
+        uint64_t Head = Buffer.Head.load(std::memory_order_acquire);
+        uint64_t First = Head > Engine::Profiler::EventsPerThread ? Head - Engine::Profiler::EventsPerThread : 0;
+
+        std::vector<Event> Copy;
+        Copy.reserve(Head - First);
+
+        for (uint64_t i = First; i < Head; i++)
+        {
+            const Slot& Source = Buffer.Events[i % Engine::Profiler::EventsPerThread];
+
+            Copy.push_back({ Source.Name.load(std::memory_order_relaxed), Source.Begin.load(std::memory_order_relaxed), Source.End.load(std::memory_order_relaxed) });
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        uint64_t After = Buffer.Head.load(std::memory_order_relaxed);
+        uint64_t Valid = After >= Engine::Profiler::EventsPerThread ? After - Engine::Profiler::EventsPerThread + 1 : 0;
+
+        if (Valid > First)
+        {
+            Copy.erase(Copy.begin(), Copy.begin() + std::min<uint64_t>(Valid - First, Copy.size()));
+        }
+
+        return Copy;
+    }
+
+    struct LocalBuffer
+    {
+        ThreadBuffer* Buffer = nullptr;
+
+        ~LocalBuffer()
+        {
+            if (Buffer != nullptr)
+            {
+                std::lock_guard<std::mutex> Lock(RegistryMutex);
+                Buffer->Retired = true;
+            }
+        }
+    };
+
+    thread_local LocalBuffer Local;
+
+    ThreadBuffer* GetThreadBuffer()
+    {
+        if (Local.Buffer != nullptr)
+        {
+            return Local.Buffer;
+        }
+
+        std::lock_guard<std::mutex> Lock(RegistryMutex);
+
+        for (auto& Buffer : Buffers)
+        {
+            if (Buffer->Retired)
+            {
+                /*
+                    The owner is gone, nothing writes the ring while it is reset
+                */
+
+                Exited.push_back({ Buffer->Id, Buffer->Name, Snapshot(*Buffer) });
+
+                size_t ExitedEvents = 0;
+
+                for (const ExitedThread& Thread : Exited)
+                {
+                    ExitedEvents += Thread.Events.size();
+                }
+
+                while (ExitedEvents > MaxExitedEvents)
+                {
+                    ExitedEvents -= Exited.front().Events.size();
+                    Exited.erase(Exited.begin());
+                }
+
+                Buffer->Id = NextId++;
+                Buffer->Name = "Thread " + std::to_string(Buffer->Id);
+                Buffer->Head.store(0, std::memory_order_relaxed);
+                Buffer->Retired = false;
+                Local.Buffer = Buffer.get();
+
+                return Local.Buffer;
+            }
+        }
+
+        auto Buffer = std::make_unique<ThreadBuffer>();
+        Buffer->Id = NextId++;
+        Buffer->Name = "Thread " + std::to_string(Buffer->Id);
+        Buffer->Events = std::make_unique<Slot[]>(Engine::Profiler::EventsPerThread);
+
+        Local.Buffer = Buffer.get();
+        Buffers.push_back(std::move(Buffer));
+
+        return Local.Buffer;
+    }
+
+    void Push(const Event& Value)
+    {
+        ThreadBuffer* Buffer = GetThreadBuffer();
+
+        uint64_t Head = Buffer->Head.load(std::memory_order_relaxed);
+
+        Slot& Target = Buffer->Events[Head % Engine::Profiler::EventsPerThread];
+
+        Target.Name.store(Value.Name, std::memory_order_relaxed);
+        Target.Begin.store(Value.Begin, std::memory_order_relaxed);
+        Target.End.store(Value.End, std::memory_order_relaxed);
+
+        Buffer->Head.store(Head + 1, std::memory_order_release);
+    }
+
+    void WriteString(std::ofstream& File, const std::string& Value)
+    {
+        File << '"';
+
+        for (char Character : Value)
+        {
+            if (Character == '"' || Character == '\\')
+            {
+                File << '\\' << Character;
+            }
+            else if (static_cast<unsigned char>(Character) < 0x20)
+            {
+                File << ' ';
+            }
+            else
+            {
+                File << Character;
+            }
+        }
+
+        File << '"';
+    }
+
+    /*
+        Trace timestamps are in microseconds, keep the nanoseconds as three decimals
+    */
+
+    void WriteMicroseconds(std::ofstream& File, uint64_t Nanoseconds)
+    {
+        uint64_t Fraction = Nanoseconds % 1000;
+
+        File << Nanoseconds / 1000 << '.' << static_cast<char>('0' + Fraction / 100) << static_cast<char>('0' + Fraction / 10 % 10) << static_cast<char>('0' + Fraction % 10);
+    }
+
+    size_t WriteThread(std::ofstream& File, uint32_t Id, const std::string& Name, const std::vector<Event>& Events, bool& First)
+    {
+        File << (First ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << Id << ",\"args\":{\"name\":";
+        WriteString(File, Name);
+        File << "}}";
+
+        First = false;
+
+        for (const Event& Value : Events)
+        {
+            File << ",\n{\"name\":";
+            WriteString(File, Value.Name);
+
+            File << ",\"ph\":\"X\",\"ts\":";
+            WriteMicroseconds(File, Value.Begin);
+            File << ",\"dur\":";
+            WriteMicroseconds(File, Value.End - Value.Begin);
+            File << ",\"pid\":1,\"tid\":" << Id << "}";
+        }
+
+        return Events.size();
+    }
+}
+
+uint64_t Engine::Profiler::Now()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Epoch).count());
+}
+
+void Engine::Profiler::Record(const char* Name, uint64_t Begin, uint64_t End)
+{
+    Push({ Name, Begin, End });
+}
+
+void Engine::Profiler::SetThreadName(const std::string& Name)
+{
+    ThreadBuffer* Buffer = GetThreadBuffer();
+
+    std::lock_guard<std::mutex> Lock(RegistryMutex);
+    Buffer->Name = Name;
+}
+
+bool Engine::Profiler::WriteChromeTrace(const std::string& FilePath)
+{
+    std::ofstream File(FilePath, std::ios::trunc);
+
+    if (!File.is_open())
+    {
+        std::cout << "PROFILE > Failed to open " << FilePath << std::endl;
+
+        return false;
+    }
+
+    std::lock_guard<std::mutex> Lock(RegistryMutex);
+
+    size_t EventCount = 0;
+    bool First = true;
+
+    File << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    for (const ExitedThread& Thread : Exited)
+    {
+        EventCount += WriteThread(File, Thread.Id, Thread.Name, Thread.Events, First);
+    }
+
+    for (const auto& Buffer : Buffers)
+    {
+        EventCount += WriteThread(File, Buffer->Id, Buffer->Name, Snapshot(*Buffer), First);
+    }
+
+    File << "\n]}\n";
+
+    std::cout << "PROFILE > Wrote " << EventCount << " events from " << Exited.size() + Buffers.size() << " threads to " << FilePath << std::endl;
+
+    return true;
+}
+
+#endif
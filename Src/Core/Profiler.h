@@ -0,0 +1,92 @@
+#pragma once
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/*
+	CPU profiler, on in debug builds. Define ENGINE_PROFILE as 1 to keep it in a release build or as 0
+	to drop it from a debug one, when it is 0 every PROFILE_ macro expands to nothing and no
+	timestamps are taken.
+*/
+
+#ifndef ENGINE_PROFILE
+	#ifdef NDEBUG
+		#define ENGINE_PROFILE 0
+	#else
+		#define ENGINE_PROFILE 1
+	#endif
+#endif
+
+#if ENGINE_PROFILE
+	#define PROFILE_CONCAT_INNER(A, B) A##B
+	#define PROFILE_CONCAT(A, B) PROFILE_CONCAT_INNER(A, B)
+
+	#define PROFILE_ZONE(Name) Engine::Profiler::Zone PROFILE_CONCAT(ProfileZone, __LINE__)(Name)
+	#define PROFILE_THREAD(Name) Engine::Profiler::SetThreadName(Name)
+	#define PROFILE_WRITE(FilePath) Engine::Profiler::WriteChromeTrace(FilePath)
+#else
+	#define PROFILE_ZONE(Name)
+	#define PROFILE_THREAD(Name)
+	#define PROFILE_WRITE(FilePath)
+#endif
+
+#if ENGINE_PROFILE
+
+namespace Engine
+{
+	/*
+		Scoped zones timed in nanoseconds on the steady clock. Every thread writes its zones into its
+		own ring of EventsPerThread entries without taking a lock, so the rings always hold the most
+		recent stretch of each thread and older events are overwritten. WriteChromeTrace copies out
+		whatever they hold as Chrome trace JSON, viewable in chrome://tracing or Perfetto.
+
+		Use the PROFILE_ macros rather than calling in here, so instrumentation disappears with
+		ENGINE_PROFILE. Zone names must outlive the profiler, string literals or __func__.
+	*/
+
+	namespace Profiler
+	{
+		static const uint32_t EventsPerThread = 1 << 16;
+
+		/*
+			Nanoseconds since the profiler was first used
+		*/
+
+		uint64_t Now();
+
+		void Record(const char* Name, uint64_t Begin, uint64_t End);
+
+		/*
+			Name shown for the calling thread in the trace, the name is copied
+		*/
+
+		void SetThreadName(const std::string& Name);
+
+		/*
+			Writes every thread's ring, returns false if the file couldn't be opened
+		*/
+
+		bool WriteChromeTrace(const std::string& FilePath);
+
+		class Zone
+		{
+		public:
+			Zone(const char* Name) : Name(Name), Begin(Engine::Profiler::Now()) {}
+
+			~Zone()
+			{
+				Engine::Profiler::Record(Name, Begin, Engine::Profiler::Now());
+			}
+
+			Zone(const Zone&) = delete;
+			Zone& operator=(const Zone&) = delete;
+		private:
+			const char* Name;
+			uint64_t Begin;
+		};
+	}
+}
+
+#endif
+
+#endif
@@ -0,0 +1,272 @@
+#include "../Common.h"
+#include "./API/Vulkan/Renderer.h"
+#include "Streaming.h"
+#include "ModelRegistry.h"
+#include "GeometryPool.h"
+#include "Profiler.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+
+VkDeviceSize Engine::Streaming::MaxUploadBytesPerFrame = 8 * 1024 * 1024;
+
+namespace
+{
+    struct Job
+    {
+        uint32_t Target;
+        std::string FilePath;
+        Engine::Model Model;
+        std::string Error;
+        std::chrono::high_resolution_clock::time_point RequestTime;
+    };
+
+    struct Upload
+    {
+        uint32_t Target;
+        std::string FilePath;
+        uint64_t Batch;
+        std::chrono::high_resolution_clock::time_point RequestTime;
+    };
+
+    std::vector<std::thread> Workers;
+    std::mutex Mutex;
+    std::condition_variable WorkAvailable;
+    std::deque<Job> Pending;
+    std::deque<Job> Prepared;
+    std::vector<Upload> Uploads;
+    std::atomic<uint32_t> Outstanding{ 0 };
+    bool Stopping = false;
+
+    void WorkerMain()
+    {
+        PROFILE_THREAD("Streaming");
+
+        for (;;)
+        {
+            Job Work;
+
+            {
+                std::unique_lock<std::mutex> Lock(Mutex);
+                WorkAvailable.wait(Lock, [] { return Stopping || !Pending.empty(); });
+
+                if (Stopping)
+                {
+                    return;
+                }
+
+                Work = std::move(Pending.front());
+                Pending.pop_front();
+            }
+
+            try
+            {
+                Work.Model.Prepare(Work.FilePath);
+            }
+            catch (const std::exception& e)
+            {
+                Work.Error = e.what();
+            }
+
+            std::lock_guard<std::mutex> Lock(Mutex);
+            Prepared.push_back(std::move(Work));
+        }
+    }
+
+    VkDeviceSize GetUploadSize(const Engine::Model& Model)
+    {
+        /*
+            Prepare has already picked the model's format, which falls back to Full without a packed pipeline
+        */
+
+        VkDeviceSize VertexStride = Model.Format == Engine::Model::VertexFormat::Packed ? sizeof(Vulkan::Renderer::PackedVertex) : sizeof(Vulkan::Renderer::Vertex);
+
+        return VertexStride * Model.VertexCount + sizeof(uint32_t) * Model.IndexCount;
+    }
+
+    void BeginUpload(Job& Work)
+    {
+        Engine::Model& Target = Engine::Models::Get(Work.Target);
+
+        Target = std::move(Work.Model);
+        Target.Upload();
+
+        Uploads.push_back({ Work.Target, Work.FilePath, Vulkan::Staging::GetBatch(), Work.RequestTime });
+    }
+
+    void FinishUpload(const Upload& Finished)
+    {
+        Engine::Model& Target = Engine::Models::Get(Finished.Target);
+
+        Target.Resident = true;
+
+        Vulkan::Renderer::InvalidateCommandBuffers();
+
+        Outstanding--;
+
+        float Elapsed = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - Finished.RequestTime).count();
+
+        std::cout << "STREAM > " << Finished.FilePath << " resident after " << Elapsed << " ms" << std::endl;
+
+        /*
+            Everything using it went away while it was loading
+        */
+
+        Engine::Models::Unload(Finished.Target);
+
+        if (Outstanding == 0)
+        {
+            Engine::GeometryPool::PrintStats();
+            Vulkan::Staging::PrintStats();
+        }
+    }
+}
+
+void Engine::Streaming::Start(unsigned int ThreadCount)
+{
+    if (!Workers.empty())
+    {
+        return;
+    }
+
+    if (ThreadCount == 0)
+    {
+        ThreadCount = std::max(1u, std::thread::hardware_concurrency() / 2);
+    }
+
+    Stopping = false;
+
+    for (unsigned int i = 0; i < ThreadCount; i++)
+    {
+        Workers.emplace_back(WorkerMain);
+    }
+
+    std::cout << "STREAM > Started " << ThreadCount << " loader threads" << std::endl;
+}
+
+void Engine::Streaming::Stop()
+{
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Stopping = true;
+    }
+
+    WorkAvailable.notify_all();
+
+    for (auto& Worker : Workers)
+    {
+        Worker.join();
+    }
+
+    Workers.clear();
+
+    /*
+        Uploads still in flight hold staging ring space, let them finish before the device goes away
+    */
+
+    for (const auto& InFlight : Uploads)
+    {
+        Vulkan::Staging::Wait(InFlight.Batch);
+        FinishUpload(InFlight);
+    }
+
+    Uploads.clear();
+    Pending.clear();
+    Prepared.clear();
+    Outstanding = 0;
+}
+
+void Engine::Streaming::Request(uint32_t Model, const std::string& FilePath)
+{
+    Engine::Streaming::Start();
+
+    Job Work{};
+    Work.Target = Model;
+    Work.FilePath = FilePath;
+    Work.RequestTime = std::chrono::high_resolution_clock::now();
+
+    Outstanding++;
+
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Pending.push_back(std::move(Work));
+    }
+
+    WorkAvailable.notify_one();
+}
+
+void Engine::Streaming::Update()
+{
+    PROFILE_ZONE("Streaming::Update");
+
+    /*
+        Retire uploads whose staging batch has completed, never blocks
+    */
+
+    Vulkan::Staging::Update();
+
+    for (size_t i = 0; i < Uploads.size();)
+    {
+        if (Vulkan::Staging::IsComplete(Uploads[i].Batch))
+        {
+            FinishUpload(Uploads[i]);
+
+            Uploads[i] = Uploads.back();
+            Uploads.pop_back();
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    /*
+        Start uploads for models the workers have finished, within this frame's budget
+    */
+
+    VkDeviceSize Budget = Engine::Streaming::MaxUploadBytesPerFrame;
+    bool First = true;
+
+    for (;;)
+    {
+        Job Work;
+
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+
+            if (Prepared.empty() || (!First && GetUploadSize(Prepared.front().Model) > Budget))
+            {
+                break;
+            }
+
+            Work = std::move(Prepared.front());
+            Prepared.pop_front();
+        }
+
+        First = false;
+
+        if (!Work.Error.empty())
+        {
+            std::cout << "STREAM > Failed to load " << Work.FilePath << ": " << Work.Error << std::endl;
+
+            Engine::Models::Entries[Work.Target].Failed = true;
+            Engine::Models::Unload(Work.Target);
+
+            Outstanding--;
+            continue;
+        }
+
+        VkDeviceSize Size = GetUploadSize(Work.Model);
+        Budget = Size < Budget ? Budget - Size : 0;
+
+        BeginUpload(Work);
+    }
+}
+
+bool Engine::Streaming::IsIdle()
+{
+    return Outstanding == 0;
+}
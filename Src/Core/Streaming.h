@@ -0,0 +1,34 @@
+#pragma once
+
+#ifndef STREAMING_H
+#define STREAMING_H
+
+namespace Engine
+{
+	/*
+		Background model loading. Worker threads run Model::Prepare (cache or OBJ parse, optimization,
+		LODs, meshlets), the render thread picks finished models up in Update and records their copies
+		into the current staging batch, submitted once for the frame. The Engine::Models entry is marked
+		resident once that batch has completed.
+	*/
+
+	namespace Streaming
+	{
+		/*
+			Caps the staging memory written per frame so a burst of finished models doesn't spike one
+			frame, a single model larger than this still goes through on its own
+		*/
+
+		extern VkDeviceSize MaxUploadBytesPerFrame;
+
+		void Start(unsigned int ThreadCount = 0);
+		void Stop();
+
+		void Request(uint32_t Model, const std::string& FilePath);
+		void Update();
+
+		bool IsIdle();
+	}
+}
+
+#endif
@@ -0,0 +1,483 @@
+#include "../../Common.h"
+#include "Tools.h"
+
+#if ENGINE_TOOLS
+
+#include "../API/Vulkan/Renderer.h"
+#include "../Model.h"
+#include "../MeshCache.h"
+#include "../ObjParser.h"
+#include "../GltfParser.h"
+#include "../VertexMap.h"
+
+#include <unordered_map>
+#include <filesystem>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader.h>
+
+namespace
+{
+    /*
+        Largest resident set the process has had so far, in bytes
+    */
+
+    size_t GetPeakResidentBytes()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS Counters{};
+
+        if (K32GetProcessMemoryInfo(GetCurrentProcess(), &Counters, sizeof(Counters)))
+        {
+            return Counters.PeakWorkingSetSize;
+        }
+
+        return 0;
+#else
+        rusage Usage{};
+        getrusage(RUSAGE_SELF, &Usage);
+
+    #ifdef __APPLE__
+        return static_cast<size_t>(Usage.ru_maxrss);
+    #else
+        return static_cast<size_t>(Usage.ru_maxrss) * 1024;
+    #endif
+#endif
+    }
+
+    /*
+        Linux lets the peak be reset so each measured pass starts from the current footprint, elsewhere
+        the peak only ever grows and passes have to run smallest first
+    */
+
+    bool ResetPeakResidentBytes()
+    {
+#ifdef __linux__
+        std::ofstream ClearRefs("/proc/self/clear_refs");
+        ClearRefs << "5";
+
+        return static_cast<bool>(ClearRefs);
+#else
+        return false;
+#endif
+    }
+
+    template<typename T>
+    size_t CapacityBytes(const std::vector<T>& Values)
+    {
+        return Values.capacity() * sizeof(T);
+    }
+
+    /*
+        The std::unordered_map setup VertexMap replaced, kept so BenchmarkVertexMap has something to
+        compare against
+    */
+
+    struct LegacyVertexHash
+    {
+        size_t operator()(Vulkan::Renderer::Vertex const& Vertex) const
+        {
+            return ((std::hash<glm::vec3>()(Vertex.Pos) ^
+                (std::hash<glm::vec3>()(Vertex.Color) << 1)) >> 1) ^
+                (std::hash<glm::vec2>()(Vertex.UV) << 1);
+        }
+    };
+
+    size_t LegacyCurrentBytes = 0;
+    size_t LegacyPeakBytes = 0;
+
+    template<typename T>
+    struct CountingAllocator
+    {
+        using value_type = T;
+
+        CountingAllocator() = default;
+
+        template<typename U>
+        CountingAllocator(const CountingAllocator<U>&) {}
+
+        T* allocate(size_t Count)
+        {
+            LegacyCurrentBytes += Count * sizeof(T);
+            LegacyPeakBytes = std::max(LegacyPeakBytes, LegacyCurrentBytes);
+
+            return static_cast<T*>(::operator new(Count * sizeof(T)));
+        }
+
+        void deallocate(T* Pointer, size_t Count)
+        {
+            LegacyCurrentBytes -= Count * sizeof(T);
+
+            ::operator delete(Pointer);
+        }
+
+        template<typename U>
+        bool operator==(const CountingAllocator<U>&) const { return true; }
+
+        template<typename U>
+        bool operator!=(const CountingAllocator<U>&) const { return false; }
+    };
+}
+
+bool Engine::Tools::VerifyParser(const std::string& FilePath)
+{
+    tinyobj::attrib_t Attrib;
+    std::vector<tinyobj::shape_t> Shapes;
+    std::vector<tinyobj::material_t> Materials;
+    std::string Warn, Error;
+
+    auto StartTime = std::chrono::high_resolution_clock::now();
+
+    if (!tinyobj::LoadObj(&Attrib, &Shapes, &Materials, &Warn, &Error, FilePath.c_str()))
+    {
+        throw std::runtime_error(Warn + Error);
+    }
+
+    auto MiddleTime = std::chrono::high_resolution_clock::now();
+
+    Engine::ObjParser::Mesh Mesh;
+
+    if (!Engine::ObjParser::Load(FilePath, Mesh, Error))
+    {
+        throw std::runtime_error(Error);
+    }
+
+    auto EndTime = std::chrono::high_resolution_clock::now();
+
+    bool Match = Attrib.vertices == Mesh.Positions && Attrib.colors == Mesh.Colors &&
+        Attrib.normals == Mesh.Normals && Attrib.texcoords == Mesh.Texcoords;
+
+    size_t Offset = 0;
+
+    for (const auto& Shape : Shapes)
+    {
+        for (const auto& Index : Shape.mesh.indices)
+        {
+            if (!Match || Offset >= Mesh.Indices.size())
+            {
+                Match = false;
+                break;
+            }
+
+            const auto& Other = Mesh.Indices[Offset++];
+            Match = Index.vertex_index == Other.VertexIndex && Index.normal_index == Other.NormalIndex && Index.texcoord_index == Other.TexcoordIndex;
+        }
+    }
+
+    Match = Match && Offset == Mesh.Indices.size();
+
+    std::cout << "MODEL > Parser check " << FilePath << ": " << (Match ? "match" : "MISMATCH") << std::endl;
+    std::cout << "MODEL > tinyobj: " << std::chrono::duration<float, std::chrono::milliseconds::period>(MiddleTime - StartTime).count() << " ms, ObjParser: "
+        << std::chrono::duration<float, std::chrono::milliseconds::period>(EndTime - MiddleTime).count() << " ms" << std::endl;
+
+    return Match;
+}
+
+bool Engine::Tools::VerifyGltf(const std::string& FilePath)
+{
+    /*
+        One sample interleaved in the Vertex layout, one with a view per attribute and 16 bit indices.
+        The source is a cold load of the OBJ, so its arrays are what the loader really produces.
+    */
+
+    std::filesystem::remove(Engine::MeshCache::GetCachePath(FilePath));
+
+    Engine::Model Source;
+    Source.Prepare(FilePath);
+
+    if (Source.Vertices.empty())
+    {
+        throw std::runtime_error("MODEL > glTF check needs an in-memory load, " + FilePath + " is imported streamed");
+    }
+
+    std::vector<uint32_t> Indices(Source.Indices.begin(), Source.Indices.begin() + Source.Lods[0].IndexCount);
+
+    bool Match = true;
+
+    for (bool Interleaved : { true, false })
+    {
+        std::string SamplePath = (std::filesystem::temp_directory_path() / (std::filesystem::path(FilePath).stem().string() + (Interleaved ? "_interleaved.glb" : "_separate.glb"))).string();
+        std::string Error;
+
+        if (!Engine::GltfParser::Write(SamplePath, Source.Vertices, Indices, Interleaved, Error))
+        {
+            throw std::runtime_error(Error);
+        }
+
+        auto StartTime = std::chrono::high_resolution_clock::now();
+
+        Engine::GltfParser::Mesh Mesh;
+
+        if (!Engine::GltfParser::Load(SamplePath, Mesh, Error))
+        {
+            throw std::runtime_error(Error);
+        }
+
+        auto EndTime = std::chrono::high_resolution_clock::now();
+
+        bool SampleMatch = Mesh.Vertices.size() == Source.Vertices.size() && Mesh.Indices == Indices &&
+            memcmp(Mesh.Vertices.data(), Source.Vertices.data(), sizeof(Vulkan::Renderer::Vertex) * Source.Vertices.size()) == 0;
+
+        std::cout << "MODEL > glTF check " << SamplePath << ": " << (SampleMatch ? "match" : "MISMATCH") << ", " << Mesh.BlockCopies << " block copies, "
+            << Mesh.ElementCopies << " element copies, " << std::chrono::duration<float, std::chrono::milliseconds::period>(EndTime - StartTime).count() << " ms" << std::endl;
+
+        /*
+            The sample loaded as a model, the cold Prepare writes its mesh cache and the warm one has to
+            keep no CPU copy, the data it stages from is the cache itself
+        */
+
+        std::filesystem::remove(Engine::MeshCache::GetCachePath(SamplePath));
+
+        Engine::Model Cold;
+        Cold.Prepare(SamplePath);
+
+        Engine::Model Warm;
+        Warm.Prepare(SamplePath);
+
+        bool WarmMapped = !Cold.Vertices.empty() && Warm.Vertices.empty() && Warm.Indices.empty();
+        bool WarmMatch = false;
+
+        Engine::MeshCache::CachedMesh Cached;
+
+        if (WarmMapped && Warm.VertexCount == Cold.VertexCount && Warm.IndexCount == Cold.IndexCount && Engine::MeshCache::Open(SamplePath, Cached))
+        {
+            WarmMatch = Cached.Info->VertexCount == Cold.VertexCount && Cached.Info->IndexCount == Cold.IndexCount &&
+                memcmp(Cached.Vertices, Cold.Vertices.data(), sizeof(Vulkan::Renderer::Vertex) * Cold.VertexCount) == 0 &&
+                memcmp(Cached.Indices, Cold.Indices.data(), sizeof(uint32_t) * Cold.IndexCount) == 0;
+
+            Engine::MeshCache::Close(Cached);
+        }
+
+        std::cout << "MODEL > glTF warm load " << SamplePath << ": " << (WarmMapped ? "mapped" : "NOT MAPPED") << ", " << (WarmMatch ? "match" : "MISMATCH") << std::endl;
+
+        Match = Match && SampleMatch && WarmMatch;
+    }
+
+    return Match;
+}
+
+void Engine::Tools::BenchmarkCache(const std::string& FilePath, int Iterations)
+{
+    /*
+        Cold starts without a cache file, so it parses the model and writes the cache like the first
+        load in the game does, warm maps that cache and stages straight from the mapping
+    */
+
+    std::string CachePath = Engine::MeshCache::GetCachePath(FilePath);
+
+    float ColdTime = 0.0f;
+    float WarmTime = 0.0f;
+
+    for (int i = 0; i < Iterations; i++)
+    {
+        std::filesystem::remove(CachePath);
+
+        auto StartTime = std::chrono::high_resolution_clock::now();
+
+        Engine::Model Model;
+        Model.Prepare(FilePath);
+        Model.Upload();
+
+        ColdTime += std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - StartTime).count();
+
+        Model.Destroy();
+        Vulkan::Staging::Submit();
+    }
+
+    for (int i = 0; i < Iterations; i++)
+    {
+        auto StartTime = std::chrono::high_resolution_clock::now();
+
+        Engine::Model Model;
+        Model.Prepare(FilePath);
+
+        /*
+            Only a warm Prepare leaves the CPU side arrays empty
+        */
+
+        if (!Model.Vertices.empty() || Model.VertexCount == 0)
+        {
+            throw std::runtime_error("BENCHMARK > Could not open mesh cache for " + FilePath);
+        }
+
+        Model.Upload();
+
+        WarmTime += std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - StartTime).count();
+
+        Model.Destroy();
+        Vulkan::Staging::Submit();
+    }
+
+    ColdTime /= Iterations;
+    WarmTime /= Iterations;
+
+    std::cout << "BENCHMARK > " << FilePath << std::endl;
+    std::cout << "BENCHMARK > Cold load: " << ColdTime << " ms" << std::endl;
+    std::cout << "BENCHMARK > Warm cache load: " << WarmTime << " ms" << std::endl;
+    std::cout << "BENCHMARK > Speedup: " << ColdTime / std::max(WarmTime, 0.001f) << "x" << std::endl;
+}
+
+void Engine::Tools::BenchmarkVertexMap(const std::string& FilePath, int Iterations)
+{
+    /*
+        Only the deduplication pass is timed, the OBJ is parsed once up front
+    */
+
+    Engine::ObjParser::Mesh Mesh;
+    std::string Error;
+
+    if (!Engine::ObjParser::Load(FilePath, Mesh, Error))
+    {
+        throw std::runtime_error(Error);
+    }
+
+    float LegacyTime = 0.0f;
+    float FlatTime = 0.0f;
+    size_t LegacyVertexCount = 0;
+    size_t FlatVertexCount = 0;
+    size_t FlatPeakBytes = 0;
+
+    LegacyPeakBytes = 0;
+
+    for (int i = 0; i < Iterations; i++)
+    {
+        std::vector<Vulkan::Renderer::Vertex> Vertices;
+        std::vector<uint32_t> Indices;
+
+        auto StartTime = std::chrono::high_resolution_clock::now();
+
+        {
+            std::unordered_map<Vulkan::Renderer::Vertex, uint32_t, LegacyVertexHash, std::equal_to<Vulkan::Renderer::Vertex>,
+                CountingAllocator<std::pair<const Vulkan::Renderer::Vertex, uint32_t>>> UniqueVertices{};
+
+            for (const auto& Index : Mesh.Indices)
+            {
+                Vulkan::Renderer::Vertex Vertex = Engine::ObjParser::BuildVertex(Mesh, Index);
+
+                if (UniqueVertices.count(Vertex) == 0)
+                {
+                    UniqueVertices[Vertex] = static_cast<uint32_t>(Vertices.size());
+                    Vertices.push_back(Vertex);
+                }
+                Indices.push_back(UniqueVertices[Vertex]);
+            }
+        }
+
+        LegacyTime += std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - StartTime).count();
+        LegacyVertexCount = Vertices.size();
+    }
+
+    for (int i = 0; i < Iterations; i++)
+    {
+        std::vector<Vulkan::Renderer::Vertex> Vertices;
+        std::vector<uint32_t> Indices;
+
+        auto StartTime = std::chrono::high_resolution_clock::now();
+
+        {
+            Engine::VertexMap UniqueVertices(Engine::ObjParser::EstimateUniqueVertices(Mesh));
+            Indices.reserve(Mesh.Indices.size());
+
+            for (const auto& Index : Mesh.Indices)
+            {
+                Indices.push_back(UniqueVertices.Insert(Engine::ObjParser::BuildVertex(Mesh, Index), Vertices));
+            }
+
+            FlatPeakBytes = UniqueVertices.GetPeakMemoryUsage();
+        }
+
+        FlatTime += std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - StartTime).count();
+        FlatVertexCount = Vertices.size();
+    }
+
+    LegacyTime /= Iterations;
+    FlatTime /= Iterations;
+
+    std::cout << "BENCHMARK > " << FilePath << " (" << Mesh.Indices.size() << " corners)" << std::endl;
+    std::cout << "BENCHMARK > std::unordered_map: " << LegacyTime << " ms, peak " << LegacyPeakBytes / 1024 << " KB, " << LegacyVertexCount << " vertices" << std::endl;
+    std::cout << "BENCHMARK > VertexMap: " << FlatTime << " ms, peak " << FlatPeakBytes / 1024 << " KB, " << FlatVertexCount << " vertices" << std::endl;
+    std::cout << "BENCHMARK > Speedup: " << LegacyTime / std::max(FlatTime, 0.001f) << "x" << std::endl;
+}
+
+void Engine::Tools::BenchmarkStreamingImport(const std::string& FilePath)
+{
+    /*
+        The streamed import runs first and its model is then loaded from the cache it wrote, on platforms
+        where the process peak can't be reset the second measurement then includes the first. The
+        in-memory side is a cold Prepare with the threshold lifted, so it writes the cache as well.
+    */
+
+    size_t BaseResident = GetPeakResidentBytes();
+    bool Resettable = ResetPeakResidentBytes();
+
+    if (Resettable)
+    {
+        BaseResident = GetPeakResidentBytes();
+    }
+
+    auto StartTime = std::chrono::high_resolution_clock::now();
+
+    size_t StreamedTracked = Engine::Model::ImportStreaming(FilePath);
+
+    {
+        Engine::Model Model;
+        Model.Prepare(FilePath);
+        Model.Upload();
+
+        Model.Destroy();
+        Vulkan::Staging::Submit();
+    }
+
+    float StreamedTime = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - StartTime).count();
+    size_t StreamedResident = GetPeakResidentBytes();
+
+    size_t InMemoryBase = StreamedResident;
+
+    if (Resettable && ResetPeakResidentBytes())
+    {
+        InMemoryBase = GetPeakResidentBytes();
+    }
+
+    std::filesystem::remove(Engine::MeshCache::GetCachePath(FilePath));
+
+    StartTime = std::chrono::high_resolution_clock::now();
+
+    size_t InMemoryTracked = 0;
+
+    {
+        size_t Threshold = Engine::Model::StreamingImportThreshold;
+        Engine::Model::StreamingImportThreshold = SIZE_MAX;
+
+        Engine::Model Model;
+        Model.Prepare(FilePath);
+
+        Engine::Model::StreamingImportThreshold = Threshold;
+
+        InMemoryTracked = CapacityBytes(Model.Vertices) + CapacityBytes(Model.Indices) + CapacityBytes(Model.Meshlets);
+
+        Model.Upload();
+
+        Model.Destroy();
+        Vulkan::Staging::Submit();
+    }
+
+    float InMemoryTime = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - StartTime).count();
+    size_t InMemoryResident = GetPeakResidentBytes();
+
+    std::cout << "BENCHMARK > " << FilePath << std::endl;
+    std::cout << "BENCHMARK > Streamed import and load: " << StreamedTime << " ms, " << StreamedTracked / 1024 << " KB tracked, peak RSS +"
+        << (StreamedResident - std::min(StreamedResident, BaseResident)) / 1024 << " KB" << std::endl;
+    std::cout << "BENCHMARK > In-memory load: " << InMemoryTime << " ms, " << InMemoryTracked / 1024 << " KB final mesh, peak RSS +"
+        << (InMemoryResident - std::min(InMemoryResident, InMemoryBase)) / 1024 << " KB" << (Resettable ? "" : " (includes streamed pass)") << std::endl;
+}
+
+#endif
@@ -0,0 +1,154 @@
+#include "../../Common.h"
+#include "../API/Vulkan/Renderer.h"
+#include "../GameObject.h"
+#include "../ModelRegistry.h"
+#include "Tools.h"
+
+#if ENGINE_TOOLS
+
+#include <thread>
+#include <cmath>
+
+void Engine::Tools::BenchmarkRecording(const std::string& FilePath, uint32_t ObjectCount, int Iterations)
+{
+    /*
+        The tool runs on an empty scene, so the grid of copies is the whole scene and the numbers
+        measure recording and not streaming
+    */
+
+    if (!Engine::GameObject::GameObjects.empty() || Vulkan::Renderer::SwapChainFramebuffers.empty())
+    {
+        throw std::runtime_error("BENCHMARK > Recording needs the renderer up with an empty scene");
+    }
+
+    uint32_t Model = Engine::Models::Acquire(FilePath);
+    const Engine::Model& SourceModel = Engine::Models::Get(Model);
+
+    uint32_t Side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(ObjectCount))));
+    float Spacing = glm::length(SourceModel.BoundsMax - SourceModel.BoundsMin);
+
+    for (uint32_t i = 0; i < ObjectCount; i++)
+    {
+        Engine::GameObject::Object GameObject{};
+        GameObject.Model = Model;
+        GameObject.ModelPath = FilePath;
+        GameObject.Position = glm::vec3((i % Side) * Spacing, 0.0f, (i / Side) * Spacing);
+        GameObject.Scale = glm::vec3(1.0f);
+        GameObject.Transform = glm::translate(glm::mat4(1.0f), GameObject.Position);
+
+        Engine::GameObject::GameObjects.push_back(GameObject);
+    }
+
+    Engine::GameObject::BuildDrawList();
+
+    VkCommandBufferAllocateInfo AllocateInfo{};
+    AllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    AllocateInfo.commandPool = Vulkan::Renderer::CommandPool;
+    AllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    AllocateInfo.commandBufferCount = 1;
+
+    VkCommandBuffer CommandBuffer;
+
+    if (vkAllocateCommandBuffers(Vulkan::Renderer::Device, &AllocateInfo, &CommandBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("BENCHMARK > Failed to allocate command buffer!");
+    }
+
+    VkRenderPassBeginInfo RenderPassInfo{};
+    RenderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    RenderPassInfo.renderPass = Vulkan::Renderer::RenderPass;
+    RenderPassInfo.framebuffer = Vulkan::Renderer::SwapChainFramebuffers[0];
+    RenderPassInfo.renderArea.extent = Vulkan::Renderer::SwapChainExtent;
+
+    std::array<VkClearValue, 2> ClearValues{};
+    ClearValues[0].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
+    ClearValues[1].depthStencil = { 1.0f, 0 };
+
+    RenderPassInfo.clearValueCount = static_cast<uint32_t>(ClearValues.size());
+    RenderPassInfo.pClearValues = ClearValues.data();
+
+    VkCommandBufferInheritanceInfo Inheritance{};
+    Inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    Inheritance.renderPass = Vulkan::Renderer::RenderPass;
+    Inheritance.subpass = 0;
+    Inheritance.framebuffer = Vulkan::Renderer::SwapChainFramebuffers[0];
+
+    /*
+        Zero threads is the inline path, anything else records secondaries on that many threads
+    */
+
+    auto Measure = [&](uint32_t Threads)
+    {
+        if (Threads > 0)
+        {
+            Vulkan::Recording::Stop();
+            Vulkan::Recording::Start(Threads);
+        }
+
+        double Total = 0.0;
+
+        for (int i = 0; i < Iterations; i++)
+        {
+            auto Start = std::chrono::high_resolution_clock::now();
+
+            Vulkan::Recording::BeginFrame(Vulkan::Renderer::CurrentFrame);
+
+            VkCommandBufferBeginInfo BeginInfo{};
+            BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+            vkBeginCommandBuffer(CommandBuffer, &BeginInfo);
+
+            if (Threads == 0)
+            {
+                vkCmdBeginRenderPass(CommandBuffer, &RenderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+                Vulkan::Renderer::BindFrameState(CommandBuffer);
+                Engine::GameObject::RenderGameObjects(CommandBuffer);
+            }
+            else
+            {
+                vkCmdBeginRenderPass(CommandBuffer, &RenderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+                Engine::GameObject::RenderGameObjectsParallel(CommandBuffer, Inheritance);
+            }
+
+            vkCmdEndRenderPass(CommandBuffer);
+            vkEndCommandBuffer(CommandBuffer);
+
+            Total += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - Start).count();
+        }
+
+        return Total / Iterations;
+    };
+
+    std::cout << "BENCHMARK > Recording " << ObjectCount << " objects, " << Engine::GameObject::DrawList.size() << " submesh draws" << std::endl;
+
+    double Inline = Measure(0);
+
+    std::cout << "BENCHMARK > Inline: " << Inline << " ms" << std::endl;
+
+    uint32_t MaxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    double Single = 0.0;
+
+    for (uint32_t Threads = 1; Threads <= MaxThreads; Threads *= 2)
+    {
+        double Time = Measure(Threads);
+
+        if (Threads == 1)
+        {
+            Single = Time;
+        }
+
+        std::cout << "BENCHMARK > Secondaries on " << Threads << " threads: " << Time << " ms (" << Single / Time << "x over 1 thread, "
+            << Inline / Time << "x over inline)" << std::endl;
+    }
+
+    vkFreeCommandBuffers(Vulkan::Renderer::Device, Vulkan::Renderer::CommandPool, 1, &CommandBuffer);
+
+    Engine::GameObject::GameObjects.clear();
+    Engine::GameObject::DrawList.clear();
+
+    Engine::Models::Release(Model);
+}
+
+#endif
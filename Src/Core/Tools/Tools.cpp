@@ -0,0 +1,134 @@
+#include "../../Common.h"
+#include "../../Engine.h"
+#include "../API/Vulkan/Renderer.h"
+#include "../MeshCache.h"
+#include "Tools.h"
+
+#if ENGINE_TOOLS
+
+#include <filesystem>
+
+namespace
+{
+    struct Tool
+    {
+        const char* Flag;
+        const char* Usage;
+        size_t RequiredArguments;
+
+        /*
+            Brought up before the tool runs and torn down after it, the scene stays empty
+        */
+
+        bool Renderer;
+        std::function<bool(const std::vector<std::string>& Arguments)> Run;
+    };
+
+    const std::vector<Tool>& GetTools()
+    {
+        static const std::vector<Tool> Tools = {
+            { "--verify-parser", "<model.obj>", 1, false, [](const std::vector<std::string>& Arguments)
+            {
+                return Engine::Tools::VerifyParser(Arguments[0]);
+            } },
+            { "--verify-gltf", "<model.obj>", 1, false, [](const std::vector<std::string>& Arguments)
+            {
+                return Engine::Tools::VerifyGltf(Arguments[0]);
+            } },
+            { "--bench-cache", "<model> [iterations]", 1, true, [](const std::vector<std::string>& Arguments)
+            {
+                Engine::Tools::BenchmarkCache(Arguments[0], Arguments.size() > 1 ? std::stoi(Arguments[1]) : 5);
+                return true;
+            } },
+            { "--bench-vertex-map", "<model.obj> [iterations]", 1, false, [](const std::vector<std::string>& Arguments)
+            {
+                Engine::Tools::BenchmarkVertexMap(Arguments[0], Arguments.size() > 1 ? std::stoi(Arguments[1]) : 5);
+                return true;
+            } },
+            { "--bench-streaming-import", "<model.obj>", 1, true, [](const std::vector<std::string>& Arguments)
+            {
+                Engine::Tools::BenchmarkStreamingImport(Arguments[0]);
+                return true;
+            } },
+            { "--bench-recording", "<model> [objects] [iterations]", 1, true, [](const std::vector<std::string>& Arguments)
+            {
+                Engine::Tools::BenchmarkRecording(Arguments[0], Arguments.size() > 1 ? static_cast<uint32_t>(std::stoul(Arguments[1])) : 10000,
+                    Arguments.size() > 2 ? std::stoi(Arguments[2]) : 20);
+                return true;
+            } },
+        };
+
+        return Tools;
+    }
+
+    void PrintUsage()
+    {
+        std::cout << "TOOLS > Usage:" << std::endl;
+
+        for (const auto& Entry : GetTools())
+        {
+            std::cout << "TOOLS >     " << Entry.Flag << " " << Entry.Usage << std::endl;
+        }
+    }
+}
+
+int Engine::Tools::Run(const std::vector<std::string>& Arguments)
+{
+    if (Arguments.empty())
+    {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    for (const auto& Entry : GetTools())
+    {
+        if (Arguments[0] != Entry.Flag)
+        {
+            continue;
+        }
+
+        std::vector<std::string> ToolArguments(Arguments.begin() + 1, Arguments.end());
+
+        if (ToolArguments.size() < Entry.RequiredArguments)
+        {
+            PrintUsage();
+            return EXIT_FAILURE;
+        }
+
+        /*
+            Tools get a mesh cache of their own, so they never replace or remove the game's cache files
+        */
+
+        Engine::MeshCache::CacheDirectory = (std::filesystem::temp_directory_path() / "EngineTools" / "Meshes").string();
+
+        if (!Entry.Renderer)
+        {
+            return Entry.Run(ToolArguments) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        Engine::Init(API::Vulkan);
+
+        bool Passed = false;
+
+        try
+        {
+            Passed = Entry.Run(ToolArguments);
+        }
+        catch (...)
+        {
+            Vulkan::Renderer::CleanUp();
+            throw;
+        }
+
+        Vulkan::Renderer::CleanUp();
+
+        return Passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    std::cout << "TOOLS > Unknown tool " << Arguments[0] << std::endl;
+    PrintUsage();
+
+    return EXIT_FAILURE;
+}
+
+#endif
@@ -0,0 +1,76 @@
+#pragma once
+
+#ifndef TOOLS_H
+#define TOOLS_H
+
+/*
+	Developer checks and benchmarks, run from the command line instead of the game (see Usage in
+	Tools.cpp). On in debug builds, define ENGINE_TOOLS as 1 to keep them in a release build or as 0
+	to drop them from a debug one, when it is 0 main always starts the game.
+*/
+
+#ifndef ENGINE_TOOLS
+	#ifdef NDEBUG
+		#define ENGINE_TOOLS 0
+	#else
+		#define ENGINE_TOOLS 1
+	#endif
+#endif
+
+#if ENGINE_TOOLS
+
+namespace Engine
+{
+	namespace Tools
+	{
+		/*
+			Arguments excludes the program name, the first one selects the tool. Returns the process
+			exit code, failure if the tool is unknown or its check didn't pass.
+		*/
+
+		int Run(const std::vector<std::string>& Arguments);
+
+		/*
+			Reference check, the in-tree OBJ parser has to produce exactly what tinyobj produces
+		*/
+
+		bool VerifyParser(const std::string& FilePath);
+
+		/*
+			Round trip check, the OBJ's final vertex and index arrays are written out as .glb samples and
+			have to come back bit for bit, both parsed and through the mesh cache on a warm load
+		*/
+
+		bool VerifyGltf(const std::string& FilePath);
+
+		/*
+			Cold against warm load of one model, both through to the staging ring
+		*/
+
+		void BenchmarkCache(const std::string& FilePath, int Iterations = 5);
+
+		/*
+			Deduplication of an OBJ's triangle corners through VertexMap and through the
+			std::unordered_map it replaced, the file is parsed once and only the dedup pass is timed
+		*/
+
+		void BenchmarkVertexMap(const std::string& FilePath, int Iterations = 5);
+
+		/*
+			Streamed import against an in-memory load of one OBJ, time and peak memory of each
+		*/
+
+		void BenchmarkStreamingImport(const std::string& FilePath);
+
+		/*
+			Loads the model into a scene of ObjectCount copies and records it inline and on 1, 2, 4...
+			threads, needs the renderer up with nothing else in the scene
+		*/
+
+		void BenchmarkRecording(const std::string& FilePath, uint32_t ObjectCount = 10000, int Iterations = 20);
+	}
+}
+
+#endif
+
+#endif
@@ -0,0 +1,108 @@
+#include "../Common.h"
+#include "./API/Vulkan/Renderer.h"
+#include "VertexMap.h"
+#include "Hash.h"
+
+static_assert(sizeof(Vulkan::Renderer::Vertex) == 44, "VertexMap hashes the vertex as raw bytes, it must not contain padding");
+
+namespace
+{
+    inline uint64_t HashVertex(const Vulkan::Renderer::Vertex& Vertex)
+    {
+        return Engine::Hash::Bytes(&Vertex, sizeof(Vertex));
+    }
+
+    inline bool SameVertex(const Vulkan::Renderer::Vertex& A, const Vulkan::Renderer::Vertex& B)
+    {
+        return memcmp(&A, &B, sizeof(Vulkan::Renderer::Vertex)) == 0;
+    }
+}
+
+Engine::VertexMap::VertexMap(size_t ExpectedCount)
+{
+    /*
+        Keep the load factor at or below 0.5 so probe sequences stay short
+    */
+
+    size_t Capacity = 16;
+
+    while (Capacity < ExpectedCount * 2)
+    {
+        Capacity <<= 1;
+    }
+
+    Engine::VertexMap::Slots.assign(Capacity, { 0, Engine::VertexMap::Empty });
+    Engine::VertexMap::Mask = Capacity - 1;
+    Engine::VertexMap::PeakMemory = Engine::VertexMap::GetMemoryUsage();
+}
+
+uint32_t Engine::VertexMap::Insert(const Vulkan::Renderer::Vertex& Vertex, std::vector<Vulkan::Renderer::Vertex>& Vertices)
+{
+    if ((Engine::VertexMap::Count + 1) * 2 > Engine::VertexMap::Slots.size())
+    {
+        Engine::VertexMap::Grow(Vertices);
+    }
+
+    uint64_t Hash = HashVertex(Vertex);
+    uint32_t Tag = static_cast<uint32_t>(Hash >> 32);
+    size_t Position = static_cast<size_t>(Hash) & Engine::VertexMap::Mask;
+
+    while (true)
+    {
+        Slot& Current = Engine::VertexMap::Slots[Position];
+
+        if (Current.Index == Engine::VertexMap::Empty)
+        {
+            Current.Tag = Tag;
+            Current.Index = static_cast<uint32_t>(Vertices.size());
+
+            Vertices.push_back(Vertex);
+            Engine::VertexMap::Count++;
+
+            return Current.Index;
+        }
+
+        if (Current.Tag == Tag && SameVertex(Vertices[Current.Index], Vertex))
+        {
+            return Current.Index;
+        }
+
+        Position = (Position + 1) & Engine::VertexMap::Mask;
+    }
+}
+
+void Engine::VertexMap::Grow(const std::vector<Vulkan::Renderer::Vertex>& Vertices)
+{
+    std::vector<Slot> OldSlots(Engine::VertexMap::Slots.size() * 2, { 0, Engine::VertexMap::Empty });
+    OldSlots.swap(Engine::VertexMap::Slots);
+
+    Engine::VertexMap::Mask = Engine::VertexMap::Slots.size() - 1;
+    Engine::VertexMap::PeakMemory = std::max(Engine::VertexMap::PeakMemory, (OldSlots.size() + Engine::VertexMap::Slots.size()) * sizeof(Slot));
+
+    for (const Slot& Old : OldSlots)
+    {
+        if (Old.Index == Engine::VertexMap::Empty)
+        {
+            continue;
+        }
+
+        size_t Position = static_cast<size_t>(HashVertex(Vertices[Old.Index])) & Engine::VertexMap::Mask;
+
+        while (Engine::VertexMap::Slots[Position].Index != Engine::VertexMap::Empty)
+        {
+            Position = (Position + 1) & Engine::VertexMap::Mask;
+        }
+
+        Engine::VertexMap::Slots[Position] = Old;
+    }
+}
+
+size_t Engine::VertexMap::GetMemoryUsage() const
+{
+    return Engine::VertexMap::Slots.size() * sizeof(Slot);
+}
+
+size_t Engine::VertexMap::GetPeakMemoryUsage() const
+{
+    return Engine::VertexMap::PeakMemory;
+}
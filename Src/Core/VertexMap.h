@@ -0,0 +1,47 @@
+#pragma once
+
+#ifndef VERTEXMAP_H
+#define VERTEXMAP_H
+
+namespace Engine
+{
+	/*
+		Open addressing vertex -> index map used for deduplication while building models.
+
+		Slots only hold a 32-bit hash tag and the vertex index, the key itself is read back from
+		the vertex array so the table stays at 8 bytes per slot. Hashing covers all 44 bytes of
+		the vertex and equality is bitwise, so the hash and compare always agree.
+	*/
+
+	class VertexMap
+	{
+	public:
+		explicit VertexMap(size_t ExpectedCount);
+
+		/*
+			Single probe sequence, returns the existing index or appends the vertex and returns its new index
+		*/
+
+		uint32_t Insert(const Vulkan::Renderer::Vertex& Vertex, std::vector<Vulkan::Renderer::Vertex>& Vertices);
+
+		size_t GetMemoryUsage() const;
+		size_t GetPeakMemoryUsage() const;
+	private:
+		struct Slot
+		{
+			uint32_t Tag;
+			uint32_t Index;
+		};
+
+		static const uint32_t Empty = 0xFFFFFFFF;
+
+		std::vector<Slot> Slots;
+		size_t Mask = 0;
+		size_t Count = 0;
+		size_t PeakMemory = 0;
+
+		void Grow(const std::vector<Vulkan::Renderer::Vertex>& Vertices);
+	};
+}
+
+#endif
@@ -0,0 +1,109 @@
+#include "../Common.h"
+#include "./API/Vulkan/Renderer.h"
+#include "VertexPacking.h"
+
+#include <cmath>
+
+static_assert(sizeof(Vulkan::Renderer::PackedVertex) == 20, "PackedVertex layout has to match BasePackedShader.vert");
+
+namespace
+{
+    inline float SignNotZero(float Value)
+    {
+        return Value >= 0.0f ? 1.0f : -1.0f;
+    }
+
+    inline uint16_t QuantizeUnorm16(float Value, float Minimum, float Extent)
+    {
+        if (Extent <= 0.0f)
+        {
+            return 0;
+        }
+
+        float Normalized = std::min(std::max((Value - Minimum) / Extent, 0.0f), 1.0f);
+
+        return static_cast<uint16_t>(std::lround(Normalized * 65535.0f));
+    }
+
+    inline int16_t QuantizeSnorm16(float Value)
+    {
+        return static_cast<int16_t>(std::lround(std::min(std::max(Value, -1.0f), 1.0f) * 32767.0f));
+    }
+}
+
+void Engine::VertexPacking::EncodeOctahedral(const glm::vec3& Normal, int16_t Encoded[2])
+{
+    float Length = std::fabs(Normal.x) + std::fabs(Normal.y) + std::fabs(Normal.z);
+
+    if (Length <= 0.0f)
+    {
+        Encoded[0] = 0;
+        Encoded[1] = 0;
+        return;
+    }
+
+    float X = Normal.x / Length;
+    float Y = Normal.y / Length;
+
+    if (Normal.z < 0.0f)
+    {
+        float FoldedX = (1.0f - std::fabs(Y)) * SignNotZero(X);
+        float FoldedY = (1.0f - std::fabs(X)) * SignNotZero(Y);
+
+        X = FoldedX;
+        Y = FoldedY;
+    }
+
+    Encoded[0] = QuantizeSnorm16(X);
+    Encoded[1] = QuantizeSnorm16(Y);
+}
+
+glm::vec3 Engine::VertexPacking::DecodeOctahedral(const int16_t Encoded[2])
+{
+    float X = std::max(Encoded[0] / 32767.0f, -1.0f);
+    float Y = std::max(Encoded[1] / 32767.0f, -1.0f);
+    float Z = 1.0f - std::fabs(X) - std::fabs(Y);
+
+    float Fold = std::min(std::max(-Z, 0.0f), 1.0f);
+
+    X += X >= 0.0f ? -Fold : Fold;
+    Y += Y >= 0.0f ? -Fold : Fold;
+
+    return glm::normalize(glm::vec3(X, Y, Z));
+}
+
+void Engine::VertexPacking::Pack(const Vulkan::Renderer::Vertex* Vertices, size_t Count, const glm::vec3& BoundsMin, const glm::vec3& BoundsMax, std::vector<Vulkan::Renderer::PackedVertex>& Result)
+{
+    glm::vec3 Extent = BoundsMax - BoundsMin;
+
+    Result.resize(Count);
+
+    for (size_t i = 0; i < Count; i++)
+    {
+        const Vulkan::Renderer::Vertex& Source = Vertices[i];
+        Vulkan::Renderer::PackedVertex& Packed = Result[i];
+
+        Packed.Pos[0] = QuantizeUnorm16(Source.Pos.x, BoundsMin.x, Extent.x);
+        Packed.Pos[1] = QuantizeUnorm16(Source.Pos.y, BoundsMin.y, Extent.y);
+        Packed.Pos[2] = QuantizeUnorm16(Source.Pos.z, BoundsMin.z, Extent.z);
+        Packed.Pos[3] = 0xFFFF;
+
+        Engine::VertexPacking::EncodeOctahedral(Source.Normal, Packed.Normal);
+
+        Packed.UV = Source.UV;
+    }
+}
+
+Vulkan::Renderer::Vertex Engine::VertexPacking::Unpack(const Vulkan::Renderer::PackedVertex& Packed, const glm::vec3& BoundsMin, const glm::vec3& BoundsMax)
+{
+    glm::vec3 Extent = BoundsMax - BoundsMin;
+
+    Vulkan::Renderer::Vertex Vertex{};
+
+    Vertex.Pos = BoundsMin + glm::vec3(Packed.Pos[0] / 65535.0f, Packed.Pos[1] / 65535.0f, Packed.Pos[2] / 65535.0f) * Extent;
+    Vertex.Normal = Engine::VertexPacking::DecodeOctahedral(Packed.Normal);
+    Vertex.UV = Packed.UV;
+    Vertex.Color = glm::vec3(1.0f);
+
+    return Vertex;
+}
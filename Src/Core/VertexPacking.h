@@ -0,0 +1,22 @@
+#pragma once
+
+#ifndef VERTEXPACKING_H
+#define VERTEXPACKING_H
+
+namespace Engine
+{
+	/*
+		Conversion between the full 44 byte vertex and Vulkan::Renderer::PackedVertex
+	*/
+
+	namespace VertexPacking
+	{
+		void EncodeOctahedral(const glm::vec3& Normal, int16_t Encoded[2]);
+		glm::vec3 DecodeOctahedral(const int16_t Encoded[2]);
+
+		void Pack(const Vulkan::Renderer::Vertex* Vertices, size_t Count, const glm::vec3& BoundsMin, const glm::vec3& BoundsMax, std::vector<Vulkan::Renderer::PackedVertex>& Result);
+		Vulkan::Renderer::Vertex Unpack(const Vulkan::Renderer::PackedVertex& Packed, const glm::vec3& BoundsMin, const glm::vec3& BoundsMax);
+	}
+}
+
+#endif
@@ -3,9 +3,11 @@
 #include "Core/FileSystem/FileSystem.h"
 
 #include "Core/Input.h"
+#include "Core/Profiler.h"
 #include "Core/Camera.h"
 
 #include "Core/API/Vulkan/Renderer.h"
+#include "Core/GameObject.h"
 
 bool Engine::Running;
 
@@ -15,8 +17,17 @@ SDL_bool WindowFullscreen;
 
 void Engine::Run()
 {
+    PROFILE_THREAD("Main");
+
     Engine::Init(API::Vulkan);
 
+    /*
+        The scene is created here rather than in Init, so the command line tools get the renderer
+        without it
+    */
+
+    Engine::GameObject::CreateGameObjects();
+
     FileSystem::LoadTextures();
 
     Engine::Running = true;
@@ -29,8 +40,19 @@ void Engine::Run()
 
     while (Engine::Running)
     {
+        PROFILE_ZONE("Frame");
+
         SDL_Event RunEvent;
 
+        /*
+            Wait for a free frame before reading input, so what gets drawn is as fresh as it can be
+        */
+
+        if (Engine::GetAPI() == API::Vulkan)
+        {
+            Vulkan::Renderer::BeginFrame();
+        }
+
         Engine::Input::ParseEvent();
 
         /*
@@ -77,6 +99,8 @@ const API& Engine::GetAPI()
 
 void Engine::Init(API API)
 {
+    PROFILE_ZONE("Engine::Init");
+
     Engine::SetAPI(API::Vulkan);
 
     /*
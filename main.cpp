@@ -1,10 +1,18 @@
 #include "./Src/Common.h"
 #include "./Src/Engine.h"  
+#include "./Src/Core/Tools/Tools.h"
 
-int main()
+int main(int argc, char** argv)
 {
     try
     {
+#if ENGINE_TOOLS
+        if (argc > 1)
+        {
+            return Engine::Tools::Run(std::vector<std::string>(argv + 1, argv + argc));
+        }
+#endif
+
         Engine::Run();
     }
     catch (const std::exception& e)